@@ -4,17 +4,29 @@
  * @brief Refer RFC8017.
  *        PKCS #1: RSA Cryptography Specifications Version 2.2
  *        (https://tools.ietf.org/html/rfc8017)
+ *
+ *        The primitives taking a key are reentrant. Each *_ws() primitive
+ *        works in the scratch of pkcs1_scratch_alloc() given by the caller,
+ *        which keeps one scratch per thread; rsaep(), rsadp(), rsasp1() and
+ *        rsavp1() put one on their stack. Results go to the buffers of the
+ *        caller only. They neither call libtommath nor print, and the only
+ *        state shared between threads is the selection of
+ *        pkcs1_kernel_select(), pkcs1_const_time_set(),
+ *        pkcs1_mul_pool_set(), pkcs1_sign_check_set() and
+ *        pkcs1_exp_autotune(), which is only read once it is made.
  * 
  * @copyright Copyright (c) 2020 Hidenori BABA
  * 
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
-#include <assert.h>
+#include <string.h>
 #include <tommath.h>
 
 #include "pkcs1.h"
+#include "pkcs1_local.h"
 #include "utils.h"
 
 /**
@@ -32,16 +44,202 @@
  */
 static bool range_chk(const uint8_t *a, size_t alen, const uint8_t *n, size_t nlen)
 {
-    bool ret;
-	mp_int x;
-	mp_int y;
+    bool        ret;
+    PKCS1_FBN_t x;
+    PKCS1_FBN_t y;
+
+    if ((PKCS1_E_OK != pkcs1_fbn_read(&x, a, alen)) ||
+        (PKCS1_E_OK != pkcs1_fbn_read(&y, n, nlen))) {
+        ret = false;
+    }
+    else {
+        ret = (0 > pkcs1_fbn_cmp(&x, &y)) ? true : false;
+    }
+    pkcs1_fbn_clear(&x);
+
+    return ret;
+}
+
+/**
+ * @brief Check a modulus length. Any length from PKCS1_MIN_N_LEN to
+ *        PKCS1_MAX_N_LEN bytes is supported, not only the usual 1024 to
+ *        4096 bit. The modulus, if given, must not have a leading zero byte,
+ *        since its length is the length k of the representatives.
+ *
+ * @param n[in]     Modulus (big-endian), or NULL to check the length only.
+ * @param n_len[in] Length of modulus in bytes.
+ * @return          true if the modulus length is supported.
+ */
+bool pkcs1_n_len_chk(const uint8_t *n, size_t n_len)
+{
+    return (PKCS1_MIN_N_LEN <= n_len) && (PKCS1_MAX_N_LEN >= n_len) &&
+           ((NULL == n) || (0 != n[0]));
+}
+
+static bool sign_check;     /* pkcs1_rsa_sign() checks every signature with e. */
+
+/**
+ * @brief Whether pkcs1_rsa_sign() and pkcs1_rsa_sign_ctx() check the signatures.
+ */
+bool pkcs1_sign_check(void)
+{
+    return sign_check;
+}
+
+/**
+ * @brief Select the fault check of the signatures.
+ *        pkcs1_rsa_sign() and pkcs1_rsa_sign_ctx() then verify every
+ *        signature s with the public exponent, s^e mod n == m, before they
+ *        return it. A fault in the private key operation, as in the CRT
+ *        recombination m = m_2 + q * h, would otherwise release a signature
+ *        that gives away a factor of n. A wrong signature is never written,
+ *        PKCS1_E_VERIFY is returned. The keys must then hold e. Call it
+ *        before other threads use this module.
+ *
+ * @param on[in]    true to check the signatures, false for the default.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK   Success.
+ */
+int pkcs1_sign_check_set(bool on)
+{
+    sign_check = on;
+
+    return PKCS1_E_OK;
+}
+
+/**
+ * @brief Allocate the scratch of the *_ws() primitives.
+ *        A scratch holds the working numbers of one operation at a time, so
+ *        every thread keeps its own. It is allocated once, and the large
+ *        working numbers then live there instead of on the stack.
+ *
+ * @param ws[out]   Allocated scratch.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ */
+int pkcs1_scratch_alloc(PKCS1_SCRATCH_t **ws)
+{
+    int ret;
+
+    if (NULL == ws) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        *ws = calloc(1, sizeof(PKCS1_SCRATCH_t));
+        ret = (NULL != *ws) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Release a scratch of pkcs1_scratch_alloc().
+ *
+ * @param ws[in]    Scratch, may be NULL.
+ */
+void pkcs1_scratch_free(PKCS1_SCRATCH_t *ws)
+{
+    if (NULL != ws) {
+        memset(ws, 0, sizeof(PKCS1_SCRATCH_t));
+        free(ws);
+    }
+}
 
-	assert(MP_OKAY == mp_init_multi(&x, &y, NULL));
+/**
+ * @brief Exponentiation with a private exponent. y = b^e mod m
+ *        pkcs1_fbn_exptmod_ct() if the constant-time engine is selected,
+ *        otherwise pkcs1_fbn_exptmod().
+ */
+static int priv_exptmod(PKCS1_SCRATCH_t *ws, const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y)
+{
+    return pkcs1_const_time() ? pkcs1_fbn_exptmod_ct_ws(&ws->exp, b, e, elen, m, y) :
+                                pkcs1_fbn_exptmod_ws(&ws->exp, b, e, elen, m, y);
+}
 
-	assert(MP_OKAY == mp_read_unsigned_bin(&x, a, alen));
-	assert(MP_OKAY == mp_read_unsigned_bin(&y, n, nlen));
+/**
+ * @brief Check the lengths of the CRT components of a private key.
+ *        A two-prime key has p, q, dP, dQ and qInv of exactly n_len / 2 bytes.
+ *        The primes of a multi-prime key are shorter, so any component of a
+ *        multi-prime key may be up to n_len / 2 bytes.
+ * 
+ * @param key[in]   RSA Private Key.
+ * @return          Result of length check.
+ */
+static bool crt_len_chk(const RSA_TOOLS_PRIV_KEY_t *key)
+{
+    bool   ret;
+    size_t i;
+    size_t crt_len;
+
+    crt_len = key->n_len / 2;
+    if (0 == key->other_cnt) {
+        ret = (crt_len == key->p_len) && (crt_len == key->q_len) &&
+              (crt_len == key->dp_len) && (crt_len == key->dq_len) &&
+              (crt_len == key->qinv_len);
+    }
+    else {
+        ret = (NULL != key->other) && ((PKCS1_MAX_PRIMES - 2) >= key->other_cnt) &&
+              (0 < key->p_len) && (crt_len >= key->p_len) &&
+              (0 < key->q_len) && (crt_len >= key->q_len) &&
+              (0 < key->dp_len) && (crt_len >= key->dp_len) &&
+              (0 < key->dq_len) && (crt_len >= key->dq_len) &&
+              (0 < key->qinv_len) && (crt_len >= key->qinv_len);
+        for (i = 0; ret && (i < key->other_cnt); i++) {
+            ret = (NULL != key->other[i].r) && (0 < key->other[i].r_len) && (crt_len >= key->other[i].r_len) &&
+                  (NULL != key->other[i].d) && (0 < key->other[i].d_len) && (crt_len >= key->other[i].d_len) &&
+                  (NULL != key->other[i].t) && (0 < key->other[i].t_len) && (crt_len >= key->other[i].t_len);
+        }
+    }
 
-    ret = (MP_LT == (mp_cmp(&x, &y))) ? true : false;
+    return ret;
+}
+
+/**
+ * @brief Step 2.b.ii and 2.b.v of RSADP for the additional primes r_3, ..., r_u.
+ *        m = m_2 + q * h of the first two primes is extended to r_1 * ... * r_u.
+ *        r_i, t_i and m_i take the places of p, qInv and m_1 in the scratch.
+ * 
+ * @param ws[in,out]    Scratch holding c, p = r_1 and q = r_2, and in m the
+ *                      message representative modulo r_1 * r_2 on input,
+ *                      modulo n on output.
+ * @param key[in]       RSA Private Key.
+ * @return              Status of pkcs1_fbn_*().
+ */
+static int rsadp_crt_other(PKCS1_SCRATCH_t *ws, const RSA_TOOLS_PRIV_KEY_t *key)
+{
+    int    ret;
+    size_t i;
+
+    /* R = r_1 * r_2 */
+    ret = pkcs1_fbn_mul(&ws->p, &ws->q, &ws->R);
+    for (i = 0; (PKCS1_E_OK == ret) && (i < key->other_cnt); i++) {
+        ret = pkcs1_fbn_read(&ws->p, key->other[i].r, key->other[i].r_len);
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_fbn_read(&ws->qinv, key->other[i].t, key->other[i].t_len);
+        }
+        /* m_i = c^(d_i) mod r_i */
+        if (PKCS1_E_OK == ret) {
+            ret = priv_exptmod(ws, &ws->c, key->other[i].d, key->other[i].d_len, &ws->p, &ws->m_1);
+        }
+        /* h = (m_i - m) * t_i mod r_i */
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_fbn_submulmod(&ws->m_1, &ws->m, &ws->qinv, &ws->p, &ws->h);
+        }
+        /* m = m + R * h, R = R * r_i */
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_fbn_mul(&ws->R, &ws->h, &ws->h);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_fbn_add(&ws->m, &ws->h, &ws->m);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_fbn_mul(&ws->R, &ws->p, &ws->R);
+        }
+    }
 
     return ret;
 }
@@ -83,40 +281,44 @@ static bool range_chk(const uint8_t *a, size_t alen, const uint8_t *n, size_t nl
  */
 int rsaep(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *emsg, size_t *emlen)
 {
-	int    ret;
-    int    status;
-	mp_int n;
-	mp_int e;
-	mp_int m;
-	mp_int c;
-
-	if ((NULL == msg) || (NULL == emsg) || (NULL == emlen)) {
+    PKCS1_SCRATCH_t ws;
+
+    return rsaep_ws(&ws, key, msg, mlen, emsg, emlen);
+}
+
+/**
+ * @brief RSAEP of rsaep() in the scratch of the caller.
+ *
+ * @param ws[in]        Scratch of pkcs1_scratch_alloc(), one per thread.
+ * @param key[in]       RSA Public Key.
+ * @param msg[in]       Message buffer.
+ * @param mlen[in]      Length of message buffer.
+ * @param emsg[out]     Encrypted message buffer.
+ * @param emlen[in,out] Length of encrypted message buffer.
+ * @return              Status of this function, see rsaep().
+ */
+int rsaep_ws(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *emsg, size_t *emlen)
+{
+	int ret;
+
+	if ((NULL == ws) || (NULL == msg) || (NULL == emsg) || (NULL == emlen)) {
 		ret = PKCS1_E_PARAM;
 	}
 	else {
-		switch (key.n_len) {
-			case 128 :	/* RSA 1024 bit */
-			case 256 :	/* RSA 2048 bit */
-			case 384 :	/* RSA 3072 bit */
-			case 512 :	/* RSA 4096 bit */
-				if ((key.n_len != mlen) ||
-					(key.n_len != *emlen) ||
-					(0 == key.e_len) ||
-					(key.n_len < key.e_len)) {
-					ret = PKCS1_E_PARAM;
-				}
-				else {
-                    if (range_chk(msg, mlen, key.n, key.n_len)) {
-                        ret = PKCS1_E_OK;
-                    }
-                    else {
-    					ret = PKCS1_E_RANGE;
-                    }
-				}
-				break;
-			default:
-				ret = PKCS1_E_PARAM;
-				break;
+		if (!pkcs1_n_len_chk(key.n, key.n_len) ||
+			(key.n_len != mlen) ||
+			(key.n_len != *emlen) ||
+			(0 == key.e_len) ||
+			(key.n_len < key.e_len)) {
+			ret = PKCS1_E_PARAM;
+		}
+		else {
+            if (range_chk(msg, mlen, key.n, key.n_len)) {
+                ret = PKCS1_E_OK;
+            }
+            else {
+				ret = PKCS1_E_RANGE;
+            }
 		}
 	}
 
@@ -124,21 +326,19 @@ int rsaep(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *emsg, siz
 		/* Error case */
 	}
 	else {
-		assert(MP_OKAY == mp_init_multi(&n, &e, &m, &c, NULL));
-
-		assert(MP_OKAY == mp_read_unsigned_bin(&n, key.n, key.n_len));
-		assert(MP_OKAY == mp_read_unsigned_bin(&e, key.e, key.e_len));
-		assert(MP_OKAY == mp_read_unsigned_bin(&m, msg,   mlen));
-
-		status = mp_exptmod(&m, &e, &n, &c);
-		if (MP_OKAY != status) {
-            printf(" (MP Error: %s) ", mp_error_to_string(status));
-			ret = PKCS1_E_INTERNAL;
+		ret = pkcs1_fbn_read(&ws->n, key.n, key.n_len);
+		if (PKCS1_E_OK == ret) {
+			ret = pkcs1_fbn_read(&ws->m, msg, mlen);
 		}
-		else {
-			*emlen = mp_unsigned_bin_size(&c);
-			assert(MP_OKAY == mp_to_unsigned_bin(&c, emsg));
-			ret = PKCS1_E_OK;
+		/* e = 3, 65537, ...: fixed chain instead of the windows. */
+		if (PKCS1_E_OK == ret) {
+			ret = pkcs1_fbn_exptmod_ws(&ws->exp, &ws->m, key.e, key.e_len, &ws->n, &ws->c);
+		}
+		if (PKCS1_E_OK == ret) {
+			ret = pkcs1_fbn_write(&ws->c, emsg, *emlen);
+		}
+		if (PKCS1_E_OK != ret) {
+			ret = PKCS1_E_INTERNAL;
 		}
 	}
 
@@ -146,6 +346,166 @@ int rsaep(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *emsg, siz
 }
 
 
+/**
+ * @brief Fault check of a signature before it is released.
+ *        s^e mod n must give back the message representative m. The check
+ *        takes s as it is, already in the fixed-width form the output was
+ *        serialized from, and e = 65537 takes the chain of 16 squarings of
+ *        pkcs1_fbn_exptmod(), so it costs far less than rsaep() on the
+ *        output bytes.
+ *
+ * @param ws[in]    Scratch holding n, the signature representative s in m
+ *                  and the message representative in c.
+ * @param key[in]   RSA Private Key holding e.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       s is the signature of m.
+ * @retval PKCS1_E_VERIFY   s is wrong, a fault was detected.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+static int sign_chk(PKCS1_SCRATCH_t *ws, const RSA_TOOLS_PRIV_KEY_t *key)
+{
+    int ret;
+
+    if (0 <= pkcs1_fbn_cmp(&ws->m, &ws->n)) {
+        ret = PKCS1_E_VERIFY;
+    }
+    else {
+        ret = pkcs1_fbn_exptmod_ws(&ws->exp, &ws->m, key->e, key->e_len, &ws->n, &ws->v);
+        if (PKCS1_E_OK != ret) {
+            ret = PKCS1_E_INTERNAL;
+        }
+        else if (0 != pkcs1_fbn_cmp(&ws->v, &ws->c)) {
+            ret = PKCS1_E_VERIFY;
+        }
+        else {
+            ret = PKCS1_E_OK;
+        }
+        pkcs1_fbn_clear(&ws->v);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief RSADP of rsadp(), with the fault check of pkcs1_sign_check_set() if check.
+ */
+static int rsadp_chk(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PRIV_KEY_t key, uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, bool use_crt, bool check)
+{
+    int ret;
+
+	if ((NULL == ws) || (NULL == emsg) || (NULL == msg) || (NULL == mlen)) {
+		ret = PKCS1_E_PARAM;
+	}
+	else {
+        if (range_chk(emsg, emlen, key.n, key.n_len)) {
+            if (use_crt) {
+                if ((key.n_len != key.d_len) || !crt_len_chk(&key)) {
+                    ret = PKCS1_E_PARAM;
+                }
+                else {
+                    ret = PKCS1_E_OK;
+                }
+            }
+            else {
+                if (key.n_len != key.d_len) {
+                    ret = PKCS1_E_PARAM;
+                }
+                else {
+                    ret = PKCS1_E_OK;
+                }
+            }
+        }
+        else {
+            ret = PKCS1_E_RANGE;
+        }
+
+        if (PKCS1_E_OK != ret) {
+            /* In case of error exit */
+        }
+        else {
+            if (!pkcs1_n_len_chk(key.n, key.n_len) ||
+                (key.n_len != emlen) ||
+                (key.n_len != *mlen) ||
+                (check && ((NULL == key.e) || (0 == key.e_len)))) {
+                ret = PKCS1_E_PARAM;
+            }
+            else {
+                ret = PKCS1_E_OK;
+            }
+        }
+	}
+
+    if (PKCS1_E_OK != ret) {
+        /* Error case */
+    }
+    else {
+        ret = pkcs1_fbn_read(&ws->n, key.n, key.n_len);
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_fbn_read(&ws->c, emsg, emlen);
+        }
+        if (PKCS1_E_OK != ret) {
+            /* Error case */
+        }
+        else if (use_crt) {
+            ret = pkcs1_fbn_read(&ws->p, key.p, key.p_len);
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_fbn_read(&ws->q, key.q, key.q_len);
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_fbn_read(&ws->qinv, key.qinv, key.qinv_len);
+            }
+            /* m_1 = c^dP mod p. */
+            if (PKCS1_E_OK == ret) {
+                ret = priv_exptmod(ws, &ws->c, key.dp, key.dp_len, &ws->p, &ws->m_1);
+            }
+            /* m_2 = c^dQ mod q. */
+            if (PKCS1_E_OK == ret) {
+                ret = priv_exptmod(ws, &ws->c, key.dq, key.dq_len, &ws->q, &ws->m_2);
+            }
+            /* h = qInv ( m_1 - m_2 ) mod p. */
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_fbn_submulmod(&ws->m_1, &ws->m_2, &ws->qinv, &ws->p, &ws->h);
+            }
+            /* m = m_2 + hq. */
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_fbn_mul(&ws->q, &ws->h, &ws->m);
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_fbn_add(&ws->m, &ws->m_2, &ws->m);
+            }
+            /* m = m + R * h for r_3, ..., r_u. */
+            if ((PKCS1_E_OK == ret) && (0 < key.other_cnt)) {
+                ret = rsadp_crt_other(ws, &key);
+            }
+        }
+        else {
+            ret = priv_exptmod(ws, &ws->c, key.d, key.d_len, &ws->n, &ws->m);
+        }
+        if (PKCS1_E_OK != ret) {
+            ret = PKCS1_E_INTERNAL;
+        }
+        else if (check) {
+            /* m is checked before it is written, msg may be emsg. */
+            ret = sign_chk(ws, &key);
+        }
+        if ((PKCS1_E_OK == ret) && (PKCS1_E_OK != pkcs1_fbn_write(&ws->m, msg, *mlen))) {
+            ret = PKCS1_E_INTERNAL;
+        }
+
+        pkcs1_fbn_clear(&ws->p);
+        pkcs1_fbn_clear(&ws->q);
+        pkcs1_fbn_clear(&ws->qinv);
+        pkcs1_fbn_clear(&ws->m);
+        pkcs1_fbn_clear(&ws->m_1);
+        pkcs1_fbn_clear(&ws->m_2);
+        pkcs1_fbn_clear(&ws->h);
+        pkcs1_fbn_clear(&ws->R);
+    }
+
+    return ret;
+}
+
 /**
  * @brief RSA encryption primitive (RSADP)
  * 
@@ -229,115 +589,26 @@ int rsaep(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *emsg, siz
  */
 int rsadp(RSA_TOOLS_PRIV_KEY_t key, uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, bool use_crt)
 {
-    int    ret;
-    int    status;
-    size_t crt_len;
-	mp_int d, n, p, q, dp, dq, qinv;
-	mp_int c, m;
-	mp_int m_1, m_2;
-	mp_int h;
-	mp_int a;
-
-    crt_len = key.n_len / 2;
-	if ((NULL == emsg) || (NULL == msg) || (NULL == mlen)) {
-		ret = PKCS1_E_PARAM;
-	}
-	else {
-        if (range_chk(emsg, emlen, key.n, key.n_len)) {
-            if (use_crt) {
-                if ((key.n_len != key.d_len) ||
-                    (crt_len != key.p_len) ||
-                    (crt_len != key.q_len) ||
-                    (crt_len != key.dp_len) ||
-                    (crt_len != key.dq_len)||
-                    (crt_len != key.qinv_len)) {
-                    ret = PKCS1_E_PARAM;
-                }
-                else {
-                    ret = PKCS1_E_OK;
-                }
-            }
-            else {
-                if (key.n_len != key.d_len) {
-                    ret = PKCS1_E_PARAM;
-                }
-                else {
-                    ret = PKCS1_E_OK;
-                }
-            }
-        }
-        else {
-            ret = PKCS1_E_RANGE;
-        }
-
-        if (PKCS1_E_OK != ret) {
-            /* In case of error exit */
-        }
-        else {
-            switch (key.n_len) {
-                case 128 :	/* RSA 1024 bit */
-                case 256 :	/* RSA 2048 bit */
-                case 384 :	/* RSA 3072 bit */
-                case 512 :	/* RSA 4096 bit */
-                    if ((key.n_len != emlen) ||
-                        (key.n_len != *mlen)) {
-                        ret = PKCS1_E_PARAM;
-                    }
-                    else {
-                        ret = PKCS1_E_OK;
-                    }
-                    break;
-                default:
-                    ret = PKCS1_E_PARAM;
-                    break;
-            }
-        }
-	}
-
-    if (PKCS1_E_OK != ret) {
-        /* Error case */
-    }
-    else {
-    	assert(MP_OKAY == mp_init_multi(&n, &d, &p, &q, &dp, &dq, &qinv, &c, NULL));
-
-    	assert(MP_OKAY == mp_read_unsigned_bin(&n,    key.n,    key.n_len));
-	    assert(MP_OKAY == mp_read_unsigned_bin(&d,    key.d,    key.d_len));
-	    assert(MP_OKAY == mp_read_unsigned_bin(&p,    key.p,    key.p_len));
-	    assert(MP_OKAY == mp_read_unsigned_bin(&q,    key.q,    key.q_len));
-	    assert(MP_OKAY == mp_read_unsigned_bin(&dp,   key.dp,   key.dp_len));
-	    assert(MP_OKAY == mp_read_unsigned_bin(&dq,   key.dq,   key.dq_len));
-	    assert(MP_OKAY == mp_read_unsigned_bin(&qinv, key.qinv, key.qinv_len));
-	    assert(MP_OKAY == mp_read_unsigned_bin(&c,    emsg,     emlen));
+    PKCS1_SCRATCH_t ws;
 
-	    assert(MP_OKAY == mp_init_multi(&m, &m_1, &m_2, &h, &a, NULL));
-
-        mp_clear_multi(&m, &m_1, &m_2, &h, &a, NULL);
-        if (use_crt) {
-            /* m_1 = c^dP mod p. */
-            assert(MP_OKAY == mp_exptmod(&c, &dp, &p, &m_1));
-            /* m_2 = c^dQ mod q. */
-            assert(MP_OKAY == mp_exptmod(&c, &dq, &q, &m_2));
-            /* h = qInv ( m_1 - m_2 ) mod p. */
-            assert(MP_OKAY == mp_sub(&m_1, &m_2, &a));
-            assert(MP_OKAY == mp_mulmod(&qinv, &a, &p, &h));                
-            /* m = m_2 + hq. */
-            assert(MP_OKAY == mp_mul(&q, &h, &a));
-            status = mp_add(&a, &m_2, &m);
-        }
-        else {
-            status = mp_exptmod(&c, &d, &n, &m);
-        }
-        if (MP_OKAY != status) {
-            ret = PKCS1_E_INTERNAL;
-        }
-        else {
-            *mlen = mp_unsigned_bin_size(&m);
-            assert(MP_OKAY == mp_to_unsigned_bin(&m, msg));
-            ret = PKCS1_E_OK;
-        }
-    }
+    return rsadp_chk(&ws, key, emsg, emlen, msg, mlen, use_crt, false);
+}
 
-    return ret;
+/**
+ * @brief RSADP of rsadp() in the scratch of the caller.
+ *
+ * @param ws[in]        Scratch of pkcs1_scratch_alloc(), one per thread.
+ * @param key[in]       RSA Private Key.
+ * @param emsg[in]      Encrypted message buffer.
+ * @param emlen[in]     Length of encrypted message buffer.
+ * @param msg[in]       Message buffer.
+ * @param mlen[in,out]  Length of message buffer.
+ * @param use_crt[in]   CRT flag.
+ * @return              Status of this function, see rsadp().
+ */
+int rsadp_ws(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PRIV_KEY_t key, uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, bool use_crt)
+{
+    return rsadp_chk(ws, key, emsg, emlen, msg, mlen, use_crt, false);
 }
 
 
@@ -398,17 +669,33 @@ int rsadp(RSA_TOOLS_PRIV_KEY_t key, uint8_t *emsg, size_t emlen, uint8_t *msg, s
  */
 int rsasp1(RSA_TOOLS_PRIV_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt)
 {
-    int     ret;
-    int     status;
-    uint8_t *emsg;
-    size_t  elen;
+    PKCS1_SCRATCH_t ws;
+
+    return rsasp1_ws(&ws, key, msg, mlen, sig, slen, use_crt);
+}
+
+/**
+ * @brief RSASP1 of rsasp1() in the scratch of the caller.
+ *
+ * @param ws[in]        Scratch of pkcs1_scratch_alloc(), one per thread.
+ * @param key[in]       RSA Private Key.
+ * @param msg[in]       Encrypted message buffer.
+ * @param mlen[in]      Length of encrypted message buffer.
+ * @param sig[out]      Signature buffer.
+ * @param slen[in,out]  Length of signature buffer.
+ * @param use_crt[in]   CRT flag.
+ * @return              Status of this function, see rsasp1().
+ */
+int rsasp1_ws(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PRIV_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt)
+{
+    int ret;
 
     if ((NULL == msg) || (NULL == sig) || (NULL == slen) ||
         (key.n_len != mlen) || (key.n_len > *slen)) {
         ret = PKCS1_E_PARAM;
     }
     else {
-        ret = rsadp(key, msg, mlen, sig, slen, use_crt);
+        ret = rsadp_chk(ws, key, msg, mlen, sig, slen, use_crt, false);
     }
 
     return ret;
@@ -452,17 +739,32 @@ int rsasp1(RSA_TOOLS_PRIV_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, si
  */
 int rsavp1(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen)
 {
-    int     ret;
-    int     status;
-    uint8_t *emsg;
-    size_t  elen;
+    PKCS1_SCRATCH_t ws;
+
+    return rsavp1_ws(&ws, key, msg, mlen, sig, slen);
+}
+
+/**
+ * @brief RSAVP1 of rsavp1() in the scratch of the caller.
+ *
+ * @param ws[in]        Scratch of pkcs1_scratch_alloc(), one per thread.
+ * @param key[in]       RSA Public Key.
+ * @param msg[in]       Message buffer.
+ * @param mlen[in]      Length of message buffer.
+ * @param sig[out]      Signature buffer.
+ * @param slen[in,out]  Length of signature buffer.
+ * @return              Status of this function, see rsavp1().
+ */
+int rsavp1_ws(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen)
+{
+    int ret;
 
     if ((NULL == msg) || (NULL == sig) || (NULL == slen) ||
         (key.n_len != mlen) || (key.n_len > *slen)) {
         ret = PKCS1_E_PARAM;
     }
     else {
-        ret = rsaep(key, msg, mlen, sig, slen);
+        ret = rsaep_ws(ws, key, msg, mlen, sig, slen);
     }
 
     return ret;
@@ -471,6 +773,8 @@ int rsavp1(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, siz
 
 /**
  * @brief PKCS1 RSA Sign
+ *        With pkcs1_sign_check_set(), the signature is checked with e before
+ *        it is returned, see sign_chk().
  * 
  * @param key[in]       Private Key.
  * @param msg[in]       Message buffer.
@@ -483,18 +787,32 @@ int rsavp1(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, siz
  * @retval PKCS1_E_OK       Success.
  * @retval PKCS1_E_PARAM    Invalid parameter.
  * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_VERIFY   Fault detected by the check, sig is not written.
  * @retval PKCS1_E_INTERNAL Internal Error.
  */
 int pkcs1_rsa_sign(RSA_TOOLS_PRIV_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt)
 {
-    return rsasp1(key, msg, mlen, sig, slen, use_crt);
+    int             ret;
+    PKCS1_SCRATCH_t ws;
+
+    if ((NULL == msg) || (NULL == sig) || (NULL == slen) ||
+        (key.n_len != mlen) || (key.n_len > *slen)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        ret = rsadp_chk(&ws, key, msg, mlen, sig, slen, use_crt, sign_check);
+    }
+
+    return ret;
 }
 
 /**
  * @brief PKCS1 RSA Verify
+ *        With the cache of pkcs1_vcache_set(), a triple which verified
+ *        before is accepted without the exponentiation.
  * 
  * @param key[in]   Public Key.
- * @param msg[in]   Message buffer.
+ * @param msg[in]   Message buffer, the encoded message of the length of n.
  * @param mlen[in]  Length of message buffer.
  * @param sig[in]   Signature buffer.
  * @param slen[in]  Length of signature buffer.
@@ -510,37 +828,41 @@ int pkcs1_rsa_sign(RSA_TOOLS_PRIV_KEY_t key, uint8_t *msg, size_t mlen, uint8_t
 int pksc1_rsa_verify(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t slen)
 {
     int     ret;
-    uint8_t *buf;
+    uint8_t buf[PKCS1_MAX_N_LEN];
+    uint8_t digest[UTILS_SHA256_LEN];
     size_t  len;
+    bool    cached;
  
-    if (key.n_len != slen) {
+    if ((key.n_len != slen) || (sizeof(buf) < slen)) {
         ret = PKCS1_E_PARAM;
     }
     else {
-        len = slen;
-        buf = malloc(len);
-        if (NULL != buf) {
-            ret = rsavp1(key, msg, mlen, buf, &len);
+        cached = pkcs1_vcache_key(&key, msg, mlen, sig, slen, digest);
+        if (cached && pkcs1_vcache_lookup(digest)) {
+            /* Verified before. */
+            ret = PKCS1_E_OK;
+        }
+        else {
+            len = slen;
+            ret = rsavp1(key, sig, slen, buf, &len);
             if (PKCS1_E_OK != ret) {
                 /* In case of error exit */
             }
             else {
-                if (blkcmp(sig, slen, buf, len, true)) {
+                if (utils_blkcmp(msg, mlen, buf, len, false)) {
                     ret = PKCS1_E_OK;
                 }
                 else {
                     ret = PKCS1_E_VERIFY;
                 }
             }
+            if (cached && (PKCS1_E_OK == ret)) {
+                pkcs1_vcache_insert(digest);
+            }
 
             memset(buf, 0, slen);
-            free(buf);
-            buf = NULL;
-        }
-        else {
-            ret = PKCS1_E_RESOURCE;
         }
     }
 
     return ret;
-}
\ No newline at end of file
+}
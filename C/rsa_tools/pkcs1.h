@@ -22,10 +22,31 @@
 #define PKCS1_E_RESOURCE    (-254)
 #define PKCS1_E_INTERNAL    (-255)
 
+#ifndef PKCS1_MAX_N_LEN
+#define PKCS1_MAX_N_LEN     (512)   /* RSA 4096 bit, 1024 or 2048 for 8192 or 16384 bit at build time */
+#endif  /* PKCS1_MAX_N_LEN */
+#define PKCS1_MIN_N_LEN     (64)    /* RSA 512 bit */
+#define PKCS1_SCREEN_BITS_MAX (64)  /* Max length of random exponents of rsavp1_screen() */
+#define PKCS1_FIAT_MAX_KEYS (16)    /* Max number of keys of a batch RSA key family */
+#define PKCS1_MAX_PRIMES    (16)    /* Max number of primes (u) of a multi-prime key */
+#define PKCS1_BLIND_REFRESH (64)    /* Default operations between two draws of a blinding factor */
+#define PKCS1_SLOT_READERS  (64)    /* Max number of readers of a key slot */
+#define PKCS1_VCACHE_MAX    (1 << 24)   /* Max number of entries of the verification cache */
+
 #ifdef PKCS1_TRACE
 #define PKCS1_DEBUG_TRACE (1)
 #endif  /* PKCS1TRACE */
 
+/* Additional prime (r_i, d_i, t_i), i = 3, ..., u of a multi-prime key (RFC 8017 3.2). */
+typedef struct {
+    uint8_t *r;     /* prime r_i */
+    uint8_t *d;     /* CRT exponent d_i = d mod (r_i - 1) */
+    uint8_t *t;     /* CRT coefficient t_i = (r_1 * ... * r_(i-1))^-1 mod r_i */
+    size_t  r_len;
+    size_t  d_len;
+    size_t  t_len;
+} RSA_TOOLS_PRIME_INFO_t;
+
 typedef struct {
     uint8_t *n;
     uint8_t *e;
@@ -43,6 +64,8 @@ typedef struct {
     size_t  dp_len;
     size_t  dq_len;
     size_t  qinv_len;
+    RSA_TOOLS_PRIME_INFO_t *other;      /* r_3, ..., r_u (NULL for a two-prime key) */
+    size_t  other_cnt;                  /* u - 2 */
 } RSA_TOOLS_PRIV_KEY_t;
 
 typedef struct {
@@ -52,12 +75,132 @@ typedef struct {
     size_t  e_len;
 } RSA_TOOLS_PUB_KEY_t;
 
+/* Precomputed key context (opaque). */
+typedef struct rsa_tools_key_ctx RSA_TOOLS_KEY_CTX_t;
+
+/* Key slot, a key context replaced while in use, and one of its readers (opaque). */
+typedef struct pkcs1_key_slot PKCS1_KEY_SLOT_t;
+typedef struct pkcs1_slot_reader PKCS1_SLOT_READER_t;
+
+/* Scratch of the primitives taking a key, one per thread (opaque). */
+typedef struct pkcs1_scratch PKCS1_SCRATCH_t;
+
+/* One (message, signature) pair of a batch verification. */
+typedef struct {
+    const uint8_t *msg;
+    size_t        mlen;
+    const uint8_t *sig;
+    size_t        slen;
+} PKCS1_VERIFY_ITEM_t;
+
+/* One message representative of a batch signature. */
+typedef struct {
+    const uint8_t *msg;
+    size_t        mlen;
+    uint8_t       *sig;
+    size_t        slen;     /* [in] Size of sig, [out] Length of the signature, that of n. */
+} PKCS1_SIGN_ITEM_t;
+
+/*
+ * Batch RSA key family: keys sharing one modulus (n, p, q, qInv) with small
+ * distinct public exponents. Every key[i] is a complete private key.
+ */
+typedef struct {
+    RSA_TOOLS_PRIV_KEY_t key[PKCS1_FIAT_MAX_KEYS];
+    size_t               cnt;
+    uint8_t              *buf;      /* Storage of the key components. */
+    size_t               buf_len;
+} RSA_TOOLS_FIAT_KEY_t;
+
+/* One ciphertext of a batch decryption. */
+typedef struct {
+    size_t        key;      /* Index of the key in the family, distinct in a batch. */
+    const uint8_t *emsg;
+    size_t        emlen;
+    uint8_t       *msg;
+    size_t        mlen;     /* [in] Size of msg, [out] Length of the message, that of n. */
+} PKCS1_FIAT_ITEM_t;
+
+/* Allocations of a primitive, see pkcs1_arena_stat() and UTILS_ARENA_STAT_t. */
+typedef struct {
+    size_t  allocs; /* Blocks allocated. */
+    size_t  frees;  /* Blocks freed. */
+    size_t  bytes;  /* Bytes requested. */
+    int64_t live;   /* Bytes allocated less bytes freed, 0 if nothing leaked. */
+    size_t  peak;   /* Peak bytes in use in the arena. */
+    size_t  heap;   /* Calls of malloc() made in the meantime. */
+} PKCS1_ARENA_STAT_t;
+
+/* Counters of the verification cache, see pkcs1_vcache_stat(). */
+typedef struct {
+    size_t  capacity;   /* Entries, 0 if the cache is off. */
+    size_t  hits;       /* Verifications found in the cache. */
+    size_t  misses;     /* Verifications not found, or expired. */
+    size_t  inserts;    /* Successful verifications added. */
+    size_t  evictions;  /* Live entries replaced by others. */
+    size_t  expired;    /* Entries dropped for their age. */
+} PKCS1_VCACHE_STAT_t;
+
 int rsaep(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *emsg, size_t *emlen);
 int rsadp(RSA_TOOLS_PRIV_KEY_t key, uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, bool use_crt);
 int rsasp1(RSA_TOOLS_PRIV_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt);
 int rsavp1(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen);
 
+int pkcs1_scratch_alloc(PKCS1_SCRATCH_t **ws);
+void pkcs1_scratch_free(PKCS1_SCRATCH_t *ws);
+int rsaep_ws(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *emsg, size_t *emlen);
+int rsadp_ws(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PRIV_KEY_t key, uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, bool use_crt);
+int rsasp1_ws(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PRIV_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt);
+int rsavp1_ws(PKCS1_SCRATCH_t *ws, RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen);
+
 int pkcs1_rsa_sign(RSA_TOOLS_PRIV_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt);
 int pksc1_rsa_verify(RSA_TOOLS_PUB_KEY_t key, uint8_t *msg, size_t mlen, uint8_t *sig, size_t slen);
+int pkcs1_vcache_set(size_t capacity, uint64_t ttl_msec);
+void pkcs1_vcache_stat(PKCS1_VCACHE_STAT_t *stat);
+
+const char *pkcs1_kernel_name(void);
+int pkcs1_kernel_select(const char *name);
+const char *pkcs1_lane_kernel_name(void);
+int pkcs1_lane_kernel_select(const char *name);
+int pkcs1_mul_pool_set(void *tpool, size_t min_bits);
+int pkcs1_const_time_set(bool on);
+int pkcs1_sign_check_set(bool on);
+int pkcs1_exp_autotune(size_t rounds);
+
+int pkcs1_ctx_priv_alloc(RSA_TOOLS_PRIV_KEY_t key, RSA_TOOLS_KEY_CTX_t **ctx);
+int pkcs1_ctx_pub_alloc(RSA_TOOLS_PUB_KEY_t key, RSA_TOOLS_KEY_CTX_t **ctx);
+void pkcs1_ctx_free(RSA_TOOLS_KEY_CTX_t *ctx);
+size_t pkcs1_ctx_n_len(const RSA_TOOLS_KEY_CTX_t *ctx);
+int pkcs1_ctx_set_blinding(RSA_TOOLS_KEY_CTX_t *ctx, size_t refresh);
+void pkcs1_arena_stat(PKCS1_ARENA_STAT_t *stat);
+
+int pkcs1_slot_alloc(RSA_TOOLS_KEY_CTX_t *ctx, PKCS1_KEY_SLOT_t **slot);
+void pkcs1_slot_free(PKCS1_KEY_SLOT_t *slot);
+int pkcs1_slot_reader_alloc(PKCS1_KEY_SLOT_t *slot, PKCS1_SLOT_READER_t **reader);
+void pkcs1_slot_reader_free(PKCS1_SLOT_READER_t *reader);
+const RSA_TOOLS_KEY_CTX_t *pkcs1_slot_enter(PKCS1_SLOT_READER_t *reader);
+void pkcs1_slot_leave(PKCS1_SLOT_READER_t *reader);
+int pkcs1_slot_publish(PKCS1_KEY_SLOT_t *slot, RSA_TOOLS_KEY_CTX_t *ctx);
+size_t pkcs1_slot_reclaim(PKCS1_KEY_SLOT_t *slot);
+
+int rsaep_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, uint8_t *emsg, size_t *emlen);
+int rsadp_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, bool use_crt);
+int rsasp1_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt);
+int rsavp1_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *sig, size_t slen, uint8_t *msg, size_t *mlen);
+int rsadp_ctx_par(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, void *tpool);
+int rsasp1_ctx_par(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, void *tpool);
+
+int pkcs1_rsa_sign_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt);
+int pkcs1_rsa_verify_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen);
+
+int pkcs1_rsa_sign_batch_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, PKCS1_SIGN_ITEM_t *items, size_t cnt, bool use_crt, int *status, void *tpool);
+int pkcs1_rsa_verify_batch(RSA_TOOLS_PUB_KEY_t key, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, int *status, void *tpool);
+int pkcs1_rsa_verify_batch_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, int *status, void *tpool);
+int rsavp1_screen(RSA_TOOLS_PUB_KEY_t key, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, size_t rand_bits, int *status);
+int rsavp1_screen_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, size_t rand_bits, int *status);
+
+int pkcs1_fiat_keygen(size_t n_len, size_t cnt, RSA_TOOLS_FIAT_KEY_t *fkey);
+void pkcs1_fiat_key_free(RSA_TOOLS_FIAT_KEY_t *fkey);
+int rsadp_fiat(const RSA_TOOLS_FIAT_KEY_t *fkey, PKCS1_FIAT_ITEM_t *items, size_t cnt);
 
 #endif  /* __PKCS1_H__ */
\ No newline at end of file
@@ -0,0 +1,843 @@
+/**
+ * @file pkcs1_batch.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Batch operations under one key.
+ *        The key is parsed and its reduction constants are computed once per
+ *        batch, and the working integers are allocated once per chunk of
+ *        items instead of once per item.
+ *        When a lane kernel takes the modulus, the chunks are made of groups
+ *        of PKCS1_LANES items whose exponentiations run side by side.
+ *        Screening checks a whole batch with one exponentiation and bisects
+ *        the batch only when the check fails.
+ *        Every chunk, and a batch as a whole on the calling thread, runs in
+ *        an arena scope of its thread (pkcs1_arena_begin()).
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+#include "utils.h"
+
+/* Chunks per thread, so that a slow chunk does not stall the whole batch. */
+#define PKCS1_BATCH_CHUNKS_PER_THREAD   (4)
+
+/* Max window width of the multi-exponentiation of screening. */
+#define PKCS1_SCREEN_WSIZE_MAX          (8)
+
+typedef struct {
+    const RSA_TOOLS_KEY_CTX_t *ctx;
+    const PKCS1_VERIFY_ITEM_t *items;
+    size_t                    cnt;
+    size_t                    unit;     /* Items of a lane group, 1 without lanes. */
+    size_t                    chunks;
+    int                       *status;
+} PKCS1_VERIFY_JOB_t;
+
+typedef struct {
+    const RSA_TOOLS_KEY_CTX_t *ctx;
+    PKCS1_SIGN_ITEM_t         *items;
+    size_t                    cnt;
+    bool                      use_crt;
+    size_t                    unit;     /* Items of a lane group, 1 without lanes. */
+    size_t                    chunks;
+    int                       *status;
+} PKCS1_SIGN_JOB_t;
+
+typedef struct {
+    const RSA_TOOLS_KEY_CTX_t *ctx;
+    size_t                    bits;     /* Length of r_i, 0 for r_i = 1. */
+    mp_int                    *sR;      /* s_i * R mod n */
+    mp_int                    *mR;      /* m_i * R mod n */
+    uint64_t                  *r;       /* Exponents of the current check. */
+    int                       *status;
+    mp_int                    bkt[1 << PKCS1_SCREEN_WSIZE_MAX];
+    bool                      used[1 << PKCS1_SCREEN_WSIZE_MAX];
+    mp_int                    run;
+    mp_int                    tot;
+    mp_int                    S;
+    mp_int                    M;
+    mp_int                    T;
+} PKCS1_SCREEN_t;
+
+/**
+ * @brief Verify one item with caller supplied working integers.
+ *
+ * @param ctx[in]   Key context holding (n, e).
+ * @param item[in]  Message and signature.
+ * @param s[in]     Working integer.
+ * @param m[in]     Working integer.
+ * @param x[in]     Working integer.
+ * @return          Status of the item, see pkcs1_rsa_verify_ctx().
+ */
+static int verify_one(const RSA_TOOLS_KEY_CTX_t *ctx, const PKCS1_VERIFY_ITEM_t *item, mp_int *s, mp_int *m, mp_int *x)
+{
+    int ret;
+
+    if ((NULL == item->msg) || (NULL == item->sig) || (ctx->n_len != item->slen)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(s, item->sig, (int)item->slen));
+        if (PKCS1_E_OK == ret) {
+            ret = (MP_LT == mp_cmp(s, &ctx->n.m)) ? PKCS1_E_OK : PKCS1_E_RANGE;
+        }
+        /* m = s^e mod n */
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_exptmod(&ctx->n, &ctx->e, s, m));
+        }
+        /* Leading zeros of the message are not significant. */
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_read_unsigned_bin(x, item->msg, (int)item->mlen));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = (MP_EQ == mp_cmp(m, x)) ? PKCS1_E_OK : PKCS1_E_VERIFY;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Number of chunks of a batch and items of a lane group.
+ */
+static size_t batch_chunks(size_t cnt, bool lanes, void *tpool, size_t *unit)
+{
+    size_t chunks;
+
+    *unit  = (lanes && (PKCS1_LANES <= cnt)) ? PKCS1_LANES : 1;
+    chunks = utils_tpool_size(tpool) * PKCS1_BATCH_CHUNKS_PER_THREAD;
+    if (chunks > (cnt + *unit - 1) / *unit) {
+        chunks = (cnt + *unit - 1) / *unit;
+    }
+
+    return chunks;
+}
+
+/**
+ * @brief Items [first, last) of chunk idx. Chunks start at a group boundary.
+ */
+static void batch_range(size_t cnt, size_t unit, size_t chunks, size_t idx, size_t *first, size_t *last)
+{
+    size_t groups;
+
+    groups = (cnt + unit - 1) / unit;
+    *first = unit * ((groups * idx) / chunks);
+    *last  = unit * ((groups * (idx + 1)) / chunks);
+    if (*last > cnt) {
+        *last = cnt;
+    }
+}
+
+/**
+ * @brief Verify up to PKCS1_LANES items with one run of the lane kernel.
+ *        Items the lanes cannot take fall back to verify_one().
+ */
+static void verify_lanes(const RSA_TOOLS_KEY_CTX_t *ctx, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, int *status)
+{
+    int             res;
+    size_t          i;
+    size_t          k;
+    size_t          inited;
+    size_t          idx[PKCS1_LANES];
+    PKCS1_LANE_OP_t op[PKCS1_LANES];
+    mp_int          s[PKCS1_LANES];
+    mp_int          m[PKCS1_LANES];
+    mp_int          x;
+
+    inited = 0;
+    res    = pkcs1_mp_status(mp_init(&x));
+    for (; (PKCS1_E_OK == res) && (inited < cnt); inited++) {
+        res = pkcs1_mp_status(mp_init_multi(&s[inited], &m[inited], NULL));
+        if (PKCS1_E_OK != res) {
+            inited--;
+        }
+    }
+
+    k = 0;
+    for (i = 0; (PKCS1_E_OK == res) && (i < cnt); i++) {
+        if ((NULL == items[i].msg) || (NULL == items[i].sig) || (ctx->n_len != items[i].slen)) {
+            status[i] = PKCS1_E_PARAM;
+        }
+        else {
+            status[i] = pkcs1_mp_status(mp_read_unsigned_bin(&s[k], items[i].sig, (int)items[i].slen));
+            if (PKCS1_E_OK == status[i]) {
+                status[i] = (MP_LT == mp_cmp(&s[k], &ctx->n.m)) ? PKCS1_E_OK : PKCS1_E_RANGE;
+            }
+            if (PKCS1_E_OK == status[i]) {
+                op[k].mt = &ctx->n;
+                op[k].ex = &ctx->e;
+                op[k].b  = &s[k];
+                op[k].y  = &m[k];
+                idx[k++] = i;
+            }
+        }
+    }
+    if ((PKCS1_E_OK == res) && (0 < k) && (MP_OKAY != pkcs1_lanes_exptmod(op, k))) {
+        for (i = 0; i < k; i++) {
+            status[idx[i]] = verify_one(ctx, &items[idx[i]], &s[i], &m[i], &x);
+        }
+        k = 0;
+    }
+    for (i = 0; (PKCS1_E_OK == res) && (i < k); i++) {
+        status[idx[i]] = pkcs1_mp_status(mp_read_unsigned_bin(&x, items[idx[i]].msg, (int)items[idx[i]].mlen));
+        if (PKCS1_E_OK == status[idx[i]]) {
+            status[idx[i]] = (MP_EQ == mp_cmp(&m[i], &x)) ? PKCS1_E_OK : PKCS1_E_VERIFY;
+        }
+    }
+
+    for (i = 0; (PKCS1_E_OK != res) && (i < cnt); i++) {
+        status[i] = res;
+    }
+    for (i = 0; i < inited; i++) {
+        mp_clear_multi(&s[i], &m[i], NULL);
+    }
+    if ((0 < inited) || (PKCS1_E_OK == res)) {
+        mp_clear(&x);
+    }
+}
+
+/**
+ * @brief Verify one chunk of a batch (thread pool job function).
+ */
+static void verify_chunk(void *arg, size_t idx)
+{
+    PKCS1_VERIFY_JOB_t *job;
+    size_t             i;
+    size_t             first;
+    size_t             last;
+    int                res;
+    bool               scoped;
+    mp_int             s, m, x;
+
+    job = (PKCS1_VERIFY_JOB_t *)arg;
+    batch_range(job->cnt, job->unit, job->chunks, idx, &first, &last);
+    scoped = pkcs1_arena_begin();
+
+    /* Full groups on the lanes, the rest one by one. */
+    for (; (1 < job->unit) && (first + job->unit <= last); first += job->unit) {
+        verify_lanes(job->ctx, &job->items[first], job->unit, &job->status[first]);
+    }
+    res = pkcs1_mp_status(mp_init_multi(&s, &m, &x, NULL));
+    for (i = first; i < last; i++) {
+        job->status[i] = (PKCS1_E_OK == res) ? verify_one(job->ctx, &job->items[i], &s, &m, &x) : res;
+    }
+    if (PKCS1_E_OK == res) {
+        mp_clear_multi(&s, &m, &x, NULL);
+    }
+    pkcs1_arena_end(scoped);
+}
+
+/**
+ * @brief PKCS1 RSA Verify of many signatures under one key context.
+ *        With PKCS1_LANES items or more, groups of PKCS1_LANES items are
+ *        verified side by side if a lane kernel takes n.
+ *
+ * @param ctx[in]       Key context holding (n, e).
+ * @param items[in]     Messages and signatures.
+ * @param cnt[in]       Number of items.
+ * @param status[out]   Status of every item (cnt entries), see pkcs1_rsa_verify_ctx().
+ * @param tpool[in]     Thread pool (utils_tpool_alloc()), or NULL to verify
+ *                      all items in the calling thread.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       All items are verified.
+ * @retval PKCS1_E_PARAM    Invalid parameter. status is not set.
+ * @retval PKCS1_E_VERIFY   Some items are not verified. See status.
+ */
+int pkcs1_rsa_verify_batch_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, int *status, void *tpool)
+{
+    int                ret;
+    size_t             i;
+    bool               scoped;
+    PKCS1_VERIFY_JOB_t job;
+
+    if ((NULL == ctx) || !ctx->has_pub || ((0 < cnt) && ((NULL == items) || (NULL == status)))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        job.ctx    = ctx;
+        job.items  = items;
+        job.cnt    = cnt;
+        job.status = status;
+        job.chunks = batch_chunks(cnt, pkcs1_lanes_ok(&ctx->n), tpool, &job.unit);
+        scoped = pkcs1_arena_begin();
+        utils_tpool_run(tpool, verify_chunk, &job, job.chunks);
+        pkcs1_arena_end(scoped);
+
+        ret = PKCS1_E_OK;
+        for (i = 0; i < cnt; i++) {
+            if (PKCS1_E_OK != status[i]) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief PKCS1 RSA Verify of many signatures under one public key.
+ *        The key context is built once for the whole batch.
+ *
+ * @param key[in]       Public Key.
+ * @param items[in]     Messages and signatures.
+ * @param cnt[in]       Number of items.
+ * @param status[out]   Status of every item (cnt entries), see pkcs1_rsa_verify_ctx().
+ * @param tpool[in]     Thread pool (utils_tpool_alloc()), or NULL.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       All items are verified.
+ * @retval PKCS1_E_PARAM    Invalid parameter. status is not set.
+ * @retval PKCS1_E_VERIFY   Some items are not verified. See status.
+ * @retval PKCS1_E_RESOURCE Memory allocation error. status is not set.
+ * @retval PKCS1_E_INTERNAL Internal Error. status is not set.
+ */
+int pkcs1_rsa_verify_batch(RSA_TOOLS_PUB_KEY_t key, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, int *status, void *tpool)
+{
+    int                 ret;
+    RSA_TOOLS_KEY_CTX_t *ctx;
+
+    ret = pkcs1_ctx_pub_alloc(key, &ctx);
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_rsa_verify_batch_ctx(ctx, items, cnt, status, tpool);
+        pkcs1_ctx_free(ctx);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Sign up to PKCS1_LANES items with one run of the lane kernel per
+ *        modulus (n, or every prime with CRT). Blinding is applied per item.
+ *        Primes the lanes do not take are exponentiated one by one.
+ */
+static void sign_lanes(const RSA_TOOLS_KEY_CTX_t *ctx, PKCS1_SIGN_ITEM_t *items, size_t cnt, bool use_crt, int *status)
+{
+    int                res;
+    int                st;
+    size_t             u;
+    size_t             w;
+    size_t             i;
+    size_t             j;
+    size_t             k;
+    size_t             inited;
+    size_t             idx[PKCS1_LANES];
+    PKCS1_BLIND_t      *blind[PKCS1_LANES];
+    PKCS1_LANE_OP_t    op[PKCS1_LANES];
+    const PKCS1_MONT_t *mt;
+    const PKCS1_EXP_t  *ex;
+    /* Per item: c, m (also c mod r_i) and m_1, ..., m_u. */
+    mp_int             v[PKCS1_LANES * (2 + PKCS1_MAX_PRIMES)];
+
+    u   = use_crt ? (2 + ctx->other_cnt) : 0;
+    w   = 2 + u;
+    res = PKCS1_E_OK;
+    for (inited = 0; (PKCS1_E_OK == res) && (inited < cnt * w); inited++) {
+        res = pkcs1_mp_status(mp_init(&v[inited]));
+    }
+    if (PKCS1_E_OK != res) {
+        inited--;
+    }
+
+    k = 0;
+    for (i = 0; (PKCS1_E_OK == res) && (i < cnt); i++) {
+        if ((NULL == items[i].msg) || (NULL == items[i].sig) ||
+            (ctx->n_len != items[i].mlen) || (ctx->n_len > items[i].slen)) {
+            status[i] = PKCS1_E_PARAM;
+        }
+        else {
+            blind[k]  = NULL;
+            status[i] = pkcs1_rep_read(ctx, items[i].msg, items[i].mlen, &v[k * w]);
+            if ((PKCS1_E_OK == status[i]) && (NULL != ctx->blind)) {
+                status[i] = pkcs1_blind(ctx, &v[k * w], &blind[k]);
+            }
+            if (PKCS1_E_OK == status[i]) {
+                idx[k++] = i;
+            }
+        }
+    }
+
+    /* Step 2.b of RSADP, m_i = c^(d_i) mod r_i for every prime, then recombine. */
+    for (j = 0; (PKCS1_E_OK == res) && (0 < k) && (j < u); j++) {
+        pkcs1_crt_prime(ctx, j, &mt, &ex);
+        for (i = 0; (PKCS1_E_OK == res) && (i < k); i++) {
+            res = pkcs1_mp_status(pkcs1_mont_mod(mt, &v[i * w], &v[(i * w) + 1]));
+            op[i].mt = mt;
+            op[i].ex = ex;
+            op[i].b  = &v[(i * w) + 1];
+            op[i].y  = &v[(i * w) + 2 + j];
+        }
+        if (PKCS1_E_OK != res) {
+            /* Error case */
+        }
+        else if (pkcs1_lanes_ok(mt)) {
+            res = pkcs1_mp_status(pkcs1_lanes_exptmod(op, k));
+        }
+        else {
+            for (i = 0; (PKCS1_E_OK == res) && (i < k); i++) {
+                res = pkcs1_mp_status(pkcs1_mont_exptmod_priv(mt, ex, op[i].b, op[i].y));
+            }
+        }
+    }
+    for (i = 0; use_crt && (PKCS1_E_OK == res) && (i < k); i++) {
+        res = pkcs1_mp_status(pkcs1_crt_garner(ctx, &v[(i * w) + 2], &v[(i * w) + 1]));
+    }
+    /* Step 2.a of RSADP, m = c^d mod n. */
+    if (!use_crt && (PKCS1_E_OK == res) && (0 < k)) {
+        for (i = 0; i < k; i++) {
+            op[i].mt = &ctx->n;
+            op[i].ex = &ctx->d;
+            op[i].b  = &v[i * w];
+            op[i].y  = &v[(i * w) + 1];
+        }
+        res = pkcs1_mp_status(pkcs1_lanes_exptmod(op, k));
+    }
+
+    for (i = 0; i < k; i++) {
+        st = res;
+        if (NULL != blind[i]) {
+            st = pkcs1_unblind(ctx, (PKCS1_E_OK == res) ? &v[(i * w) + 1] : NULL, blind[i]);
+            if (PKCS1_E_OK != res) {
+                st = res;
+            }
+        }
+        if (PKCS1_E_OK == st) {
+            st = pkcs1_rep_write(&v[(i * w) + 1], items[idx[i]].sig, ctx->n_len);
+        }
+        if (PKCS1_E_OK == st) {
+            items[idx[i]].slen = ctx->n_len;
+        }
+        status[idx[i]] = st;
+    }
+    for (i = 0; (PKCS1_E_OK != res) && (0 == k) && (i < cnt); i++) {
+        status[i] = res;
+    }
+    for (i = 0; i < inited; i++) {
+        mp_clear(&v[i]);
+    }
+}
+
+/**
+ * @brief Sign one chunk of a batch (thread pool job function).
+ */
+static void sign_chunk(void *arg, size_t idx)
+{
+    PKCS1_SIGN_JOB_t *job;
+    size_t           i;
+    size_t           first;
+    size_t           last;
+    bool             scoped;
+
+    job = (PKCS1_SIGN_JOB_t *)arg;
+    batch_range(job->cnt, job->unit, job->chunks, idx, &first, &last);
+    scoped = pkcs1_arena_begin();
+
+    /* Full groups on the lanes, the rest one by one. */
+    for (; (1 < job->unit) && (first + job->unit <= last); first += job->unit) {
+        sign_lanes(job->ctx, &job->items[first], job->unit, job->use_crt, &job->status[first]);
+    }
+    for (i = first; i < last; i++) {
+        job->status[i] = rsasp1_ctx(job->ctx, job->items[i].msg, job->items[i].mlen,
+                                    job->items[i].sig, &job->items[i].slen, job->use_crt);
+    }
+    pkcs1_arena_end(scoped);
+}
+
+/**
+ * @brief RSASP1 of many message representatives under one key context.
+ *        Every item is signed as by rsasp1_ctx(). With PKCS1_LANES items or
+ *        more, groups of PKCS1_LANES items are exponentiated side by side if
+ *        a lane kernel takes n (or p and q with CRT), unless the
+ *        constant-time engine is selected (pkcs1_const_time_set()).
+ *
+ * @param ctx[in]       Key context holding the private key.
+ * @param items[in,out] Message representatives and signature buffers.
+ * @param cnt[in]       Number of items.
+ * @param use_crt[in]   CRT flag.
+ * @param status[out]   Status of every item (cnt entries), see rsasp1_ctx().
+ * @param tpool[in]     Thread pool (utils_tpool_alloc()), or NULL to sign
+ *                      all items in the calling thread.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       All items are signed.
+ * @retval PKCS1_E_PARAM    Invalid parameter. status is not set.
+ * @retval PKCS1_E_INTERNAL Some items are not signed. See status.
+ */
+int pkcs1_rsa_sign_batch_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, PKCS1_SIGN_ITEM_t *items, size_t cnt, bool use_crt, int *status, void *tpool)
+{
+    int              ret;
+    size_t           i;
+    bool             lanes;
+    bool             scoped;
+    PKCS1_SIGN_JOB_t job;
+
+    if ((NULL == ctx) || (use_crt && !ctx->has_crt) || (!use_crt && !ctx->has_priv) ||
+        ((0 < cnt) && ((NULL == items) || (NULL == status)))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        /* The lane kernel is not constant time, the hardened mode signs one by one. */
+        lanes = use_crt ? (pkcs1_lanes_ok(&ctx->p) && pkcs1_lanes_ok(&ctx->q)) : pkcs1_lanes_ok(&ctx->n);
+        lanes = lanes && !pkcs1_const_time();
+        job.ctx     = ctx;
+        job.items   = items;
+        job.cnt     = cnt;
+        job.use_crt = use_crt;
+        job.status  = status;
+        job.chunks  = batch_chunks(cnt, lanes, tpool, &job.unit);
+        scoped = pkcs1_arena_begin();
+        utils_tpool_run(tpool, sign_chunk, &job, job.chunks);
+        pkcs1_arena_end(scoped);
+
+        ret = PKCS1_E_OK;
+        for (i = 0; i < cnt; i++) {
+            if (PKCS1_E_OK != status[i]) {
+                ret = PKCS1_E_INTERNAL;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Window width of a multi-exponentiation of k bases with bits bit
+ *        exponents, minimizing (bits / w) * (k + 2^(w+1)) multiplications.
+ */
+static int screen_wsize(size_t k, size_t bits)
+{
+    int    w;
+    int    ret;
+    size_t cost;
+    size_t best;
+
+    ret  = 1;
+    best = SIZE_MAX;
+    for (w = 1; (w <= PKCS1_SCREEN_WSIZE_MAX) && ((size_t)w <= bits); w++) {
+        cost = ((bits + w - 1) / w) * (k + ((size_t)2 << w));
+        if (cost < best) {
+            best = cost;
+            ret  = w;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief y = prod(base[idx[j]] ^ r[idx[j]]) in Montgomery form (bucket method).
+ *        Each window costs one multiplication per base plus 2^(w+1) to
+ *        combine the buckets, so the bases are not exponentiated one by one.
+ */
+static int screen_multiexp(PKCS1_SCREEN_t *scr, const mp_int *base, const size_t *idx, size_t k, size_t bits, mp_int *y)
+{
+    int      status;
+    int      w;
+    size_t   nwin;
+    size_t   win;
+    size_t   j;
+    uint64_t d;
+    uint64_t mask;
+    bool     y_set;
+    bool     run_set;
+    bool     tot_set;
+
+    w      = screen_wsize(k, bits);
+    nwin   = (bits + w - 1) / w;
+    mask   = ((uint64_t)1 << w) - 1;
+    y_set  = false;
+    status = MP_OKAY;
+    for (win = nwin; (MP_OKAY == status) && (0 < win); win--) {
+        for (j = 0; (MP_OKAY == status) && y_set && (j < (size_t)w); j++) {
+            status = pkcs1_mont_sqr(&scr->ctx->n, y, y);
+        }
+        memset(scr->used, 0, sizeof(scr->used));
+        for (j = 0; (MP_OKAY == status) && (j < k); j++) {
+            d = (scr->r[idx[j]] >> ((win - 1) * w)) & mask;
+            if (0 == d) {
+                /* Nothing to do */
+            }
+            else if (scr->used[d]) {
+                status = pkcs1_mont_mul(&scr->ctx->n, &scr->bkt[d], &base[idx[j]], &scr->bkt[d]);
+            }
+            else {
+                status = mp_copy(&base[idx[j]], &scr->bkt[d]);
+                scr->used[d] = true;
+            }
+        }
+        /* tot = prod(bkt[d] ^ d) = prod over d of (prod of bkt[d'] with d' >= d) */
+        run_set = false;
+        tot_set = false;
+        for (d = mask; (MP_OKAY == status) && (0 < d); d--) {
+            if (scr->used[d]) {
+                status = run_set ? pkcs1_mont_mul(&scr->ctx->n, &scr->run, &scr->bkt[d], &scr->run) : mp_copy(&scr->bkt[d], &scr->run);
+                run_set = true;
+            }
+            if ((MP_OKAY == status) && run_set) {
+                status = tot_set ? pkcs1_mont_mul(&scr->ctx->n, &scr->tot, &scr->run, &scr->tot) : mp_copy(&scr->run, &scr->tot);
+                tot_set = true;
+            }
+        }
+        if ((MP_OKAY == status) && tot_set) {
+            status = y_set ? pkcs1_mont_mul(&scr->ctx->n, y, &scr->tot, y) : mp_copy(&scr->tot, y);
+            y_set = true;
+        }
+    }
+    /* Every r_i is nonzero, so y is always set. */
+
+    return status;
+}
+
+/**
+ * @brief Check prod(s_i ^ r_i) ^ e == prod(m_i ^ r_i) mod n for the k items
+ *        idx[0 .. k-1] with fresh random exponents r_i.
+ *        With a single item r = 1, so that the check is an exact verification.
+ */
+static int screen_check(PKCS1_SCREEN_t *scr, const size_t *idx, size_t k)
+{
+    int      ret;
+    size_t   j;
+    size_t   bits;
+    uint64_t mask;
+
+    ret  = PKCS1_E_OK;
+    bits = ((1 < k) && (0 < scr->bits)) ? scr->bits : 1;
+    mask = (PKCS1_SCREEN_BITS_MAX == bits) ? UINT64_MAX : ((((uint64_t)1) << bits) - 1);
+    for (j = 0; j < k; j++) {
+        scr->r[idx[j]] = 1;
+    }
+    if (1 < bits) {
+        for (j = 0; (PKCS1_E_OK == ret) && (j < k); j++) {
+            ret = (UTILS_E_OK == utils_random(&scr->r[idx[j]], sizeof(uint64_t))) ? PKCS1_E_OK : PKCS1_E_INTERNAL;
+            scr->r[idx[j]] &= mask;
+            /* Nonzero, so that no item drops out of the check. */
+            if (0 == scr->r[idx[j]]) {
+                scr->r[idx[j]] = 1;
+            }
+        }
+    }
+
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(screen_multiexp(scr, scr->sR, idx, k, bits, &scr->S));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(screen_multiexp(scr, scr->mR, idx, k, bits, &scr->M));
+    }
+    /* Back from Montgomery form, then T = S^e mod n */
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_montgomery_reduce(&scr->S, &scr->ctx->n.m, scr->ctx->n.rho));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_montgomery_reduce(&scr->M, &scr->ctx->n.m, scr->ctx->n.rho));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(pkcs1_mont_exptmod(&scr->ctx->n, &scr->ctx->e, &scr->S, &scr->T));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = (MP_EQ == mp_cmp(&scr->T, &scr->M)) ? PKCS1_E_OK : PKCS1_E_VERIFY;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Screen the k items idx[0 .. k-1]. When the check fails, screen both
+ *        halves again until the failing items are isolated.
+ *
+ * @return  PKCS1_E_OK, or an error which stops the whole screening.
+ */
+static int screen_range(PKCS1_SCREEN_t *scr, const size_t *idx, size_t k)
+{
+    int    ret;
+    int    res;
+    size_t j;
+
+    ret = PKCS1_E_OK;
+    if (0 < k) {
+        res = screen_check(scr, idx, k);
+        if ((PKCS1_E_OK == res) || ((PKCS1_E_VERIFY == res) && (1 == k))) {
+            for (j = 0; j < k; j++) {
+                scr->status[idx[j]] = res;
+            }
+        }
+        else if (PKCS1_E_VERIFY == res) {
+            ret = screen_range(scr, idx, k / 2);
+            if (PKCS1_E_OK == ret) {
+                ret = screen_range(scr, idx + (k / 2), k - (k / 2));
+            }
+        }
+        else {
+            ret = res;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief RSAVP1 of many (message representative, signature) pairs under one
+ *        key, screened together.
+ *        The batch is accepted by checking (prod s_i^r_i)^e == prod m_i^r_i mod n,
+ *        which costs about one multiplication per item per rand_bits / log2(cnt)
+ *        bits plus a single exponentiation. When the check fails, the batch is
+ *        bisected until the bad items are isolated and verified one by one.
+ *
+ *        With rand_bits = 0 every r_i is 1. This is the cheapest check, but a
+ *        batch such as (m_1 * y, s_1), (m_2 / y, s_2) passes it. With random
+ *        nonzero r_i of rand_bits bits, such a batch passes with probability
+ *        about 2^-rand_bits.
+ *        This is screening: it assures that every m_i has been signed, not
+ *        that every s_i is the signature itself. A signature negated as
+ *        (m_i, -s_i), which reveals s_i, passes with probability 1/2.
+ *
+ * @param ctx[in]       Key context holding (n, e).
+ * @param items[in]     Message representatives (EM, leading zeros allowed) and signatures.
+ * @param cnt[in]       Number of items.
+ * @param rand_bits[in] Length of random exponents (0 .. PKCS1_SCREEN_BITS_MAX).
+ * @param status[out]   Status of every item (cnt entries).
+ *                      PKCS1_E_OK, PKCS1_E_VERIFY, PKCS1_E_RANGE (s >= n), or
+ *                      PKCS1_E_PARAM (NULL, or slen is not the length of n).
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       All items are verified.
+ * @retval PKCS1_E_PARAM    Invalid parameter. status is not set.
+ * @retval PKCS1_E_VERIFY   Some items are not verified. See status.
+ * @retval PKCS1_E_RESOURCE Memory allocation error. status is not valid.
+ * @retval PKCS1_E_INTERNAL Internal Error. status is not valid.
+ */
+int rsavp1_screen_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, size_t rand_bits, int *status)
+{
+    int            ret;
+    size_t         i;
+    size_t         k;
+    size_t         *idx;
+    bool           scoped;
+    PKCS1_SCREEN_t *scr;
+
+    idx    = NULL;
+    scr    = NULL;
+    scoped = pkcs1_arena_begin();
+    if ((NULL == ctx) || !ctx->has_pub || (PKCS1_SCREEN_BITS_MAX < rand_bits) ||
+        ((0 < cnt) && ((NULL == items) || (NULL == status)))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else if (0 == cnt) {
+        ret = PKCS1_E_OK;
+    }
+    else {
+        ret = PKCS1_E_RESOURCE;
+        idx = calloc(cnt, sizeof(size_t));
+        scr = calloc(1, sizeof(PKCS1_SCREEN_t));
+        if ((NULL != idx) && (NULL != scr)) {
+            scr->sR = calloc(cnt, sizeof(mp_int));
+            scr->mR = calloc(cnt, sizeof(mp_int));
+            scr->r  = calloc(cnt, sizeof(uint64_t));
+            if ((NULL != scr->sR) && (NULL != scr->mR) && (NULL != scr->r)) {
+                ret = pkcs1_mp_status(mp_init_multi(&scr->run, &scr->tot, &scr->S, &scr->M, &scr->T, NULL));
+            }
+        }
+        for (i = 0; (PKCS1_E_OK == ret) && (i < (1 << PKCS1_SCREEN_WSIZE_MAX)); i++) {
+            ret = pkcs1_mp_status(mp_init(&scr->bkt[i]));
+        }
+    }
+
+    /* Sort out malformed items, and move the others into Montgomery form. */
+    k = 0;
+    for (i = 0; (NULL != idx) && (PKCS1_E_OK == ret) && (i < cnt); i++) {
+        if ((NULL == items[i].msg) || (NULL == items[i].sig) || (ctx->n_len != items[i].slen)) {
+            status[i] = PKCS1_E_PARAM;
+        }
+        else {
+            ret = pkcs1_mp_status(mp_init_multi(&scr->sR[i], &scr->mR[i], NULL));
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_read_unsigned_bin(&scr->T, items[i].sig, (int)items[i].slen));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_read_unsigned_bin(&scr->M, items[i].msg, (int)items[i].mlen));
+            }
+            if (PKCS1_E_OK != ret) {
+                /* Error case */
+            }
+            else if (MP_LT != mp_cmp(&scr->T, &ctx->n.m)) {
+                status[i] = PKCS1_E_RANGE;
+            }
+            else if (MP_LT != mp_cmp(&scr->M, &ctx->n.m)) {
+                /* s^e mod n is never m. */
+                status[i] = PKCS1_E_VERIFY;
+            }
+            else {
+                ret = pkcs1_mp_status(pkcs1_mont_mul(&ctx->n, &scr->T, &ctx->n.rr, &scr->sR[i]));
+                if (PKCS1_E_OK == ret) {
+                    ret = pkcs1_mp_status(pkcs1_mont_mul(&ctx->n, &scr->M, &ctx->n.rr, &scr->mR[i]));
+                }
+                idx[k++] = i;
+            }
+        }
+    }
+
+    if ((NULL != idx) && (PKCS1_E_OK == ret)) {
+        scr->ctx    = ctx;
+        scr->bits   = rand_bits;
+        scr->status = status;
+        ret = screen_range(scr, idx, k);
+    }
+    if ((NULL != idx) && (PKCS1_E_OK == ret)) {
+        for (i = 0; i < cnt; i++) {
+            if (PKCS1_E_OK != status[i]) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+    }
+
+    if (NULL != scr) {
+        for (i = 0; (NULL != scr->sR) && (NULL != scr->mR) && (i < cnt); i++) {
+            mp_clear_multi(&scr->sR[i], &scr->mR[i], NULL);
+        }
+        for (i = 0; i < (1 << PKCS1_SCREEN_WSIZE_MAX); i++) {
+            mp_clear(&scr->bkt[i]);
+        }
+        mp_clear_multi(&scr->run, &scr->tot, &scr->S, &scr->M, &scr->T, NULL);
+        free(scr->sR);
+        free(scr->mR);
+        free(scr->r);
+        free(scr);
+    }
+    free(idx);
+    pkcs1_arena_end(scoped);
+
+    return ret;
+}
+
+/**
+ * @brief RSAVP1 of many pairs under one public key, screened together.
+ *        See rsavp1_screen_ctx().
+ *
+ * @param key[in]       Public Key.
+ * @param items[in]     Message representatives and signatures.
+ * @param cnt[in]       Number of items.
+ * @param rand_bits[in] Length of random exponents (0 .. PKCS1_SCREEN_BITS_MAX).
+ * @param status[out]   Status of every item (cnt entries).
+ * @return              Status of this function, see rsavp1_screen_ctx().
+ */
+int rsavp1_screen(RSA_TOOLS_PUB_KEY_t key, const PKCS1_VERIFY_ITEM_t *items, size_t cnt, size_t rand_bits, int *status)
+{
+    int                 ret;
+    RSA_TOOLS_KEY_CTX_t *ctx;
+
+    ret = pkcs1_ctx_pub_alloc(key, &ctx);
+    if (PKCS1_E_OK == ret) {
+        ret = rsavp1_screen_ctx(ctx, items, cnt, rand_bits, status);
+        pkcs1_ctx_free(ctx);
+    }
+
+    return ret;
+}
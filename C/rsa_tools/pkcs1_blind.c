@@ -0,0 +1,355 @@
+/**
+ * @file pkcs1_blind.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Base blinding of the private key operations of a key context.
+ *        c is replaced by c * r^e before the exponentiation and the result is
+ *        multiplied by r^-1. A blinding pair (r^e, r^-1) is squared after each
+ *        use, which gives the pair of r^2, and is drawn again only every
+ *        refresh operations. The pair is held in the Montgomery form of n,
+ *        so blinding and unblinding are one Montgomery multiplication each
+ *        and the squarings keep the form: a blinded operation costs four
+ *        Montgomery multiplications and no division, not an inversion and
+ *        an exponentiation.
+ *        A pair is owned by one caller at a time. Every thread keeps the
+ *        pair of its last operation in a thread-specific slot of the
+ *        context, taken and given back without a lock. Only a thread with
+ *        more than one operation under way (a batch) or without a pair
+ *        takes the lock, for the idle list of the context, which also gets
+ *        the pair of a thread that exits. So there are as many pairs as
+ *        threads that used the context, plus the items of a batch.
+ *        The pairs outlive the operation, so the arena scope of the
+ *        operation is paused while they are worked on.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+#include "utils.h"
+
+/* Tries to draw an r invertible mod n. Failing all of them means n is not an RSA modulus. */
+#define PKCS1_BLIND_RETRY   (8)
+
+struct pkcs1_blind {
+    mp_int             vi;      /* r^e * R mod n */
+    mp_int             vf;      /* r^-1 * R mod n */
+    size_t             uses;    /* Operations since r was drawn. */
+    PKCS1_BLIND_POOL_t *pool;
+    PKCS1_BLIND_t      *next;   /* Idle list. */
+    PKCS1_BLIND_t      *link;   /* All pairs of the pool. */
+};
+
+struct pkcs1_blind_pool {
+    pthread_mutex_t lock;       /* Protects idle and all. */
+    pthread_key_t   key;        /* Pair of the thread, not in use. */
+    bool            keyed;      /* key was created, otherwise every pair goes by idle. */
+    PKCS1_BLIND_t   *idle;      /* Pairs not in use and not held by a thread. */
+    PKCS1_BLIND_t   *all;       /* Every pair, to free those held by threads. */
+    size_t          refresh;    /* Operations between two draws of r. */
+};
+
+/**
+ * @brief Release a blinding pair.
+ */
+static void blind_free(PKCS1_BLIND_t *b)
+{
+    mp_clear_multi(&b->vi, &b->vf, NULL);
+    free(b);
+}
+
+/**
+ * @brief Put a pair on the idle list of its pool.
+ */
+static void blind_idle(PKCS1_BLIND_t *b)
+{
+    PKCS1_BLIND_POOL_t *pool;
+
+    pool = b->pool;
+    pthread_mutex_lock(&pool->lock);
+    b->next    = pool->idle;
+    pool->idle = b;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief Destructor of the slot of an exiting thread: the pair goes idle.
+ */
+static void blind_exit(void *arg)
+{
+    blind_idle((PKCS1_BLIND_t *)arg);
+}
+
+/**
+ * @brief Draw a new r and set vi = r^e * R mod n, vf = r^-1 * R mod n.
+ */
+static int blind_draw(const RSA_TOOLS_KEY_CTX_t *ctx, PKCS1_BLIND_t *b)
+{
+    int     ret;
+    int     status;
+    int     i;
+    uint8_t buf[PKCS1_MAX_N_LEN];
+    mp_int  r;
+
+    ret = pkcs1_mp_status(mp_init(&r));
+    if (PKCS1_E_OK == ret) {
+        status = MP_VAL;
+        for (i = 0; (PKCS1_E_OK == ret) && (MP_VAL == status) && (i < PKCS1_BLIND_RETRY); i++) {
+            if (UTILS_E_OK != utils_random(buf, ctx->n_len)) {
+                ret = PKCS1_E_INTERNAL;
+            }
+            else {
+                status = mp_read_unsigned_bin(&r, buf, (int)ctx->n_len);
+                if (MP_OKAY == status) {
+                    status = mp_mod(&r, &ctx->n.m, &r);
+                }
+                /* MP_VAL if r has no inverse, r = 0 included. */
+                if (MP_OKAY == status) {
+                    status = mp_invmod(&r, &ctx->n.m, &b->vf);
+                }
+                if ((PKCS1_E_OK == ret) && (MP_OKAY != status) && (MP_VAL != status)) {
+                    ret = pkcs1_mp_status(status);
+                }
+            }
+        }
+        if ((PKCS1_E_OK == ret) && (MP_OKAY != status)) {
+            ret = PKCS1_E_INTERNAL;
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_exptmod(&ctx->n, &ctx->e, &r, &b->vi));
+        }
+        /* Into the Montgomery form: x * R^2 / R */
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_mul(&ctx->n, &b->vi, &ctx->n.rr, &b->vi));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_mul(&ctx->n, &b->vf, &ctx->n.rr, &b->vf));
+        }
+        if (PKCS1_E_OK == ret) {
+            b->uses = 0;
+        }
+        memset(buf, 0, sizeof(buf));
+        mp_clear(&r);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Take a pair of the context: that of the thread, an idle one or a
+ *        new one, which then needs a draw.
+ */
+static int blind_take(PKCS1_BLIND_POOL_t *pool, PKCS1_BLIND_t **b)
+{
+    int           ret;
+    PKCS1_BLIND_t *p;
+
+    p = NULL;
+    if (pool->keyed) {
+        p = pthread_getspecific(pool->key);
+        if (NULL != p) {
+            (void)pthread_setspecific(pool->key, NULL);
+        }
+    }
+    if (NULL == p) {
+        pthread_mutex_lock(&pool->lock);
+        p = pool->idle;
+        if (NULL != p) {
+            pool->idle = p->next;
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    ret = PKCS1_E_OK;
+    if (NULL == p) {
+        p = calloc(1, sizeof(PKCS1_BLIND_t));
+        if (NULL == p) {
+            ret = PKCS1_E_RESOURCE;
+        }
+        else if (PKCS1_E_OK != (ret = pkcs1_mp_status(mp_init_multi(&p->vi, &p->vf, NULL)))) {
+            free(p);
+            p = NULL;
+        }
+        else {
+            p->uses = pool->refresh;
+            p->pool = pool;
+            pthread_mutex_lock(&pool->lock);
+            p->link   = pool->all;
+            pool->all = p;
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+    *b = p;
+
+    return ret;
+}
+
+/**
+ * @brief Give a pair back: into the slot of the thread if it is empty,
+ *        otherwise onto the idle list.
+ */
+static void blind_give(PKCS1_BLIND_t *b)
+{
+    PKCS1_BLIND_POOL_t *pool;
+
+    pool = b->pool;
+    if (!pool->keyed || (NULL != pthread_getspecific(pool->key)) ||
+        (0 != pthread_setspecific(pool->key, b))) {
+        blind_idle(b);
+    }
+}
+
+/**
+ * @brief Allocate the blinding state of a key context.
+ *        Without a thread-specific key left in the process, the pairs go by
+ *        the idle list only.
+ *
+ * @param refresh[in]   Operations between two draws of r (1 or more).
+ * @param pool[out]     Blinding state.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ */
+int pkcs1_blind_pool_alloc(size_t refresh, PKCS1_BLIND_POOL_t **pool)
+{
+    int                ret;
+    PKCS1_BLIND_POOL_t *p;
+
+    p = calloc(1, sizeof(PKCS1_BLIND_POOL_t));
+    if (NULL == p) {
+        ret = PKCS1_E_RESOURCE;
+    }
+    else if (0 != pthread_mutex_init(&p->lock, NULL)) {
+        free(p);
+        ret = PKCS1_E_RESOURCE;
+    }
+    else {
+        p->keyed   = (0 == pthread_key_create(&p->key, blind_exit)) ? true : false;
+        p->refresh = refresh;
+        *pool = p;
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Release the blinding state of a key context and all its pairs,
+ *        those held by threads included. No pair may be in use.
+ *
+ * @param pool[in]  Blinding state (NULL is allowed).
+ */
+void pkcs1_blind_pool_free(PKCS1_BLIND_POOL_t *pool)
+{
+    PKCS1_BLIND_t *b;
+
+    if (NULL != pool) {
+        if (pool->keyed) {
+            /* No destructor runs for the slots any more. */
+            pthread_key_delete(pool->key);
+        }
+        while (NULL != pool->all) {
+            b = pool->all;
+            pool->all = b->link;
+            blind_free(b);
+        }
+        pthread_mutex_destroy(&pool->lock);
+        free(pool);
+    }
+}
+
+/**
+ * @brief Blind an input representative. c = c * r^e mod n
+ *        The pair taken for it is owned by the caller until pkcs1_unblind().
+ *
+ * @param ctx[in]       Key context with blinding and (n, e).
+ * @param c[in,out]     Input representative.
+ * @param b[out]        Blinding pair.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_blind(const RSA_TOOLS_KEY_CTX_t *ctx, mp_int *c, PKCS1_BLIND_t **b)
+{
+    int           ret;
+    PKCS1_BLIND_t *p;
+    bool          paused;
+
+    paused = utils_arena_pause(true);
+    ret = blind_take(ctx->blind, &p);
+    if ((PKCS1_E_OK == ret) && (ctx->blind->refresh <= p->uses)) {
+        ret = blind_draw(ctx, p);
+    }
+    /* c * (r^e * R) / R */
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(pkcs1_mont_mul(&ctx->n, c, &p->vi, c));
+    }
+
+    if (PKCS1_E_OK == ret) {
+        *b = p;
+    }
+    else if (NULL != p) {
+        /* Drawn again by the next user. */
+        p->uses = ctx->blind->refresh;
+        blind_give(p);
+    }
+    (void)utils_arena_pause(paused);
+
+    return ret;
+}
+
+/**
+ * @brief Unblind an output representative, m = m * r^-1 mod n, and give the
+ *        pair back squared. On error of the blinded operation (m is NULL)
+ *        the pair is given back to be drawn again.
+ *
+ * @param ctx[in]       Key context with blinding.
+ * @param m[in,out]     Output representative, or NULL.
+ * @param b[in]         Blinding pair of pkcs1_blind().
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_unblind(const RSA_TOOLS_KEY_CTX_t *ctx, mp_int *m, PKCS1_BLIND_t *b)
+{
+    int  ret;
+    bool paused;
+
+    paused = utils_arena_pause(true);
+    ret    = PKCS1_E_OK;
+    if (NULL != m) {
+        /* m * (r^-1 * R) / R */
+        ret = pkcs1_mp_status(pkcs1_mont_mul(&ctx->n, m, &b->vf, m));
+        /* (r^e)^2 = (r^2)^e, (r^-1)^2 = (r^2)^-1, and (x * R)^2 / R = x^2 * R */
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_sqr(&ctx->n, &b->vi, &b->vi));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_sqr(&ctx->n, &b->vf, &b->vf));
+        }
+    }
+
+    if ((NULL == m) || (PKCS1_E_OK != ret)) {
+        b->uses = ctx->blind->refresh;
+    }
+    else {
+        b->uses++;
+    }
+    blind_give(b);
+    (void)utils_arena_pause(paused);
+
+    return ret;
+}
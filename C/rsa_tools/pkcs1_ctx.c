@@ -0,0 +1,1756 @@
+/**
+ * @file pkcs1_ctx.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Precomputed RSA key context.
+ *        The key components are parsed, the Montgomery constants of n, p and q
+ *        are computed and the exponents are recoded only once when a context
+ *        is built. The primitives taking a context reuse all of them.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+#include "utils.h"
+
+/* Exponent lengths tuned by pkcs1_exp_autotune(): 512, 1024, 2048 and 4096 bit. */
+#define EXP_TUNE_CLASSES    (4)
+#define EXP_TUNE_BITS_MIN   (512)
+#define EXP_TUNE_WSIZE_MIN  (3)
+#define EXP_TUNE_ROUNDS     (7)
+
+/* Engines tuned by pkcs1_exp_autotune(). */
+#define EXP_TUNE_MONT       (0)     /* pkcs1_mont_exptmod() of the key contexts */
+#define EXP_TUNE_FBN        (1)     /* pkcs1_fbn_exptmod() of the primitives taking a key */
+#define EXP_TUNE_ENGINES    (2)
+
+/* Window widths of the tuned classes of each engine, 0 for the static choice. */
+static int exp_tuned[EXP_TUNE_ENGINES][EXP_TUNE_CLASSES];
+
+/**
+ * @brief Convert a libtommath status to a PKCS1 status.
+ *
+ * @param status[in]    libtommath status.
+ * @return              PKCS1 status.
+ */
+int pkcs1_mp_status(int status)
+{
+    int ret;
+
+    switch (status) {
+        case MP_OKAY :
+            ret = PKCS1_E_OK;
+            break;
+        case MP_MEM :
+            ret = PKCS1_E_RESOURCE;
+            break;
+        default:
+            ret = PKCS1_E_INTERNAL;
+            break;
+    }
+
+    return ret;
+}
+
+/* Allocations of the last primitive of the calling thread. */
+static __thread PKCS1_ARENA_STAT_t arena_last;
+
+/**
+ * @brief Open an arena scope for one primitive, see utils_arena_begin().
+ *        The working integers of the primitive are then taken from the arena
+ *        of the calling thread. Only libtommath built with the allocation
+ *        hooks of utils_arena.c (PKCS1_ARENA_TOMMATH, see TOMMATH_SOURCE_DIR
+ *        of CMakeLists.txt) allocates there, so no scope is opened otherwise.
+ *        If no scope can be opened the primitive runs on the heap as well.
+ *
+ * @return  true if a scope is open, to be given to pkcs1_arena_end().
+ */
+bool pkcs1_arena_begin(void)
+{
+#ifdef PKCS1_ARENA_TOMMATH
+    return (UTILS_E_OK == utils_arena_begin());
+#else   /* PKCS1_ARENA_TOMMATH */
+    return false;
+#endif  /* PKCS1_ARENA_TOMMATH */
+}
+
+/**
+ * @brief Close the arena scope of a primitive and keep its statistics for
+ *        pkcs1_arena_stat().
+ *
+ * @param scoped[in]    Return value of pkcs1_arena_begin().
+ */
+void pkcs1_arena_end(bool scoped)
+{
+    UTILS_ARENA_STAT_t stat;
+
+    memset(&stat, 0, sizeof(stat));
+    if (scoped) {
+        utils_arena_end(&stat);
+    }
+    arena_last.allocs = stat.allocs;
+    arena_last.frees  = stat.frees;
+    arena_last.bytes  = stat.bytes;
+    arena_last.live   = stat.live;
+    arena_last.peak   = stat.peak;
+    arena_last.heap   = stat.heap;
+}
+
+/**
+ * @brief Allocations of the last primitive or batch run by the calling thread.
+ *        They are counted by the allocation hooks of utils_arena.c as
+ *        libtommath calls them, so all stay 0 unless it is built with them
+ *        (PKCS1_ARENA_TOMMATH). A primitive gives back all it allocates, so
+ *        live is 0 and allocs equals frees; a soak test can check that for
+ *        every call. Allocations made on the threads of a pool are not
+ *        counted.
+ *
+ * @param stat[out] Statistics.
+ */
+void pkcs1_arena_stat(PKCS1_ARENA_STAT_t *stat)
+{
+    if (NULL != stat) {
+        *stat = arena_last;
+    }
+}
+
+/**
+ * @brief Check that a key component is present and not longer than max_len.
+ */
+static bool comp_chk(const uint8_t *a, size_t alen, size_t max_len)
+{
+    return ((NULL != a) && (0 < alen) && (max_len >= alen)) ? true : false;
+}
+
+/**
+ * @brief Tuned class of an exponent length.
+ *        Class i covers the lengths from 3/4 to 3/2 of EXP_TUNE_BITS_MIN << i.
+ *
+ * @return  Index of the class, or EXP_TUNE_CLASSES if there is none.
+ */
+static size_t exp_tune_class(size_t bits)
+{
+    size_t i;
+
+    for (i = 0; i < EXP_TUNE_CLASSES; i++) {
+        if ((((size_t)(EXP_TUNE_BITS_MIN << i) * 3) / 4 <= bits) &&
+            (((size_t)(EXP_TUNE_BITS_MIN << i) * 3) / 2 > bits)) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/**
+ * @brief Static sliding window width for an exponent, which minimizes the
+ *        count of multiplications.
+ */
+static int exp_wsize_static(size_t bits)
+{
+    int ret;
+
+    if (bits <= 7) {
+        ret = 2;
+    }
+    else if (bits <= 36) {
+        ret = 3;
+    }
+    else if (bits <= 140) {
+        ret = 4;
+    }
+    else if (bits <= 450) {
+        ret = 5;
+    }
+    else if (bits <= 1303) {
+        ret = 6;
+    }
+    else if (bits <= 3529) {
+        ret = 7;
+    }
+    else {
+        ret = PKCS1_EXP_WSIZE_MAX;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Choose the sliding window width for an exponent of
+ *        pkcs1_mont_exptmod().
+ *        The width of pkcs1_exp_autotune() if the length was tuned,
+ *        otherwise the static choice, which minimizes the count of
+ *        multiplications.
+ *
+ * @param bits[in]  Bit length of the exponent.
+ * @return          Window width in bits.
+ */
+int pkcs1_exp_wsize(size_t bits)
+{
+    int    ret;
+    size_t i;
+
+    i = exp_tune_class(bits);
+    if ((EXP_TUNE_CLASSES > i) && (0 != exp_tuned[EXP_TUNE_MONT][i])) {
+        ret = exp_tuned[EXP_TUNE_MONT][i];
+    }
+    else {
+        ret = exp_wsize_static(bits);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Choose the sliding window width for an exponent of
+ *        pkcs1_fbn_exptmod(), tuned apart from pkcs1_exp_wsize(). The
+ *        caller bounds it by PKCS1_FBN_WSIZE_MAX.
+ *
+ * @param bits[in]  Bit length of the exponent.
+ * @return          Window width in bits.
+ */
+int pkcs1_fbn_exp_wsize(size_t bits)
+{
+    int    ret;
+    size_t i;
+
+    i = exp_tune_class(bits);
+    if ((EXP_TUNE_CLASSES > i) && (0 != exp_tuned[EXP_TUNE_FBN][i])) {
+        ret = exp_tuned[EXP_TUNE_FBN][i];
+    }
+    else {
+        ret = exp_wsize_static(bits);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Get a bit of a big-endian byte string.
+ */
+static int exp_bit(const uint8_t *e, size_t elen, size_t i)
+{
+    return (e[elen - 1 - (i / 8)] >> (i % 8)) & 1;
+}
+
+/**
+ * @brief Initialize Montgomery parameters of a modulus.
+ *
+ * @param mt[out]   Montgomery parameters.
+ * @param m[in]     Modulus buffer (big-endian).
+ * @param mlen[in]  Length of modulus buffer.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Modulus is even or zero.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_mont_init(PKCS1_MONT_t *mt, const uint8_t *m, size_t mlen)
+{
+    int status;
+
+    mt->km = NULL;
+    mt->fm = NULL;
+    status = mp_init_multi(&mt->m, &mt->rr, NULL);
+    if (MP_OKAY == status) {
+        status = mp_read_unsigned_bin(&mt->m, m, (int)mlen);
+    }
+    if (MP_OKAY == status) {
+        if (mp_iszero(&mt->m) || !mp_isodd(&mt->m)) {
+            status = MP_VAL;
+        }
+    }
+    if (MP_OKAY == status) {
+        status = mp_montgomery_setup(&mt->m, &mt->rho);
+    }
+    /* rr = (R mod m)^2 mod m */
+    if (MP_OKAY == status) {
+        status = mp_montgomery_calc_normalization(&mt->rr, &mt->m);
+    }
+    if (MP_OKAY == status) {
+        status = mp_sqrmod(&mt->rr, &mt->m, &mt->rr);
+    }
+    if (MP_OKAY == status) {
+        status = pkcs1_kmont_init(mt);
+    }
+    /* The constant-time engine takes m as it is, once for all its calls. */
+    if ((MP_OKAY == status) && (PKCS1_MAX_N_LEN >= mlen)) {
+        mt->fm = malloc(sizeof(PKCS1_FBN_t));
+        if (NULL == mt->fm) {
+            status = MP_MEM;
+        }
+        else if (PKCS1_E_OK != pkcs1_fbn_read(mt->fm, m, mlen)) {
+            status = MP_VAL;
+        }
+    }
+    mt->len = (size_t)mp_unsigned_bin_size(&mt->m);
+
+    return (MP_VAL == status) ? PKCS1_E_PARAM : pkcs1_mp_status(status);
+}
+
+/**
+ * @brief Release Montgomery parameters.
+ *
+ * @param mt[in]    Montgomery parameters.
+ */
+void pkcs1_mont_clear(PKCS1_MONT_t *mt)
+{
+    pkcs1_kmont_clear(mt);
+    if (NULL != mt->fm) {
+        pkcs1_fbn_clear(mt->fm);
+        free(mt->fm);
+        mt->fm = NULL;
+    }
+    mp_clear_multi(&mt->m, &mt->rr, NULL);
+    mt->rho = 0;
+    mt->len = 0;
+}
+
+/**
+ * @brief Recode an exponent into left-to-right sliding windows.
+ *        The exponent equals sum(digit_k * 2^pos_k) where every digit is odd,
+ *        so only the odd powers of the base have to be tabulated.
+ *
+ * @param ex[out]   Recoded exponent.
+ * @param e[in]     Exponent buffer (big-endian).
+ * @param elen[in]  Length of exponent buffer.
+ * @param wsize[in] Window width in bits, 0 for that of pkcs1_exp_wsize().
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ */
+static int exp_recode_w(PKCS1_EXP_t *ex, const uint8_t *e, size_t elen, int wsize)
+{
+    int    ret;
+    size_t bits;
+    size_t i;
+    size_t j;
+    size_t k;
+    size_t pos;
+    size_t val;
+
+    memset(ex, 0, sizeof(PKCS1_EXP_t));
+    ex->fermat = pkcs1_exp_fermat(e, elen);
+
+    bits = elen * 8;
+    while ((0 < bits) && (0 == exp_bit(e, elen, bits - 1))) {
+        bits--;
+    }
+    ex->wsize = (0 < wsize) ? wsize : pkcs1_exp_wsize(bits);
+    ex->bits  = bits;
+
+    if (0 == bits) {
+        /* e = 0: no window at all. */
+        ret = PKCS1_E_OK;
+    }
+    else {
+        ex->win  = malloc(bits * sizeof(PKCS1_WIN_t));
+        ex->elen = (bits + 7) / 8;
+        ex->e    = malloc(ex->elen);
+        if ((NULL == ex->win) || (NULL == ex->e)) {
+            ret = PKCS1_E_RESOURCE;
+        }
+        else {
+            memcpy(ex->e, &e[elen - ex->elen], ex->elen);
+            pos = bits;
+            i   = bits;
+            while (0 < i) {
+                if (0 == exp_bit(e, elen, i - 1)) {
+                    i--;
+                }
+                else {
+                    /* Window is bit (i - 1) down to bit j, and bit j is one. */
+                    j = (i > (size_t)ex->wsize) ? (i - ex->wsize) : 0;
+                    while (0 == exp_bit(e, elen, j)) {
+                        j++;
+                    }
+                    val = 0;
+                    for (k = i; k > j; k--) {
+                        val = (val << 1) | exp_bit(e, elen, k - 1);
+                    }
+                    ex->win[ex->cnt].sqr = (0 == ex->cnt) ? 0 : (uint16_t)(pos - j);
+                    ex->win[ex->cnt].idx = (uint16_t)(val >> 1);
+                    ex->cnt++;
+                    pos = j;
+                    i   = j;
+                }
+            }
+            ex->tail = pos;
+            ret = PKCS1_E_OK;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Recode an exponent into sliding windows of the width of
+ *        pkcs1_exp_wsize(). See exp_recode_w().
+ *
+ * @param ex[out]   Recoded exponent.
+ * @param e[in]     Exponent buffer (big-endian).
+ * @param elen[in]  Length of exponent buffer.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ */
+int pkcs1_exp_recode(PKCS1_EXP_t *ex, const uint8_t *e, size_t elen)
+{
+    return exp_recode_w(ex, e, elen, 0);
+}
+
+/**
+ * @brief Release a recoded exponent.
+ *
+ * @param ex[in]    Recoded exponent.
+ */
+void pkcs1_exp_clear(PKCS1_EXP_t *ex)
+{
+    if (NULL != ex->win) {
+        memset(ex->win, 0, ex->cnt * sizeof(PKCS1_WIN_t));
+        free(ex->win);
+    }
+    if (NULL != ex->e) {
+        memset(ex->e, 0, ex->elen);
+        free(ex->e);
+    }
+    memset(ex, 0, sizeof(PKCS1_EXP_t));
+}
+
+/**
+ * @brief Check whether an exponent has the form 2^k + 1 (k >= 1).
+ *        Such exponents (3, 17, 65537, ...) are evaluated by a fixed chain
+ *        of k squarings and one multiplication without any window table.
+ *
+ * @param e[in]     Exponent buffer (big-endian).
+ * @param elen[in]  Length of exponent buffer.
+ * @return          k, or 0 if the exponent does not have the form 2^k + 1.
+ */
+size_t pkcs1_exp_fermat(const uint8_t *e, size_t elen)
+{
+    size_t bits;
+    size_t ones;
+    size_t i;
+
+    bits = 0;
+    ones = 0;
+    for (i = 0; i < elen * 8; i++) {
+        if (exp_bit(e, elen, i)) {
+            bits = i + 1;
+            ones++;
+        }
+    }
+
+    return ((2 == ones) && exp_bit(e, elen, 0)) ? (bits - 1) : 0;
+}
+
+/**
+ * @brief Montgomery multiplication. c = a * b * R^-1 mod m
+ */
+int pkcs1_mont_mul(const PKCS1_MONT_t *mt, const mp_int *a, const mp_int *b, mp_int *c)
+{
+    int status;
+
+    status = mp_mul(a, b, c);
+    if (MP_OKAY == status) {
+        status = mp_montgomery_reduce(c, &mt->m, mt->rho);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Montgomery squaring. b = a * a * R^-1 mod m
+ */
+int pkcs1_mont_sqr(const PKCS1_MONT_t *mt, const mp_int *a, mp_int *b)
+{
+    int status;
+
+    status = mp_sqr(a, b);
+    if (MP_OKAY == status) {
+        status = mp_montgomery_reduce(b, &mt->m, mt->rho);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Modular reduction without division. y = x mod m
+ *        x is taken from the top in parts below R. With y < m, y * R plus
+ *        the next part is below (m + 1) * R, so its REDC and a Montgomery
+ *        multiplication by R^2 give it mod m. The top part is as long as
+ *        it may be below m * R, so the input c < n of a two-prime key is
+ *        one step for p and q: y = REDC(REDC(c) * R^2).
+ *
+ * @param mt[in]    Montgomery parameters of m.
+ * @param x[in]     Non-negative integer.
+ * @param y[out]    Result, may alias x.
+ * @return          libtommath status.
+ */
+int pkcs1_mont_mod(const PKCS1_MONT_t *mt, const mp_int *x, mp_int *y)
+{
+    int    status;
+    int    rbits;
+    int    over;
+    int    k;
+    int    i;
+    mp_int a, t;
+
+    /* R = 2^rbits, whole digits as mp_montgomery_reduce() takes them. */
+    rbits = ((mp_count_bits(&mt->m) + DIGIT_BIT - 1) / DIGIT_BIT) * DIGIT_BIT;
+    over  = mp_count_bits(x) - ((mp_count_bits(&mt->m) - 1) + rbits);
+    k     = (0 < over) ? ((over + rbits - 1) / rbits) : 0;
+
+    status = mp_init_multi(&a, &t, NULL);
+    if (MP_OKAY == status) {
+        status = mp_div_2d(x, k * rbits, &a, NULL);
+        for (i = k; (MP_OKAY == status) && (0 <= i); i--) {
+            /* a = a * R + part i of x */
+            if (i < k) {
+                status = mp_mul_2d(&a, rbits, &a);
+                if (MP_OKAY == status) {
+                    status = mp_div_2d(x, i * rbits, &t, NULL);
+                }
+                if (MP_OKAY == status) {
+                    status = mp_mod_2d(&t, rbits, &t);
+                }
+                if (MP_OKAY == status) {
+                    status = mp_add(&a, &t, &a);
+                }
+            }
+            /* a = REDC(REDC(a) * R^2) = a mod m */
+            if (MP_OKAY == status) {
+                status = mp_montgomery_reduce(&a, &mt->m, mt->rho);
+            }
+            if (MP_OKAY == status) {
+                status = pkcs1_mont_mul(mt, &a, &mt->rr, &a);
+            }
+        }
+        if (MP_OKAY == status) {
+            mp_exch(&a, y);
+        }
+        mp_clear_multi(&a, &t, NULL);
+    }
+
+    return status;
+}
+
+/**
+ * @brief h = (a - (b mod r)) * t mod r without division, t in the
+ *        Montgomery form of r. The difference is brought into [0, r) by
+ *        one addition of r times its sign.
+ */
+static int mont_submul(const PKCS1_MONT_t *mt, const mp_int *a, const mp_int *b, const mp_int *t, mp_int *h)
+{
+    int    status;
+    mp_int x;
+
+    status = mp_init(&x);
+    if (MP_OKAY == status) {
+        status = pkcs1_mont_mod(mt, b, &x);
+        if (MP_OKAY == status) {
+            status = mp_sub(a, &x, &x);
+        }
+        if (MP_OKAY == status) {
+            status = mp_mul_d(&mt->m, (mp_digit)((MP_LT == mp_cmp_d(&x, 0)) ? 1 : 0), h);
+        }
+        if (MP_OKAY == status) {
+            status = mp_add(&x, h, &x);
+        }
+        if (MP_OKAY == status) {
+            status = pkcs1_mont_mul(mt, t, &x, h);
+        }
+        mp_clear(&x);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Fixed square-and-multiply chain for e = 2^k + 1.
+ *        Starting from bR = b * R mod m, k Montgomery squarings give
+ *        b^(2^k) * R, and the final Montgomery multiplication by b (not in
+ *        Montgomery form) both multiplies and leaves Montgomery form.
+ *
+ * @param mt[in]    Montgomery parameters of m (rr is not used).
+ * @param k[in]     Exponent is 2^k + 1.
+ * @param bR[in]    b * R mod m.
+ * @param b[in]     Base, an integer between 0 and m - 1.
+ * @param y[out]    Result, b^(2^k + 1) mod m.
+ * @return          libtommath status.
+ */
+static int mont_fermat(const PKCS1_MONT_t *mt, size_t k, const mp_int *bR, const mp_int *b, mp_int *y)
+{
+    int    status;
+    size_t s;
+    mp_int acc;
+
+    status = mp_init(&acc);
+    if (MP_OKAY == status) {
+        status = pkcs1_mont_sqr(mt, bR, &acc);
+        for (s = 1; (MP_OKAY == status) && (s < k); s++) {
+            status = pkcs1_mont_sqr(mt, &acc, &acc);
+        }
+        if (MP_OKAY == status) {
+            status = pkcs1_mont_mul(mt, &acc, b, &acc);
+        }
+        if (MP_OKAY == status) {
+            mp_exch(&acc, y);
+        }
+        mp_clear(&acc);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Sliding window exponentiation in Montgomery form. y = b^e mod m
+ */
+static int mont_exptmod_win(const PKCS1_MONT_t *mt, const PKCS1_EXP_t *ex, const mp_int *b, mp_int *y)
+{
+    int    status;
+    int    tcnt;
+    int    i;
+    size_t k;
+    size_t s;
+    mp_int tbl[1 << (PKCS1_EXP_WSIZE_MAX - 1)];
+    mp_int acc;
+    mp_int tmp;
+
+    tcnt = 1 << (ex->wsize - 1);
+    memset(tbl, 0, sizeof(tbl));
+    status = mp_init_multi(&acc, &tmp, NULL);
+    for (i = 0; (MP_OKAY == status) && (i < tcnt); i++) {
+        status = mp_init(&tbl[i]);
+    }
+
+    /* tbl[i] = b^(2i+1) in Montgomery form. */
+    if (MP_OKAY == status) {
+        status = pkcs1_mont_mul(mt, b, &mt->rr, &tbl[0]);
+    }
+    if ((MP_OKAY == status) && (1 < tcnt)) {
+        status = pkcs1_mont_sqr(mt, &tbl[0], &tmp);
+    }
+    for (i = 1; (MP_OKAY == status) && (i < tcnt); i++) {
+        status = pkcs1_mont_mul(mt, &tbl[i - 1], &tmp, &tbl[i]);
+    }
+
+    if (MP_OKAY == status) {
+        status = mp_copy(&tbl[ex->win[0].idx], &acc);
+    }
+    for (k = 1; (MP_OKAY == status) && (k < ex->cnt); k++) {
+        for (s = 0; (MP_OKAY == status) && (s < ex->win[k].sqr); s++) {
+            status = pkcs1_mont_sqr(mt, &acc, &acc);
+        }
+        if (MP_OKAY == status) {
+            status = pkcs1_mont_mul(mt, &acc, &tbl[ex->win[k].idx], &acc);
+        }
+    }
+    for (s = 0; (MP_OKAY == status) && (s < ex->tail); s++) {
+        status = pkcs1_mont_sqr(mt, &acc, &acc);
+    }
+
+    /* Leave Montgomery form. */
+    if (MP_OKAY == status) {
+        status = mp_montgomery_reduce(&acc, &mt->m, mt->rho);
+    }
+    if (MP_OKAY == status) {
+        mp_exch(&acc, y);
+    }
+
+    for (i = 0; i < tcnt; i++) {
+        mp_clear(&tbl[i]);
+    }
+    mp_clear_multi(&acc, &tmp, NULL);
+
+    return status;
+}
+
+/**
+ * @brief Modular exponentiation with precomputed Montgomery parameters and a
+ *        recoded exponent. y = b^e mod m
+ *        A modulus with kernel parameters takes pkcs1_kmont_exptmod().
+ *        Otherwise exponents of the form 2^k + 1 take the fixed chain of
+ *        mont_fermat(), all others the sliding windows of mont_exptmod_win().
+ *
+ * @param mt[in]    Montgomery parameters of m.
+ * @param ex[in]    Recoded exponent e.
+ * @param b[in]     Base, an integer between 0 and m - 1.
+ * @param y[out]    Result.
+ * @return          libtommath status.
+ */
+int pkcs1_mont_exptmod(const PKCS1_MONT_t *mt, const PKCS1_EXP_t *ex, const mp_int *b, mp_int *y)
+{
+    int    status;
+    mp_int bR;
+
+    if (0 == ex->cnt) {
+        mp_set(y, 1);
+        status = MP_OKAY;
+    }
+    else if (NULL != mt->km) {
+        status = pkcs1_kmont_exptmod(mt->km, ex, b, y);
+    }
+    else if (0 != ex->fermat) {
+        status = mp_init(&bR);
+        if (MP_OKAY == status) {
+            status = pkcs1_mont_mul(mt, b, &mt->rr, &bR);
+            if (MP_OKAY == status) {
+                status = mont_fermat(mt, ex->fermat, &bR, b, y);
+            }
+            mp_clear(&bR);
+        }
+    }
+    else {
+        status = mont_exptmod_win(mt, ex, b, y);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Modular exponentiation with a private exponent. y = b^e mod m
+ *        pkcs1_mont_exptmod(), or pkcs1_fbn_exptmod_ct() over the exponent
+ *        as it was given if the constant-time engine is selected. The base
+ *        and the result then pass as octet strings of the length of m, and
+ *        m is the one cached by pkcs1_mont_init().
+ *
+ * @param mt[in]    Montgomery parameters of m.
+ * @param ex[in]    Recoded exponent e.
+ * @param b[in]     Base, an integer between 0 and m - 1.
+ * @param y[out]    Result.
+ * @return          libtommath status.
+ */
+int pkcs1_mont_exptmod_priv(const PKCS1_MONT_t *mt, const PKCS1_EXP_t *ex, const mp_int *b, mp_int *y)
+{
+    int         status;
+    uint8_t     buf[PKCS1_MAX_N_LEN];
+    size_t      len;
+    size_t      blen;
+    PKCS1_FBN_t fb;
+
+    len  = mt->len;
+    blen = (size_t)mp_unsigned_bin_size((mp_int *)b);
+    if (!pkcs1_const_time()) {
+        status = pkcs1_mont_exptmod(mt, ex, b, y);
+    }
+    else if ((NULL == mt->fm) || (len < blen)) {
+        status = MP_VAL;
+    }
+    else {
+        /* b = 0 || b, of the length of m */
+        memset(buf, 0, len);
+        status = mp_to_unsigned_bin((mp_int *)b, &buf[len - blen]);
+        if ((MP_OKAY == status) && (PKCS1_E_OK != pkcs1_fbn_read(&fb, buf, len))) {
+            status = MP_VAL;
+        }
+        if ((MP_OKAY == status) && (PKCS1_E_OK != pkcs1_fbn_exptmod_ct(&fb, ex->e, ex->elen, mt->fm, &fb))) {
+            status = MP_VAL;
+        }
+        if ((MP_OKAY == status) && (PKCS1_E_OK != pkcs1_fbn_write(&fb, buf, len))) {
+            status = MP_VAL;
+        }
+        if (MP_OKAY == status) {
+            status = mp_read_unsigned_bin(y, buf, (int)len);
+        }
+        memset(buf, 0, sizeof(buf));
+        pkcs1_fbn_clear(&fb);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Time of one exponentiation y = b^e mod m of an engine with windows
+ *        of wsize bits, the recoding of the exponent left out.
+ *        The FBN takes m and b as mt->fm and fb.
+ *
+ * @return  Status of this function.
+ */
+static int exp_tune_time(const PKCS1_MONT_t *mt, int engine, const uint8_t *e, size_t elen, int wsize,
+                         const mp_int *b, const PKCS1_FBN_t *fb, void **ts, uint64_t *nsec)
+{
+    int         ret;
+    PKCS1_EXP_t ex;
+    PKCS1_FBN_t fy;
+    mp_int      y;
+
+    if (EXP_TUNE_FBN == engine) {
+        utils_ts_gettime(ts[0]);
+        ret = pkcs1_fbn_exptmod_w(fb, e, elen, mt->fm, &fy, (unsigned)wsize);
+        utils_ts_gettime(ts[1]);
+        pkcs1_fbn_clear(&fy);
+    }
+    else {
+        ret = exp_recode_w(&ex, e, elen, wsize);
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_init(&y));
+        }
+        if (PKCS1_E_OK == ret) {
+            utils_ts_gettime(ts[0]);
+            ret = pkcs1_mp_status(pkcs1_mont_exptmod(mt, &ex, b, &y));
+            utils_ts_gettime(ts[1]);
+            mp_clear(&y);
+        }
+        pkcs1_exp_clear(&ex);
+    }
+    if (PKCS1_E_OK == ret) {
+        utils_ts_diff(ts[0], ts[1], ts[2]);
+        *nsec = (utils_ts_sec(ts[2]) * 1000000000) + utils_ts_nsec(ts[2]);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Tune the sliding window widths on this CPU.
+ *        For exponents of 512, 1024, 2048 and 4096 bit, each the length of
+ *        its modulus as in the exponents d of the whole modulus and dP, dQ of
+ *        the primes, both engines taking the widths are timed on a random
+ *        modulus and exponent: pkcs1_mont_exptmod() of the key contexts, on
+ *        the kernel or libtommath as pkcs1_mont_init() picks it, with every
+ *        width from 3 to 8 bits, and the fixed-width numbers of the
+ *        primitives taking a key with 3 to PKCS1_FBN_WSIZE_MAX bits.
+ *        The widths take turns in each of the rounds and the fastest round
+ *        of a width counts. The fastest width of an engine, if it beats the
+ *        static one by more than the noise, is kept for exponents of that
+ *        class, from 3/4 to 3/2 of its length, and every exponent recoded
+ *        afterwards by pkcs1_ctx_priv_alloc() or taken by rsadp() follows
+ *        it. Other lengths keep the static choice.
+ *        It takes a few seconds. Tune again after pkcs1_kernel_select(),
+ *        and call it before other threads use this module. The constant-time
+ *        engine keeps its fixed window, so the private key operations only
+ *        follow the tuned widths while it is off.
+ *
+ * @param rounds[in]    Exponentiations timed per width, the best counts. 0 for 7.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_exp_autotune(size_t rounds)
+{
+    int          ret;
+    int          k;
+    int          w;
+    int          wmax;
+    int          best;
+    size_t       i;
+    size_t       r;
+    size_t       len;
+    uint64_t     t;
+    uint64_t     tw[PKCS1_EXP_WSIZE_MAX + 1];
+    uint8_t      m[PKCS1_KERNEL_MAX_N_LEN];
+    uint8_t      e[PKCS1_KERNEL_MAX_N_LEN];
+    void         *ts[3];
+    PKCS1_MONT_t mt;
+    PKCS1_FBN_t  fb;
+    mp_int       b;
+
+    if (0 == rounds) {
+        rounds = EXP_TUNE_ROUNDS;
+    }
+    ts[0] = utils_ts_alloc();
+    ts[1] = utils_ts_alloc();
+    ts[2] = utils_ts_alloc();
+    if ((NULL == ts[0]) || (NULL == ts[1]) || (NULL == ts[2])) {
+        ret = PKCS1_E_RESOURCE;
+    }
+    else if (PKCS1_E_OK != (ret = pkcs1_mp_status(mp_init(&b)))) {
+        /* Error case */
+    }
+    else {
+        for (i = 0; (PKCS1_E_OK == ret) && (i < EXP_TUNE_CLASSES); i++) {
+            len = (size_t)(EXP_TUNE_BITS_MIN << i) / 8;
+            memset(&mt, 0, sizeof(mt));
+            memset(&fb, 0, sizeof(fb));
+            if ((UTILS_E_OK != utils_random(m, len)) || (UTILS_E_OK != utils_random(e, len))) {
+                ret = PKCS1_E_INTERNAL;
+            }
+            else {
+                /* An odd modulus of full length, and a base below it. */
+                m[0]       |= 0x80;
+                m[len - 1] |= 0x01;
+                e[0]       |= 0x80;
+                ret = pkcs1_mont_init(&mt, m, len);
+            }
+            if (PKCS1_E_OK == ret) {
+                m[0] &= 0x7F;
+                ret = pkcs1_mp_status(mp_read_unsigned_bin(&b, m, (int)len));
+            }
+            if ((PKCS1_E_OK == ret) && (NULL != mt.fm)) {
+                ret = pkcs1_fbn_read(&fb, m, len);
+            }
+            for (k = 0; (PKCS1_E_OK == ret) && (k < EXP_TUNE_ENGINES); k++) {
+                exp_tuned[k][i] = 0;
+                if (EXP_TUNE_FBN != k) {
+                    wmax = PKCS1_EXP_WSIZE_MAX;
+                }
+                else if (NULL != mt.fm) {
+                    wmax = PKCS1_FBN_WSIZE_MAX;
+                }
+                else {
+                    /* Longer than the fixed-width numbers take: not tuned. */
+                    wmax = 0;
+                }
+                for (w = EXP_TUNE_WSIZE_MIN; w <= wmax; w++) {
+                    tw[w] = UINT64_MAX;
+                }
+                for (r = 0; (PKCS1_E_OK == ret) && (r < rounds); r++) {
+                    for (w = EXP_TUNE_WSIZE_MIN; (PKCS1_E_OK == ret) && (w <= wmax); w++) {
+                        ret = exp_tune_time(&mt, k, e, len, w, &b, &fb, ts, &t);
+                        if ((PKCS1_E_OK == ret) && (t < tw[w])) {
+                            tw[w] = t;
+                        }
+                    }
+                }
+                if ((PKCS1_E_OK == ret) && (EXP_TUNE_WSIZE_MIN <= wmax)) {
+                    /* The static width stays unless another one is faster by 1/32, beyond the noise. */
+                    best = exp_wsize_static(len * 8);
+                    best = (wmax < best) ? wmax : best;
+                    for (w = EXP_TUNE_WSIZE_MIN; w <= wmax; w++) {
+                        if ((tw[w] + (tw[w] / 32)) < tw[best]) {
+                            best = w;
+                        }
+                    }
+                    exp_tuned[k][i] = best;
+                }
+            }
+            pkcs1_fbn_clear(&fb);
+            pkcs1_mont_clear(&mt);
+        }
+        mp_clear(&b);
+    }
+    utils_ts_free(ts[0]);
+    utils_ts_free(ts[1]);
+    utils_ts_free(ts[2]);
+    memset(m, 0, sizeof(m));
+    memset(e, 0, sizeof(e));
+
+    return ret;
+}
+
+/**
+ * @brief Precompute the additional primes (r_i, d_i, t_i) of a multi-prime key.
+ */
+static int ctx_other_alloc(RSA_TOOLS_KEY_CTX_t *c, const RSA_TOOLS_PRIV_KEY_t *key)
+{
+    int                          ret;
+    int                          status;
+    size_t                       i;
+    size_t                       crt_len;
+    const RSA_TOOLS_PRIME_INFO_t *o;
+
+    crt_len = key->n_len / 2;
+    if ((NULL == key->other) || ((PKCS1_MAX_PRIMES - 2) < key->other_cnt)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        c->r  = calloc(key->other_cnt, sizeof(PKCS1_MONT_t));
+        c->dr = calloc(key->other_cnt, sizeof(PKCS1_EXP_t));
+        c->t  = calloc(key->other_cnt, sizeof(mp_int));
+        ret   = ((NULL != c->r) && (NULL != c->dr) && (NULL != c->t)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+        if (PKCS1_E_OK == ret) {
+            /* Cleared by pkcs1_ctx_free() from here on. */
+            c->other_cnt = key->other_cnt;
+        }
+    }
+    for (i = 0; (PKCS1_E_OK == ret) && (i < c->other_cnt); i++) {
+        o = &key->other[i];
+        if (!comp_chk(o->r, o->r_len, crt_len) || !comp_chk(o->d, o->d_len, crt_len) ||
+            !comp_chk(o->t, o->t_len, crt_len)) {
+            ret = PKCS1_E_PARAM;
+        }
+        else {
+            ret = pkcs1_mont_init(&c->r[i], o->r, o->r_len);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_exp_recode(&c->dr[i], o->d, o->d_len);
+        }
+        if (PKCS1_E_OK == ret) {
+            status = mp_init(&c->t[i]);
+            if (MP_OKAY == status) {
+                status = mp_read_unsigned_bin(&c->t[i], o->t, (int)o->t_len);
+            }
+            /* t_i in the Montgomery form of r_i, t_i * R mod r_i. */
+            if (MP_OKAY == status) {
+                status = pkcs1_mont_mod(&c->r[i], &c->t[i], &c->t[i]);
+            }
+            if (MP_OKAY == status) {
+                status = pkcs1_mont_mul(&c->r[i], &c->t[i], &c->r[i].rr, &c->t[i]);
+            }
+            ret = pkcs1_mp_status(status);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Allocate a key context for an RSA private key.
+ *        The (n, d) form is used if d is given, the CRT form is used if all of
+ *        p, q, dP, dQ and qInv are given, together with (r_i, d_i, t_i) of
+ *        a multi-prime key. When e is also given, the context serves the
+ *        public key operations too, and the private key operations are
+ *        blinded (see pkcs1_ctx_set_blinding()).
+ *
+ * @param key[in]   RSA Private Key.
+ * @param ctx[out]  Allocated key context.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_ctx_priv_alloc(RSA_TOOLS_PRIV_KEY_t key, RSA_TOOLS_KEY_CTX_t **ctx)
+{
+    int                 ret;
+    int                 status;
+    size_t              crt_len;
+    RSA_TOOLS_KEY_CTX_t *c;
+
+    crt_len = key.n_len / 2;
+    if ((NULL == ctx) || (NULL == key.n) || !pkcs1_n_len_chk(key.n, key.n_len)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        c = calloc(1, sizeof(RSA_TOOLS_KEY_CTX_t));
+        if (NULL == c) {
+            ret = PKCS1_E_RESOURCE;
+        }
+        else {
+            c->n_len    = key.n_len;
+            c->has_pub  = comp_chk(key.e, key.e_len, key.n_len);
+            c->has_priv = comp_chk(key.d, key.d_len, key.n_len);
+            c->has_crt  = comp_chk(key.p,    key.p_len,    crt_len) &&
+                          comp_chk(key.q,    key.q_len,    crt_len) &&
+                          comp_chk(key.dp,   key.dp_len,   crt_len) &&
+                          comp_chk(key.dq,   key.dq_len,   crt_len) &&
+                          comp_chk(key.qinv, key.qinv_len, crt_len);
+
+            if (!c->has_priv && !c->has_crt) {
+                ret = PKCS1_E_PARAM;
+            }
+            else {
+                ret = pkcs1_mont_init(&c->n, key.n, key.n_len);
+            }
+            if ((PKCS1_E_OK == ret) && c->has_pub) {
+                ret = pkcs1_exp_recode(&c->e, key.e, key.e_len);
+            }
+            if ((PKCS1_E_OK == ret) && c->has_priv) {
+                ret = pkcs1_exp_recode(&c->d, key.d, key.d_len);
+            }
+            if ((PKCS1_E_OK == ret) && c->has_crt) {
+                ret = pkcs1_mont_init(&c->p, key.p, key.p_len);
+                if (PKCS1_E_OK == ret) {
+                    ret = pkcs1_mont_init(&c->q, key.q, key.q_len);
+                }
+                if (PKCS1_E_OK == ret) {
+                    ret = pkcs1_exp_recode(&c->dp, key.dp, key.dp_len);
+                }
+                if (PKCS1_E_OK == ret) {
+                    ret = pkcs1_exp_recode(&c->dq, key.dq, key.dq_len);
+                }
+                if (PKCS1_E_OK == ret) {
+                    /* qInv in the Montgomery form of p, qInv * R mod p. */
+                    status = mp_init(&c->qinv);
+                    if (MP_OKAY == status) {
+                        status = mp_read_unsigned_bin(&c->qinv, key.qinv, (int)key.qinv_len);
+                    }
+                    if (MP_OKAY == status) {
+                        status = pkcs1_mont_mod(&c->p, &c->qinv, &c->qinv);
+                    }
+                    if (MP_OKAY == status) {
+                        status = pkcs1_mont_mul(&c->p, &c->qinv, &c->p.rr, &c->qinv);
+                    }
+                    ret = pkcs1_mp_status(status);
+                }
+                if ((PKCS1_E_OK == ret) && (0 < key.other_cnt)) {
+                    ret = ctx_other_alloc(c, &key);
+                }
+            }
+            if ((PKCS1_E_OK == ret) && c->has_pub) {
+                ret = pkcs1_blind_pool_alloc(PKCS1_BLIND_REFRESH, &c->blind);
+            }
+
+            if (PKCS1_E_OK != ret) {
+                pkcs1_ctx_free(c);
+            }
+            else {
+                *ctx = c;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Allocate a key context for an RSA public key.
+ *
+ * @param key[in]   RSA Public Key.
+ * @param ctx[out]  Allocated key context.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_ctx_pub_alloc(RSA_TOOLS_PUB_KEY_t key, RSA_TOOLS_KEY_CTX_t **ctx)
+{
+    int                 ret;
+    RSA_TOOLS_KEY_CTX_t *c;
+
+    if ((NULL == ctx) || (NULL == key.n) || !pkcs1_n_len_chk(key.n, key.n_len) ||
+        !comp_chk(key.e, key.e_len, key.n_len)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        c = calloc(1, sizeof(RSA_TOOLS_KEY_CTX_t));
+        if (NULL == c) {
+            ret = PKCS1_E_RESOURCE;
+        }
+        else {
+            c->n_len   = key.n_len;
+            c->has_pub = true;
+            ret = pkcs1_mont_init(&c->n, key.n, key.n_len);
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_exp_recode(&c->e, key.e, key.e_len);
+            }
+
+            if (PKCS1_E_OK != ret) {
+                pkcs1_ctx_free(c);
+            }
+            else {
+                *ctx = c;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Release a key context.
+ *        All key material held by the context is cleared.
+ *
+ * @param ctx[in]   Key context.
+ */
+void pkcs1_ctx_free(RSA_TOOLS_KEY_CTX_t *ctx)
+{
+    size_t i;
+
+    if (NULL != ctx) {
+        pkcs1_blind_pool_free(ctx->blind);
+        for (i = 0; i < ctx->other_cnt; i++) {
+            pkcs1_mont_clear(&ctx->r[i]);
+            pkcs1_exp_clear(&ctx->dr[i]);
+            mp_clear(&ctx->t[i]);
+        }
+        free(ctx->r);
+        free(ctx->dr);
+        free(ctx->t);
+        pkcs1_mont_clear(&ctx->n);
+        pkcs1_mont_clear(&ctx->p);
+        pkcs1_mont_clear(&ctx->q);
+        mp_clear(&ctx->qinv);
+        pkcs1_exp_clear(&ctx->e);
+        pkcs1_exp_clear(&ctx->d);
+        pkcs1_exp_clear(&ctx->dp);
+        pkcs1_exp_clear(&ctx->dq);
+        memset(ctx, 0, sizeof(RSA_TOOLS_KEY_CTX_t));
+        free(ctx);
+    }
+}
+
+/**
+ * @brief Get the modulus length of a key context.
+ *
+ * @param ctx[in]   Key context.
+ * @return          Length of modulus in bytes, 0 if ctx is NULL.
+ */
+size_t pkcs1_ctx_n_len(const RSA_TOOLS_KEY_CTX_t *ctx)
+{
+    return (NULL != ctx) ? ctx->n_len : 0;
+}
+
+/**
+ * @brief Set the base blinding of the private key operations.
+ *        The blinding factor is squared after each operation and drawn again
+ *        every refresh operations, every thread with a factor of its own.
+ *        The outputs do not change.
+ *        Call it before the context is shared by other threads.
+ *
+ * @param ctx[in,out]   Key context holding a private key and e.
+ * @param refresh[in]   Operations between two draws of the blinding factor,
+ *                      0 to turn blinding off.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ */
+int pkcs1_ctx_set_blinding(RSA_TOOLS_KEY_CTX_t *ctx, size_t refresh)
+{
+    int ret;
+
+    if ((NULL == ctx) || ((0 < refresh) && (!ctx->has_pub || (!ctx->has_priv && !ctx->has_crt)))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        pkcs1_blind_pool_free(ctx->blind);
+        ctx->blind = NULL;
+        ret = PKCS1_E_OK;
+        if (0 < refresh) {
+            ret = pkcs1_blind_pool_alloc(refresh, &ctx->blind);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Read an input representative and check 0 <= x <= (n - 1).
+ */
+int pkcs1_rep_read(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *a, size_t alen, mp_int *x)
+{
+    int ret;
+
+    ret = pkcs1_mp_status(mp_read_unsigned_bin(x, a, (int)alen));
+    if (PKCS1_E_OK == ret) {
+        ret = (MP_LT == mp_cmp(x, &ctx->n.m)) ? PKCS1_E_OK : PKCS1_E_RANGE;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Write an output representative of exactly alen octets (I2OSP).
+ *        The leading octets are zero, so outputs always have the length of
+ *        the modulus.
+ */
+int pkcs1_rep_write(const mp_int *x, uint8_t *a, size_t alen)
+{
+    int    ret;
+    size_t size;
+
+    size = (size_t)mp_unsigned_bin_size(x);
+    if (alen < size) {
+        ret = PKCS1_E_INTERNAL;
+    }
+    else {
+        memset(a, 0, alen - size);
+        ret = pkcs1_mp_status(mp_to_unsigned_bin(x, &a[alen - size]));
+    }
+
+    return ret;
+}
+
+/**
+ * @brief RSA encryption primitive (RSAEP) with a key context.
+ *        See rsaep() for the specification.
+ *
+ * @param ctx[in]       Key context holding (n, e).
+ * @param msg[in]       Message buffer.
+ * @param mlen[in]      Length of message buffer.
+ * @param emsg[out]     Encrypted message buffer.
+ * @param emlen[in,out] Length of encrypted message buffer.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int rsaep_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, uint8_t *emsg, size_t *emlen)
+{
+    int    ret;
+    bool   scoped;
+    mp_int m;
+    mp_int c;
+
+    if ((NULL == ctx) || (NULL == msg) || (NULL == emsg) || (NULL == emlen) ||
+        !ctx->has_pub || (ctx->n_len != mlen) || (ctx->n_len > *emlen)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        scoped = pkcs1_arena_begin();
+        ret = pkcs1_mp_status(mp_init_multi(&m, &c, NULL));
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_rep_read(ctx, msg, mlen, &m);
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(pkcs1_mont_exptmod(&ctx->n, &ctx->e, &m, &c));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_rep_write(&c, emsg, ctx->n_len);
+            }
+            if (PKCS1_E_OK == ret) {
+                *emlen = ctx->n_len;
+            }
+            mp_clear_multi(&m, &c, NULL);
+        }
+        pkcs1_arena_end(scoped);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Half-exponentiations of the CRT branch, one index per prime.
+ */
+typedef struct {
+    const RSA_TOOLS_KEY_CTX_t *ctx;
+    const mp_int              *c;
+    mp_int                    *m;       /* m_1, ..., m_u */
+    int                       *status;  /* libtommath status of each index. */
+} PKCS1_CRT_JOB_t;
+
+/**
+ * @brief Modulus and exponent of one prime of the CRT branch.
+ *        Index 0 is (p, dP), 1 is (q, dQ) and 2, ... are (r_i, d_i), i = 3, ..., u.
+ */
+void pkcs1_crt_prime(const RSA_TOOLS_KEY_CTX_t *ctx, size_t idx, const PKCS1_MONT_t **mt, const PKCS1_EXP_t **ex)
+{
+    if (0 == idx) {
+        *mt = &ctx->p;
+        *ex = &ctx->dp;
+    }
+    else if (1 == idx) {
+        *mt = &ctx->q;
+        *ex = &ctx->dq;
+    }
+    else {
+        *mt = &ctx->r[idx - 2];
+        *ex = &ctx->dr[idx - 2];
+    }
+}
+
+/**
+ * @brief Step 2.b.i, 2.b.ii of RSADP for one prime. m_i = c^(d_i) mod r_i
+ *        Only m_i and local scratch are written, so the indices can run on
+ *        different threads at the same time.
+ *        The scratch lives in an arena scope of the running thread. m_i is
+ *        copied out of it, into room made by ctx_crt(), so it is not moved.
+ */
+static void crt_exp_job(void *arg, size_t idx)
+{
+    PKCS1_CRT_JOB_t    *job;
+    const PKCS1_MONT_t *mt;
+    const PKCS1_EXP_t  *ex;
+    int                status;
+    bool               scoped;
+    mp_int             h, y;
+
+    job = (PKCS1_CRT_JOB_t *)arg;
+    pkcs1_crt_prime(job->ctx, idx, &mt, &ex);
+
+    scoped = pkcs1_arena_begin();
+    status = mp_init_multi(&h, &y, NULL);
+    if (MP_OKAY == status) {
+        status = pkcs1_mont_mod(mt, job->c, &h);
+        if (MP_OKAY == status) {
+            status = pkcs1_mont_exptmod_priv(mt, ex, &h, &y);
+        }
+        if (MP_OKAY == status) {
+            status = mp_copy(&y, &job->m[idx]);
+        }
+        mp_clear_multi(&h, &y, NULL);
+    }
+    pkcs1_arena_end(scoped);
+    job->status[idx] = status;
+}
+
+/**
+ * @brief Step 2.b.iii to 2.b.v of RSADP. Recombine m_1, ..., m_u into m.
+ *        Every h is one Montgomery multiplication by qInv or t_i kept in the
+ *        Montgomery form of p or r_i, and m_2 and m are brought into the
+ *        range of the prime by pkcs1_mont_mod(), without any division.
+ */
+int pkcs1_crt_garner(const RSA_TOOLS_KEY_CTX_t *ctx, const mp_int *mi, mp_int *m)
+{
+    int    status;
+    size_t i;
+    mp_int R, h;
+
+    status = mp_init_multi(&R, &h, NULL);
+    if (MP_OKAY == status) {
+        /* h = qInv ( m_1 - m_2 ) mod p */
+        status = mont_submul(&ctx->p, &mi[0], &mi[1], &ctx->qinv, &h);
+        /* m = m_2 + hq. */
+        if (MP_OKAY == status) {
+            status = mp_mul(&ctx->q.m, &h, m);
+        }
+        if (MP_OKAY == status) {
+            status = mp_add(m, &mi[1], m);
+        }
+        /* R = r_1 * r_2 */
+        if ((MP_OKAY == status) && (0 < ctx->other_cnt)) {
+            status = mp_mul(&ctx->p.m, &ctx->q.m, &R);
+        }
+        for (i = 0; (MP_OKAY == status) && (i < ctx->other_cnt); i++) {
+            /* h = (m_i - m) * t_i mod r_i */
+            status = mont_submul(&ctx->r[i], &mi[2 + i], m, &ctx->t[i], &h);
+            /* m = m + R * h, R = R * r_i */
+            if (MP_OKAY == status) {
+                status = mp_mul(&R, &h, &h);
+            }
+            if (MP_OKAY == status) {
+                status = mp_add(m, &h, m);
+            }
+            if (MP_OKAY == status) {
+                status = mp_mul(&R, &ctx->r[i].m, &R);
+            }
+        }
+        mp_clear_multi(&R, &h, NULL);
+    }
+
+    return status;
+}
+
+/**
+ * @brief CRT branch of RSADP. The half-exponentiations of all the primes are
+ *        given to tpool, the calling thread takes one of them too.
+ *        Without a pool they are run one after another.
+ *        m_i are made as large as r_i up front, so that no job has to grow
+ *        an integer of the calling thread.
+ */
+static int ctx_crt(const RSA_TOOLS_KEY_CTX_t *ctx, const mp_int *c, mp_int *m, void *tpool)
+{
+    int                status;
+    size_t             cnt;
+    size_t             i;
+    size_t             inited;
+    mp_int             mi[PKCS1_MAX_PRIMES];
+    int                st[PKCS1_MAX_PRIMES];
+    PKCS1_CRT_JOB_t    job;
+    const PKCS1_MONT_t *mt;
+    const PKCS1_EXP_t  *ex;
+
+    cnt    = 2 + ctx->other_cnt;
+    status = MP_OKAY;
+    for (inited = 0; (MP_OKAY == status) && (inited < cnt); inited++) {
+        pkcs1_crt_prime(ctx, inited, &mt, &ex);
+        status = mp_init_size(&mi[inited], mt->m.used);
+    }
+    if (MP_OKAY != status) {
+        inited--;
+    }
+    else {
+        job.ctx    = ctx;
+        job.c      = c;
+        job.m      = mi;
+        job.status = st;
+        if (UTILS_E_OK != utils_tpool_run(tpool, crt_exp_job, &job, cnt)) {
+            status = MP_VAL;
+        }
+        for (i = 0; (MP_OKAY == status) && (i < cnt); i++) {
+            status = st[i];
+        }
+        if (MP_OKAY == status) {
+            status = pkcs1_crt_garner(ctx, mi, m);
+        }
+    }
+    for (i = 0; i < inited; i++) {
+        mp_clear(&mi[i]);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Fault check of a signature with a key context, see sign_chk() of pkcs1.c.
+ *        s^e mod n takes the recoded e of the context, the chain of
+ *        mont_fermat() or the kernel for e = 65537, and is compared with the
+ *        input representative c as it was before blinding.
+ */
+static int ctx_sign_chk(const RSA_TOOLS_KEY_CTX_t *ctx, const mp_int *s, const mp_int *c)
+{
+    int    ret;
+    mp_int v;
+
+    ret = pkcs1_mp_status(mp_init(&v));
+    if (PKCS1_E_OK == ret) {
+        if (MP_LT != mp_cmp(s, &ctx->n.m)) {
+            ret = PKCS1_E_VERIFY;
+        }
+        else {
+            ret = pkcs1_mp_status(pkcs1_mont_exptmod(&ctx->n, &ctx->e, s, &v));
+        }
+        if ((PKCS1_E_OK == ret) && (MP_EQ != mp_cmp(&v, c))) {
+            ret = PKCS1_E_VERIFY;
+        }
+        mp_clear(&v);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief RSADP with a key context and an optional thread pool for the CRT branch.
+ *        The input is blinded if the context has blinding.
+ *        The working integers live in an arena scope of the calling thread,
+ *        those of crt_exp_job() in a scope of the thread running it.
+ *        If check, the output is checked by ctx_sign_chk() against a copy of
+ *        the input before it is written, so msg and emsg may be the same
+ *        buffer and a wrong output never reaches msg.
+ */
+static int ctx_rsadp(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, bool use_crt, void *tpool, bool check)
+{
+    int           ret;
+    int           res;
+    bool          scoped;
+    mp_int        c, m, x;
+    PKCS1_BLIND_t *blind;
+
+    if ((NULL == ctx) || (NULL == emsg) || (NULL == msg) || (NULL == mlen) ||
+        (ctx->n_len != emlen) || (ctx->n_len > *mlen) ||
+        (use_crt && !ctx->has_crt) || (!use_crt && !ctx->has_priv) || (check && !ctx->has_pub)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        scoped = pkcs1_arena_begin();
+        ret = pkcs1_mp_status(mp_init_multi(&c, &m, &x, NULL));
+        if (PKCS1_E_OK == ret) {
+            blind = NULL;
+            ret = pkcs1_rep_read(ctx, emsg, emlen, &c);
+            if ((PKCS1_E_OK == ret) && check) {
+                ret = pkcs1_mp_status(mp_copy(&c, &x));
+            }
+            if ((PKCS1_E_OK == ret) && (NULL != ctx->blind)) {
+                ret = pkcs1_blind(ctx, &c, &blind);
+            }
+            if (PKCS1_E_OK != ret) {
+                /* Error case */
+            }
+            else if (use_crt) {
+                ret = pkcs1_mp_status(ctx_crt(ctx, &c, &m, tpool));
+            }
+            else {
+                ret = pkcs1_mp_status(pkcs1_mont_exptmod_priv(&ctx->n, &ctx->d, &c, &m));
+            }
+            if (NULL != blind) {
+                res = pkcs1_unblind(ctx, (PKCS1_E_OK == ret) ? &m : NULL, blind);
+                if (PKCS1_E_OK == ret) {
+                    ret = res;
+                }
+            }
+            if ((PKCS1_E_OK == ret) && check) {
+                ret = ctx_sign_chk(ctx, &m, &x);
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_rep_write(&m, msg, ctx->n_len);
+            }
+            if (PKCS1_E_OK == ret) {
+                *mlen = ctx->n_len;
+            }
+            mp_clear_multi(&c, &m, &x, NULL);
+        }
+        pkcs1_arena_end(scoped);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief RSA decryption primitive (RSADP) with a key context.
+ *        See rsadp() for the specification.
+ *
+ * @param ctx[in]       Key context holding the private key.
+ * @param emsg[in]      Encrypted message buffer.
+ * @param emlen[in]     Length of encrypted message buffer.
+ * @param msg[out]      Message buffer.
+ * @param mlen[in,out]  Length of message buffer.
+ * @param use_crt[in]   CRT flag.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int rsadp_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, bool use_crt)
+{
+    return ctx_rsadp(ctx, emsg, emlen, msg, mlen, use_crt, NULL, false);
+}
+
+/**
+ * @brief RSA decryption primitive (RSADP) with CRT, the half-exponentiations
+ *        modulo p and q (and r_i) running concurrently on a thread pool.
+ *        The output is the same as rsadp_ctx() with use_crt.
+ *        A pool with one helper thread is enough for a two-prime key. The pool
+ *        runs the jobs of concurrent callers one after another, so give every
+ *        signing thread its own small pool.
+ *
+ * @param ctx[in]       Key context holding the CRT components.
+ * @param emsg[in]      Encrypted message buffer.
+ * @param emlen[in]     Length of encrypted message buffer.
+ * @param msg[out]      Message buffer.
+ * @param mlen[in,out]  Length of message buffer.
+ * @param tpool[in]     Thread pool (utils_tpool_alloc()), or NULL.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int rsadp_ctx_par(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *emsg, size_t emlen, uint8_t *msg, size_t *mlen, void *tpool)
+{
+    return ctx_rsadp(ctx, emsg, emlen, msg, mlen, true, tpool, false);
+}
+
+/**
+ * @brief RSA Signature Primitive, version 1 (RSASP1) with a key context.
+ *        See rsasp1() for the specification.
+ *
+ * @param ctx[in]       Key context holding the private key.
+ * @param msg[in]       Message representative buffer.
+ * @param mlen[in]      Length of message representative buffer.
+ * @param sig[out]      Signature buffer.
+ * @param slen[in,out]  Length of signature buffer.
+ * @param use_crt[in]   CRT flag.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int rsasp1_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt)
+{
+    return rsadp_ctx(ctx, msg, mlen, sig, slen, use_crt);
+}
+
+/**
+ * @brief RSA Signature Primitive, version 1 (RSASP1) with CRT on a thread pool.
+ *        See rsadp_ctx_par().
+ *
+ * @param ctx[in]       Key context holding the CRT components.
+ * @param msg[in]       Message representative buffer.
+ * @param mlen[in]      Length of message representative buffer.
+ * @param sig[out]      Signature buffer.
+ * @param slen[in,out]  Length of signature buffer.
+ * @param tpool[in]     Thread pool (utils_tpool_alloc()), or NULL.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int rsasp1_ctx_par(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, void *tpool)
+{
+    return rsadp_ctx_par(ctx, msg, mlen, sig, slen, tpool);
+}
+
+/**
+ * @brief RSA Verification Primitive, version 1 (RSAVP1) with a key context.
+ *        See rsavp1() for the specification.
+ *
+ * @param ctx[in]       Key context holding (n, e).
+ * @param sig[in]       Signature buffer.
+ * @param slen[in]      Length of signature buffer.
+ * @param msg[out]      Message representative buffer.
+ * @param mlen[in,out]  Length of message representative buffer.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int rsavp1_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *sig, size_t slen, uint8_t *msg, size_t *mlen)
+{
+    return rsaep_ctx(ctx, sig, slen, msg, mlen);
+}
+
+/**
+ * @brief PKCS1 RSA Sign with a key context.
+ *        With pkcs1_sign_check_set(), the signature is checked with e before
+ *        it is returned, so the context must then hold e.
+ *
+ * @param ctx[in]       Key context holding the private key.
+ * @param msg[in]       Message buffer.
+ * @param mlen[in]      Length of message buffer.
+ * @param sig[out]      Signature buffer.
+ * @param slen[in,out]  Length of signature buffer.
+ * @param use_crt[in]   CRT flag.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_VERIFY   Fault detected by the check, sig is not written.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_rsa_sign_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, uint8_t *sig, size_t *slen, bool use_crt)
+{
+    return ctx_rsadp(ctx, msg, mlen, sig, slen, use_crt, NULL, pkcs1_sign_check());
+}
+
+/**
+ * @brief PKCS1 RSA Verify with a key context.
+ *
+ * @param ctx[in]   Key context holding (n, e).
+ * @param msg[in]   Message buffer, the encoded message of the length of n.
+ * @param mlen[in]  Length of message buffer.
+ * @param sig[in]   Signature buffer.
+ * @param slen[in]  Length of signature buffer.
+ * @return          Status of this function.
+ *                  If return code is not equal PKCS1_E_OK, it should handle VERIFYCATION ERROR.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Value range error.
+ * @retval PKCS1_E_VERIFY   Verify error.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_rsa_verify_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen)
+{
+    int     ret;
+    uint8_t buf[PKCS1_MAX_N_LEN];
+    size_t  len;
+
+    if ((NULL == ctx) || (NULL == msg) || (ctx->n_len != slen)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        len = sizeof(buf);
+        ret = rsavp1_ctx(ctx, sig, slen, buf, &len);
+        if (PKCS1_E_OK != ret) {
+            /* In case of error exit */
+        }
+        else {
+            if (utils_blkcmp(msg, mlen, buf, len, false)) {
+                ret = PKCS1_E_OK;
+            }
+            else {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        memset(buf, 0, sizeof(buf));
+    }
+
+    return ret;
+}
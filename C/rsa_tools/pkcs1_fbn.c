@@ -0,0 +1,1925 @@
+/**
+ * @file pkcs1_fbn.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Fixed-width bignum of the primitives taking a key.
+ *        A number is held in 64 bit limbs of a PKCS1_FBN_t, which is large
+ *        enough for the product of two numbers below the largest modulus.
+ *        It lives on the stack of the caller, so an RSAEP or RSADP performs
+ *        no heap allocation at all. Exponentiations use Montgomery
+ *        multiplication with the bmi2 kernel if it is selected, otherwise a
+ *        portable word-by-word (CIOS) loop. Large moduli take Montgomery
+ *        reduction by Karatsuba products instead, a low half product for the
+ *        quotient and a high half product for its multiple of m, which are,
+ *        with pkcs1_mul_pool_set(), split over a thread pool.
+ *        Squarings take the symmetric square in each of these, so every
+ *        cross product is computed once.
+ *        pkcs1_fbn_exptmod_ct() is the constant-time engine of the private
+ *        key operations selected by pkcs1_const_time_set(). Every one of the
+ *        Montgomery multiplications above ends in a masked subtraction and
+ *        runs the same instructions whatever the operands are.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+#include "utils.h"
+
+#define FBN_LIMB_BITS   (64)
+#define FBN_CT_WSIZE    (5)     /* Fixed window of the constant-time engine. */
+
+#if ((1 << (PKCS1_FBN_WSIZE_MAX - 1)) > PKCS1_FBN_TBL_ENTRIES) || ((1 << FBN_CT_WSIZE) > PKCS1_FBN_TBL_ENTRIES)
+#error "PKCS1_FBN_TBL_ENTRIES is too small for the windows."
+#endif
+
+/* Montgomery multiplications of this many limbs (8192 bit) or more take the Karatsuba products. */
+#define FBN_KARATSUBA_LIMBS     (128)
+/* Products of fewer limbs than this are schoolbook. */
+#define FBN_KARATSUBA_CUTOFF    (48)
+/* Default of pkcs1_mul_pool_set(): products from 8192 bit on are split over the pool. */
+#define FBN_POOL_BITS           (8192)
+/* Scratch of fbn_kmul(), fbn_ksqr() and fbn_pmul() for n limbs. */
+#define FBN_KMUL_SCRATCH(n)     ((4 * (n)) + 64)
+#define FBN_PMUL_SCRATCH(n)     ((2 * (n)) + 8 + (3 * FBN_KMUL_SCRATCH(((n) / 2) + 2)))
+/* Scratch of fbn_kmullo(), fbn_pmullo() and fbn_pmulhi() for n limbs. */
+#define FBN_KMULLO_SCRATCH(n)   ((8 * (n)) + 64)
+#define FBN_PMULLO_SCRATCH(n)   ((24 * (((n) / 2) + 1)) + 192)
+#define FBN_PMULHI_SCRATCH(n)   ((9 * (n)) + 131)
+
+/**
+ * @brief Montgomery parameters of one odd modulus of n limbs. R = 2^(64 * n)
+ */
+typedef struct {
+    size_t               n;
+    uint64_t             m0inv;     /* -1/m mod 2^64 */
+    uint64_t             m[PKCS1_FBN_MOD_LIMBS];
+    const PKCS1_KERNEL_t *k;        /* The bmi2 kernel, or NULL for the loop. */
+    PKCS1_KMONT_t        km;
+    bool                 kara;      /* Reduction by Karatsuba products instead. */
+    uint64_t             mp[PKCS1_FBN_MOD_LIMBS];   /* -1/m mod R, if kara. */
+    uint64_t             r1[PKCS1_FBN_MOD_LIMBS];   /* R mod m, one in the Montgomery form. */
+    uint64_t             rr[PKCS1_FBN_MOD_LIMBS];   /* R^2 mod m */
+} FBN_MONT_t;
+
+/**
+ * @brief The products of the top level of a Karatsuba product, run by
+ *        fbn_pmul(), fbn_pmullo() and fbn_pmulhi() on a thread pool.
+ */
+typedef struct {
+    uint64_t       *r[3];
+    const uint64_t *a[3];
+    const uint64_t *b[3];
+    size_t         n[3];
+    uint64_t       *w[3];
+    bool           lo[3];   /* Only the low half, by fbn_kmullo(). */
+} FBN_PMUL_JOB_t;
+
+static void   *fbn_pool;        /* Thread pool of pkcs1_mul_pool_set(), or NULL. */
+static size_t fbn_pool_limbs;   /* Products of this many limbs or more are split over it. */
+static bool   fbn_ct;           /* Private key operations take the constant-time engine. */
+
+/**
+ * @brief Drop the leading zero limbs.
+ */
+static void fbn_clamp(PKCS1_FBN_t *x)
+{
+    while ((0 < x->used) && (0 == x->d[x->used - 1])) {
+        x->used--;
+    }
+}
+
+/**
+ * @brief Copy a number. c = a
+ */
+static void fbn_copy(const PKCS1_FBN_t *a, PKCS1_FBN_t *c)
+{
+    if (a != c) {
+        memcpy(c->d, a->d, a->used * sizeof(uint64_t));
+        c->used = a->used;
+    }
+}
+
+/**
+ * @brief Wipe a number and set it to zero.
+ *
+ * @param x[out]    Number.
+ */
+void pkcs1_fbn_clear(PKCS1_FBN_t *x)
+{
+    memset(x, 0, sizeof(PKCS1_FBN_t));
+}
+
+/**
+ * @brief Load 8 big-endian octets as a limb, a single byte swap on x86.
+ */
+static uint64_t fbn_load_be64(const uint8_t *a)
+{
+    uint64_t v;
+
+    memcpy(&v, a, sizeof(v));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    v = __builtin_bswap64(v);
+#endif
+
+    return v;
+}
+
+/**
+ * @brief Store a limb as 8 big-endian octets.
+ */
+static void fbn_store_be64(uint8_t *a, uint64_t v)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    v = __builtin_bswap64(v);
+#endif
+    memcpy(a, &v, sizeof(v));
+}
+
+/**
+ * @brief Convert an octet string into a number (OS2IP).
+ *        Whole limbs are loaded from the end of a, 8 octets at a time.
+ *
+ * @param x[out]    Number.
+ * @param a[in]     Big-endian octet string.
+ * @param alen[in]  Length of a.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    a is longer than a number can hold.
+ */
+int pkcs1_fbn_read(PKCS1_FBN_t *x, const uint8_t *a, size_t alen)
+{
+    int    ret;
+    size_t full;
+    size_t i;
+
+    if ((PKCS1_FBN_LIMBS * sizeof(uint64_t)) < alen) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        full = alen / sizeof(uint64_t);
+        for (i = 0; i < full; i++) {
+            x->d[i] = fbn_load_be64(&a[alen - (sizeof(uint64_t) * (i + 1))]);
+        }
+        x->used = full;
+        if (0 != (alen % sizeof(uint64_t))) {
+            /* The leading octets of a partial limb. */
+            x->d[full] = 0;
+            for (i = 0; i < (alen % sizeof(uint64_t)); i++) {
+                x->d[full] = (x->d[full] << 8) | a[i];
+            }
+            x->used++;
+        }
+        fbn_clamp(x);
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Convert a number into an octet string of exactly alen octets (I2OSP).
+ *        The leading octets are zero, so outputs of the primitives always
+ *        have the length of the modulus. Whole limbs are stored 8 octets at
+ *        a time.
+ *
+ * @param x[in]     Number.
+ * @param a[out]    Big-endian octet string.
+ * @param alen[in]  Length of a.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    x is 256^alen or more ("integer too large").
+ */
+int pkcs1_fbn_write(const PKCS1_FBN_t *x, uint8_t *a, size_t alen)
+{
+    int      ret;
+    size_t   n;
+    size_t   full;
+    size_t   rem;
+    size_t   i;
+    uint64_t top;
+
+    n = x->used;
+    while ((0 < n) && (0 == x->d[n - 1])) {
+        n--;
+    }
+    full = alen / sizeof(uint64_t);
+    rem  = alen % sizeof(uint64_t);
+    top  = (full < n) ? x->d[full] : 0;
+    if ((n > (full + ((0 != rem) ? 1 : 0))) || ((0 != rem) && (0 != (top >> (8 * rem))))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        for (i = 0; i < full; i++) {
+            fbn_store_be64(&a[alen - (sizeof(uint64_t) * (i + 1))], (i < n) ? x->d[i] : 0);
+        }
+        for (i = rem; 0 < i; i--) {
+            a[i - 1] = (uint8_t)top;
+            top    >>= 8;
+        }
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Compare two numbers.
+ *
+ * @return  -1 if a < b, 0 if a == b, 1 if a > b.
+ */
+int pkcs1_fbn_cmp(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b)
+{
+    int    ret;
+    size_t i;
+
+    if (a->used != b->used) {
+        ret = (a->used < b->used) ? -1 : 1;
+    }
+    else {
+        ret = 0;
+        for (i = a->used; (0 == ret) && (0 < i); i--) {
+            if (a->d[i - 1] != b->d[i - 1]) {
+                ret = (a->d[i - 1] < b->d[i - 1]) ? -1 : 1;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Addition. c = a + b, c may alias a or b.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    The sum does not fit into a number.
+ */
+int pkcs1_fbn_add(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, PKCS1_FBN_t *c)
+{
+    int               ret;
+    const PKCS1_FBN_t *x;
+    const PKCS1_FBN_t *y;
+    unsigned __int128 t;
+    size_t            i;
+
+    /* x is the longer one. */
+    x = (a->used >= b->used) ? a : b;
+    y = (a->used >= b->used) ? b : a;
+    t = 0;
+    for (i = 0; i < x->used; i++) {
+        t += x->d[i];
+        if (i < y->used) {
+            t += y->d[i];
+        }
+        c->d[i] = (uint64_t)t;
+        t >>= FBN_LIMB_BITS;
+    }
+    c->used = x->used;
+    if (0 == t) {
+        ret = PKCS1_E_OK;
+    }
+    else if (PKCS1_FBN_LIMBS > c->used) {
+        c->d[c->used++] = (uint64_t)t;
+        ret = PKCS1_E_OK;
+    }
+    else {
+        ret = PKCS1_E_PARAM;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Subtraction. c = a - b, c may alias a or b.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    a is below b.
+ */
+int pkcs1_fbn_sub(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, PKCS1_FBN_t *c)
+{
+    int      ret;
+    uint64_t u;
+    uint64_t v;
+    uint64_t borrow;
+    size_t   i;
+
+    if (0 > pkcs1_fbn_cmp(a, b)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        borrow = 0;
+        for (i = 0; i < a->used; i++) {
+            u       = a->d[i];
+            v       = (i < b->used) ? b->d[i] : 0;
+            c->d[i] = u - v - borrow;
+            borrow  = (u < v) || ((u == v) && (0 != borrow));
+        }
+        c->used = a->used;
+        fbn_clamp(c);
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Multiplication. c = a * b, c may alias a or b.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    The product does not fit into a number.
+ */
+int pkcs1_fbn_mul(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, PKCS1_FBN_t *c)
+{
+    int               ret;
+    uint64_t          t[PKCS1_FBN_LIMBS + 1];
+    unsigned __int128 p;
+    uint64_t          carry;
+    size_t            len;
+    size_t            i;
+    size_t            j;
+
+    /* The product has a->used + b->used limbs, or one less. */
+    len = a->used + b->used;
+    if ((PKCS1_FBN_LIMBS + 1) < len) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        memset(t, 0, len * sizeof(uint64_t));
+        for (i = 0; i < a->used; i++) {
+            carry = 0;
+            for (j = 0; j < b->used; j++) {
+                p = ((unsigned __int128)a->d[i] * b->d[j]) + t[i + j] + carry;
+                t[i + j] = (uint64_t)p;
+                carry    = (uint64_t)(p >> FBN_LIMB_BITS);
+            }
+            t[i + b->used] = carry;
+        }
+        while ((0 < len) && (0 == t[len - 1])) {
+            len--;
+        }
+        if (PKCS1_FBN_LIMBS < len) {
+            ret = PKCS1_E_PARAM;
+        }
+        else {
+            memcpy(c->d, t, len * sizeof(uint64_t));
+            c->used = len;
+            ret = PKCS1_E_OK;
+        }
+        memset(t, 0, sizeof(t));
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Modular reduction. c = a mod m
+ *        Knuth's Algorithm D (TAOCP Vol. 2, 4.3.1), of which only the
+ *        remainder is kept. c may alias a.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    m is zero.
+ */
+int pkcs1_fbn_mod(const PKCS1_FBN_t *a, const PKCS1_FBN_t *m, PKCS1_FBN_t *c)
+{
+    int               ret;
+    uint64_t          u[PKCS1_FBN_LIMBS + 1];
+    uint64_t          v[PKCS1_FBN_LIMBS];
+    unsigned __int128 num;
+    unsigned __int128 qhat;
+    unsigned __int128 rhat;
+    unsigned __int128 p;
+    __int128          t;
+    __int128          k;
+    unsigned          s;
+    size_t            n;
+    size_t            i;
+    size_t            j;
+
+    n = m->used;
+    if (0 == n) {
+        ret = PKCS1_E_PARAM;
+    }
+    else if (0 > pkcs1_fbn_cmp(a, m)) {
+        fbn_copy(a, c);
+        ret = PKCS1_E_OK;
+    }
+    else if (1 == n) {
+        num = 0;
+        for (i = a->used; 0 < i; i--) {
+            num = ((num << FBN_LIMB_BITS) | a->d[i - 1]) % m->d[0];
+        }
+        c->d[0] = (uint64_t)num;
+        c->used = 1;
+        fbn_clamp(c);
+        ret = PKCS1_E_OK;
+    }
+    else {
+        /* Normalize, so that the top bit of v is set. */
+        s = (unsigned)__builtin_clzll(m->d[n - 1]);
+        for (i = n - 1; 0 < i; i--) {
+            v[i] = (m->d[i] << s) | ((0 == s) ? 0 : (m->d[i - 1] >> (FBN_LIMB_BITS - s)));
+        }
+        v[0] = m->d[0] << s;
+        u[a->used] = (0 == s) ? 0 : (a->d[a->used - 1] >> (FBN_LIMB_BITS - s));
+        for (i = a->used - 1; 0 < i; i--) {
+            u[i] = (a->d[i] << s) | ((0 == s) ? 0 : (a->d[i - 1] >> (FBN_LIMB_BITS - s)));
+        }
+        u[0] = a->d[0] << s;
+
+        for (j = a->used - n + 1; 0 < j--; ) {
+            /* Estimate the quotient digit from the top two limbs, at most one too large after the test. */
+            num  = ((unsigned __int128)u[j + n] << FBN_LIMB_BITS) | u[j + n - 1];
+            qhat = num / v[n - 1];
+            rhat = num % v[n - 1];
+            while (((qhat >> FBN_LIMB_BITS) != 0) ||
+                   ((qhat * v[n - 2]) > ((rhat << FBN_LIMB_BITS) | u[j + n - 2]))) {
+                qhat--;
+                rhat += v[n - 1];
+                if (0 != (rhat >> FBN_LIMB_BITS)) {
+                    break;
+                }
+            }
+            /* u[j .. j+n] -= qhat * v */
+            k = 0;
+            for (i = 0; i < n; i++) {
+                p = qhat * v[i];
+                t = (__int128)u[i + j] - k - (__int128)(uint64_t)p;
+                u[i + j] = (uint64_t)t;
+                k = (__int128)(uint64_t)(p >> FBN_LIMB_BITS) - (t >> FBN_LIMB_BITS);
+            }
+            t = (__int128)u[j + n] - k;
+            u[j + n] = (uint64_t)t;
+            /* Add back if qhat was one too large. */
+            if (0 > t) {
+                k = 0;
+                for (i = 0; i < n; i++) {
+                    t = (__int128)u[i + j] + v[i] + k;
+                    u[i + j] = (uint64_t)t;
+                    k = t >> FBN_LIMB_BITS;
+                }
+                u[j + n] += (uint64_t)k;
+            }
+        }
+
+        /* Unnormalize the remainder u[0 .. n-1]. */
+        for (i = 0; (i + 1) < n; i++) {
+            c->d[i] = (u[i] >> s) | ((0 == s) ? 0 : (u[i + 1] << (FBN_LIMB_BITS - s)));
+        }
+        c->d[n - 1] = u[n - 1] >> s;
+        c->used = n;
+        fbn_clamp(c);
+        memset(u, 0, sizeof(u));
+        memset(v, 0, sizeof(v));
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Modular multiplication. c = a * b mod m
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    m is zero, or a * b does not fit into a number.
+ */
+int pkcs1_fbn_mulmod(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, const PKCS1_FBN_t *m, PKCS1_FBN_t *c)
+{
+    int         ret;
+    PKCS1_FBN_t t;
+
+    ret = pkcs1_fbn_mul(a, b, &t);
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_fbn_mod(&t, m, c);
+    }
+    pkcs1_fbn_clear(&t);
+
+    return ret;
+}
+
+/**
+ * @brief Montgomery multiplication of the portable loop. c = a * b / R mod m
+ *        Coarsely integrated operand scanning, c may alias a or b.
+ */
+static void fbn_mont_mul_loop(const FBN_MONT_t *mm, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    uint64_t          t[PKCS1_FBN_MOD_LIMBS + 2];
+    uint64_t          d[PKCS1_FBN_MOD_LIMBS];
+    unsigned __int128 p;
+    uint64_t          carry;
+    uint64_t          borrow;
+    uint64_t          keep;
+    uint64_t          q;
+    size_t            n;
+    size_t            i;
+    size_t            j;
+
+    n = mm->n;
+    memset(t, 0, (n + 2) * sizeof(uint64_t));
+    for (i = 0; i < n; i++) {
+        /* t += a[i] * b */
+        carry = 0;
+        for (j = 0; j < n; j++) {
+            p     = ((unsigned __int128)a[i] * b[j]) + t[j] + carry;
+            t[j]  = (uint64_t)p;
+            carry = (uint64_t)(p >> FBN_LIMB_BITS);
+        }
+        p        = (unsigned __int128)t[n] + carry;
+        t[n]     = (uint64_t)p;
+        t[n + 1] = (uint64_t)(p >> FBN_LIMB_BITS);
+
+        /* t = (t + q * m) / 2^64 */
+        q     = t[0] * mm->m0inv;
+        p     = ((unsigned __int128)q * mm->m[0]) + t[0];
+        carry = (uint64_t)(p >> FBN_LIMB_BITS);
+        for (j = 1; j < n; j++) {
+            p        = ((unsigned __int128)q * mm->m[j]) + t[j] + carry;
+            t[j - 1] = (uint64_t)p;
+            carry    = (uint64_t)(p >> FBN_LIMB_BITS);
+        }
+        p        = (unsigned __int128)t[n] + carry;
+        t[n - 1] = (uint64_t)p;
+        t[n]     = t[n + 1] + (uint64_t)(p >> FBN_LIMB_BITS);
+    }
+
+    /* t is below 2m, subtract m if it is not below m. */
+    borrow = 0;
+    for (j = 0; j < n; j++) {
+        d[j]   = t[j] - mm->m[j] - borrow;
+        borrow = (t[j] < mm->m[j]) || ((t[j] == mm->m[j]) && (0 != borrow));
+    }
+    keep = 0 - (borrow & (t[n] ^ 1));
+    for (j = 0; j < n; j++) {
+        c[j] = (t[j] & keep) | (d[j] & ~keep);
+    }
+    memset(t, 0, sizeof(t));
+    memset(d, 0, sizeof(d));
+}
+
+/**
+ * @brief r[0 .. n-1] += a[0 .. n-1]
+ *
+ * @return  Carry out of r[n-1].
+ */
+static uint64_t fbn_limbs_add(uint64_t *r, const uint64_t *a, size_t n)
+{
+    unsigned __int128 t;
+    size_t            i;
+
+    t = 0;
+    for (i = 0; i < n; i++) {
+        t    = (unsigned __int128)r[i] + a[i] + (uint64_t)t;
+        r[i] = (uint64_t)t;
+        t  >>= FBN_LIMB_BITS;
+    }
+
+    return (uint64_t)t;
+}
+
+/**
+ * @brief r[0 .. n-1] -= a[0 .. n-1]
+ *
+ * @return  Borrow out of r[n-1].
+ */
+static uint64_t fbn_limbs_sub(uint64_t *r, const uint64_t *a, size_t n)
+{
+    uint64_t u;
+    uint64_t borrow;
+    size_t   i;
+
+    borrow = 0;
+    for (i = 0; i < n; i++) {
+        u      = r[i];
+        r[i]   = u - a[i] - borrow;
+        borrow = (u < a[i]) || ((u == a[i]) && (0 != borrow));
+    }
+
+    return borrow;
+}
+
+/**
+ * @brief Propagate a carry into r[0 .. n-1].
+ *        All the limbs are visited, however early the carry dies out.
+ *
+ * @return  Carry out of r[n-1].
+ */
+static uint64_t fbn_limbs_inc(uint64_t *r, size_t n, uint64_t carry)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        r[i] += carry;
+        carry = (r[i] < carry) ? 1 : 0;
+    }
+
+    return carry;
+}
+
+/**
+ * @brief Propagate a borrow into r[0 .. n-1].
+ *        All the limbs are visited, however early the borrow dies out.
+ */
+static void fbn_limbs_dec(uint64_t *r, size_t n, uint64_t borrow)
+{
+    uint64_t u;
+    size_t   i;
+
+    for (i = 0; i < n; i++) {
+        u      = r[i];
+        r[i]   = u - borrow;
+        borrow = (u < borrow) ? 1 : 0;
+    }
+}
+
+/**
+ * @brief Schoolbook product. r[0 .. 2n-1] = a[0 .. n-1] * b[0 .. n-1]
+ *        r must not overlap a or b.
+ */
+static void fbn_smul(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+{
+    unsigned __int128 p;
+    uint64_t          carry;
+    size_t            i;
+    size_t            j;
+
+    memset(r, 0, 2 * n * sizeof(uint64_t));
+    for (i = 0; i < n; i++) {
+        carry = 0;
+        for (j = 0; j < n; j++) {
+            p        = ((unsigned __int128)a[i] * b[j]) + r[i + j] + carry;
+            r[i + j] = (uint64_t)p;
+            carry    = (uint64_t)(p >> FBN_LIMB_BITS);
+        }
+        r[i + n] = carry;
+    }
+}
+
+/**
+ * @brief Schoolbook low half product. r[0 .. n-1] = a * b mod 2^(64n)
+ *        The partial products above limb n-1 are left out.
+ *        r must not overlap a or b.
+ */
+static void fbn_smullo(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+{
+    unsigned __int128 p;
+    uint64_t          carry;
+    size_t            i;
+    size_t            j;
+
+    memset(r, 0, n * sizeof(uint64_t));
+    for (i = 0; i < n; i++) {
+        carry = 0;
+        for (j = 0; (i + j) < n; j++) {
+            p        = ((unsigned __int128)a[i] * b[j]) + r[i + j] + carry;
+            r[i + j] = (uint64_t)p;
+            carry    = (uint64_t)(p >> FBN_LIMB_BITS);
+        }
+    }
+}
+
+/**
+ * @brief Schoolbook square. r[0 .. 2n-1] = a[0 .. n-1]^2
+ *        The products a_i * a_j (i < j) are summed once and doubled, then
+ *        the squares a_i^2 are added, which saves almost half the products.
+ *        r must not overlap a.
+ */
+static void fbn_ssqr(uint64_t *r, const uint64_t *a, size_t n)
+{
+    unsigned __int128 p;
+    uint64_t          carry;
+    size_t            i;
+    size_t            j;
+
+    memset(r, 0, 2 * n * sizeof(uint64_t));
+    for (i = 0; (i + 1) < n; i++) {
+        carry = 0;
+        for (j = i + 1; j < n; j++) {
+            p        = ((unsigned __int128)a[i] * a[j]) + r[i + j] + carry;
+            r[i + j] = (uint64_t)p;
+            carry    = (uint64_t)(p >> FBN_LIMB_BITS);
+        }
+        r[i + n] = carry;
+    }
+    /* Double, the sum is below 2^(128n - 1). */
+    for (i = (2 * n) - 1; i > 0; i--) {
+        r[i] = (r[i] << 1) | (r[i - 1] >> (FBN_LIMB_BITS - 1));
+    }
+    r[0] <<= 1;
+    carry = 0;
+    for (i = 0; i < n; i++) {
+        p            = ((unsigned __int128)a[i] * a[i]) + r[2 * i] + carry;
+        r[2 * i]     = (uint64_t)p;
+        p            = (unsigned __int128)r[(2 * i) + 1] + (uint64_t)(p >> FBN_LIMB_BITS);
+        r[(2 * i) + 1] = (uint64_t)p;
+        carry        = (uint64_t)(p >> FBN_LIMB_BITS);
+    }
+}
+
+/**
+ * @brief Montgomery squaring of the portable loop. c = a * a / R mod m
+ *        Separated operand scanning: the square of fbn_ssqr(), then a
+ *        Montgomery reduction one limb at a time. c may alias a.
+ */
+static void fbn_mont_sqr_loop(const FBN_MONT_t *mm, uint64_t *c, const uint64_t *a)
+{
+    uint64_t          t[2 * PKCS1_FBN_MOD_LIMBS];
+    uint64_t          d[PKCS1_FBN_MOD_LIMBS];
+    unsigned __int128 p;
+    uint64_t          *r;
+    uint64_t          carry;
+    uint64_t          top;
+    uint64_t          borrow;
+    uint64_t          keep;
+    uint64_t          q;
+    size_t            n;
+    size_t            i;
+    size_t            j;
+
+    n = mm->n;
+    fbn_ssqr(t, a, n);
+
+    /* t[i] becomes 0, the carry limb and the carry go into t[i + n]. */
+    top = 0;
+    for (i = 0; i < n; i++) {
+        q     = t[i] * mm->m0inv;
+        carry = 0;
+        for (j = 0; j < n; j++) {
+            p        = ((unsigned __int128)q * mm->m[j]) + t[i + j] + carry;
+            t[i + j] = (uint64_t)p;
+            carry    = (uint64_t)(p >> FBN_LIMB_BITS);
+        }
+        p        = (unsigned __int128)t[i + n] + carry + top;
+        t[i + n] = (uint64_t)p;
+        top      = (uint64_t)(p >> FBN_LIMB_BITS);
+    }
+
+    /* top:r is below 2m, subtract m if it is not below m. */
+    r      = &t[n];
+    borrow = 0;
+    for (j = 0; j < n; j++) {
+        d[j]   = r[j] - mm->m[j] - borrow;
+        borrow = (r[j] < mm->m[j]) || ((r[j] == mm->m[j]) && (0 != borrow));
+    }
+    keep = 0 - (borrow & (top ^ 1));
+    for (j = 0; j < n; j++) {
+        c[j] = (r[j] & keep) | (d[j] & ~keep);
+    }
+    memset(t, 0, sizeof(t));
+    memset(d, 0, sizeof(d));
+}
+
+/**
+ * @brief Operand of the middle product of Karatsuba, s = a0 + a1 of h + 1
+ *        limbs, where a = a1 * 2^(64 * l) + a0.
+ */
+static void fbn_ksum(uint64_t *s, const uint64_t *a, size_t l, size_t h)
+{
+    memcpy(s, &a[l], h * sizeof(uint64_t));
+    s[h] = 0;
+    (void)fbn_limbs_inc(&s[l], h + 1 - l, fbn_limbs_add(s, a, l));
+}
+
+/**
+ * @brief Put the three products of Karatsuba together.
+ *        r holds a0 * b0 in its low 2l limbs and a1 * b1 in its high 2h
+ *        limbs, z = (a0 + a1) * (b0 + b1) of 2h + 2 limbs. Then
+ *        r += (z - a0 * b0 - a1 * b1) * 2^(64 * l), z is overwritten.
+ */
+static void fbn_kjoin(uint64_t *r, uint64_t *z, size_t l, size_t h)
+{
+    size_t rn;
+    size_t zn;
+
+    rn = 2 * (l + h);
+    zn = (2 * h) + 2;
+    fbn_limbs_dec(&z[2 * l], zn - (2 * l), fbn_limbs_sub(z, r, 2 * l));
+    fbn_limbs_dec(&z[2 * h], zn - (2 * h), fbn_limbs_sub(z, &r[2 * l], 2 * h));
+    /* The middle term is below 2^(64 * (rn - l)), the limbs of z above are zero. */
+    if ((l + zn) > rn) {
+        zn = rn - l;
+    }
+    (void)fbn_limbs_inc(&r[l + zn], rn - l - zn, fbn_limbs_add(&r[l], z, zn));
+}
+
+/**
+ * @brief Karatsuba product. r[0 .. 2n-1] = a[0 .. n-1] * b[0 .. n-1]
+ *        r must not overlap a, b or w.
+ *
+ * @param w[in]     Scratch of FBN_KMUL_SCRATCH(n) limbs.
+ */
+static void fbn_kmul(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *w)
+{
+    uint64_t *sa;
+    uint64_t *sb;
+    uint64_t *z;
+    size_t   l;
+    size_t   h;
+
+    if (FBN_KARATSUBA_CUTOFF > n) {
+        fbn_smul(r, a, b, n);
+    }
+    else {
+        l  = n / 2;
+        h  = n - l;
+        sa = w;
+        sb = &w[h + 1];
+        z  = &w[(2 * h) + 2];
+        fbn_ksum(sa, a, l, h);
+        fbn_ksum(sb, b, l, h);
+        fbn_kmul(r, a, b, l, &z[(2 * h) + 2]);
+        fbn_kmul(&r[2 * l], &a[l], &b[l], h, &z[(2 * h) + 2]);
+        fbn_kmul(z, sa, sb, h + 1, &z[(2 * h) + 2]);
+        fbn_kjoin(r, z, l, h);
+    }
+}
+
+/**
+ * @brief Karatsuba square. r[0 .. 2n-1] = a[0 .. n-1]^2
+ *        The three products are squares, down to fbn_ssqr().
+ *        r must not overlap a or w.
+ *
+ * @param w[in]     Scratch of FBN_KMUL_SCRATCH(n) limbs.
+ */
+static void fbn_ksqr(uint64_t *r, const uint64_t *a, size_t n, uint64_t *w)
+{
+    uint64_t *z;
+    size_t   l;
+    size_t   h;
+
+    if (FBN_KARATSUBA_CUTOFF > n) {
+        fbn_ssqr(r, a, n);
+    }
+    else {
+        l = n / 2;
+        h = n - l;
+        z = &w[(2 * h) + 2];
+        fbn_ksum(w, a, l, h);
+        fbn_ksqr(r, a, l, &z[(2 * h) + 2]);
+        fbn_ksqr(&r[2 * l], &a[l], h, &z[(2 * h) + 2]);
+        fbn_ksqr(z, w, h + 1, &z[(2 * h) + 2]);
+        fbn_kjoin(r, z, l, h);
+    }
+}
+
+/**
+ * @brief Karatsuba low half product. r[0 .. n-1] = a * b mod 2^(64n)
+ *        With a = a1 * 2^(64 * l) + a0, only a0 * b0 is a full product, the
+ *        cross products a0 * b1 and a1 * b0 are low half products of h
+ *        limbs, and a1 * b1 is left out but for its lowest limb if n is odd.
+ *        r must not overlap a, b or w.
+ *
+ * @param w[in]     Scratch of FBN_KMULLO_SCRATCH(n) limbs.
+ */
+static void fbn_kmullo(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *w)
+{
+    uint64_t *x;
+    uint64_t *y;
+    uint64_t *pa;
+    uint64_t *pb;
+    size_t   l;
+    size_t   h;
+
+    if (FBN_KARATSUBA_CUTOFF > n) {
+        fbn_smullo(r, a, b, n);
+    }
+    else {
+        l  = n / 2;
+        h  = n - l;
+        x  = w;
+        y  = &w[h];
+        pa = &w[2 * h];
+        pb = &w[3 * h];
+        /* a0 and b0 of h limbs. */
+        memset(pa, 0, 2 * h * sizeof(uint64_t));
+        memcpy(pa, a, l * sizeof(uint64_t));
+        memcpy(pb, b, l * sizeof(uint64_t));
+        fbn_kmul(r, a, b, l, &w[4 * h]);
+        if ((2 * l) < n) {
+            /* The one limb of a1 * b1 below 2^(64n). */
+            r[2 * l] = a[l] * b[l];
+        }
+        fbn_kmullo(x, pa, &b[l], h, &w[4 * h]);
+        fbn_kmullo(y, &a[l], pb, h, &w[4 * h]);
+        (void)fbn_limbs_add(x, y, h);
+        (void)fbn_limbs_add(&r[l], x, h);
+    }
+}
+
+/**
+ * @brief One of the products of the top level, a job of the pool.
+ *        A product of a number by itself is a square.
+ */
+static void fbn_pmul_job(void *arg, size_t idx)
+{
+    FBN_PMUL_JOB_t *job;
+
+    job = (FBN_PMUL_JOB_t *)arg;
+    if (job->lo[idx]) {
+        fbn_kmullo(job->r[idx], job->a[idx], job->b[idx], job->n[idx], job->w[idx]);
+    }
+    else if (job->a[idx] == job->b[idx]) {
+        fbn_ksqr(job->r[idx], job->a[idx], job->n[idx], job->w[idx]);
+    }
+    else {
+        fbn_kmul(job->r[idx], job->a[idx], job->b[idx], job->n[idx], job->w[idx]);
+    }
+}
+
+/**
+ * @brief Product of two numbers of n limbs. r[0 .. 2n-1] = a * b
+ *        From the pool limbs of pkcs1_mul_pool_set() on, the three products
+ *        of the top level of Karatsuba run on the pool. If the pool is busy,
+ *        they run on this thread, so a job of the pool may call this too.
+ *        If a and b are the same, the products are squares.
+ *        r must not overlap a, b or w.
+ *
+ * @param w[in]     Scratch of FBN_PMUL_SCRATCH(n) limbs.
+ */
+static void fbn_pmul(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *w)
+{
+    FBN_PMUL_JOB_t job;
+    void           *pool;
+    uint64_t       *z;
+    size_t         l;
+    size_t         h;
+    size_t         i;
+
+    pool = fbn_pool;
+    if ((NULL == pool) || (fbn_pool_limbs > n) || (FBN_KARATSUBA_CUTOFF > n)) {
+        if (a == b) {
+            fbn_ksqr(r, a, n, w);
+        }
+        else {
+            fbn_kmul(r, a, b, n, w);
+        }
+    }
+    else {
+        l = n / 2;
+        h = n - l;
+        z = &w[(2 * h) + 2];
+        fbn_ksum(w, a, l, h);
+        if (a != b) {
+            fbn_ksum(&w[h + 1], b, l, h);
+        }
+
+        job.r[0] = r;
+        job.a[0] = a;
+        job.b[0] = b;
+        job.n[0] = l;
+        job.r[1] = &r[2 * l];
+        job.a[1] = &a[l];
+        job.b[1] = &b[l];
+        job.n[1] = h;
+        job.r[2] = z;
+        job.a[2] = w;
+        job.b[2] = (a == b) ? w : &w[h + 1];
+        job.n[2] = h + 1;
+        for (i = 0; i < 3; i++) {
+            job.w[i]  = &z[(2 * h) + 2 + (i * FBN_KMUL_SCRATCH(h + 1))];
+            job.lo[i] = false;
+        }
+        (void)utils_tpool_try_run(pool, fbn_pmul_job, &job, 3);
+        fbn_kjoin(r, z, l, h);
+    }
+}
+
+/**
+ * @brief Low half product of two numbers of n limbs. r[0 .. n-1] = a * b mod 2^(64n)
+ *        From the pool limbs of pkcs1_mul_pool_set() on, the full product
+ *        a0 * b0 and the two low half cross products of fbn_kmullo() run on
+ *        the pool.
+ *        r must not overlap a, b or w.
+ *
+ * @param w[in]     Scratch of FBN_PMULLO_SCRATCH(n) limbs.
+ */
+static void fbn_pmullo(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *w)
+{
+    FBN_PMUL_JOB_t job;
+    void           *pool;
+    uint64_t       *x;
+    uint64_t       *y;
+    uint64_t       *pa;
+    uint64_t       *pb;
+    size_t         l;
+    size_t         h;
+
+    pool = fbn_pool;
+    if ((NULL == pool) || (fbn_pool_limbs > n) || (FBN_KARATSUBA_CUTOFF > n)) {
+        fbn_kmullo(r, a, b, n, w);
+    }
+    else {
+        l  = n / 2;
+        h  = n - l;
+        x  = w;
+        y  = &w[h];
+        pa = &w[2 * h];
+        pb = &w[3 * h];
+        memset(pa, 0, 2 * h * sizeof(uint64_t));
+        memcpy(pa, a, l * sizeof(uint64_t));
+        memcpy(pb, b, l * sizeof(uint64_t));
+        if ((2 * l) < n) {
+            /* The one limb of a1 * b1 below 2^(64n). */
+            r[2 * l] = a[l] * b[l];
+        }
+
+        job.r[0]  = r;
+        job.a[0]  = a;
+        job.b[0]  = b;
+        job.n[0]  = l;
+        job.w[0]  = &w[4 * h];
+        job.lo[0] = false;
+        job.r[1]  = x;
+        job.a[1]  = pa;
+        job.b[1]  = &b[l];
+        job.n[1]  = h;
+        job.w[1]  = &w[(8 * h) + 64];
+        job.lo[1] = true;
+        job.r[2]  = y;
+        job.a[2]  = &a[l];
+        job.b[2]  = pb;
+        job.n[2]  = h;
+        job.w[2]  = &w[(16 * h) + 128];
+        job.lo[2] = true;
+        (void)utils_tpool_try_run(pool, fbn_pmul_job, &job, 3);
+        (void)fbn_limbs_add(x, y, h);
+        (void)fbn_limbs_add(&r[l], x, h);
+    }
+}
+
+/**
+ * @brief a mod 2^(64l) - 1 of a number of 2l limbs, l limbs.
+ *        The high half is added to the low half with an end-around carry.
+ */
+static void fbn_wrap_m1(uint64_t *x, const uint64_t *a, size_t l)
+{
+    memcpy(x, a, l * sizeof(uint64_t));
+    (void)fbn_limbs_inc(x, l, fbn_limbs_add(x, &a[l], l));
+}
+
+/**
+ * @brief a mod 2^(64l) + 1 of a number of 2l limbs, l + 1 limbs.
+ *        The high half is subtracted from the low half, and 2^(64l) + 1 is
+ *        added back on a borrow. x[l] is 1 only for 2^(64l).
+ */
+static void fbn_wrap_p1(uint64_t *x, const uint64_t *a, size_t l)
+{
+    memcpy(x, a, l * sizeof(uint64_t));
+    x[l] = fbn_limbs_inc(x, l, fbn_limbs_sub(x, &a[l], l));
+}
+
+/**
+ * @brief High half product of two numbers of n = 2l limbs, whose low half
+ *        is known. hi[0 .. n-1] = a * b / 2^(64n), lo = a * b mod 2^(64n)
+ *        a * b mod 2^(64n) - 1 is the sum of the two halves, so hi follows
+ *        from lo and the wrapped product. That one is put together by the
+ *        CRT from a * b mod 2^(64l) - 1 and mod 2^(64l) + 1, two full
+ *        products of l limbs instead of the three of Karatsuba, which run
+ *        on the pool from the pool limbs of pkcs1_mul_pool_set() on.
+ *        Every step is masked, so it takes the same time for all a and b.
+ *        hi must not overlap a, b, lo or w.
+ *
+ * @param w[in]     Scratch of FBN_PMULHI_SCRATCH(n) limbs.
+ */
+static void fbn_pmulhi(uint64_t *hi, const uint64_t *a, const uint64_t *b, const uint64_t *lo, size_t n, uint64_t *w)
+{
+    FBN_PMUL_JOB_t job;
+    void           *pool;
+    uint64_t       *a1;
+    uint64_t       *b1;
+    uint64_t       *a2;
+    uint64_t       *b2;
+    uint64_t       *s;
+    uint64_t       *pa;
+    uint64_t       *pb;
+    uint64_t       odd;
+    uint64_t       ones;
+    size_t         l;
+    size_t         j;
+
+    l  = n / 2;
+    a1 = w;
+    b1 = &a1[l];
+    a2 = &b1[l];
+    b2 = &a2[l + 1];
+    s  = &b2[l + 1];
+    pa = &s[l + 1];
+    pb = &pa[2 * l];
+    fbn_wrap_m1(a1, a, l);
+    fbn_wrap_m1(b1, b, l);
+    fbn_wrap_p1(a2, a, l);
+    fbn_wrap_p1(b2, b, l);
+
+    /* The low l limbs of the residues mod 2^(64l) + 1, their top limbs are taken below. */
+    pool = ((NULL != fbn_pool) && (fbn_pool_limbs <= n)) ? fbn_pool : NULL;
+    job.r[0]  = pa;
+    job.a[0]  = a1;
+    job.b[0]  = b1;
+    job.n[0]  = l;
+    job.w[0]  = &pb[2 * l];
+    job.lo[0] = false;
+    job.r[1]  = pb;
+    job.a[1]  = a2;
+    job.b[1]  = b2;
+    job.n[1]  = l;
+    job.w[1]  = &pb[(6 * l) + 64];
+    job.lo[1] = false;
+    (void)utils_tpool_try_run(pool, fbn_pmul_job, &job, 2);
+
+    /* x = a * b mod 2^(64l) - 1 */
+    fbn_wrap_m1(a1, pa, l);
+    /* y = a * b mod 2^(64l) + 1. With 2^(64l) = -1, the top limbs give
+       -(a2_top * b2 + b2_top * a2) + a2_top * b2_top, of which only one term
+       is not 0. */
+    fbn_wrap_p1(s, pb, l);
+    for (j = 0; j < l; j++) {
+        pa[j] = (b2[j] & (0 - a2[l])) | (a2[j] & (0 - b2[l]));
+    }
+    pa[l] = 0;
+    odd   = fbn_limbs_sub(s, pa, l + 1);
+    (void)fbn_limbs_inc(s, l + 1, odd);
+    s[l] += odd;
+    (void)fbn_limbs_inc(s, l + 1, a2[l] & b2[l]);
+
+    /* k = (x - y) / 2 mod 2^(64l) - 1, as 2^(64l) + 1 = 2 there. */
+    memcpy(pa, s, l * sizeof(uint64_t));
+    (void)fbn_limbs_inc(pa, l, s[l]);
+    fbn_limbs_dec(a1, l, fbn_limbs_sub(a1, pa, l));
+    odd = a1[0] & 1;
+    fbn_limbs_dec(a1, l, odd);
+    for (j = 0; (j + 1) < l; j++) {
+        a1[j] = (a1[j] >> 1) | (a1[j + 1] << (FBN_LIMB_BITS - 1));
+    }
+    a1[l - 1] = (a1[l - 1] >> 1) | (odd << (FBN_LIMB_BITS - 1));
+
+    /* a * b mod 2^(64n) - 1 = y + k * (2^(64l) + 1) */
+    memcpy(hi, a1, l * sizeof(uint64_t));
+    memcpy(&hi[l], a1, l * sizeof(uint64_t));
+    odd = fbn_limbs_inc(&hi[l + 1], l - 1, fbn_limbs_add(hi, s, l + 1));
+    (void)fbn_limbs_inc(hi, n, odd);
+
+    /* hi = wrapped - lo mod 2^(64n) - 1, where all ones stands for 0. hi
+       is below 2^(64n) - 1, as a and b are. */
+    fbn_limbs_dec(hi, n, fbn_limbs_sub(hi, lo, n));
+    ones = ~(uint64_t)0;
+    for (j = 0; j < n; j++) {
+        ones &= hi[j];
+    }
+    ones = 0 - (uint64_t)(0 == (ones + 1));
+    for (j = 0; j < n; j++) {
+        hi[j] &= ~ones;
+    }
+}
+
+/**
+ * @brief Montgomery multiplication by full products. c = a * b / R mod m
+ *        t = a * b, q = t * m' mod R and c = (t + q * m) / R, which is
+ *        below 2m. q is a low half product. The low half of q * m is
+ *        R - (t mod R), or 0, so only its high half is computed, if n is
+ *        even. c may alias a or b.
+ */
+static void fbn_mont_mul_kara(const FBN_MONT_t *mm, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    uint64_t t[2 * PKCS1_FBN_MOD_LIMBS];
+    uint64_t u[2 * PKCS1_FBN_MOD_LIMBS];
+    uint64_t q[PKCS1_FBN_MOD_LIMBS];
+    uint64_t d[PKCS1_FBN_MOD_LIMBS];
+    uint64_t w[FBN_PMULLO_SCRATCH(PKCS1_FBN_MOD_LIMBS)];  /* The largest of the three. */
+    uint64_t top;
+    uint64_t low;
+    uint64_t borrow;
+    uint64_t keep;
+    size_t   n;
+    size_t   j;
+
+    n = mm->n;
+    fbn_pmul(t, a, b, n, w);
+    fbn_pmullo(q, t, mm->mp, n, w);
+    if (0 == (n % 2)) {
+        /* d = R - (t mod R) mod R, the low half of q * m. */
+        memset(d, 0, n * sizeof(uint64_t));
+        (void)fbn_limbs_sub(d, t, n);
+        fbn_pmulhi(&u[n], q, mm->m, d, n, w);
+    }
+    else {
+        fbn_pmul(u, q, mm->m, n, w);
+    }
+
+    /* The low halves of t and q * m add up to 0, or to R if t is not 0 there. */
+    low = 0;
+    for (j = 0; j < n; j++) {
+        low |= t[j];
+    }
+    top  = fbn_limbs_add(&t[n], &u[n], n);
+    top += fbn_limbs_inc(&t[n], n, (low | (0 - low)) >> (FBN_LIMB_BITS - 1));
+
+    /* t is below 2m, subtract m if it is not below m. */
+    borrow = 0;
+    for (j = 0; j < n; j++) {
+        d[j]   = t[n + j] - mm->m[j] - borrow;
+        borrow = (t[n + j] < mm->m[j]) || ((t[n + j] == mm->m[j]) && (0 != borrow));
+    }
+    keep = 0 - (borrow & (top ^ 1));
+    for (j = 0; j < n; j++) {
+        c[j] = (t[n + j] & keep) | (d[j] & ~keep);
+    }
+    memset(t, 0, sizeof(t));
+    memset(u, 0, sizeof(u));
+    memset(q, 0, sizeof(q));
+    memset(d, 0, sizeof(d));
+}
+
+/**
+ * @brief Montgomery multiplication. c = a * b / R mod m
+ */
+static void fbn_mont_mul(const FBN_MONT_t *mm, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    if (mm->kara) {
+        fbn_mont_mul_kara(mm, c, a, b);
+    }
+    else if (NULL != mm->k) {
+        mm->k->mul(&mm->km, c, a, b);
+    }
+    else {
+        fbn_mont_mul_loop(mm, c, a, b);
+    }
+}
+
+/**
+ * @brief Montgomery squaring. c = a * a / R mod m
+ *        The full products take the Karatsuba square for a * a.
+ */
+static void fbn_mont_sqr(const FBN_MONT_t *mm, uint64_t *c, const uint64_t *a)
+{
+    if (mm->kara) {
+        fbn_mont_mul_kara(mm, c, a, a);
+    }
+    else if (NULL != mm->k) {
+        mm->k->sqr(&mm->km, c, a);
+    }
+    else {
+        fbn_mont_sqr_loop(mm, c, a);
+    }
+}
+
+/**
+ * @brief Modular addition. c = a + b mod m for a and b below m.
+ *        m is subtracted by a mask, not a branch. c may alias a or b.
+ */
+static void fbn_mod_add(const FBN_MONT_t *mm, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    uint64_t s[PKCS1_FBN_MOD_LIMBS];
+    uint64_t carry;
+    uint64_t keep;
+    size_t   n;
+    size_t   j;
+
+    n = mm->n;
+    memcpy(s, a, n * sizeof(uint64_t));
+    carry = fbn_limbs_add(s, b, n);
+    memcpy(c, s, n * sizeof(uint64_t));
+    /* Keep the sum if it is below m. */
+    keep = 0 - (fbn_limbs_sub(c, mm->m, n) & (carry ^ 1));
+    for (j = 0; j < n; j++) {
+        c[j] = (s[j] & keep) | (c[j] & ~keep);
+    }
+    memset(s, 0, sizeof(s));
+}
+
+/**
+ * @brief Modular subtraction. c = a - b mod m for a and b below m.
+ *        m is added back by a mask, not a branch. c may alias a or b.
+ */
+static void fbn_mod_sub(const FBN_MONT_t *mm, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    uint64_t d[PKCS1_FBN_MOD_LIMBS];
+    uint64_t t[PKCS1_FBN_MOD_LIMBS];
+    uint64_t mask;
+    size_t   n;
+    size_t   j;
+
+    n = mm->n;
+    memcpy(d, a, n * sizeof(uint64_t));
+    mask = 0 - fbn_limbs_sub(d, b, n);
+    for (j = 0; j < n; j++) {
+        t[j] = mm->m[j] & mask;
+    }
+    (void)fbn_limbs_add(d, t, n);
+    memcpy(c, d, n * sizeof(uint64_t));
+    memset(d, 0, sizeof(d));
+}
+
+/**
+ * @brief Set up the Montgomery parameters of an odd modulus.
+ *        Moduli split over the pool of pkcs1_mul_pool_set() take the
+ *        Karatsuba products, otherwise the bmi2 kernel is used if it is the
+ *        selected kernel and m is in its range. Large moduli without the
+ *        kernel take the Karatsuba products too.
+ */
+static void fbn_mont_init(FBN_MONT_t *mm, const PKCS1_FBN_t *m)
+{
+    const PKCS1_KERNEL_t *k;
+    unsigned __int128    p;
+    uint64_t             t[PKCS1_FBN_MOD_LIMBS];
+    uint64_t             carry;
+    uint64_t             e;
+    size_t               bits;
+    size_t               i;
+    size_t               j;
+
+    mm->n     = m->used;
+    memcpy(mm->m, m->d, m->used * sizeof(uint64_t));
+    mm->m0inv = pkcs1_limb_m0inv(m->d[0], FBN_LIMB_BITS);
+    mm->k     = NULL;
+    mm->kara  = false;
+
+    k    = pkcs1_kernel_get();
+    bits = (FBN_LIMB_BITS * m->used) - (size_t)__builtin_clzll(m->d[m->used - 1]);
+    if ((NULL != fbn_pool) && (fbn_pool_limbs <= mm->n)) {
+        mm->kara = true;
+    }
+    else if ((NULL != k) && (FBN_LIMB_BITS == k->limb_bits) && (1 == k->lanes) &&
+             (k->min_bits <= bits) && (k->max_bits >= bits)) {
+        mm->k         = k;
+        mm->km.kernel = k;
+        mm->km.limbs  = mm->n;
+        mm->km.m0inv  = mm->m0inv;
+        mm->km.m      = mm->m;
+        mm->km.rr     = NULL;   /* Not used by mul() and sqr(). */
+    }
+    else if (FBN_KARATSUBA_LIMBS <= mm->n) {
+        mm->kara = true;
+    }
+    else {
+        /* The portable loop. */
+    }
+
+    if (mm->kara) {
+        /* m' = -1/m mod R limb by limb: t = 1 + m * m' becomes 0 mod R from the bottom. */
+        memset(t, 0, mm->n * sizeof(uint64_t));
+        t[0] = 1;
+        for (i = 0; i < mm->n; i++) {
+            mm->mp[i] = t[i] * mm->m0inv;
+            carry     = 0;
+            for (j = i; j < mm->n; j++) {
+                p     = ((unsigned __int128)mm->mp[i] * mm->m[j - i]) + t[j] + carry;
+                t[j]  = (uint64_t)p;
+                carry = (uint64_t)(p >> FBN_LIMB_BITS);
+            }
+        }
+    }
+
+    /* R mod m by doublings of 2^(bits - 1) < m, R^2 mod m as the Montgomery
+       form of 2^(64n) by squarings and doublings of one, no division. */
+    memset(mm->r1, 0, mm->n * sizeof(uint64_t));
+    if (1 < bits) {
+        mm->r1[(bits - 1) / FBN_LIMB_BITS] = (uint64_t)1 << ((bits - 1) % FBN_LIMB_BITS);
+    }
+    for (i = bits - 1; i < (FBN_LIMB_BITS * mm->n); i++) {
+        fbn_mod_add(mm, mm->r1, mm->r1, mm->r1);
+    }
+    memcpy(mm->rr, mm->r1, mm->n * sizeof(uint64_t));
+    e = FBN_LIMB_BITS * mm->n;
+    for (i = FBN_LIMB_BITS - (size_t)__builtin_clzll(e); 0 < i; i--) {
+        fbn_mont_sqr(mm, mm->rr, mm->rr);
+        if (0 != ((e >> (i - 1)) & 1)) {
+            fbn_mod_add(mm, mm->rr, mm->rr, mm->rr);
+        }
+    }
+}
+
+/**
+ * @brief Convert a number of any length into the Montgomery form.
+ *        c = a * R mod m
+ *        a is taken n limbs at a time from the top. With c the Montgomery
+ *        form of the limbs so far, that of the next step is c * R^2 / R plus
+ *        part * R^2 / R, so the reduction takes no division.
+ */
+static void fbn_mont_in(const FBN_MONT_t *mm, const PKCS1_FBN_t *a, uint64_t *c)
+{
+    uint64_t x[PKCS1_FBN_MOD_LIMBS];
+    size_t   n;
+    size_t   k;
+    size_t   len;
+
+    n = mm->n;
+    memset(c, 0, n * sizeof(uint64_t));
+    for (k = (a->used + n - 1) / n; 0 < k; k--) {
+        len = a->used - ((k - 1) * n);
+        len = (n < len) ? n : len;
+        memset(x, 0, n * sizeof(uint64_t));
+        memcpy(x, &a->d[(k - 1) * n], len * sizeof(uint64_t));
+        fbn_mont_mul(mm, x, x, mm->rr);
+        if (((a->used + n - 1) / n) != k) {
+            fbn_mont_mul(mm, c, c, mm->rr);
+        }
+        fbn_mod_add(mm, c, c, x);
+    }
+    memset(x, 0, sizeof(x));
+}
+
+/**
+ * @brief h = (a - b) * t mod r without division.
+ *        a and b of any length are brought into the range of r by
+ *        Montgomery multiplications by R^2 mod r, their difference by a
+ *        masked addition of r, and the product by t leaves the Montgomery
+ *        form. This is the recombination of the CRT halves of RSADP.
+ *
+ * @param a[in]     Number.
+ * @param b[in]     Number.
+ * @param t[in]     Number below r.
+ * @param r[in]     Modulus, odd and of PKCS1_FBN_MOD_LIMBS limbs or less.
+ * @param h[out]    Result, may alias a, b or t.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    r is even or too long, or t is not below r.
+ */
+int pkcs1_fbn_submulmod(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, const PKCS1_FBN_t *t, const PKCS1_FBN_t *r, PKCS1_FBN_t *h)
+{
+    int        ret;
+    FBN_MONT_t mm;
+    uint64_t   x[PKCS1_FBN_MOD_LIMBS];
+    uint64_t   y[PKCS1_FBN_MOD_LIMBS];
+
+    if ((0 == r->used) || (PKCS1_FBN_MOD_LIMBS < r->used) || (0 == (r->d[0] & 1)) ||
+        (0 <= pkcs1_fbn_cmp(t, r))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        fbn_mont_init(&mm, r);
+        fbn_mont_in(&mm, a, x);
+        fbn_mont_in(&mm, b, y);
+        fbn_mod_sub(&mm, x, x, y);
+        /* (a - b) * R * t / R */
+        memset(y, 0, mm.n * sizeof(uint64_t));
+        memcpy(y, t->d, t->used * sizeof(uint64_t));
+        fbn_mont_mul(&mm, x, x, y);
+        memcpy(h->d, x, mm.n * sizeof(uint64_t));
+        h->used = mm.n;
+        fbn_clamp(h);
+        memset(x, 0, sizeof(x));
+        memset(y, 0, sizeof(y));
+        memset(&mm, 0, sizeof(mm));
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Window width of a sliding window exponentiation, the width of
+ *        pkcs1_fbn_exp_wsize() up to PKCS1_FBN_WSIZE_MAX, which bounds the
+ *        table in the workspace.
+ */
+static unsigned fbn_wsize(size_t bits)
+{
+    unsigned w;
+
+    w = (unsigned)pkcs1_fbn_exp_wsize(bits);
+    if (PKCS1_FBN_WSIZE_MAX < w) {
+        w = PKCS1_FBN_WSIZE_MAX;
+    }
+
+    return w;
+}
+
+/**
+ * @brief Bit pos of a big-endian exponent.
+ */
+static unsigned fbn_bit(const uint8_t *e, size_t elen, size_t pos)
+{
+    return (e[elen - 1 - (pos / 8)] >> (pos % 8)) & 1;
+}
+
+/**
+ * @brief Modular exponentiation. y = b^e mod m
+ *        Sliding windows of odd digits over a table of b^1, b^3, ...,
+ *        b^(2^w - 1), all in Montgomery form in the workspace ws. The
+ *        exponent is scanned as it is, without any recoding. e = 2^k + 1
+ *        takes the chain of k squarings.
+ *
+ * @param ws[in]    Workspace, wiped before return.
+ * @param b[in]     Base.
+ * @param e[in]     Exponent (big-endian, may have leading zeros).
+ * @param elen[in]  Length of e.
+ * @param m[in]     Modulus, odd and of PKCS1_FBN_MOD_LIMBS limbs or less.
+ * @param y[out]    Result, may alias b.
+ * @param wsize[in] Window width in bits, 0 for that of fbn_wsize().
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    m is even or too long.
+ */
+static int fbn_exptmod_w(PKCS1_FBN_EXP_WS_t *ws, const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y, unsigned wsize)
+{
+    int         ret;
+    FBN_MONT_t  mm;
+    uint64_t    (*tbl)[PKCS1_FBN_MOD_LIMBS];
+    uint64_t    *acc;
+    uint64_t    *sq;
+    size_t      bits;
+    size_t      tcnt;
+    size_t      fermat;
+    size_t      pos;
+    size_t      i;
+    size_t      d;
+    unsigned    l;
+    unsigned    j;
+    unsigned    w;
+
+    if ((0 == m->used) || (PKCS1_FBN_MOD_LIMBS < m->used) || (0 == (m->d[0] & 1))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        fbn_mont_init(&mm, m);
+        tbl = (uint64_t (*)[PKCS1_FBN_MOD_LIMBS])ws->tbl;
+        acc = ws->acc;
+        sq  = ws->x;
+
+        bits = 8 * elen;
+        while ((0 < bits) && (0 == fbn_bit(e, elen, bits - 1))) {
+            bits--;
+        }
+        w      = (0 < wsize) ? wsize : fbn_wsize(bits);
+        tcnt   = (size_t)1 << (w - 1);
+        fermat = pkcs1_exp_fermat(e, elen);
+
+        /* acc = R mod m (one), tbl[0] = b * R mod m */
+        memcpy(acc, mm.r1, mm.n * sizeof(uint64_t));
+        fbn_mont_in(&mm, b, tbl[0]);
+        if (0 != fermat) {
+            /* e = 2^k + 1 (3, 65537, ...): k squarings and one multiplication. */
+            memcpy(acc, tbl[0], mm.n * sizeof(uint64_t));
+            for (i = 0; i < fermat; i++) {
+                fbn_mont_sqr(&mm, acc, acc);
+            }
+            fbn_mont_mul(&mm, acc, acc, tbl[0]);
+        }
+        else if (0 < bits) {
+            /* tbl[i] = b^(2i+1) */
+            fbn_mont_sqr(&mm, sq, tbl[0]);
+            for (i = 1; i < tcnt; i++) {
+                fbn_mont_mul(&mm, tbl[i], tbl[i - 1], sq);
+            }
+
+            /* The top bit starts the first window, so acc is replaced by its digit. */
+            pos = bits;
+            while (0 < pos) {
+                if (0 == fbn_bit(e, elen, pos - 1)) {
+                    fbn_mont_sqr(&mm, acc, acc);
+                    pos--;
+                }
+                else {
+                    /* Window of l bits [pos - l, pos) ending in a 1 bit. */
+                    l = ((size_t)w < pos) ? w : (unsigned)pos;
+                    while (0 == fbn_bit(e, elen, pos - l)) {
+                        l--;
+                    }
+                    d = 0;
+                    for (j = l; 0 < j; j--) {
+                        d = (d << 1) | fbn_bit(e, elen, pos - (l - j) - 1);
+                    }
+                    if (bits == pos) {
+                        memcpy(acc, tbl[d >> 1], mm.n * sizeof(uint64_t));
+                    }
+                    else {
+                        for (j = 0; j < l; j++) {
+                            fbn_mont_sqr(&mm, acc, acc);
+                        }
+                        fbn_mont_mul(&mm, acc, acc, tbl[d >> 1]);
+                    }
+                    pos -= l;
+                }
+            }
+        }
+        else {
+            /* e = 0: acc stays one. */
+        }
+        /* Out of the Montgomery form. */
+        memset(sq, 0, mm.n * sizeof(uint64_t));
+        sq[0] = 1;
+        fbn_mont_mul(&mm, acc, acc, sq);
+        memcpy(y->d, acc, mm.n * sizeof(uint64_t));
+        y->used = mm.n;
+        fbn_clamp(y);
+
+        memset(tbl, 0, tcnt * sizeof(tbl[0]));
+        memset(acc, 0, sizeof(ws->acc));
+        memset(sq, 0, sizeof(ws->x));
+        memset(&mm, 0, sizeof(mm));
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Modular exponentiation. y = b^e mod m
+ *        fbn_exptmod_w() with the window width of fbn_wsize().
+ *
+ * @param ws[in]    Workspace, wiped before return.
+ * @param b[in]     Base.
+ * @param e[in]     Exponent (big-endian, may have leading zeros).
+ * @param elen[in]  Length of e.
+ * @param m[in]     Modulus, odd and of PKCS1_FBN_MOD_LIMBS limbs or less.
+ * @param y[out]    Result, may alias b.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    m is even or too long.
+ */
+int pkcs1_fbn_exptmod_ws(PKCS1_FBN_EXP_WS_t *ws, const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y)
+{
+    return fbn_exptmod_w(ws, b, e, elen, m, y, 0);
+}
+
+/**
+ * @brief Modular exponentiation of pkcs1_fbn_exptmod_ws() with its
+ *        workspace on the stack. y = b^e mod m
+ */
+int pkcs1_fbn_exptmod(const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y)
+{
+    PKCS1_FBN_EXP_WS_t ws;
+
+    return pkcs1_fbn_exptmod_ws(&ws, b, e, elen, m, y);
+}
+
+/**
+ * @brief Modular exponentiation of pkcs1_fbn_exptmod() with windows of
+ *        wsize bits, for pkcs1_exp_autotune(). y = b^e mod m
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    m is even or too long, or wsize is 0 or above
+ *                          PKCS1_FBN_WSIZE_MAX.
+ */
+int pkcs1_fbn_exptmod_w(const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y, unsigned wsize)
+{
+    int                ret;
+    PKCS1_FBN_EXP_WS_t ws;
+
+    if ((0 == wsize) || (PKCS1_FBN_WSIZE_MAX < wsize)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        ret = fbn_exptmod_w(&ws, b, e, elen, m, y, wsize);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Store a number as entry j of a table of the constant-time engine.
+ *        The entries are interleaved, limb i of every entry lies in tbl[i],
+ *        so that the cache lines read by fbn_ct_gather() do not depend on j.
+ */
+static void fbn_ct_scatter(uint64_t (*tbl)[1 << FBN_CT_WSIZE], size_t n, size_t j, const uint64_t *x)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        tbl[i][j] = x[i];
+    }
+}
+
+/**
+ * @brief Load entry j of a table of the constant-time engine.
+ *        Every entry is read and all but entry j are masked off.
+ */
+static void fbn_ct_gather(uint64_t (*tbl)[1 << FBN_CT_WSIZE], size_t n, size_t j, uint64_t *x)
+{
+    uint64_t mask;
+    uint64_t v;
+    size_t   i;
+    size_t   k;
+
+    for (i = 0; i < n; i++) {
+        v = 0;
+        for (k = 0; k < ((size_t)1 << FBN_CT_WSIZE); k++) {
+            /* All ones if k == j, without a branch. */
+            mask = 0 - (((uint64_t)(k ^ j) - 1) >> (FBN_LIMB_BITS - 1));
+            v   |= tbl[i][k] & mask;
+        }
+        x[i] = v;
+    }
+}
+
+/**
+ * @brief Modular exponentiation in constant time. y = b^e mod m
+ *        Fixed windows of FBN_CT_WSIZE bits over all 8 * elen bits of e, so
+ *        the sequence of squarings and multiplications depends on elen only.
+ *        Digits of zero multiply by one (R mod m) like any other digit, and
+ *        the table entries are taken by fbn_ct_gather(). b is brought into
+ *        the Montgomery form by multiplications with R^2 mod m, no division.
+ *        The table lives in the workspace ws.
+ *
+ * @param ws[in]    Workspace, wiped before return.
+ * @param b[in]     Base.
+ * @param e[in]     Exponent (big-endian, may have leading zeros).
+ * @param elen[in]  Length of e.
+ * @param m[in]     Modulus, odd and of PKCS1_FBN_MOD_LIMBS limbs or less.
+ * @param y[out]    Result, may alias b.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    m is even or too long.
+ */
+int pkcs1_fbn_exptmod_ct_ws(PKCS1_FBN_EXP_WS_t *ws, const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y)
+{
+    int         ret;
+    FBN_MONT_t  mm;
+    uint64_t    (*tbl)[1 << FBN_CT_WSIZE];
+    uint64_t    *acc;
+    uint64_t    *x;
+    size_t      pos;
+    size_t      d;
+    size_t      j;
+    size_t      l;
+
+    if ((0 == m->used) || (PKCS1_FBN_MOD_LIMBS < m->used) || (0 == (m->d[0] & 1))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        fbn_mont_init(&mm, m);
+        tbl = (uint64_t (*)[1 << FBN_CT_WSIZE])ws->tbl;
+        acc = ws->acc;
+        x   = ws->x;
+
+        /* tbl[0] = R mod m (one), tbl[1] = b * R mod m */
+        memcpy(acc, mm.r1, mm.n * sizeof(uint64_t));
+        fbn_mont_in(&mm, b, x);
+        fbn_ct_scatter(tbl, mm.n, 0, acc);
+        fbn_ct_scatter(tbl, mm.n, 1, x);
+        memcpy(acc, x, mm.n * sizeof(uint64_t));
+        for (j = 2; j < ((size_t)1 << FBN_CT_WSIZE); j++) {
+            fbn_mont_mul(&mm, acc, acc, x);
+            fbn_ct_scatter(tbl, mm.n, j, acc);
+        }
+
+        /* The top window may be short, it replaces acc. */
+        pos = 8 * elen;
+        l   = pos % FBN_CT_WSIZE;
+        l   = (0 == l) ? FBN_CT_WSIZE : l;
+        while (0 < pos) {
+            d = 0;
+            for (j = 0; j < l; j++) {
+                d = (d << 1) | fbn_bit(e, elen, pos - j - 1);
+            }
+            if ((8 * elen) == pos) {
+                fbn_ct_gather(tbl, mm.n, d, acc);
+            }
+            else {
+                for (j = 0; j < l; j++) {
+                    fbn_mont_sqr(&mm, acc, acc);
+                }
+                fbn_ct_gather(tbl, mm.n, d, x);
+                fbn_mont_mul(&mm, acc, acc, x);
+            }
+            pos -= l;
+            l    = FBN_CT_WSIZE;
+        }
+        if (0 == elen) {
+            /* e = 0 */
+            fbn_ct_gather(tbl, mm.n, 0, acc);
+        }
+
+        /* Out of the Montgomery form. */
+        memset(x, 0, mm.n * sizeof(uint64_t));
+        x[0] = 1;
+        fbn_mont_mul(&mm, acc, acc, x);
+        memcpy(y->d, acc, mm.n * sizeof(uint64_t));
+        y->used = mm.n;
+        fbn_clamp(y);
+
+        memset(ws->tbl, 0, sizeof(ws->tbl));
+        memset(acc, 0, sizeof(ws->acc));
+        memset(x, 0, sizeof(ws->x));
+        memset(&mm, 0, sizeof(mm));
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Modular exponentiation of pkcs1_fbn_exptmod_ct_ws() with its
+ *        workspace on the stack. y = b^e mod m
+ */
+int pkcs1_fbn_exptmod_ct(const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y)
+{
+    PKCS1_FBN_EXP_WS_t ws;
+
+    return pkcs1_fbn_exptmod_ct_ws(&ws, b, e, elen, m, y);
+}
+
+/**
+ * @brief Square a cnt times in place by the Montgomery squaring of m, or by
+ *        the Montgomery multiplication of a by itself, for the benchmarks of
+ *        the squarings. a = a^(2^cnt) / R^(2^cnt - 1) mod m
+ *
+ * @param m[in]         Modulus, odd and of PKCS1_FBN_MOD_LIMBS limbs or less.
+ * @param a[in,out]     Number below m.
+ * @param cnt[in]       Number of squarings.
+ * @param by_mul[in]    Multiply instead of squaring.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    m is even or too long, or a is not below m.
+ */
+int pkcs1_fbn_mont_sqr_run(const PKCS1_FBN_t *m, PKCS1_FBN_t *a, size_t cnt, bool by_mul)
+{
+    int        ret;
+    FBN_MONT_t mm;
+    uint64_t   x[PKCS1_FBN_MOD_LIMBS];
+    size_t     i;
+
+    if ((0 == m->used) || (PKCS1_FBN_MOD_LIMBS < m->used) || (0 == (m->d[0] & 1)) ||
+        (0 <= pkcs1_fbn_cmp(a, m))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        fbn_mont_init(&mm, m);
+        memset(x, 0, mm.n * sizeof(uint64_t));
+        memcpy(x, a->d, a->used * sizeof(uint64_t));
+        for (i = 0; i < cnt; i++) {
+            if (by_mul) {
+                fbn_mont_mul(&mm, x, x, x);
+            }
+            else {
+                fbn_mont_sqr(&mm, x, x);
+            }
+        }
+        memcpy(a->d, x, mm.n * sizeof(uint64_t));
+        a->used = mm.n;
+        fbn_clamp(a);
+        memset(x, 0, sizeof(x));
+        ret = PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Whether the private key operations take the constant-time engine.
+ */
+bool pkcs1_const_time(void)
+{
+    return fbn_ct;
+}
+
+/**
+ * @brief Select the constant-time engine for the private key operations.
+ *        rsadp(), rsasp1() and pkcs1_rsa_sign(), the same operations of key
+ *        contexts, pkcs1_rsa_sign_batch_ctx() and the root of rsadp_fiat()
+ *        then exponentiate with pkcs1_fbn_exptmod_ct() instead of the
+ *        sliding windows; batch signing leaves the lane kernel. Only the
+ *        exponentiations are covered: the CRT recombination, the blinding
+ *        and the conversions of the representatives still take libtommath
+ *        or the lengths of their numbers, and their time may depend on the
+ *        values. The public key operations are not affected. Call it before
+ *        other threads use this module.
+ *
+ * @param on[in]    true for the constant-time engine, false for the default.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK   Success.
+ */
+int pkcs1_const_time_set(bool on)
+{
+    fbn_ct = on;
+
+    return PKCS1_E_OK;
+}
+
+/**
+ * @brief Set the thread pool of the products of large moduli.
+ *        Exponentiations of the primitives taking a key with a modulus of
+ *        min_bits or more take Karatsuba products, whose three products of
+ *        the top level run on the pool. A busy pool runs them on the calling
+ *        thread, so the pool may also run the primitives themselves. Call it
+ *        before other threads use this module, and keep the pool until it is
+ *        set to NULL.
+ *
+ * @param tpool[in]     Thread pool of utils_tpool_alloc(), or NULL for none.
+ * @param min_bits[in]  Least modulus length in bits, 0 for the default (8192).
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK   Success.
+ */
+int pkcs1_mul_pool_set(void *tpool, size_t min_bits)
+{
+    if (0 == min_bits) {
+        min_bits = FBN_POOL_BITS;
+    }
+    fbn_pool_limbs = (min_bits + FBN_LIMB_BITS - 1) / FBN_LIMB_BITS;
+    fbn_pool       = tpool;
+
+    return PKCS1_E_OK;
+}
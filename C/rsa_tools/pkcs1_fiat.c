@@ -0,0 +1,616 @@
+/**
+ * @file pkcs1_fiat.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Batch RSA decryption (A. Fiat, "Batch RSA", CRYPTO '89).
+ *        Ciphertexts under keys which share one modulus and have small
+ *        distinct public exponents e_i are decrypted with one full size
+ *        exponentiation. The ciphertexts are combined up a binary tree into
+ *        v = prod(c_i ^ (E / e_i)), E = prod(e_i), the root is decrypted as
+ *        v ^ (1/E), and the result is split down the tree again with small
+ *        exponents and one modular inversion per node. Only the root takes
+ *        the private key, and the constant-time engine when it is selected.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+#include "utils.h"
+
+/* Public exponents of a key family, the smallest odd primes. */
+static const uint8_t fiat_e[PKCS1_FIAT_MAX_KEYS] = {
+    3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59
+};
+
+/* Node of the batch tree. The leaves are the ciphertexts. */
+typedef struct {
+    mp_int v;       /* Product of the ciphertexts below, see file header. */
+    mp_int e;       /* Product of the public exponents below. */
+    bool   leaf;
+    size_t left;    /* Index of the children (internal node only). */
+    size_t right;
+    size_t item;    /* Index of the item (leaf only). */
+} PKCS1_FIAT_NODE_t;
+
+typedef struct {
+    mp_int            n;
+    mp_int            p;
+    mp_int            q;
+    mp_int            qinv;
+    PKCS1_FIAT_NODE_t node[(2 * PKCS1_FIAT_MAX_KEYS) - 1];
+    size_t            node_cnt;
+    PKCS1_FIAT_ITEM_t *items;
+} PKCS1_FIAT_t;
+
+/**
+ * @brief Random source of mp_prime_random_ex().
+ */
+static int fiat_rng(unsigned char *dst, int len, void *dat)
+{
+    (void)dat;
+
+    return (UTILS_E_OK == utils_random(dst, (size_t)len)) ? len : 0;
+}
+
+/**
+ * @brief Write x as a big endian integer of exactly len bytes.
+ */
+static int fiat_write(const mp_int *x, uint8_t *a, size_t len)
+{
+    int    ret;
+    size_t size;
+
+    size = (size_t)mp_unsigned_bin_size(x);
+    if (len < size) {
+        ret = PKCS1_E_INTERNAL;
+    }
+    else {
+        memset(a, 0, len - size);
+        ret = pkcs1_mp_status(mp_to_unsigned_bin(x, &a[len - size]));
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Generate a prime of bits bits with the top two bits set, such that
+ *        p - 1 is coprime to all of the first cnt exponents.
+ */
+static int fiat_prime(mp_int *p, int bits, size_t cnt)
+{
+    int      ret;
+    size_t   i;
+    bool     ok;
+    mp_digit r;
+
+    ok  = false;
+    ret = PKCS1_E_OK;
+    while ((PKCS1_E_OK == ret) && !ok) {
+        ret = pkcs1_mp_status(mp_prime_random_ex(p, mp_prime_rabin_miller_trials(bits), bits,
+                                                 LTM_PRIME_2MSB_ON, fiat_rng, NULL));
+        ok = true;
+        for (i = 0; (PKCS1_E_OK == ret) && ok && (i < cnt); i++) {
+            /* e_i is prime, so e_i | p - 1 iff p mod e_i == 1. */
+            ret = pkcs1_mp_status(mp_mod_d(p, fiat_e[i], &r));
+            ok  = (1 != r);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Key generation of pkcs1_fiat_keygen() with checked parameters.
+ */
+static int fiat_keygen(size_t n_len, size_t cnt, RSA_TOOLS_FIAT_KEY_t *fkey)
+{
+    int                  ret;
+    size_t               i;
+    size_t               half;
+    uint8_t              *a;
+    RSA_TOOLS_PRIV_KEY_t *key;
+    mp_int               n, p, q, qinv, p_1, q_1, lcm, e, d, x;
+
+    half = n_len / 2;
+    memset(fkey, 0, sizeof(RSA_TOOLS_FIAT_KEY_t));
+    ret = pkcs1_mp_status(mp_init_multi(&n, &p, &q, &qinv, &p_1, &q_1, &lcm, &e, &d, &x, NULL));
+    if (PKCS1_E_OK == ret) {
+        /* Shared n, p, q, qInv, then (e, d, dP, dQ) of every key. */
+        fkey->buf_len = (n_len + (3 * half)) + (cnt * (1 + n_len + (2 * half)));
+        fkey->buf     = calloc(1, fkey->buf_len);
+        ret = (NULL != fkey->buf) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    }
+
+    if (PKCS1_E_OK == ret) {
+        ret = fiat_prime(&p, (int)(half * 8), cnt);
+    }
+    do {
+        if (PKCS1_E_OK == ret) {
+            ret = fiat_prime(&q, (int)(half * 8), cnt);
+        }
+    } while ((PKCS1_E_OK == ret) && (MP_EQ == mp_cmp(&p, &q)));
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_mul(&p, &q, &n));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_invmod(&q, &p, &qinv));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_sub_d(&p, 1, &p_1));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_sub_d(&q, 1, &q_1));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_lcm(&p_1, &q_1, &lcm));
+    }
+
+    a = fkey->buf;
+    if (PKCS1_E_OK == ret) {
+        key          = &fkey->key[0];
+        key->n       = a;
+        key->n_len   = n_len;
+        a           += n_len;
+        key->p       = a;
+        key->p_len   = half;
+        a           += half;
+        key->q       = a;
+        key->q_len   = half;
+        a           += half;
+        key->qinv    = a;
+        key->qinv_len = half;
+        a           += half;
+        ret = fiat_write(&n, key->n, n_len);
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = fiat_write(&p, key->p, half);
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = fiat_write(&q, key->q, half);
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = fiat_write(&qinv, key->qinv, half);
+    }
+
+    for (i = 0; (PKCS1_E_OK == ret) && (i < cnt); i++) {
+        key = &fkey->key[i];
+        if (0 < i) {
+            *key = fkey->key[0];
+        }
+        key->e      = a;
+        key->e_len  = 1;
+        key->e[0]   = fiat_e[i];
+        a          += 1;
+        key->d      = a;
+        key->d_len  = n_len;
+        a          += n_len;
+        key->dp     = a;
+        key->dp_len = half;
+        a          += half;
+        key->dq     = a;
+        key->dq_len = half;
+        a          += half;
+
+        /* d = e^-1 mod lcm(p-1, q-1), dP = d mod (p-1), dQ = d mod (q-1) */
+        ret = pkcs1_mp_status(mp_set_int(&e, fiat_e[i]));
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_invmod(&e, &lcm, &d));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = fiat_write(&d, key->d, n_len);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_mod(&d, &p_1, &x));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = fiat_write(&x, key->dp, half);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_mod(&d, &q_1, &x));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = fiat_write(&x, key->dq, half);
+        }
+    }
+
+    if (PKCS1_E_OK == ret) {
+        fkey->cnt = cnt;
+    }
+    else {
+        pkcs1_fiat_key_free(fkey);
+    }
+    mp_clear_multi(&n, &p, &q, &qinv, &p_1, &q_1, &lcm, &e, &d, &x, NULL);
+
+    return ret;
+}
+
+/**
+ * @brief Generate a batch RSA key family.
+ *        key[i] of the family has the public exponent e_i, the i-th odd prime
+ *        (3, 5, 7, 11, ...), and all keys share (n, p, q, qInv).
+ *        Components have the fixed lengths rsadp() expects (d: n_len,
+ *        p, q, dP, dQ, qInv: n_len / 2). Release with pkcs1_fiat_key_free().
+ *
+ * @param n_len[in]     Length of the modulus in bytes, even and accepted by
+ *                      pkcs1_n_len_chk().
+ * @param cnt[in]       Number of keys (2 .. PKCS1_FIAT_MAX_KEYS).
+ * @param fkey[out]     Key family.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+int pkcs1_fiat_keygen(size_t n_len, size_t cnt, RSA_TOOLS_FIAT_KEY_t *fkey)
+{
+    int ret;
+
+    /* The primes are of n_len / 2 bytes each. */
+    if ((NULL == fkey) || (2 > cnt) || (PKCS1_FIAT_MAX_KEYS < cnt) ||
+        !pkcs1_n_len_chk(NULL, n_len) || (0 != (n_len % 2))) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        ret = fiat_keygen(n_len, cnt, fkey);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Release a key family generated by pkcs1_fiat_keygen().
+ *
+ * @param fkey[in]  Key family.
+ */
+void pkcs1_fiat_key_free(RSA_TOOLS_FIAT_KEY_t *fkey)
+{
+    if (NULL != fkey) {
+        if (NULL != fkey->buf) {
+            memset(fkey->buf, 0, fkey->buf_len);
+            free(fkey->buf);
+        }
+        memset(fkey, 0, sizeof(RSA_TOOLS_FIAT_KEY_t));
+    }
+}
+
+/**
+ * @brief Build the tree over items lo .. hi-1 bottom up.
+ *        v = v_L ^ e_R * v_R ^ e_L mod n, e = e_L * e_R.
+ *
+ * @param idx[out]  Index of the node.
+ */
+static int fiat_up(PKCS1_FIAT_t *ft, const RSA_TOOLS_FIAT_KEY_t *fkey, size_t lo, size_t hi, size_t *idx)
+{
+    int               ret;
+    size_t            mid;
+    PKCS1_FIAT_NODE_t *nd;
+    PKCS1_FIAT_NODE_t *l;
+    PKCS1_FIAT_NODE_t *r;
+    mp_int            a;
+
+    *idx = ft->node_cnt++;
+    nd   = &ft->node[*idx];
+    ret  = pkcs1_mp_status(mp_init_multi(&nd->v, &nd->e, NULL));
+    if (PKCS1_E_OK != ret) {
+        /* Error case */
+    }
+    else if (1 == (hi - lo)) {
+        nd->leaf = true;
+        nd->item = lo;
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&nd->v, ft->items[lo].emsg, (int)ft->items[lo].emlen));
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_read_unsigned_bin(&nd->e, fkey->key[ft->items[lo].key].e,
+                                                       (int)fkey->key[ft->items[lo].key].e_len));
+        }
+    }
+    else {
+        mid = lo + ((hi - lo) / 2);
+        ret = fiat_up(ft, fkey, lo, mid, &nd->left);
+        if (PKCS1_E_OK == ret) {
+            ret = fiat_up(ft, fkey, mid, hi, &nd->right);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_init(&a));
+            if (PKCS1_E_OK == ret) {
+                l = &ft->node[nd->left];
+                r = &ft->node[nd->right];
+                ret = pkcs1_mp_status(mp_exptmod(&l->v, &r->e, &ft->n, &nd->v));
+                if (PKCS1_E_OK == ret) {
+                    ret = pkcs1_mp_status(mp_exptmod(&r->v, &l->e, &ft->n, &a));
+                }
+                if (PKCS1_E_OK == ret) {
+                    ret = pkcs1_mp_status(mp_mulmod(&nd->v, &a, &ft->n, &nd->v));
+                }
+                if (PKCS1_E_OK == ret) {
+                    ret = pkcs1_mp_status(mp_mul(&l->e, &r->e, &nd->e));
+                }
+                mp_clear(&a);
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Split m = v ^ (1/e) of a node down to the leaves.
+ *        With X = 0 mod e_L and X = 1 mod e_R, m^X = v_L^(X/e_L) * v_R^((X-1)/e_R) * m_R,
+ *        so m_R = m^X / (v_L^(X/e_L) * v_R^((X-1)/e_R)) and m_L = m / m_R.
+ */
+static int fiat_down(PKCS1_FIAT_t *ft, size_t idx, mp_int *m)
+{
+    int               ret;
+    PKCS1_FIAT_NODE_t *nd;
+    PKCS1_FIAT_NODE_t *l;
+    PKCS1_FIAT_NODE_t *r;
+    PKCS1_FIAT_ITEM_t *item;
+    mp_int            x, a, b, t, m_l, m_r;
+
+    nd = &ft->node[idx];
+    if (nd->leaf) {
+        item = &ft->items[nd->item];
+        /* emlen is the length of n. */
+        ret = pkcs1_rep_write(m, item->msg, item->emlen);
+        if (PKCS1_E_OK == ret) {
+            item->mlen = item->emlen;
+        }
+    }
+    else {
+        l   = &ft->node[nd->left];
+        r   = &ft->node[nd->right];
+        ret = pkcs1_mp_status(mp_init_multi(&x, &a, &b, &t, &m_l, &m_r, NULL));
+        if (PKCS1_E_OK == ret) {
+            /* a = e_L^-1 mod e_R, X = e_L * a, b = (X - 1) / e_R */
+            ret = pkcs1_mp_status(mp_invmod(&l->e, &r->e, &a));
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_mul(&l->e, &a, &x));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_sub_d(&x, 1, &b));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_div(&b, &r->e, &b, NULL));
+            }
+            /* t = v_L^a * v_R^b mod n */
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_exptmod(&l->v, &a, &ft->n, &t));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_exptmod(&r->v, &b, &ft->n, &m_l));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_mulmod(&t, &m_l, &ft->n, &t));
+            }
+            /* m_R = m^X / t mod n */
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_invmod(&t, &ft->n, &t));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_exptmod(m, &x, &ft->n, &m_r));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_mulmod(&m_r, &t, &ft->n, &m_r));
+            }
+            /* m_L = m / m_R mod n */
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_invmod(&m_r, &ft->n, &t));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_mulmod(m, &t, &ft->n, &m_l));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = fiat_down(ft, nd->left, &m_l);
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = fiat_down(ft, nd->right, &m_r);
+            }
+            mp_clear_multi(&x, &a, &b, &t, &m_l, &m_r, NULL);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief y = v^d mod p of the root, for a prime p and a private exponent d.
+ *        mp_exptmod(), or with the constant-time engine selected,
+ *        pkcs1_mont_exptmod_priv() over the Montgomery parameters of p as
+ *        the key contexts take them.
+ */
+static int fiat_exptmod_priv(const mp_int *v, const mp_int *d, const mp_int *p, mp_int *y)
+{
+    int          ret;
+    size_t       plen;
+    size_t       dlen;
+    uint8_t      buf[PKCS1_MAX_N_LEN];
+    PKCS1_MONT_t mt;
+    PKCS1_EXP_t  ex;
+
+    if (!pkcs1_const_time()) {
+        ret = pkcs1_mp_status(mp_exptmod((mp_int *)v, (mp_int *)d, (mp_int *)p, y));
+    }
+    else {
+        memset(&mt, 0, sizeof(mt));
+        memset(&ex, 0, sizeof(ex));
+        plen = (size_t)mp_unsigned_bin_size((mp_int *)p);
+        dlen = (size_t)mp_unsigned_bin_size((mp_int *)d);
+        if ((sizeof(buf) < plen) || (sizeof(buf) < dlen)) {
+            ret = PKCS1_E_PARAM;
+        }
+        else {
+            ret = pkcs1_mp_status(mp_to_unsigned_bin((mp_int *)p, buf));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mont_init(&mt, buf, plen);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_to_unsigned_bin((mp_int *)d, buf));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_exp_recode(&ex, buf, dlen);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_mod(&mt, v, y));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_exptmod_priv(&mt, &ex, y, y));
+        }
+        pkcs1_exp_clear(&ex);
+        pkcs1_mont_clear(&mt);
+        memset(buf, 0, sizeof(buf));
+    }
+
+    return ret;
+}
+
+/**
+ * @brief m = v ^ (1/E) mod n of the root with CRT.
+ */
+static int fiat_root(PKCS1_FIAT_t *ft, mp_int *m)
+{
+    int               ret;
+    PKCS1_FIAT_NODE_t *nd;
+    mp_int            d, x, m_1, m_2;
+
+    nd  = &ft->node[0];
+    ret = pkcs1_mp_status(mp_init_multi(&d, &x, &m_1, &m_2, NULL));
+    if (PKCS1_E_OK == ret) {
+        /* m_1 = v^(E^-1 mod (p-1)) mod p */
+        ret = pkcs1_mp_status(mp_sub_d(&ft->p, 1, &x));
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_invmod(&nd->e, &x, &d));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = fiat_exptmod_priv(&nd->v, &d, &ft->p, &m_1);
+        }
+        /* m_2 = v^(E^-1 mod (q-1)) mod q */
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_sub_d(&ft->q, 1, &x));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_invmod(&nd->e, &x, &d));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = fiat_exptmod_priv(&nd->v, &d, &ft->q, &m_2);
+        }
+        /* m = m_2 + q * (qInv (m_1 - m_2) mod p) */
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_sub(&m_1, &m_2, &x));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_mulmod(&ft->qinv, &x, &ft->p, &x));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_mul(&ft->q, &x, &x));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_add(&x, &m_2, m));
+        }
+        mp_clear_multi(&d, &x, &m_1, &m_2, NULL);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief RSA Decryption Primitive of a batch of ciphertexts (batch RSA).
+ *        items[i].emsg is decrypted with key[items[i].key] of the family,
+ *        and the keys of a batch have to be distinct. The cost is one CRT
+ *        exponentiation plus small exponentiations and two inversions per
+ *        tree node, instead of cnt CRT exponentiations.
+ *
+ * @param fkey[in]          Key family (pkcs1_fiat_keygen()).
+ * @param items[in,out]     Ciphertexts and message buffers (mlen >= n_len).
+ * @param cnt[in]           Number of items (1 .. fkey->cnt).
+ * @return                  Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RANGE    Some ciphertext is not between 0 and n - 1.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error, or some ciphertext is not coprime to n.
+ */
+int rsadp_fiat(const RSA_TOOLS_FIAT_KEY_t *fkey, PKCS1_FIAT_ITEM_t *items, size_t cnt)
+{
+    int                        ret;
+    size_t                     i;
+    size_t                     root;
+    uint32_t                   used;
+    const RSA_TOOLS_PRIV_KEY_t *key;
+    PKCS1_FIAT_t               *ft;
+    mp_int                     m;
+
+    ft  = NULL;
+    key = NULL;
+    if ((NULL == fkey) || (NULL == items) || (0 == cnt) || (fkey->cnt < cnt)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        ret  = PKCS1_E_OK;
+        used = 0;
+        key  = &fkey->key[0];
+        for (i = 0; (PKCS1_E_OK == ret) && (i < cnt); i++) {
+            if ((fkey->cnt <= items[i].key) || (0 != (used & (1u << items[i].key))) ||
+                (NULL == items[i].emsg) || (NULL == items[i].msg) ||
+                (key->n_len != items[i].emlen) || (key->n_len > items[i].mlen)) {
+                ret = PKCS1_E_PARAM;
+            }
+            else if (0 <= memcmp(items[i].emsg, key->n, key->n_len)) {
+                ret = PKCS1_E_RANGE;
+            }
+            else {
+                used |= (1u << items[i].key);
+            }
+        }
+    }
+
+    if (PKCS1_E_OK == ret) {
+        ft  = calloc(1, sizeof(PKCS1_FIAT_t));
+        ret = (NULL != ft) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    }
+    if (PKCS1_E_OK == ret) {
+        ft->items = items;
+        ret = pkcs1_mp_status(mp_init_multi(&ft->n, &ft->p, &ft->q, &ft->qinv, &m, NULL));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&ft->n, key->n, (int)key->n_len));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&ft->p, key->p, (int)key->p_len));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&ft->q, key->q, (int)key->q_len));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&ft->qinv, key->qinv, (int)key->qinv_len));
+    }
+
+    if (PKCS1_E_OK == ret) {
+        ret = fiat_up(ft, fkey, 0, cnt, &root);
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = fiat_root(ft, &m);
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = fiat_down(ft, root, &m);
+    }
+
+    if (NULL != ft) {
+        for (i = 0; i < ft->node_cnt; i++) {
+            mp_clear_multi(&ft->node[i].v, &ft->node[i].e, NULL);
+        }
+        mp_clear_multi(&ft->n, &ft->p, &ft->q, &ft->qinv, &m, NULL);
+        free(ft);
+    }
+
+    return ret;
+}
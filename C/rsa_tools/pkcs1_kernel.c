@@ -0,0 +1,430 @@
+/**
+ * @file pkcs1_kernel.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Montgomery multiplication kernels and their runtime selection.
+ *        The first kernel of the table that the CPU supports is used for the
+ *        moduli in its range, all others stay on the libtommath path.
+ *        A modulus and the operands are converted into the limbs of the
+ *        kernel once per exponentiation.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+
+/* Kernels in the order of preference. */
+static const PKCS1_KERNEL_t *const kernel_tbl[] = {
+#ifdef PKCS1_KERNEL_X86
+    &pkcs1_kernel_bmi2,
+    &pkcs1_kernel_avx2,
+#endif  /* PKCS1_KERNEL_X86 */
+    NULL
+};
+
+static pthread_once_t       kernel_once = PTHREAD_ONCE_INIT;
+static const PKCS1_KERNEL_t *kernel_cur;
+
+/**
+ * @brief Select the first supported kernel.
+ */
+static void kernel_auto(void)
+{
+    size_t i;
+
+    kernel_cur = NULL;
+    for (i = 0; (NULL == kernel_cur) && (NULL != kernel_tbl[i]); i++) {
+        if (kernel_tbl[i]->supported()) {
+            kernel_cur = kernel_tbl[i];
+        }
+    }
+}
+
+/**
+ * @brief Get the kernel used for new moduli.
+ *
+ * @return  Kernel, NULL for the libtommath path.
+ */
+const PKCS1_KERNEL_t *pkcs1_kernel_get(void)
+{
+    pthread_once(&kernel_once, kernel_auto);
+
+    return kernel_cur;
+}
+
+#ifdef PKCS1_KERNEL_X86
+/**
+ * @brief Read XCR0, the register states enabled by the OS.
+ *        Only valid if CPUID reports OSXSAVE.
+ */
+uint64_t pkcs1_cpu_xcr0(void)
+{
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+
+    return ((uint64_t)hi << 32) | lo;
+}
+#endif  /* PKCS1_KERNEL_X86 */
+
+/**
+ * @brief Get the name of the Montgomery multiplication kernel in use.
+ *
+ * @return  Kernel name, "portable" for the libtommath path.
+ */
+const char *pkcs1_kernel_name(void)
+{
+    const PKCS1_KERNEL_t *k;
+
+    k = pkcs1_kernel_get();
+
+    return (NULL != k) ? k->name : "portable";
+}
+
+/**
+ * @brief Select the Montgomery multiplication kernel.
+ *        Key contexts keep the kernel they were built with, so the selection
+ *        applies to contexts built afterwards and to the primitives taking a
+ *        key. Call it before other threads use this module.
+ *
+ * @param name[in]  Kernel name, "portable" for the libtommath path or NULL
+ *                  for the best kernel the CPU supports.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Unknown kernel, or not supported by this CPU.
+ */
+int pkcs1_kernel_select(const char *name)
+{
+    int    ret;
+    size_t i;
+
+    pthread_once(&kernel_once, kernel_auto);
+    if (NULL == name) {
+        kernel_auto();
+        ret = PKCS1_E_OK;
+    }
+    else if (0 == strcmp(name, "portable")) {
+        kernel_cur = NULL;
+        ret = PKCS1_E_OK;
+    }
+    else {
+        ret = PKCS1_E_PARAM;
+        for (i = 0; (PKCS1_E_PARAM == ret) && (NULL != kernel_tbl[i]); i++) {
+            if ((0 == strcmp(name, kernel_tbl[i]->name)) && kernel_tbl[i]->supported()) {
+                kernel_cur = kernel_tbl[i];
+                ret = PKCS1_E_OK;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Convert a number into limbs of lb bits, least significant first.
+ *
+ * @param a[in]         Number below 2^(lb * limbs).
+ * @param lb[in]        Bits of a limb (56 or less, or 64).
+ * @param limbs[in]     Number of limbs.
+ * @param x[out]        Limb j is written to x[j * stride].
+ * @param stride[in]    Distance of two limbs in x.
+ * @return              libtommath status.
+ */
+int pkcs1_limbs_read(const mp_int *a, unsigned lb, size_t limbs, uint64_t *x, size_t stride)
+{
+    int      status;
+    uint8_t  buf[PKCS1_KERNEL_MAX_LIMBS * 8];
+    size_t   blen;
+    size_t   len;
+    size_t   i;
+    size_t   k;
+    unsigned bits;
+    uint64_t acc;
+    uint64_t mask;
+
+    blen   = (limbs * lb + 7) / 8;
+    len    = (size_t)mp_unsigned_bin_size(a);
+    status = ((len <= blen) && (sizeof(buf) >= blen)) ? MP_OKAY : MP_VAL;
+    if (MP_OKAY == status) {
+        memset(buf, 0, blen - len);
+        status = mp_to_unsigned_bin(a, &buf[blen - len]);
+    }
+    if (MP_OKAY == status) {
+        mask = PKCS1_LIMB_MASK(lb);
+        acc  = 0;
+        bits = 0;
+        k    = 0;
+        for (i = blen; i > 0; i--) {
+            acc  |= (uint64_t)buf[i - 1] << bits;
+            bits += 8;
+            if (bits >= lb) {
+                x[(k++) * stride] = acc & mask;
+                bits -= lb;
+                acc   = (uint64_t)buf[i - 1] >> (8 - bits);
+            }
+        }
+        for (; k < limbs; k++) {
+            x[k * stride] = acc;
+            acc = 0;
+        }
+        memset(buf, 0, blen);
+    }
+
+    return status;
+}
+
+/**
+ * @brief Convert limbs of lb bits, least significant first, into a number.
+ *
+ * @param x[in]         Limb j is read from x[j * stride], below 2^lb.
+ * @param lb[in]        Bits of a limb (56 or less, or 64).
+ * @param limbs[in]     Number of limbs.
+ * @param stride[in]    Distance of two limbs in x.
+ * @param a[out]        Number.
+ * @return              libtommath status.
+ */
+int pkcs1_limbs_write(const uint64_t *x, unsigned lb, size_t limbs, size_t stride, mp_int *a)
+{
+    int      status;
+    uint8_t  buf[PKCS1_KERNEL_MAX_LIMBS * 8];
+    size_t   blen;
+    size_t   i;
+    size_t   k;
+    unsigned bits;
+    uint64_t acc;
+
+    blen = (limbs * lb + 7) / 8;
+    if (sizeof(buf) < blen) {
+        status = MP_VAL;
+    }
+    else {
+        acc  = 0;
+        bits = 0;
+        k    = 0;
+        for (i = blen; i > 0; i--) {
+            while ((bits < 8) && (k < limbs)) {
+                acc  |= x[(k++) * stride] << bits;
+                bits += lb;
+            }
+            buf[i - 1] = (uint8_t)acc;
+            acc  >>= 8;
+            bits   = (bits > 8) ? (bits - 8) : 0;
+        }
+        status = mp_read_unsigned_bin(a, buf, (int)blen);
+        memset(buf, 0, blen);
+    }
+
+    return status;
+}
+
+/**
+ * @brief -1/m0 mod 2^lb for an odd m0, by Newton iteration.
+ */
+uint64_t pkcs1_limb_m0inv(uint64_t m0, unsigned lb)
+{
+    uint64_t inv;
+    int      i;
+
+    /* m0 * inv = 1 mod 2^3, every step doubles the correct bits. */
+    inv = m0;
+    for (i = 0; i < 5; i++) {
+        inv *= 2 - (m0 * inv);
+    }
+
+    return (0 - inv) & PKCS1_LIMB_MASK(lb);
+}
+
+/**
+ * @brief Build the kernel parameters of a modulus, if a kernel is in use and
+ *        the modulus is in its range. Otherwise mt->km is left NULL.
+ *
+ * @param mt[in,out]    Montgomery parameters (m is set).
+ * @return              libtommath status.
+ */
+int pkcs1_kmont_init(PKCS1_MONT_t *mt)
+{
+    int                  status;
+    size_t               bits;
+    size_t               limbs;
+    const PKCS1_KERNEL_t *k;
+    PKCS1_KMONT_t        *km;
+    mp_int               t;
+
+    status = MP_OKAY;
+    mt->km = NULL;
+    k      = pkcs1_kernel_get();
+    bits   = (size_t)mp_count_bits(&mt->m);
+    if ((NULL != k) && (k->min_bits <= bits) && (k->max_bits >= bits)) {
+        limbs = (bits + k->limb_bits - 1) / k->limb_bits;
+        limbs = ((limbs + k->lanes - 1) / k->lanes) * k->lanes;
+        km = calloc(1, sizeof(PKCS1_KMONT_t) + (2 * limbs * sizeof(uint64_t)));
+        if ((NULL == km) || (PKCS1_KERNEL_MAX_LIMBS < limbs)) {
+            free(km);
+            status = MP_MEM;
+        }
+        else {
+            km->kernel = k;
+            km->limbs  = limbs;
+            km->m      = (uint64_t *)(km + 1);
+            km->rr     = km->m + limbs;
+            status    = pkcs1_limbs_read(&mt->m, k->limb_bits, limbs, km->m, 1);
+            km->m0inv = pkcs1_limb_m0inv(km->m[0], k->limb_bits);
+
+            if (MP_OKAY == status) {
+                status = mp_init(&t);
+                if (MP_OKAY == status) {
+                    status = mp_2expt(&t, (int)(2 * limbs * k->limb_bits));
+                    if (MP_OKAY == status) {
+                        status = mp_mod(&t, &mt->m, &t);
+                    }
+                    if (MP_OKAY == status) {
+                        status = pkcs1_limbs_read(&t, k->limb_bits, limbs, km->rr, 1);
+                    }
+                    mp_clear(&t);
+                }
+            }
+            if (MP_OKAY == status) {
+                mt->km = km;
+            }
+            else {
+                free(km);
+            }
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Release the kernel parameters of a modulus.
+ */
+void pkcs1_kmont_clear(PKCS1_MONT_t *mt)
+{
+    if (NULL != mt->km) {
+        memset(mt->km->m, 0, 2 * mt->km->limbs * sizeof(uint64_t));
+        free(mt->km);
+        mt->km = NULL;
+    }
+}
+
+/**
+ * @brief Normalize the limbs of a Montgomery product below 2m and subtract m
+ *        if it is not below m, without branching on the value.
+ *
+ * @param km[in]    Kernel parameters.
+ * @param c[out]    Result, km->limbs limbs.
+ * @param t[in]     km->limbs limbs holding less than 2m, each limb may
+ *                  exceed limb_bits bits by the carries still to propagate.
+ */
+void pkcs1_kmont_final(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *t)
+{
+    uint64_t r[PKCS1_KERNEL_MAX_LIMBS];
+    uint64_t mask;
+    uint64_t carry;
+    uint64_t borrow;
+    uint64_t keep;
+    uint64_t v;
+    unsigned lb;
+    size_t   j;
+
+    lb    = km->kernel->limb_bits;
+    mask  = PKCS1_LIMB_MASK(lb);
+    carry = 0;
+    for (j = 0; j < km->limbs; j++) {
+        v     = t[j] + carry;
+        r[j]  = v & mask;
+        carry = v >> lb;
+    }
+    borrow = 0;
+    for (j = 0; j < km->limbs; j++) {
+        v      = r[j] - km->m[j] - borrow;
+        c[j]   = v & mask;
+        borrow = v >> 63;
+    }
+    /* r < m iff the subtraction borrows out of the carry limb. */
+    keep = 0 - (borrow & (carry ^ 1));
+    for (j = 0; j < km->limbs; j++) {
+        c[j] = (r[j] & keep) | (c[j] & ~keep);
+    }
+}
+
+/**
+ * @brief Sliding window exponentiation with a kernel. y = b^e mod m
+ *        The table is on the stack, sized for the widest window and the
+ *        longest operand (160KB), so that no exponentiation allocates.
+ *
+ * @param km[in]    Kernel parameters of m.
+ * @param ex[in]    Recoded exponent e (ex->cnt > 0, ex->wsize up to
+ *                  PKCS1_EXP_WSIZE_MAX).
+ * @param b[in]     Base, an integer between 0 and m - 1.
+ * @param y[out]    Result.
+ * @return          libtommath status.
+ */
+int pkcs1_kmont_exptmod(const PKCS1_KMONT_t *km, const PKCS1_EXP_t *ex, const mp_int *b, mp_int *y)
+{
+    int                  status;
+    size_t               tcnt;
+    size_t               i;
+    size_t               k;
+    size_t               s;
+    size_t               n;
+    uint64_t             tbl[((size_t)1 << (PKCS1_EXP_WSIZE_MAX - 1)) * PKCS1_KERNEL_MAX_LIMBS];
+    uint64_t             acc[PKCS1_KERNEL_MAX_LIMBS];
+    uint64_t             tmp[PKCS1_KERNEL_MAX_LIMBS];
+    const PKCS1_KERNEL_t *kn;
+
+    kn   = km->kernel;
+    n    = km->limbs;
+    tcnt = 0;
+    if ((1 > ex->wsize) || (PKCS1_EXP_WSIZE_MAX < ex->wsize)) {
+        status = MP_VAL;
+    }
+    else {
+        tcnt   = (size_t)1 << (ex->wsize - 1);
+        status = pkcs1_limbs_read(b, kn->limb_bits, n, tmp, 1);
+    }
+
+    if (MP_OKAY == status) {
+        /* tbl[i] = b^(2i+1) in Montgomery form. */
+        kn->mul(km, &tbl[0], tmp, km->rr);
+        if (1 < tcnt) {
+            kn->sqr(km, tmp, &tbl[0]);
+        }
+        for (i = 1; i < tcnt; i++) {
+            kn->mul(km, &tbl[i * n], &tbl[(i - 1) * n], tmp);
+        }
+
+        memcpy(acc, &tbl[ex->win[0].idx * n], n * sizeof(uint64_t));
+        for (k = 1; k < ex->cnt; k++) {
+            for (s = 0; s < ex->win[k].sqr; s++) {
+                kn->sqr(km, acc, acc);
+            }
+            kn->mul(km, acc, acc, &tbl[ex->win[k].idx * n]);
+        }
+        for (s = 0; s < ex->tail; s++) {
+            kn->sqr(km, acc, acc);
+        }
+
+        /* Leave Montgomery form. */
+        memset(tmp, 0, n * sizeof(uint64_t));
+        tmp[0] = 1;
+        kn->mul(km, acc, acc, tmp);
+        status = pkcs1_limbs_write(acc, kn->limb_bits, n, 1, y);
+
+        memset(acc, 0, n * sizeof(uint64_t));
+        memset(tbl, 0, tcnt * n * sizeof(uint64_t));
+    }
+
+    return status;
+}
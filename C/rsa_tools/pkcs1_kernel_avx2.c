@@ -0,0 +1,190 @@
+/**
+ * @file pkcs1_kernel_avx2.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Montgomery multiplication kernel with AVX2.
+ *        Numbers are held in 29 bit limbs, one limb in each 64 bit lane, so
+ *        that the 32x32 bit products of vpmuludq can be summed in the lanes
+ *        without carrying. Row i of the operand scanning adds a_i * b and
+ *        q_i * m to the accumulator at limb i; the carries are propagated
+ *        only every AVX2_NORM_ROWS rows. The squaring leaves out the
+ *        products a_i * a_j below the diagonal of row i.
+ *        The functions are compiled for AVX2 by a target attribute and are
+ *        only called after the CPUID check of avx2_supported().
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+
+#ifdef PKCS1_KERNEL_X86
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define AVX2_LIMB_BITS  (29)
+#define AVX2_LIMB_MASK  ((1ULL << AVX2_LIMB_BITS) - 1)
+#define AVX2_LANES      (4)
+
+/*
+ * A row adds less than 2^59 to a lane, so 16 rows and the carry of the
+ * previous normalization stay below 2^64.
+ */
+#define AVX2_NORM_ROWS  (16)
+
+/**
+ * @brief CPUID check of AVX2 and of the YMM state enabled by the OS.
+ */
+static bool avx2_supported(void)
+{
+    unsigned int a, b, c, d;
+    bool         ret;
+
+    ret = false;
+    if (__get_cpuid(1, &a, &b, &c, &d) && (0 != (c & bit_OSXSAVE)) && (0 != (c & bit_AVX)) &&
+        (0x6 == (pkcs1_cpu_xcr0() & 0x6)) &&
+        __get_cpuid_count(7, 0, &a, &b, &c, &d) && (0 != (b & bit_AVX2))) {
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Propagate the carries of t[0] .. t[cnt - 1] into t[cnt].
+ */
+static inline void avx2_carry(uint64_t *t, size_t cnt)
+{
+    size_t   j;
+    uint64_t carry;
+
+    carry = 0;
+    for (j = 0; j < cnt; j++) {
+        t[j] += carry;
+        carry = t[j] >> AVX2_LIMB_BITS;
+        t[j] &= AVX2_LIMB_MASK;
+    }
+    t[cnt] += carry;
+}
+
+/**
+ * @brief Montgomery multiplication. c = a * b / R mod m
+ */
+__attribute__((target("avx2")))
+static void avx2_mont_mul(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    uint64_t       t[(2 * PKCS1_KERNEL_MAX_LIMBS) + AVX2_LANES];
+    const uint64_t *m;
+    uint64_t       *p;
+    uint64_t       q;
+    size_t         n;
+    size_t         i;
+    size_t         j;
+    __m256i        va, vq, vt;
+
+    n = km->limbs;
+    m = km->m;
+    memset(t, 0, ((2 * n) + 1) * sizeof(uint64_t));
+    for (i = 0; i < n; i++) {
+        p  = &t[i];
+        q  = ((p[0] + (a[i] * b[0])) * km->m0inv) & AVX2_LIMB_MASK;
+        va = _mm256_set1_epi64x((long long)a[i]);
+        vq = _mm256_set1_epi64x((long long)q);
+        for (j = 0; j < n; j += AVX2_LANES) {
+            vt = _mm256_loadu_si256((const __m256i *)&p[j]);
+            vt = _mm256_add_epi64(vt, _mm256_mul_epu32(va, _mm256_loadu_si256((const __m256i *)&b[j])));
+            vt = _mm256_add_epi64(vt, _mm256_mul_epu32(vq, _mm256_loadu_si256((const __m256i *)&m[j])));
+            _mm256_storeu_si256((__m256i *)&p[j], vt);
+        }
+        /* The low limb is now a multiple of 2^29. */
+        p[1] += p[0] >> AVX2_LIMB_BITS;
+        if ((AVX2_NORM_ROWS - 1) == (i % AVX2_NORM_ROWS)) {
+            avx2_carry(&p[1], n - 1);
+        }
+    }
+    pkcs1_kmont_final(km, c, &t[n]);
+}
+
+/**
+ * @brief Montgomery squaring. c = a * a / R mod m
+ *        Row i adds a_i^2 at limb 2i and 2a_i * a_j (j > i) at limb i + j,
+ *        all past limb i, so q_i only takes a_0^2 into account in row 0.
+ *        The products 2a_i * a_j run in the same pass as q_i * m from the
+ *        block of j = i + 1 on, the lanes of j <= i in it masked off, which
+ *        saves a quarter of the vpmuludq. 2a_i * a_j is below 2^59, so a
+ *        row adds less than 3 * 2^58 to a lane and AVX2_NORM_ROWS holds.
+ */
+__attribute__((target("avx2")))
+static void avx2_mont_sqr(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *a)
+{
+    static const int64_t mask[AVX2_LANES][AVX2_LANES] = {
+        {  0, -1, -1, -1 },
+        {  0,  0, -1, -1 },
+        {  0,  0,  0, -1 },
+        {  0,  0,  0,  0 },
+    };
+    uint64_t       t[(2 * PKCS1_KERNEL_MAX_LIMBS) + AVX2_LANES];
+    const uint64_t *m;
+    uint64_t       *p;
+    uint64_t       q;
+    size_t         n;
+    size_t         i;
+    size_t         j;
+    size_t         j0;
+    __m256i        va, vq, vt, vx;
+
+    n = km->limbs;
+    m = km->m;
+    memset(t, 0, ((2 * n) + 1) * sizeof(uint64_t));
+    for (i = 0; i < n; i++) {
+        p     = &t[i];
+        p[i] += a[i] * a[i];
+        q     = (p[0] * km->m0inv) & AVX2_LIMB_MASK;
+        va    = _mm256_set1_epi64x((long long)(a[i] << 1));
+        vq    = _mm256_set1_epi64x((long long)q);
+        j0    = i - (i % AVX2_LANES);
+        for (j = 0; j < j0; j += AVX2_LANES) {
+            vt = _mm256_loadu_si256((const __m256i *)&p[j]);
+            vt = _mm256_add_epi64(vt, _mm256_mul_epu32(vq, _mm256_loadu_si256((const __m256i *)&m[j])));
+            _mm256_storeu_si256((__m256i *)&p[j], vt);
+        }
+        vx = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&a[j0]),
+                              _mm256_loadu_si256((const __m256i *)mask[i % AVX2_LANES]));
+        for (j = j0; j < n; j += AVX2_LANES) {
+            vt = _mm256_loadu_si256((const __m256i *)&p[j]);
+            vt = _mm256_add_epi64(vt, _mm256_mul_epu32(va, vx));
+            vt = _mm256_add_epi64(vt, _mm256_mul_epu32(vq, _mm256_loadu_si256((const __m256i *)&m[j])));
+            _mm256_storeu_si256((__m256i *)&p[j], vt);
+            if ((j + AVX2_LANES) < n) {
+                vx = _mm256_loadu_si256((const __m256i *)&a[j + AVX2_LANES]);
+            }
+        }
+        /* The low limb is now a multiple of 2^29. */
+        p[1] += p[0] >> AVX2_LIMB_BITS;
+        if ((AVX2_NORM_ROWS - 1) == (i % AVX2_NORM_ROWS)) {
+            avx2_carry(&p[1], n - 1);
+        }
+    }
+    pkcs1_kmont_final(km, c, &t[n]);
+}
+
+const PKCS1_KERNEL_t pkcs1_kernel_avx2 = {
+    "avx2",
+    AVX2_LIMB_BITS,
+    AVX2_LANES,
+    1024,
+    PKCS1_KERNEL_MAX_N_LEN * 8,
+    avx2_supported,
+    avx2_mont_mul,
+    avx2_mont_sqr,
+};
+
+#endif  /* PKCS1_KERNEL_X86 */
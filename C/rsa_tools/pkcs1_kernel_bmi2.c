@@ -0,0 +1,307 @@
+/**
+ * @file pkcs1_kernel_bmi2.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Montgomery multiplication kernel with BMI2 and ADX.
+ *        Numbers are held in 64 bit limbs. The building block is a row,
+ *        p[0 .. n-1] += a * b[0 .. n-1], in which mulx leaves the flags
+ *        alone, adcx carries the low halves of the products along CF and
+ *        adox carries the high halves along OF, so the two carry chains run
+ *        interleaved without any flag saving.
+ *        The rows are fully unrolled for 8, 16, 24 and 32 limbs, the CRT
+ *        halves and the moduli of 1024 to 4096 bit keys up to 2048 bits;
+ *        other lengths run a loop of the same step.
+ *        Multiplication and squaring produce the full product, which is
+ *        then reduced by a Montgomery reduction made of the same rows; the
+ *        squaring of the unrolled lengths is a multiplication.
+ *        The kernel is only used after the CPUID check of bmi2_supported().
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+
+#ifdef PKCS1_KERNEL_X86
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define BMI2_LIMB_BITS  (64)
+#define BMI2_MAX_LIMBS  ((PKCS1_KERNEL_MAX_N_LEN * 8) / BMI2_LIMB_BITS)
+
+#ifndef bit_BMI2
+#define bit_BMI2        (1U << 8)
+#endif
+#ifndef bit_ADX
+#define bit_ADX         (1U << 19)
+#endif
+
+/*
+ * One step of a row: p[j] += lo(a * b[j]) on CF and hi(a * b[j - 1]) on OF.
+ * The high half of the previous step is in r10 (A) or r11 (B), the steps
+ * alternate, so that no move is needed between them.
+ */
+#define BMI2_STEP_A(j)                          \
+    "mulx   8*" #j "(%[b]), %%rax, %%r11\n\t"   \
+    "mov    8*" #j "(%[p]), %[t]\n\t"           \
+    "adcx   %%rax, %[t]\n\t"                    \
+    "adox   %%r10, %[t]\n\t"                    \
+    "mov    %[t], 8*" #j "(%[p])\n\t"
+#define BMI2_STEP_B(j)                          \
+    "mulx   8*" #j "(%[b]), %%rax, %%r10\n\t"   \
+    "mov    8*" #j "(%[p]), %[t]\n\t"           \
+    "adcx   %%rax, %[t]\n\t"                    \
+    "adox   %%r11, %[t]\n\t"                    \
+    "mov    %[t], 8*" #j "(%[p])\n\t"
+#define BMI2_STEP8(j0, j1, j2, j3, j4, j5, j6, j7)  \
+    BMI2_STEP_A(j0) BMI2_STEP_B(j1) BMI2_STEP_A(j2) BMI2_STEP_B(j3) \
+    BMI2_STEP_A(j4) BMI2_STEP_B(j5) BMI2_STEP_A(j6) BMI2_STEP_B(j7)
+
+#define BMI2_ROW8   BMI2_STEP8(0, 1, 2, 3, 4, 5, 6, 7)
+#define BMI2_ROW16  BMI2_ROW8 BMI2_STEP8(8, 9, 10, 11, 12, 13, 14, 15)
+#define BMI2_ROW24  BMI2_ROW16 BMI2_STEP8(16, 17, 18, 19, 20, 21, 22, 23)
+#define BMI2_ROW32  BMI2_ROW24 BMI2_STEP8(24, 25, 26, 27, 28, 29, 30, 31)
+
+/*
+ * p[0 .. n-1] += a * b[0 .. n-1] for a fixed n, returning the carry limb.
+ * The last high half and both pending carries fit in the carry limb.
+ */
+#define BMI2_ADDMUL(name, row)                                              \
+static inline uint64_t name(uint64_t *p, uint64_t a, const uint64_t *b)    \
+{                                                                           \
+    uint64_t t;                                                             \
+    uint64_t hi;                                                            \
+                                                                            \
+    __asm__ volatile (                                                      \
+        "xor    %%r10d, %%r10d\n\t"                                         \
+        row                                                                 \
+        "mov    $0, %%eax\n\t"                                              \
+        "adcx   %%rax, %%r10\n\t"                                           \
+        "adox   %%rax, %%r10\n\t"                                           \
+        "mov    %%r10, %[hi]\n\t"                                           \
+        : [t] "=&r"(t), [hi] "=&r"(hi)                                      \
+        : [p] "r"(p), [b] "r"(b), "d"(a)                                    \
+        : "rax", "r10", "r11", "cc", "memory");                             \
+                                                                            \
+    return hi;                                                              \
+}
+
+BMI2_ADDMUL(bmi2_addmul8, BMI2_ROW8)
+BMI2_ADDMUL(bmi2_addmul16, BMI2_ROW16)
+BMI2_ADDMUL(bmi2_addmul24, BMI2_ROW24)
+BMI2_ADDMUL(bmi2_addmul32, BMI2_ROW32)
+
+/**
+ * @brief p[0 .. n-1] += a * b[0 .. n-1] for any n (1 or more), returning the
+ *        carry limb. The loop counter is kept by lea and jrcxz, which leave
+ *        both carry chains intact.
+ */
+static inline uint64_t bmi2_addmul_loop(uint64_t *p, uint64_t a, const uint64_t *b, size_t n)
+{
+    uint64_t t;
+    uint64_t hi;
+
+    __asm__ volatile (
+        "xor    %%r10d, %%r10d\n\t"
+        "1:\n\t"
+        "mulx   (%[b]), %%rax, %%r11\n\t"
+        "mov    (%[p]), %[t]\n\t"
+        "adcx   %%rax, %[t]\n\t"
+        "adox   %%r10, %[t]\n\t"
+        "mov    %[t], (%[p])\n\t"
+        "mov    %%r11, %%r10\n\t"
+        "lea    8(%[b]), %[b]\n\t"
+        "lea    8(%[p]), %[p]\n\t"
+        "lea    -1(%%rcx), %%rcx\n\t"
+        "jrcxz  2f\n\t"
+        "jmp    1b\n"
+        "2:\n\t"
+        "mov    $0, %%eax\n\t"
+        "adcx   %%rax, %%r10\n\t"
+        "adox   %%rax, %%r10\n\t"
+        "mov    %%r10, %[hi]\n\t"
+        : [t] "=&r"(t), [hi] "=&r"(hi), [p] "+r"(p), [b] "+r"(b), "+c"(n)
+        : "d"(a)
+        : "rax", "r10", "r11", "cc", "memory");
+
+    return hi;
+}
+
+/**
+ * @brief p[0 .. n-1] += a * b[0 .. n-1], the unrolled row if there is one.
+ */
+static inline uint64_t bmi2_addmul(uint64_t *p, uint64_t a, const uint64_t *b, size_t n)
+{
+    uint64_t hi;
+
+    switch (n) {
+    case 8:
+        hi = bmi2_addmul8(p, a, b);
+        break;
+    case 16:
+        hi = bmi2_addmul16(p, a, b);
+        break;
+    case 24:
+        hi = bmi2_addmul24(p, a, b);
+        break;
+    case 32:
+        hi = bmi2_addmul32(p, a, b);
+        break;
+    default:
+        hi = bmi2_addmul_loop(p, a, b, n);
+        break;
+    }
+
+    return hi;
+}
+
+/**
+ * @brief CPUID check of BMI2 (mulx) and ADX (adcx, adox).
+ */
+static bool bmi2_supported(void)
+{
+    unsigned int a, b, c, d;
+    bool         ret;
+
+    ret = false;
+    if (__get_cpuid_count(7, 0, &a, &b, &c, &d) && (0 != (b & bit_BMI2)) && (0 != (b & bit_ADX))) {
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Montgomery reduction. c = t / R mod m
+ *
+ * @param km[in]    Kernel parameters.
+ * @param c[out]    Result, km->limbs limbs.
+ * @param t[in]     2 * km->limbs limbs below m * R, destroyed.
+ */
+static void bmi2_redc(const PKCS1_KMONT_t *km, uint64_t *c, uint64_t *t)
+{
+    uint64_t           *r;
+    uint64_t           d[BMI2_MAX_LIMBS];
+    uint64_t           hi;
+    uint64_t           keep;
+    unsigned long long v;
+    unsigned char      carry;
+    unsigned char      cy;
+    unsigned char      borrow;
+    size_t             n;
+    size_t             i;
+
+    n     = km->limbs;
+    carry = 0;
+    for (i = 0; i < n; i++) {
+        /* t[i] becomes 0, the carry limb and the carry go into t[i + n]. */
+        hi    = bmi2_addmul(&t[i], t[i] * km->m0inv, km->m, n);
+        cy    = _addcarry_u64(carry, t[i + n], hi, &v);
+        t[i + n] = v;
+        carry = cy;
+    }
+
+    /* carry:r is below 2m, subtract m if it is not below m. */
+    r      = &t[n];
+    borrow = 0;
+    for (i = 0; i < n; i++) {
+        borrow = _subborrow_u64(borrow, r[i], km->m[i], &v);
+        d[i]   = v;
+    }
+    keep = 0 - (uint64_t)(borrow & (carry ^ 1));
+    for (i = 0; i < n; i++) {
+        c[i] = (r[i] & keep) | (d[i] & ~keep);
+    }
+    memset(d, 0, n * sizeof(uint64_t));
+}
+
+/**
+ * @brief Montgomery multiplication. c = a * b / R mod m
+ */
+static void bmi2_mont_mul(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    uint64_t t[2 * BMI2_MAX_LIMBS];
+    size_t   n;
+    size_t   i;
+
+    n = km->limbs;
+    memset(t, 0, n * sizeof(uint64_t));
+    for (i = 0; i < n; i++) {
+        t[i + n] = bmi2_addmul(&t[i], a[i], b, n);
+    }
+    bmi2_redc(km, c, t);
+    memset(t, 0, 2 * n * sizeof(uint64_t));
+}
+
+/**
+ * @brief Montgomery squaring by a square. c = a * a / R mod m
+ *        The products a_i * a_j (i < j) are summed once and doubled, then
+ *        the squares a_i^2 are added, which saves almost half the products.
+ */
+static void bmi2_mont_ssqr(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *a)
+{
+    uint64_t           t[2 * BMI2_MAX_LIMBS];
+    unsigned __int128  sq;
+    unsigned long long v;
+    unsigned char      cy;
+    size_t             n;
+    size_t             i;
+
+    n = km->limbs;
+    memset(t, 0, 2 * n * sizeof(uint64_t));
+    for (i = 0; (i + 1) < n; i++) {
+        t[i + n] = bmi2_addmul_loop(&t[(2 * i) + 1], a[i], &a[i + 1], n - 1 - i);
+    }
+    /* Double, the sum is below 2^(128n - 1). */
+    for (i = (2 * n) - 1; i > 0; i--) {
+        t[i] = (t[i] << 1) | (t[i - 1] >> 63);
+    }
+    t[0] <<= 1;
+    cy = 0;
+    for (i = 0; i < n; i++) {
+        sq = (unsigned __int128)a[i] * a[i];
+        cy = _addcarry_u64(cy, t[2 * i], (uint64_t)sq, &v);
+        t[2 * i] = v;
+        cy = _addcarry_u64(cy, t[(2 * i) + 1], (uint64_t)(sq >> 64), &v);
+        t[(2 * i) + 1] = v;
+    }
+    bmi2_redc(km, c, t);
+    memset(t, 0, 2 * n * sizeof(uint64_t));
+}
+
+/**
+ * @brief Montgomery squaring. c = a * a / R mod m
+ *        The shortened rows of the square run the loop, which loses against
+ *        the unrolled rows of a * a, so the lengths with an unrolled row
+ *        multiply.
+ */
+static void bmi2_mont_sqr(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *a)
+{
+    if ((0 == (km->limbs % 8)) && (32 >= km->limbs)) {
+        bmi2_mont_mul(km, c, a, a);
+    }
+    else {
+        bmi2_mont_ssqr(km, c, a);
+    }
+}
+
+const PKCS1_KERNEL_t pkcs1_kernel_bmi2 = {
+    "bmi2",
+    BMI2_LIMB_BITS,
+    1,
+    512,
+    PKCS1_KERNEL_MAX_N_LEN * 8,
+    bmi2_supported,
+    bmi2_mont_mul,
+    bmi2_mont_sqr,
+};
+
+#endif  /* PKCS1_KERNEL_X86 */
@@ -0,0 +1,426 @@
+/**
+ * @file pkcs1_lanes.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Independent modular exponentiations run side by side.
+ *        PKCS1_LANES exponentiations, each with its own modulus, base and
+ *        exponent, run one fixed window schedule together, so that a lane
+ *        kernel can do the Montgomery multiplications of all of them with
+ *        the same instructions. Numbers are held in 52 bit limbs.
+ *        A lane kernel is selected automatically only if the CPU has one.
+ *        The scalar emulation of the IFMA kernel gives the same results on
+ *        any CPU and is used when it is selected explicitly.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+
+#define LANE_MASK   ((1ULL << PKCS1_LANE_LIMB_BITS) - 1)
+#define LANE_HALF   (PKCS1_LANE_LIMB_BITS / 2)
+
+static bool emu_supported(void);
+static void emu_mul(const PKCS1_LMONT_t *lm, uint64_t *c, const uint64_t *a, const uint64_t *b);
+
+static const PKCS1_LANE_KERNEL_t lane_emu = {
+    "ifma-emu",
+    1024,
+    PKCS1_KERNEL_MAX_N_LEN * 8,
+    emu_supported,
+    emu_mul,
+};
+
+/* Kernels in the order of preference. */
+static const PKCS1_LANE_KERNEL_t *const lane_tbl[] = {
+#ifdef PKCS1_KERNEL_X86
+    &pkcs1_lane_ifma,
+#endif  /* PKCS1_KERNEL_X86 */
+    &lane_emu,
+    NULL
+};
+
+static pthread_once_t            lane_once = PTHREAD_ONCE_INIT;
+static const PKCS1_LANE_KERNEL_t *lane_cur;
+
+/**
+ * @brief Select the first supported kernel, the emulation excluded.
+ */
+static void lane_auto(void)
+{
+    size_t i;
+
+    lane_cur = NULL;
+    for (i = 0; (NULL == lane_cur) && (&lane_emu != lane_tbl[i]); i++) {
+        if (lane_tbl[i]->supported()) {
+            lane_cur = lane_tbl[i];
+        }
+    }
+}
+
+/**
+ * @brief Get the lane kernel in use, NULL if there is none.
+ */
+static const PKCS1_LANE_KERNEL_t *lane_get(void)
+{
+    pthread_once(&lane_once, lane_auto);
+
+    return lane_cur;
+}
+
+/**
+ * @brief Get the name of the lane kernel used by the batch operations.
+ *
+ * @return  Kernel name, "none" if the batches run one exponentiation after
+ *          another.
+ */
+const char *pkcs1_lane_kernel_name(void)
+{
+    const PKCS1_LANE_KERNEL_t *k;
+
+    k = lane_get();
+
+    return (NULL != k) ? k->name : "none";
+}
+
+/**
+ * @brief Select the lane kernel used by the batch operations.
+ *        Call it before other threads use this module.
+ *
+ * @param name[in]  Kernel name, "none" to turn the lanes off or NULL for the
+ *                  kernel of the CPU, if any.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Unknown kernel, or not supported by this CPU.
+ */
+int pkcs1_lane_kernel_select(const char *name)
+{
+    int    ret;
+    size_t i;
+
+    pthread_once(&lane_once, lane_auto);
+    if (NULL == name) {
+        lane_auto();
+        ret = PKCS1_E_OK;
+    }
+    else if (0 == strcmp(name, "none")) {
+        lane_cur = NULL;
+        ret = PKCS1_E_OK;
+    }
+    else {
+        ret = PKCS1_E_PARAM;
+        for (i = 0; (PKCS1_E_PARAM == ret) && (NULL != lane_tbl[i]); i++) {
+            if ((0 == strcmp(name, lane_tbl[i]->name)) && lane_tbl[i]->supported()) {
+                lane_cur = lane_tbl[i];
+                ret = PKCS1_E_OK;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief The emulation runs everywhere.
+ */
+static bool emu_supported(void)
+{
+    return true;
+}
+
+/**
+ * @brief Low and high 52 bits of the product of two 52 bit limbs, as
+ *        vpmadd52luq and vpmadd52huq compute them.
+ */
+static inline void emu_mul52(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi)
+{
+    uint64_t a0, a1, b0, b1;
+    uint64_t p00, p01, p11;
+    uint64_t low;
+
+    a0  = a & ((1ULL << LANE_HALF) - 1);
+    a1  = (a & LANE_MASK) >> LANE_HALF;
+    b0  = b & ((1ULL << LANE_HALF) - 1);
+    b1  = (b & LANE_MASK) >> LANE_HALF;
+    p00 = a0 * b0;
+    p01 = (a0 * b1) + (a1 * b0);
+    p11 = a1 * b1;
+    low = p00 + ((p01 & ((1ULL << LANE_HALF) - 1)) << LANE_HALF);
+    *lo = low & LANE_MASK;
+    *hi = p11 + (p01 >> LANE_HALF) + (low >> PKCS1_LANE_LIMB_BITS);
+}
+
+/**
+ * @brief Montgomery multiplication of the IFMA kernel, one lane after another.
+ *        The order of the additions is that of the IFMA kernel.
+ */
+static void emu_mul(const PKCS1_LMONT_t *lm, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    uint64_t t[(2 * PKCS1_LANE_MAX_LIMBS) + 1];
+    uint64_t r[PKCS1_LANE_MAX_LIMBS];
+    uint64_t lo, hi;
+    uint64_t ai, q;
+    uint64_t v, carry, borrow, keep;
+    size_t   n;
+    size_t   l;
+    size_t   i;
+    size_t   j;
+
+    n = lm->limbs;
+    for (l = 0; l < PKCS1_LANES; l++) {
+        memset(t, 0, ((2 * n) + 1) * sizeof(uint64_t));
+        for (i = 0; i < n; i++) {
+            ai = a[(i * PKCS1_LANES) + l];
+            for (j = 0; j < n; j++) {
+                emu_mul52(ai, b[(j * PKCS1_LANES) + l], &lo, &hi);
+                t[i + j]     += lo;
+                t[i + j + 1] += hi;
+            }
+            emu_mul52(t[i], lm->m0inv[l], &q, &hi);
+            for (j = 0; j < n; j++) {
+                emu_mul52(q, lm->m[(j * PKCS1_LANES) + l], &lo, &hi);
+                t[i + j]     += lo;
+                t[i + j + 1] += hi;
+            }
+            t[i + 1] += t[i] >> PKCS1_LANE_LIMB_BITS;
+        }
+
+        /* Normalize t[n .. 2n-1] (below 2m) and subtract m if not below m. */
+        carry = 0;
+        for (j = 0; j < n; j++) {
+            v     = t[n + j] + carry;
+            r[j]  = v & LANE_MASK;
+            carry = v >> PKCS1_LANE_LIMB_BITS;
+        }
+        borrow = 0;
+        for (j = 0; j < n; j++) {
+            v      = r[j] - lm->m[(j * PKCS1_LANES) + l] - borrow;
+            t[j]   = v & LANE_MASK;
+            borrow = v >> 63;
+        }
+        keep = 0 - (borrow & (carry ^ 1));
+        for (j = 0; j < n; j++) {
+            c[(j * PKCS1_LANES) + l] = (r[j] & keep) | (t[j] & ~keep);
+        }
+    }
+}
+
+/**
+ * @brief Limbs of a modulus for the lane kernels, 0 if no kernel takes it.
+ */
+static size_t lane_limbs(const PKCS1_LANE_KERNEL_t *k, const PKCS1_MONT_t *mt)
+{
+    size_t bits;
+    size_t limbs;
+
+    limbs = 0;
+    bits  = (size_t)mp_count_bits(&mt->m);
+    if ((NULL != k) && (k->min_bits <= bits) && (k->max_bits >= bits) && mp_isodd(&mt->m)) {
+        limbs = (bits + PKCS1_LANE_LIMB_BITS - 1) / PKCS1_LANE_LIMB_BITS;
+        if (PKCS1_LANE_MAX_LIMBS < limbs) {
+            limbs = 0;
+        }
+    }
+
+    return limbs;
+}
+
+/**
+ * @brief Check whether the exponentiations modulo m can run on the lanes.
+ *
+ * @param mt[in]    Montgomery parameters of m.
+ * @return          true if a lane kernel is in use and takes m.
+ */
+bool pkcs1_lanes_ok(const PKCS1_MONT_t *mt)
+{
+    return (0 != lane_limbs(lane_get(), mt));
+}
+
+/**
+ * @brief Window width of the fixed window schedule.
+ */
+static unsigned lane_wsize(size_t bits)
+{
+    unsigned w;
+
+    if (32 >= bits) {
+        w = 1;
+    }
+    else if (128 >= bits) {
+        w = 3;
+    }
+    else if (512 >= bits) {
+        w = 4;
+    }
+    else {
+        w = 5;
+    }
+
+    return w;
+}
+
+/**
+ * @brief Digit of w bits of an exponent starting at bit pos.
+ */
+static size_t lane_digit(const PKCS1_EXP_t *ex, size_t pos, unsigned w)
+{
+    size_t   d;
+    size_t   i;
+    unsigned k;
+
+    d = 0;
+    for (k = w; k > 0; k--) {
+        i = pos + k - 1;
+        d <<= 1;
+        if (i < ex->bits) {
+            d |= (ex->e[ex->elen - 1 - (i / 8)] >> (i % 8)) & 1;
+        }
+    }
+
+    return d;
+}
+
+/**
+ * @brief Modular exponentiations on the lanes. y_l = b_l^e_l mod m_l
+ *        All moduli must have the same number of limbs (e.g. one modulus
+ *        for all lanes). The lanes after cnt are left idle.
+ *
+ * @param op[in,out]    Exponentiations.
+ * @param cnt[in]       Number of exponentiations, 1 .. PKCS1_LANES.
+ * @return              libtommath status, MP_VAL if the lanes do not take
+ *                      the moduli (see pkcs1_lanes_ok()).
+ */
+int pkcs1_lanes_exptmod(const PKCS1_LANE_OP_t *op, size_t cnt)
+{
+    int                       status;
+    const PKCS1_LANE_KERNEL_t *k;
+    PKCS1_LMONT_t             lm;
+    size_t                    n;
+    size_t                    vlen;
+    size_t                    bits;
+    size_t                    pos;
+    size_t                    d[PKCS1_LANES];
+    size_t                    l;
+    size_t                    j;
+    size_t                    s;
+    size_t                    tcnt;
+    unsigned                  w;
+    bool                      any;
+    uint64_t                  *buf;
+    uint64_t                  *rr, *one, *tmp, *acc, *tbl;
+    mp_int                    t;
+
+    k      = lane_get();
+    n      = ((0 < cnt) && (PKCS1_LANES >= cnt)) ? lane_limbs(k, op[0].mt) : 0;
+    status = (0 != n) ? MP_OKAY : MP_VAL;
+    bits   = 0;
+    for (l = 0; (MP_OKAY == status) && (l < cnt); l++) {
+        if (n != lane_limbs(k, op[l].mt)) {
+            status = MP_VAL;
+        }
+        else if (bits < op[l].ex->bits) {
+            bits = op[l].ex->bits;
+        }
+    }
+
+    buf = NULL;
+    if (MP_OKAY == status) {
+        w    = lane_wsize(bits);
+        tcnt = (size_t)1 << w;
+        vlen = n * PKCS1_LANES;
+        buf  = calloc((5 + tcnt) * vlen, sizeof(uint64_t));
+        status = (NULL != buf) ? mp_init(&t) : MP_MEM;
+    }
+    if (MP_OKAY == status) {
+        lm.limbs = n;
+        lm.m     = buf;
+        rr       = lm.m + vlen;
+        one      = rr + vlen;
+        tmp      = one + vlen;
+        acc      = tmp + vlen;
+        tbl      = acc + vlen;
+
+        /* Moduli, R^2 mod m and the bases. Idle lanes repeat lane 0 with b = 0. */
+        for (l = 0; (MP_OKAY == status) && (l < PKCS1_LANES); l++) {
+            if ((0 < l) && (op[(l < cnt) ? l : 0].mt == op[(l - 1 < cnt) ? (l - 1) : 0].mt)) {
+                for (j = 0; j < n; j++) {
+                    lm.m[(j * PKCS1_LANES) + l] = lm.m[(j * PKCS1_LANES) + l - 1];
+                    rr[(j * PKCS1_LANES) + l]   = rr[(j * PKCS1_LANES) + l - 1];
+                }
+                lm.m0inv[l] = lm.m0inv[l - 1];
+            }
+            else {
+                status = pkcs1_limbs_read(&op[(l < cnt) ? l : 0].mt->m, PKCS1_LANE_LIMB_BITS, n, &lm.m[l], PKCS1_LANES);
+                if (MP_OKAY == status) {
+                    lm.m0inv[l] = pkcs1_limb_m0inv(lm.m[l], PKCS1_LANE_LIMB_BITS);
+                    status = mp_2expt(&t, (int)(2 * n * PKCS1_LANE_LIMB_BITS));
+                }
+                if (MP_OKAY == status) {
+                    status = mp_mod(&t, &op[(l < cnt) ? l : 0].mt->m, &t);
+                }
+                if (MP_OKAY == status) {
+                    status = pkcs1_limbs_read(&t, PKCS1_LANE_LIMB_BITS, n, &rr[l], PKCS1_LANES);
+                }
+            }
+            if ((MP_OKAY == status) && (l < cnt)) {
+                status = pkcs1_limbs_read(op[l].b, PKCS1_LANE_LIMB_BITS, n, &tmp[l], PKCS1_LANES);
+            }
+            one[l] = 1;
+        }
+        mp_clear(&t);
+    }
+
+    if (MP_OKAY == status) {
+        /* tbl[i] = b^i in Montgomery form, tbl[0] = R mod m. */
+        k->mul(&lm, &tbl[0], rr, one);
+        k->mul(&lm, &tbl[vlen], tmp, rr);
+        for (j = 2; j < tcnt; j++) {
+            k->mul(&lm, &tbl[j * vlen], &tbl[(j - 1) * vlen], &tbl[vlen]);
+        }
+
+        /* Most significant window first, the same squarings for all lanes. */
+        pos = ((bits + w - 1) / w) * w;
+        memcpy(acc, &tbl[0], vlen * sizeof(uint64_t));
+        while (0 < pos) {
+            pos -= w;
+            any  = false;
+            for (l = 0; l < PKCS1_LANES; l++) {
+                d[l] = (l < cnt) ? lane_digit(op[l].ex, pos, w) : 0;
+                any  = any || (0 != d[l]);
+            }
+            for (s = 0; (s < w) && (pos + w < ((bits + w - 1) / w) * w); s++) {
+                k->mul(&lm, acc, acc, acc);
+            }
+            if (any) {
+                for (j = 0; j < n; j++) {
+                    for (l = 0; l < PKCS1_LANES; l++) {
+                        tmp[(j * PKCS1_LANES) + l] = tbl[(d[l] * vlen) + (j * PKCS1_LANES) + l];
+                    }
+                }
+                k->mul(&lm, acc, acc, tmp);
+            }
+        }
+
+        /* Leave Montgomery form. */
+        k->mul(&lm, acc, acc, one);
+        for (l = 0; (MP_OKAY == status) && (l < cnt); l++) {
+            status = pkcs1_limbs_write(&acc[l], PKCS1_LANE_LIMB_BITS, n, PKCS1_LANES, op[l].y);
+        }
+    }
+
+    if (NULL != buf) {
+        memset(buf, 0, (5 + tcnt) * vlen * sizeof(uint64_t));
+        free(buf);
+    }
+
+    return status;
+}
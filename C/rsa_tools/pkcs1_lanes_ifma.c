@@ -0,0 +1,129 @@
+/**
+ * @file pkcs1_lanes_ifma.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Lane kernel with AVX-512 IFMA.
+ *        Each 64 bit lane of a ZMM register holds a 52 bit limb of its own
+ *        exponentiation, so one vpmadd52luq / vpmadd52huq does a limb
+ *        product of all PKCS1_LANES exponentiations. The low and high halves
+ *        of the products are summed in separate accumulator limbs and carried
+ *        only once per row.
+ *        The functions are compiled for AVX-512 by a target attribute and are
+ *        only called after the CPUID check of ifma_supported().
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+
+#ifdef PKCS1_KERNEL_X86
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define IFMA_LIMB_MASK  ((1ULL << PKCS1_LANE_LIMB_BITS) - 1)
+
+#ifndef bit_AVX512F
+#define bit_AVX512F     (1U << 16)
+#endif
+#ifndef bit_AVX512IFMA
+#define bit_AVX512IFMA  (1U << 21)
+#endif
+
+/**
+ * @brief CPUID check of AVX-512 IFMA and of the ZMM state enabled by the OS.
+ */
+static bool ifma_supported(void)
+{
+    unsigned int a, b, c, d;
+    bool         ret;
+
+    ret = false;
+    if (__get_cpuid(1, &a, &b, &c, &d) && (0 != (c & bit_OSXSAVE)) &&
+        (0xE6 == (pkcs1_cpu_xcr0() & 0xE6)) &&
+        __get_cpuid_count(7, 0, &a, &b, &c, &d) &&
+        (0 != (b & bit_AVX512F)) && (0 != (b & bit_AVX512IFMA))) {
+        ret = true;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Montgomery multiplication of all lanes. c = a * b / R mod m
+ */
+__attribute__((target("avx512f,avx512ifma")))
+static void ifma_mul(const PKCS1_LMONT_t *lm, uint64_t *c, const uint64_t *a, const uint64_t *b)
+{
+    __m512i        t[(2 * PKCS1_LANE_MAX_LIMBS) + 1];
+    const uint64_t *m;
+    size_t         n;
+    size_t         i;
+    size_t         j;
+    __m512i        zero, mask, one, k0;
+    __m512i        ai, q, v, carry, borrow;
+    __mmask8       keep;
+
+    n    = lm->limbs;
+    m    = lm->m;
+    zero = _mm512_setzero_si512();
+    mask = _mm512_set1_epi64((long long)IFMA_LIMB_MASK);
+    one  = _mm512_set1_epi64(1);
+    k0   = _mm512_loadu_si512(lm->m0inv);
+    for (j = 0; j < (2 * n) + 1; j++) {
+        t[j] = zero;
+    }
+
+    for (i = 0; i < n; i++) {
+        ai = _mm512_loadu_si512(&a[i * PKCS1_LANES]);
+        for (j = 0; j < n; j++) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], ai, _mm512_loadu_si512(&b[j * PKCS1_LANES]));
+        }
+        q = _mm512_madd52lo_epu64(zero, t[i], k0);
+        for (j = 0; j < n; j++) {
+            t[i + j] = _mm512_madd52lo_epu64(t[i + j], q, _mm512_loadu_si512(&m[j * PKCS1_LANES]));
+        }
+        /* The low 52 bits of t[i] are now 0. */
+        t[i + 1] = _mm512_add_epi64(t[i + 1], _mm512_srli_epi64(t[i], PKCS1_LANE_LIMB_BITS));
+        for (j = 0; j < n; j++) {
+            t[i + 1 + j] = _mm512_madd52hi_epu64(t[i + 1 + j], ai, _mm512_loadu_si512(&b[j * PKCS1_LANES]));
+            t[i + 1 + j] = _mm512_madd52hi_epu64(t[i + 1 + j], q, _mm512_loadu_si512(&m[j * PKCS1_LANES]));
+        }
+    }
+
+    /* Normalize t[n .. 2n-1] (below 2m) and subtract m if not below m. */
+    carry = zero;
+    for (j = 0; j < n; j++) {
+        v         = _mm512_add_epi64(t[n + j], carry);
+        t[n + j]  = _mm512_and_si512(v, mask);
+        carry     = _mm512_srli_epi64(v, PKCS1_LANE_LIMB_BITS);
+    }
+    borrow = zero;
+    for (j = 0; j < n; j++) {
+        v      = _mm512_sub_epi64(_mm512_sub_epi64(t[n + j], _mm512_loadu_si512(&m[j * PKCS1_LANES])), borrow);
+        t[j]   = _mm512_and_si512(v, mask);
+        borrow = _mm512_srli_epi64(v, 63);
+    }
+    keep = _mm512_cmpeq_epi64_mask(_mm512_andnot_si512(carry, borrow), one);
+    for (j = 0; j < n; j++) {
+        _mm512_storeu_si512(&c[j * PKCS1_LANES], _mm512_mask_blend_epi64(keep, t[j], t[n + j]));
+    }
+}
+
+const PKCS1_LANE_KERNEL_t pkcs1_lane_ifma = {
+    "ifma",
+    1024,
+    PKCS1_KERNEL_MAX_N_LEN * 8,
+    ifma_supported,
+    ifma_mul,
+};
+
+#endif  /* PKCS1_KERNEL_X86 */
@@ -0,0 +1,282 @@
+/**
+ * @file pkcs1_local.h
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Internal definitions shared by the PKCS1 implementation files.
+ *        This header is NOT a part of the public interface.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#ifndef __PKCS1_LOCAL_H__
+#define __PKCS1_LOCAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <tommath.h>
+
+#include "pkcs1.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define PKCS1_KERNEL_X86    (1)
+#endif  /* __x86_64__ */
+
+/* Largest modulus of the kernels, larger ones take the portable paths. */
+#define PKCS1_KERNEL_MAX_N_LEN  (512)   /* RSA 4096 bit */
+/* Max number of limbs of a kernel operand (4096 bit in 29 bit limbs, padded). */
+#define PKCS1_KERNEL_MAX_LIMBS  (160)
+
+/* Mask of the bits of a limb of lb bits (1 .. 64). */
+#define PKCS1_LIMB_MASK(lb)     ((64 <= (lb)) ? UINT64_MAX : ((1ULL << (lb)) - 1))
+
+typedef struct pkcs1_kernel PKCS1_KERNEL_t;
+
+/**
+ * @brief Montgomery parameters of one modulus in the limbs of a kernel.
+ *        A number is held in limbs uint64_t words of limb_bits bits each,
+ *        least significant first. R = 2^(limb_bits * limbs).
+ */
+typedef struct {
+    const PKCS1_KERNEL_t *kernel;
+    size_t               limbs;     /* A multiple of kernel->lanes. */
+    uint64_t             m0inv;     /* -1/m mod 2^limb_bits */
+    uint64_t             *m;
+    uint64_t             *rr;       /* R^2 mod m */
+} PKCS1_KMONT_t;
+
+/**
+ * @brief Montgomery multiplication kernel.
+ *        mul() and sqr() take operands below m and return c = a * b / R mod m,
+ *        fully reduced. The output may alias the inputs.
+ */
+struct pkcs1_kernel {
+    const char *name;
+    unsigned   limb_bits;
+    size_t     lanes;
+    size_t     min_bits;    /* Range of modulus lengths it is used for. */
+    size_t     max_bits;
+    bool       (*supported)(void);
+    void       (*mul)(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *a, const uint64_t *b);
+    void       (*sqr)(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *a);
+};
+
+/* Number of exponentiations run side by side by a lane kernel. */
+#define PKCS1_LANES             (8)
+#define PKCS1_LANE_LIMB_BITS    (52)
+/* Max number of limbs of a lane operand (4096 bit in 52 bit limbs). */
+#define PKCS1_LANE_MAX_LIMBS    (80)
+
+/**
+ * @brief Montgomery parameters of the moduli of PKCS1_LANES lanes, all of
+ *        the same number of limbs. Numbers are held in structure of arrays
+ *        order, limb j of lane l at [j * PKCS1_LANES + l].
+ *        R = 2^(PKCS1_LANE_LIMB_BITS * limbs).
+ */
+typedef struct {
+    size_t   limbs;
+    uint64_t m0inv[PKCS1_LANES];    /* -1/m mod 2^52 of each lane. */
+    uint64_t *m;
+} PKCS1_LMONT_t;
+
+/**
+ * @brief Lane kernel. mul() takes operands below m in every lane and
+ *        returns c = a * b / R mod m, fully reduced. c may alias a or b.
+ */
+typedef struct {
+    const char *name;
+    size_t     min_bits;    /* Range of modulus lengths it is used for. */
+    size_t     max_bits;
+    bool       (*supported)(void);
+    void       (*mul)(const PKCS1_LMONT_t *lm, uint64_t *c, const uint64_t *a, const uint64_t *b);
+} PKCS1_LANE_KERNEL_t;
+
+/* Limbs of the largest modulus, and of a fixed-width number (a product of two numbers below it). */
+#define PKCS1_FBN_MOD_LIMBS     ((PKCS1_MAX_N_LEN + 7) / 8)
+#define PKCS1_FBN_LIMBS         (2 * PKCS1_FBN_MOD_LIMBS)
+
+/**
+ * @brief Fixed-width number in 64 bit limbs, least significant first.
+ *        Only d[0 .. used-1] are valid.
+ */
+typedef struct {
+    size_t   used;  /* Number of limbs without the leading zero ones, 0 for zero. */
+    uint64_t d[PKCS1_FBN_LIMBS];
+} PKCS1_FBN_t;
+
+/* Entries of the table of one exponentiation, windows up to 6 bits of odd digits or 5 bits of all digits. */
+#define PKCS1_FBN_TBL_ENTRIES   (32)
+/* Widest sliding window of pkcs1_fbn_exptmod_ws(). */
+#define PKCS1_FBN_WSIZE_MAX     (6)
+
+/**
+ * @brief Workspace of one exponentiation of pkcs1_fbn_exptmod_ws() or
+ *        pkcs1_fbn_exptmod_ct_ws(): the table of the windows and the
+ *        accumulators, all in 64 bit limbs.
+ */
+typedef struct {
+    uint64_t    tbl[PKCS1_FBN_TBL_ENTRIES * PKCS1_FBN_MOD_LIMBS];
+    uint64_t    acc[PKCS1_FBN_MOD_LIMBS];
+    uint64_t    x[PKCS1_FBN_MOD_LIMBS];
+} PKCS1_FBN_EXP_WS_t;
+
+/**
+ * @brief Scratch of the primitives taking a key, see pkcs1_scratch_alloc().
+ *        Every working number of one operation lives here, and the secret
+ *        ones are wiped before the operation returns.
+ */
+struct pkcs1_scratch {
+    PKCS1_FBN_t        n;
+    PKCS1_FBN_t        p;       /* r_1, or r_i of the additional primes. */
+    PKCS1_FBN_t        q;       /* r_2 */
+    PKCS1_FBN_t        qinv;    /* qInv, or t_i of the additional primes. */
+    PKCS1_FBN_t        c;
+    PKCS1_FBN_t        m;
+    PKCS1_FBN_t        m_1;     /* m_1, or m_i of the additional primes. */
+    PKCS1_FBN_t        m_2;
+    PKCS1_FBN_t        h;
+    PKCS1_FBN_t        R;       /* r_1 * ... * r_(i-1) of the additional primes. */
+    PKCS1_FBN_t        v;       /* s^e of the fault check. */
+    PKCS1_FBN_EXP_WS_t exp;
+};
+
+/**
+ * @brief Montgomery arithmetic parameters of one modulus.
+ */
+typedef struct {
+    mp_int        m;    /* Modulus (odd). */
+    mp_int        rr;   /* R^2 mod m. */
+    mp_digit      rho;  /* -1/m mod b. */
+    size_t        len;  /* Length of modulus in bytes. */
+    PKCS1_KMONT_t *km;  /* Parameters of the kernel, NULL for the libtommath path. */
+    PKCS1_FBN_t   *fm;  /* m of the constant-time engine, NULL if m is too long. */
+} PKCS1_MONT_t;
+
+/**
+ * @brief One window of a recoded exponent.
+ *        Square the accumulator sqr times, then multiply by table[idx].
+ */
+typedef struct {
+    uint16_t sqr;
+    uint16_t idx;
+} PKCS1_WIN_t;
+
+/* Widest sliding window of pkcs1_exp_recode(). */
+#define PKCS1_EXP_WSIZE_MAX     (8)
+
+/**
+ * @brief Exponent recoded into sliding windows of odd digits.
+ */
+typedef struct {
+    int         wsize;  /* Window width in bits. */
+    size_t      cnt;    /* Number of windows. */
+    size_t      tail;   /* Squarings after the last window. */
+    PKCS1_WIN_t *win;   /* Windows, most significant first. */
+    size_t      fermat; /* k if the exponent is 2^k + 1 (e.g. 3, 65537), otherwise 0. */
+    size_t      bits;   /* Length of the exponent in bits. */
+    uint8_t     *e;     /* The exponent itself (big-endian, elen bytes). */
+    size_t      elen;
+} PKCS1_EXP_t;
+
+/**
+ * @brief One exponentiation of a lane kernel run. y = b^e mod m
+ */
+typedef struct {
+    const PKCS1_MONT_t *mt;
+    const PKCS1_EXP_t  *ex;
+    const mp_int       *b;  /* Base, an integer between 0 and m - 1. */
+    mp_int             *y;
+} PKCS1_LANE_OP_t;
+
+/* Blinding pair (r^e, r^-1) and the blinding state of a key context, see pkcs1_blind.c. */
+typedef struct pkcs1_blind PKCS1_BLIND_t;
+typedef struct pkcs1_blind_pool PKCS1_BLIND_POOL_t;
+
+/**
+ * @brief Precomputed RSA key context.
+ *        Immutable once built, so it may be shared by any number of callers.
+ *        Only the blinding pairs change, each owned by one caller at a time
+ *        (see pkcs1_blind.c).
+ */
+struct rsa_tools_key_ctx {
+    size_t       n_len;
+    bool         has_pub;   /* (n, e) is available. */
+    bool         has_priv;  /* (n, d) is available. */
+    bool         has_crt;   /* (p, q, dP, dQ, qInv) is available. */
+    PKCS1_MONT_t n;
+    PKCS1_MONT_t p;
+    PKCS1_MONT_t q;
+    mp_int       qinv;      /* qInv * R mod p, in the Montgomery form of p. */
+    PKCS1_EXP_t  e;
+    PKCS1_EXP_t  d;
+    PKCS1_EXP_t  dp;
+    PKCS1_EXP_t  dq;
+    size_t       other_cnt; /* u - 2 of a multi-prime key. */
+    PKCS1_MONT_t *r;        /* r_3, ..., r_u */
+    PKCS1_EXP_t  *dr;       /* d_3, ..., d_u */
+    mp_int       *t;        /* t_i * R mod r_i, in the Montgomery form of r_i, i = 3, ..., u */
+    PKCS1_BLIND_POOL_t *blind;  /* Blinding of the private key operations, or NULL. */
+};
+
+bool pkcs1_n_len_chk(const uint8_t *n, size_t n_len);
+bool pkcs1_sign_check(void);
+bool pkcs1_vcache_key(const RSA_TOOLS_PUB_KEY_t *key, const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, uint8_t *digest);
+bool pkcs1_vcache_lookup(const uint8_t *digest);
+void pkcs1_vcache_insert(const uint8_t *digest);
+int pkcs1_mp_status(int status);
+bool pkcs1_arena_begin(void);
+void pkcs1_arena_end(bool scoped);
+int pkcs1_mont_init(PKCS1_MONT_t *mt, const uint8_t *m, size_t mlen);
+void pkcs1_mont_clear(PKCS1_MONT_t *mt);
+int pkcs1_exp_wsize(size_t bits);
+int pkcs1_fbn_exp_wsize(size_t bits);
+int pkcs1_exp_recode(PKCS1_EXP_t *ex, const uint8_t *e, size_t elen);
+void pkcs1_exp_clear(PKCS1_EXP_t *ex);
+int pkcs1_mont_mul(const PKCS1_MONT_t *mt, const mp_int *a, const mp_int *b, mp_int *c);
+int pkcs1_mont_sqr(const PKCS1_MONT_t *mt, const mp_int *a, mp_int *b);
+int pkcs1_mont_mod(const PKCS1_MONT_t *mt, const mp_int *x, mp_int *y);
+int pkcs1_mont_exptmod(const PKCS1_MONT_t *mt, const PKCS1_EXP_t *ex, const mp_int *b, mp_int *y);
+int pkcs1_mont_exptmod_priv(const PKCS1_MONT_t *mt, const PKCS1_EXP_t *ex, const mp_int *b, mp_int *y);
+size_t pkcs1_exp_fermat(const uint8_t *e, size_t elen);
+int pkcs1_rep_read(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *a, size_t alen, mp_int *x);
+int pkcs1_rep_write(const mp_int *x, uint8_t *a, size_t alen);
+void pkcs1_crt_prime(const RSA_TOOLS_KEY_CTX_t *ctx, size_t idx, const PKCS1_MONT_t **mt, const PKCS1_EXP_t **ex);
+int pkcs1_crt_garner(const RSA_TOOLS_KEY_CTX_t *ctx, const mp_int *mi, mp_int *m);
+const PKCS1_KERNEL_t *pkcs1_kernel_get(void);
+int pkcs1_kmont_init(PKCS1_MONT_t *mt);
+void pkcs1_kmont_clear(PKCS1_MONT_t *mt);
+int pkcs1_kmont_exptmod(const PKCS1_KMONT_t *km, const PKCS1_EXP_t *ex, const mp_int *b, mp_int *y);
+void pkcs1_kmont_final(const PKCS1_KMONT_t *km, uint64_t *c, const uint64_t *t);
+int pkcs1_limbs_read(const mp_int *a, unsigned lb, size_t limbs, uint64_t *x, size_t stride);
+int pkcs1_limbs_write(const uint64_t *x, unsigned lb, size_t limbs, size_t stride, mp_int *a);
+uint64_t pkcs1_limb_m0inv(uint64_t m0, unsigned lb);
+bool pkcs1_lanes_ok(const PKCS1_MONT_t *mt);
+int pkcs1_lanes_exptmod(const PKCS1_LANE_OP_t *op, size_t cnt);
+#ifdef PKCS1_KERNEL_X86
+uint64_t pkcs1_cpu_xcr0(void);
+extern const PKCS1_KERNEL_t pkcs1_kernel_bmi2;
+extern const PKCS1_KERNEL_t pkcs1_kernel_avx2;
+extern const PKCS1_LANE_KERNEL_t pkcs1_lane_ifma;
+#endif  /* PKCS1_KERNEL_X86 */
+void pkcs1_fbn_clear(PKCS1_FBN_t *x);
+int pkcs1_fbn_read(PKCS1_FBN_t *x, const uint8_t *a, size_t alen);
+int pkcs1_fbn_write(const PKCS1_FBN_t *x, uint8_t *a, size_t alen);
+int pkcs1_fbn_cmp(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b);
+int pkcs1_fbn_add(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, PKCS1_FBN_t *c);
+int pkcs1_fbn_sub(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, PKCS1_FBN_t *c);
+int pkcs1_fbn_mul(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, PKCS1_FBN_t *c);
+int pkcs1_fbn_mod(const PKCS1_FBN_t *a, const PKCS1_FBN_t *m, PKCS1_FBN_t *c);
+int pkcs1_fbn_mulmod(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, const PKCS1_FBN_t *m, PKCS1_FBN_t *c);
+int pkcs1_fbn_submulmod(const PKCS1_FBN_t *a, const PKCS1_FBN_t *b, const PKCS1_FBN_t *t, const PKCS1_FBN_t *r, PKCS1_FBN_t *h);
+int pkcs1_fbn_exptmod(const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y);
+int pkcs1_fbn_exptmod_ct(const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y);
+int pkcs1_fbn_exptmod_ws(PKCS1_FBN_EXP_WS_t *ws, const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y);
+int pkcs1_fbn_exptmod_w(const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y, unsigned wsize);
+int pkcs1_fbn_exptmod_ct_ws(PKCS1_FBN_EXP_WS_t *ws, const PKCS1_FBN_t *b, const uint8_t *e, size_t elen, const PKCS1_FBN_t *m, PKCS1_FBN_t *y);
+int pkcs1_fbn_mont_sqr_run(const PKCS1_FBN_t *m, PKCS1_FBN_t *a, size_t cnt, bool by_mul);
+bool pkcs1_const_time(void);
+int pkcs1_blind_pool_alloc(size_t refresh, PKCS1_BLIND_POOL_t **pool);
+void pkcs1_blind_pool_free(PKCS1_BLIND_POOL_t *pool);
+int pkcs1_blind(const RSA_TOOLS_KEY_CTX_t *ctx, mp_int *c, PKCS1_BLIND_t **b);
+int pkcs1_unblind(const RSA_TOOLS_KEY_CTX_t *ctx, mp_int *m, PKCS1_BLIND_t *b);
+
+#endif  /* __PKCS1_LOCAL_H__ */
@@ -8,28 +8,40 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <tommath.h>
 #include "pkcs1.h"
+#include "pkcs1_local.h"
 #include "utils.h"
 #include "nist_tv_rsadp.h"
 #include "nist_tv_rsasp1.h"
+#include "rsa_tv_mprime.h"
 
 /**
  * @brief Verification Test for RSADP/RSAEP.
  * 
  * @return Status of this function.
  * 
- * @retval  PKCS1_E_OK  Success.
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test vector failed.
  */
 int pkcs1_rsadp_test()
 {
     int ret;
+    int result;
     uint8_t              buf[512];
     size_t               len;
     int                  i;
     int                  tv_cnt;
     NIST_TV_RSADP_t      *tv;
 
+    result = PKCS1_E_OK;
     tv_cnt = (sizeof(nist_rsadp_tv_param) / sizeof(NIST_TV_RSADP_t));
     for (i = 0; i < tv_cnt; i++) {
         tv = &(nist_rsadp_tv_param[i]);
@@ -39,17 +51,19 @@ int pkcs1_rsadp_test()
             len = tv->pubkey.n_len;
             ret = rsaep(tv->pubkey, tv->k, tv->k_len, buf, &len);
             if (0 == ret) {
-                if (blkcmp(tv->c, tv->c_len, buf, len, true)) {
+                if (utils_blkcmp(tv->c, tv->c_len, buf, len, false)) {
                     printf("RSAEP: OK.       ");
                 }
                 else {
                     printf("RSAEP: NG.\n");
-                    hexdump(tv->c, tv->c_len, "Expected Ciphertext.");
-                    hexdump(buf, len, "Calculated Chipertext.");
+                    result = PKCS1_E_VERIFY;
+                    utils_hexdump(tv->c, tv->c_len, "Expected Ciphertext.");
+                    utils_hexdump(buf, len, "Calculated Chipertext.");
                 }
             }
             else {
                 printf("RSAEP: Error. ret=%d  ", ret);
+                result = PKCS1_E_VERIFY;
             }
         }
         else {
@@ -60,18 +74,20 @@ int pkcs1_rsadp_test()
         len = tv->privkey.n_len;
         ret = rsadp(tv->privkey, tv->c, tv->c_len, buf, &len, false);
         if (0 == ret) {
-            if (blkcmp(tv->k, tv->k_len, buf, len, true)) {
+            if (utils_blkcmp(tv->k, tv->k_len, buf, len, false)) {
                 printf("RSADP: OK.               ");
             }
             else {
                 printf("RSADP: NG.\n");
-                hexdump(tv->k, tv->k_len, "Expected Ciphertext.");
-                hexdump(buf, len, "Calculated Chipertext.");
+                result = PKCS1_E_VERIFY;
+                utils_hexdump(tv->k, tv->k_len, "Expected Ciphertext.");
+                utils_hexdump(buf, len, "Calculated Chipertext.");
             }
         }
         else {
             if (tv->e_result) {
                 printf("RSADP: Error. ret=%d  ", ret);
+                result = PKCS1_E_VERIFY;
             }
             else {
                 printf("RSADP: Expected Result.  ");
@@ -80,7 +96,7 @@ int pkcs1_rsadp_test()
         printf("Finish Test %02d.\n", i);
     }
 
-   return PKCS1_E_OK;
+   return result;
 }
 
 /**
@@ -88,17 +104,20 @@ int pkcs1_rsadp_test()
  * 
  * @return Status of this function.
  * 
- * @retval  PKCS1_E_OK  Success.
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test vector failed.
  */
 int pkcs1_rsasp1_test()
 {
     int ret;
+    int result;
     uint8_t              buf[512];
     size_t               len;
     int                  i;
     int                  tv_cnt;
     NIST_TV_RSASP1_t     *tv;
 
+    result = PKCS1_E_OK;
     tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
     for (i = 0; i < tv_cnt; i++) {
         tv = &(nist_rsasp1_tv_param[i]);
@@ -108,17 +127,19 @@ int pkcs1_rsasp1_test()
             len = tv->privkey.n_len;
             ret = rsasp1(tv->privkey, tv->EM, tv->em_len, buf, &len, false);
             if (0 == ret) {
-                if (blkcmp(tv->Sig, tv->sig_len, buf, len, true)) {
+                if (utils_blkcmp(tv->Sig, tv->sig_len, buf, len, false)) {
                     printf("RSASP1: OK.       ");
                 }
                 else {
                     printf("RSASP1: NG.\n");
-                    hexdump(tv->Sig, tv->sig_len, "Expected Signature.");
-                    hexdump(buf, len, "Calculated Signature.");
+                    result = PKCS1_E_VERIFY;
+                    utils_hexdump(tv->Sig, tv->sig_len, "Expected Signature.");
+                    utils_hexdump(buf, len, "Calculated Signature.");
                 }
             }
             else {
                 printf("RSASP1: Error. ret=%d  ", ret);
+                result = PKCS1_E_VERIFY;
             }
         }
         else {
@@ -129,18 +150,20 @@ int pkcs1_rsasp1_test()
         len = tv->privkey.n_len;
         ret = rsavp1(tv->pubkey, tv->Sig, tv->sig_len, buf, &len);
         if (0 == ret) {
-            if (blkcmp(tv->EM, tv->em_len, buf, len, true)) {
+            if (utils_blkcmp(tv->EM, tv->em_len, buf, len, false)) {
                 printf("RSAVP1: OK.               ");
             }
             else {
                 printf("RSAVP1: NG.\n");
-                hexdump(tv->EM, tv->em_len, "Expected Signature.");
-                hexdump(buf, len, "Calculated Signature.");
+                result = PKCS1_E_VERIFY;
+                utils_hexdump(tv->EM, tv->em_len, "Expected Signature.");
+                utils_hexdump(buf, len, "Calculated Signature.");
             }
        }
         else {
             if (tv->e_result) {
                 printf("RSAVP1: Error. ret=%d  ", ret);
+                result = PKCS1_E_VERIFY;
             }
             else {
                 printf("RSAVP1: Expected Result.  ");
@@ -149,7 +172,7 @@ int pkcs1_rsasp1_test()
         printf("Finish Test %02d.\n", i);
     }
 
-   return PKCS1_E_OK;
+   return result;
 }
 
 /**
@@ -157,11 +180,13 @@ int pkcs1_rsasp1_test()
  * 
  * @return Status of this function.
  * 
- * @retval  PKCS1_E_OK  Success.
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test vector failed.
  */
 int pkcs1_rsa_sign_test()
 {
     int ret;
+    int result;
     uint8_t              buf[512];
     size_t               len;
     int                  i;
@@ -169,6 +194,7 @@ int pkcs1_rsa_sign_test()
     NIST_TV_RSASP1_t     *tv;
 
     printf("Start RSA Sign Test\n");
+    result = PKCS1_E_OK;
     tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
     printf("*** No Padding ***\n");
     for (i = 0; i < tv_cnt; i++) {
@@ -179,15 +205,17 @@ int pkcs1_rsa_sign_test()
             len = tv->privkey.n_len;
             ret = pkcs1_rsa_sign(tv->privkey, tv->EM, tv->em_len, buf, &len, false);
             if (0 == ret) {
-                if (blkcmp(tv->Sig, tv->sig_len, buf, len, true)) {
+                if (utils_blkcmp(tv->Sig, tv->sig_len, buf, len, true)) {
                     printf("OK.\n");
                 }
                 else {
                     printf("NG.\n");
+                    result = PKCS1_E_VERIFY;
                 }
             }
             else {
                 printf("Error. ret=%d\n", ret);
+                result = PKCS1_E_VERIFY;
             }
         }
         else {
@@ -197,7 +225,7 @@ int pkcs1_rsa_sign_test()
  
     printf("Finish RSA Sign Test\n");
  
-   return PKCS1_E_OK;
+   return result;
 }
 
 /**
@@ -205,11 +233,13 @@ int pkcs1_rsa_sign_test()
  * 
  * @return Status of this function.
  * 
- * @retval  PKCS1_E_OK  Success.
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test vector failed.
  */
 int pkcs1_rsa_verify_test()
 {
     int ret;
+    int result;
     uint8_t              buf[512];
     size_t               len;
     int                  i;
@@ -217,6 +247,7 @@ int pkcs1_rsa_verify_test()
     NIST_TV_RSASP1_t     *tv;
 
     printf("Start RSA Verify Test\n");
+    result = PKCS1_E_OK;
     tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
     printf("*** No Padding ***\n");
     for (i = 0; i < tv_cnt; i++) {
@@ -227,15 +258,17 @@ int pkcs1_rsa_verify_test()
             len = tv->pubkey.n_len;
             ret = rsavp1(tv->pubkey, tv->Sig, tv->sig_len, buf, &len);
             if (0 == ret) {
-                if (blkcmp(tv->EM, tv->em_len, buf, len, true)) {
+                if (utils_blkcmp(tv->EM, tv->em_len, buf, len, true)) {
                     printf("OK.\n");
                 }
                 else {
                     printf("NG.\n");
+                    result = PKCS1_E_VERIFY;
                 }
             }
             else {
                 printf("Error. ret=%d\n", ret);
+                result = PKCS1_E_VERIFY;
             }
         }
         else {
@@ -245,5 +278,4111 @@ int pkcs1_rsa_verify_test()
  
     printf("Finish RSA Verify Test\n");
  
-   return PKCS1_E_OK;
-}
\ No newline at end of file
+   return result;
+}
+
+/**
+ * @brief Derive the CRT components (dP, dQ, qInv) of a test vector key which
+ *        only carries (n, e, d, p, q).
+ * 
+ * @param key[in,out]   Private Key. dp, dq and qinv are set on success.
+ * @param buf[out]      Storage for dP, dQ and qInv (3 * key->n_len bytes).
+ * @return              true on success.
+ */
+static bool tv_crt_derive(RSA_TOOLS_PRIV_KEY_t *key, uint8_t *buf)
+{
+    bool   ret;
+    int    status;
+    mp_int d, p, q, t, u;
+
+    ret = false;
+    if ((NULL != key->p) && (NULL != key->q) &&
+        (MP_OKAY == mp_init_multi(&d, &p, &q, &t, &u, NULL))) {
+        status = mp_read_unsigned_bin(&d, key->d, key->d_len);
+        if (MP_OKAY == status) {
+            status = mp_read_unsigned_bin(&p, key->p, key->p_len);
+        }
+        if (MP_OKAY == status) {
+            status = mp_read_unsigned_bin(&q, key->q, key->q_len);
+        }
+        /* dP = d mod (p - 1) */
+        if (MP_OKAY == status) {
+            status = mp_sub_d(&p, 1, &t);
+        }
+        if (MP_OKAY == status) {
+            status = mp_mod(&d, &t, &u);
+        }
+        if (MP_OKAY == status) {
+            key->dp_len = mp_unsigned_bin_size(&u);
+            status = mp_to_unsigned_bin(&u, &buf[0]);
+        }
+        /* dQ = d mod (q - 1) */
+        if (MP_OKAY == status) {
+            status = mp_sub_d(&q, 1, &t);
+        }
+        if (MP_OKAY == status) {
+            status = mp_mod(&d, &t, &u);
+        }
+        if (MP_OKAY == status) {
+            key->dq_len = mp_unsigned_bin_size(&u);
+            status = mp_to_unsigned_bin(&u, &buf[key->n_len]);
+        }
+        /* qInv = q^-1 mod p */
+        if (MP_OKAY == status) {
+            status = mp_invmod(&q, &p, &u);
+        }
+        if (MP_OKAY == status) {
+            key->qinv_len = mp_unsigned_bin_size(&u);
+            status = mp_to_unsigned_bin(&u, &buf[key->n_len * 2]);
+        }
+        if (MP_OKAY == status) {
+            key->dp   = &buf[0];
+            key->dq   = &buf[key->n_len];
+            key->qinv = &buf[key->n_len * 2];
+            ret = true;
+        }
+        mp_clear_multi(&d, &p, &q, &t, &u, NULL);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test for the precomputed key context.
+ *        Every primitive taking a key context is checked against the NIST
+ *        test vectors, with and without CRT.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test vector failed.
+ */
+int pkcs1_ctx_test()
+{
+    int                  ret;
+    int                  res;
+    uint8_t              buf[PKCS1_MAX_N_LEN];
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    size_t               len;
+    int                  i;
+    int                  tv_cnt;
+    bool                 use_crt;
+    NIST_TV_RSADP_t      *tv;
+    NIST_TV_RSASP1_t     *tv2;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_KEY_CTX_t  *pctx;
+    RSA_TOOLS_KEY_CTX_t  *sctx;
+
+    ret = PKCS1_E_OK;
+    tv_cnt = (sizeof(nist_rsadp_tv_param) / sizeof(NIST_TV_RSADP_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv = &(nist_rsadp_tv_param[i]);
+        printf("Start RSADP CTX Test %02d...  ", i);
+        if ((PKCS1_E_OK != pkcs1_ctx_pub_alloc(tv->pubkey, &pctx)) ||
+            (PKCS1_E_OK != pkcs1_ctx_priv_alloc(tv->privkey, &sctx))) {
+            printf("Error. Key context.\n");
+            ret = PKCS1_E_VERIFY;
+            continue;
+        }
+
+        if (tv->e_result) {
+            memset(buf, 0, sizeof(buf));
+            len = sizeof(buf);
+            res = rsaep_ctx(pctx, tv->k, tv->k_len, buf, &len);
+            if ((PKCS1_E_OK == res) && utils_blkcmp(tv->c, tv->c_len, buf, len, false)) {
+                printf("RSAEP: OK.       ");
+            }
+            else {
+                printf("RSAEP: NG. ret=%d  ", res);
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        else {
+            printf("RSAEP: Skipped.  ");
+        }
+
+        memset(buf, 0, sizeof(buf));
+        len = sizeof(buf);
+        res = rsadp_ctx(sctx, tv->c, tv->c_len, buf, &len, false);
+        if (tv->e_result && (PKCS1_E_OK == res) && utils_blkcmp(tv->k, tv->k_len, buf, len, false)) {
+            printf("RSADP: OK.               ");
+        }
+        else if (!tv->e_result && (PKCS1_E_RANGE == res)) {
+            printf("RSADP: Expected Result.  ");
+        }
+        else {
+            printf("RSADP: NG. ret=%d  ", res);
+            ret = PKCS1_E_VERIFY;
+        }
+        printf("Finish Test %02d.\n", i);
+
+        pkcs1_ctx_free(pctx);
+        pkcs1_ctx_free(sctx);
+    }
+
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv2 = &(nist_rsasp1_tv_param[i]);
+        if (!tv2->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        printf("Start RSASP1 CTX Test %02d...  ", i);
+        priv = tv2->privkey;
+        if (!tv_crt_derive(&priv, crt) ||
+            (PKCS1_E_OK != pkcs1_ctx_priv_alloc(priv, &sctx))) {
+            printf("Error. Key context.\n");
+            ret = PKCS1_E_VERIFY;
+            continue;
+        }
+
+        for (use_crt = false; ; use_crt = true) {
+            memset(buf, 0, sizeof(buf));
+            len = sizeof(buf);
+            res = pkcs1_rsa_sign_ctx(sctx, tv2->EM, tv2->em_len, buf, &len, use_crt);
+            if ((PKCS1_E_OK == res) && utils_blkcmp(tv2->Sig, tv2->sig_len, buf, len, true)) {
+                printf("%s: OK.  ", use_crt ? "Sign(CRT)" : "Sign");
+            }
+            else {
+                printf("%s: NG. ret=%d  ", use_crt ? "Sign(CRT)" : "Sign", res);
+                ret = PKCS1_E_VERIFY;
+            }
+            if (use_crt) {
+                break;
+            }
+        }
+
+        res = pkcs1_rsa_verify_ctx(sctx, tv2->EM, tv2->em_len, tv2->Sig, tv2->sig_len);
+        if (PKCS1_E_OK == res) {
+            printf("Verify: OK.  ");
+        }
+        else {
+            printf("Verify: NG. ret=%d  ", res);
+            ret = PKCS1_E_VERIFY;
+        }
+        printf("Finish Test %02d.\n", i);
+
+        pkcs1_ctx_free(sctx);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test for the small public exponent chain.
+ *        rsaep() and rsaep_ctx() with e = 3 and e = 65537 are compared with
+ *        mp_exptmod() on the moduli and messages of the NIST test vectors.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test vector failed.
+ */
+int pkcs1_fermat_test()
+{
+    static const struct {
+        uint8_t e[3];
+        size_t  e_len;
+        size_t  k;
+    } exps[] = {
+        { { 0x03, 0x00, 0x00 }, 1, 1 },     /* 3 */
+        { { 0x00, 0x03, 0x00 }, 2, 1 },     /* 3 with a leading zero */
+        { { 0x05, 0x00, 0x00 }, 1, 2 },     /* 5 */
+        { { 0x01, 0x00, 0x01 }, 3, 16 },    /* 65537 */
+        { { 0x01, 0x00, 0x00 }, 1, 0 },     /* 1 */
+        { { 0x07, 0x00, 0x00 }, 1, 0 },     /* 7 */
+        { { 0x01, 0x00, 0x03 }, 3, 0 },     /* 65539 */
+    };
+    int                 ret;
+    int                 res;
+    uint8_t             buf[PKCS1_MAX_N_LEN];
+    uint8_t             buf2[PKCS1_MAX_N_LEN];
+    uint8_t             ref[PKCS1_MAX_N_LEN];
+    size_t              len;
+    size_t              len2;
+    int                 i;
+    int                 j;
+    int                 tv_cnt;
+    NIST_TV_RSADP_t     *tv;
+    RSA_TOOLS_PUB_KEY_t pub;
+    RSA_TOOLS_KEY_CTX_t *ctx;
+    mp_int              n, e, m, c;
+
+    ret = PKCS1_E_OK;
+    printf("Start Fermat Exponent Test\n");
+    for (j = 0; j < (int)(sizeof(exps) / sizeof(exps[0])); j++) {
+        if (exps[j].k != pkcs1_exp_fermat(exps[j].e, exps[j].e_len)) {
+            printf("Exponent %d: NG.\n", j);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+
+    tv_cnt = (sizeof(nist_rsadp_tv_param) / sizeof(NIST_TV_RSADP_t));
+    for (i = 0; (i < tv_cnt) && (PKCS1_E_OK == ret); i++) {
+        tv = &(nist_rsadp_tv_param[i]);
+        if (!tv->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        printf("Test Vector %02d: ", i);
+        for (j = 0; j < (int)(sizeof(exps) / sizeof(exps[0])); j++) {
+            if (0 == exps[j].k) {
+                continue;
+            }
+            pub       = tv->pubkey;
+            pub.e     = (uint8_t *)exps[j].e;
+            pub.e_len = exps[j].e_len;
+
+            /* Reference */
+            memset(ref, 0, sizeof(ref));
+            if ((MP_OKAY != mp_init_multi(&n, &e, &m, &c, NULL)) ||
+                (MP_OKAY != mp_read_unsigned_bin(&n, pub.n, pub.n_len)) ||
+                (MP_OKAY != mp_read_unsigned_bin(&e, pub.e, pub.e_len)) ||
+                (MP_OKAY != mp_read_unsigned_bin(&m, tv->k, tv->k_len)) ||
+                (MP_OKAY != mp_exptmod(&m, &e, &n, &c)) ||
+                (MP_OKAY != mp_to_unsigned_bin(&c, ref))) {
+                ret = PKCS1_E_INTERNAL;
+            }
+            len = mp_unsigned_bin_size(&c);
+            mp_clear_multi(&n, &e, &m, &c, NULL);
+
+            memset(buf, 0, sizeof(buf));
+            len2 = pub.n_len;
+            res = rsaep(pub, tv->k, tv->k_len, buf, &len2);
+            if ((PKCS1_E_OK != res) || !utils_blkcmp(ref, len, buf, len2, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+
+            memset(buf2, 0, sizeof(buf2));
+            len2 = sizeof(buf2);
+            res = pkcs1_ctx_pub_alloc(pub, &ctx);
+            if (PKCS1_E_OK == res) {
+                res = rsaep_ctx(ctx, tv->k, tv->k_len, buf2, &len2);
+                pkcs1_ctx_free(ctx);
+            }
+            if ((PKCS1_E_OK != res) || !utils_blkcmp(ref, len, buf2, len2, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        printf("%s\n", (PKCS1_E_OK == ret) ? "OK." : "NG.");
+    }
+    printf("Finish Fermat Exponent Test\n");
+
+    return ret;
+}
+
+#define BATCH_TEST_KINDS    (5)
+#define BATCH_TEST_REPEAT   (8)
+
+/**
+ * @brief Verification Test for the batch verification.
+ *        Valid, corrupted, out of range and malformed items are mixed in one
+ *        batch, and the status of every item has to match pksc1_rsa_verify().
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test vector failed.
+ */
+int pkcs1_batch_test()
+{
+    int                  ret;
+    int                  res;
+    uint8_t              bad_sig[PKCS1_MAX_N_LEN];
+    uint8_t              bad_msg[PKCS1_MAX_N_LEN];
+    uint8_t              big_sig[PKCS1_MAX_N_LEN];
+    PKCS1_VERIFY_ITEM_t  items[BATCH_TEST_KINDS * BATCH_TEST_REPEAT];
+    int                  expect[BATCH_TEST_KINDS];
+    int                  status[BATCH_TEST_KINDS * BATCH_TEST_REPEAT];
+    PKCS1_VERIFY_ITEM_t  *it;
+    int                  i;
+    int                  j;
+    int                  tv_cnt;
+    int                  use_pool;
+    void                 *tpool;
+    NIST_TV_RSASP1_t     *tv;
+
+    ret = PKCS1_E_OK;
+    tpool = utils_tpool_alloc(3);
+    if (NULL == tpool) {
+        return PKCS1_E_RESOURCE;
+    }
+
+    printf("Start RSA Batch Verify Test\n");
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv = &(nist_rsasp1_tv_param[i]);
+        if (!tv->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        printf("Test Vector %02d: ", i);
+        memcpy(bad_sig, tv->Sig, tv->sig_len);
+        bad_sig[tv->sig_len - 1] ^= 0x01;
+        memcpy(bad_msg, tv->EM, tv->em_len);
+        bad_msg[tv->em_len / 2] ^= 0x80;
+        memset(big_sig, 0xff, tv->sig_len);
+
+        for (j = 0; j < BATCH_TEST_KINDS * BATCH_TEST_REPEAT; j++) {
+            it       = &items[j];
+            it->msg  = tv->EM;
+            it->mlen = tv->em_len;
+            it->sig  = tv->Sig;
+            it->slen = tv->sig_len;
+            switch (j % BATCH_TEST_KINDS) {
+                case 1 :    /* Corrupted signature */
+                    it->sig = bad_sig;
+                    break;
+                case 2 :    /* Corrupted message */
+                    it->msg = bad_msg;
+                    break;
+                case 3 :    /* Signature out of range */
+                    it->sig = big_sig;
+                    break;
+                case 4 :    /* Signature length mismatch */
+                    it->slen = tv->sig_len - 1;
+                    break;
+                default:
+                    break;
+            }
+            if (j < BATCH_TEST_KINDS) {
+                expect[j] = pksc1_rsa_verify(tv->pubkey, (uint8_t *)it->msg, it->mlen, (uint8_t *)it->sig, it->slen);
+            }
+        }
+        if ((PKCS1_E_OK != expect[0]) || (PKCS1_E_VERIFY != expect[1]) ||
+            (PKCS1_E_VERIFY != expect[2]) || (PKCS1_E_RANGE != expect[3]) ||
+            (PKCS1_E_PARAM != expect[4])) {
+            printf("Legacy NG.  ");
+            ret = PKCS1_E_VERIFY;
+        }
+
+        for (use_pool = 0; use_pool < 2; use_pool++) {
+            memset(status, 0, sizeof(status));
+            res = pkcs1_rsa_verify_batch(tv->pubkey, items, BATCH_TEST_KINDS * BATCH_TEST_REPEAT,
+                                         status, use_pool ? tpool : NULL);
+            for (j = 0; j < BATCH_TEST_KINDS * BATCH_TEST_REPEAT; j++) {
+                if (expect[j % BATCH_TEST_KINDS] != status[j]) {
+                    res = PKCS1_E_INTERNAL;
+                }
+            }
+            if (PKCS1_E_VERIFY == res) {
+                printf("%s: OK.  ", use_pool ? "Threads" : "Single");
+            }
+            else {
+                printf("%s: NG. ret=%d  ", use_pool ? "Threads" : "Single", res);
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+
+        /* All valid. */
+        res = pkcs1_rsa_verify_batch(tv->pubkey, items, 1, status, tpool);
+        if (PKCS1_E_OK != res) {
+            printf("All valid: NG. ret=%d", res);
+            ret = PKCS1_E_VERIFY;
+        }
+        printf("\n");
+    }
+    printf("Finish RSA Batch Verify Test\n");
+
+    utils_tpool_free(tpool);
+
+    return ret;
+}
+
+#define SCREEN_TEST_CNT     (40)
+
+/**
+ * @brief Check rsavp1_screen() with and without random exponents.
+ * 
+ * @return true if the result and the status of every item are as expected.
+ */
+static bool screen_test_one(RSA_TOOLS_PUB_KEY_t key, const PKCS1_VERIFY_ITEM_t *items, size_t rand_bits, int expect_ret, const int *expect)
+{
+    bool ret;
+    int  res;
+    int  status[SCREEN_TEST_CNT];
+    int  j;
+
+    memset(status, 0, sizeof(status));
+    res = rsavp1_screen(key, items, SCREEN_TEST_CNT, rand_bits, status);
+    ret = (expect_ret == res);
+    for (j = 0; j < SCREEN_TEST_CNT; j++) {
+        if (expect[j] != status[j]) {
+            ret = false;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Write x as a big endian integer of exactly len bytes.
+ */
+static bool screen_test_write(mp_int *x, uint8_t *buf, size_t len)
+{
+    size_t size;
+
+    size = (size_t)mp_unsigned_bin_size(x);
+    memset(buf, 0, len);
+
+    return (size <= len) && (MP_OKAY == mp_to_unsigned_bin(x, &buf[len - size]));
+}
+
+/**
+ * @brief Make distinct valid pairs (EM * t^e, Sig * t) mod n, t = 2, 3, ...
+ *        from one test vector, so that no two items of a batch are the same.
+ *        msg_y and msg_yinv are EM_5 * 2 and EM_30 / 2, which cancel out in
+ *        the product of all messages.
+ */
+static bool screen_test_pairs(NIST_TV_RSASP1_t *tv, uint8_t *mbuf, uint8_t *sbuf, uint8_t *msg_y, uint8_t *msg_yinv)
+{
+    bool   ret;
+    int    j;
+    size_t len;
+    mp_int n, e, m, s, t, x;
+
+    len = tv->pubkey.n_len;
+    if (MP_OKAY != mp_init_multi(&n, &e, &m, &s, &t, &x, NULL)) {
+        return false;
+    }
+    ret = (MP_OKAY == mp_read_unsigned_bin(&n, tv->pubkey.n, (int)tv->pubkey.n_len)) &&
+          (MP_OKAY == mp_read_unsigned_bin(&e, tv->pubkey.e, (int)tv->pubkey.e_len));
+    for (j = 0; ret && (j < SCREEN_TEST_CNT); j++) {
+        ret = (MP_OKAY == mp_read_unsigned_bin(&m, tv->EM, (int)tv->em_len)) &&
+              (MP_OKAY == mp_read_unsigned_bin(&s, tv->Sig, (int)tv->sig_len)) &&
+              (MP_OKAY == mp_set_int(&t, (unsigned long)(j + 2))) &&
+              (MP_OKAY == mp_exptmod(&t, &e, &n, &x)) &&
+              (MP_OKAY == mp_mulmod(&m, &x, &n, &m)) &&
+              (MP_OKAY == mp_mulmod(&s, &t, &n, &s)) &&
+              screen_test_write(&m, &mbuf[j * len], len) &&
+              screen_test_write(&s, &sbuf[j * len], len);
+        if (ret && (5 == j)) {
+            ret = (MP_OKAY == mp_set_int(&t, 2)) &&
+                  (MP_OKAY == mp_mulmod(&m, &t, &n, &x)) &&
+                  screen_test_write(&x, msg_y, len);
+        }
+        if (ret && (30 == j)) {
+            ret = (MP_OKAY == mp_set_int(&t, 2)) &&
+                  (MP_OKAY == mp_invmod(&t, &n, &t)) &&
+                  (MP_OKAY == mp_mulmod(&m, &t, &n, &x)) &&
+                  screen_test_write(&x, msg_yinv, len);
+        }
+    }
+    mp_clear_multi(&n, &e, &m, &s, &t, &x, NULL);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test for the screening of a batch.
+ *        Bad items have to be isolated by bisection, and a batch whose bad
+ *        items cancel out in the product has to be caught by random exponents.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test vector failed.
+ */
+int pkcs1_screen_test()
+{
+    int                  ret;
+    bool                 res;
+    uint8_t              *mbuf;
+    uint8_t              *sbuf;
+    uint8_t              bad_sig[PKCS1_MAX_N_LEN];
+    uint8_t              big_sig[PKCS1_MAX_N_LEN];
+    uint8_t              msg_y[PKCS1_MAX_N_LEN];
+    uint8_t              msg_yinv[PKCS1_MAX_N_LEN];
+    PKCS1_VERIFY_ITEM_t  items[SCREEN_TEST_CNT];
+    int                  expect[SCREEN_TEST_CNT];
+    int                  i;
+    int                  j;
+    int                  tv_cnt;
+    size_t               len;
+    NIST_TV_RSASP1_t     *tv;
+
+    ret  = PKCS1_E_OK;
+    mbuf = malloc(SCREEN_TEST_CNT * PKCS1_MAX_N_LEN);
+    sbuf = malloc(SCREEN_TEST_CNT * PKCS1_MAX_N_LEN);
+    if ((NULL == mbuf) || (NULL == sbuf)) {
+        free(mbuf);
+        free(sbuf);
+        return PKCS1_E_RESOURCE;
+    }
+
+    printf("Start RSA Screening Test\n");
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv = &(nist_rsasp1_tv_param[i]);
+        if (!tv->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        printf("Test Vector %02d: ", i);
+        len = tv->pubkey.n_len;
+        if (!screen_test_pairs(tv, mbuf, sbuf, msg_y, msg_yinv)) {
+            printf("Setup NG.\n");
+            ret = PKCS1_E_VERIFY;
+            continue;
+        }
+        memset(big_sig, 0xff, len);
+        for (j = 0; j < SCREEN_TEST_CNT; j++) {
+            items[j].msg  = &mbuf[j * len];
+            items[j].mlen = len;
+            items[j].sig  = &sbuf[j * len];
+            items[j].slen = len;
+            expect[j]     = PKCS1_E_OK;
+        }
+
+        /* All valid. */
+        res = screen_test_one(tv->pubkey, items, 0, PKCS1_E_OK, expect) &&
+              screen_test_one(tv->pubkey, items, 32, PKCS1_E_OK, expect) &&
+              screen_test_one(tv->pubkey, items, PKCS1_SCREEN_BITS_MAX, PKCS1_E_OK, expect);
+        printf("Valid: %s  ", res ? "OK." : "NG.");
+        if (!res) {
+            ret = PKCS1_E_VERIFY;
+        }
+
+        /* (EM_5 * 2, Sig_5), (EM_30 / 2, Sig_30) passes without random exponents only. */
+        items[5].msg  = msg_y;
+        items[30].msg = msg_yinv;
+        res = screen_test_one(tv->pubkey, items, 0, PKCS1_E_OK, expect);
+        expect[5]  = PKCS1_E_VERIFY;
+        expect[30] = PKCS1_E_VERIFY;
+        res = res && screen_test_one(tv->pubkey, items, 32, PKCS1_E_VERIFY, expect);
+        printf("Random: %s  ", res ? "OK." : "NG.");
+        if (!res) {
+            ret = PKCS1_E_VERIFY;
+        }
+        items[5].msg  = &mbuf[5 * len];
+        items[30].msg = &mbuf[30 * len];
+        expect[5]  = PKCS1_E_OK;
+        expect[30] = PKCS1_E_OK;
+
+        /* Bad items are isolated. */
+        memcpy(bad_sig, items[17].sig, len);
+        bad_sig[len - 1] ^= 0x01;
+        items[3].sig  = items[4].sig;
+        items[17].sig = bad_sig;
+        items[39].msg = items[38].msg;
+        items[9].sig  = big_sig;
+        items[22].slen--;
+        expect[3]  = PKCS1_E_VERIFY;
+        expect[17] = PKCS1_E_VERIFY;
+        expect[39] = PKCS1_E_VERIFY;
+        expect[9]  = PKCS1_E_RANGE;
+        expect[22] = PKCS1_E_PARAM;
+        res = screen_test_one(tv->pubkey, items, 0, PKCS1_E_VERIFY, expect) &&
+              screen_test_one(tv->pubkey, items, 32, PKCS1_E_VERIFY, expect);
+        printf("Bisect: %s\n", res ? "OK." : "NG.");
+        if (!res) {
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    printf("Finish RSA Screening Test\n");
+
+    free(mbuf);
+    free(sbuf);
+
+    return ret;
+}
+
+#define FIAT_TEST_N_LEN     (256)
+#define FIAT_TEST_KEYS      (8)
+#define FIAT_TEST_ROUNDS    (10)
+
+/**
+ * @brief Elapsed time between two timestamps in micro seconds.
+ */
+static uint64_t fiat_test_usec(void *t1, void *t2, void *t3)
+{
+    utils_ts_diff(t1, t2, t3);
+
+    return (utils_ts_sec(t3) * 1000000) + (utils_ts_nsec(t3) / 1000);
+}
+
+/**
+ * @brief Verification Test and benchmark for batch RSA decryption.
+ *        A key family is generated, random messages are encrypted with
+ *        rsaep() under each key, and rsadp_fiat() has to give back the same
+ *        messages as rsadp() with CRT. Then both are timed.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_fiat_test()
+{
+    int                  ret;
+    int                  res;
+    RSA_TOOLS_FIAT_KEY_t fkey;
+    RSA_TOOLS_PUB_KEY_t  pub;
+    PKCS1_FIAT_ITEM_t    items[FIAT_TEST_KEYS];
+    uint8_t              msg[FIAT_TEST_KEYS][FIAT_TEST_N_LEN];
+    uint8_t              emsg[FIAT_TEST_KEYS][FIAT_TEST_N_LEN];
+    uint8_t              dmsg[FIAT_TEST_KEYS][FIAT_TEST_N_LEN];
+    uint8_t              buf[FIAT_TEST_N_LEN];
+    size_t               len;
+    size_t               cnt;
+    size_t               i;
+    int                  j;
+    void                 *t1;
+    void                 *t2;
+    void                 *t3;
+    uint64_t             usec_crt;
+    uint64_t             usec_fiat;
+
+    ret = PKCS1_E_OK;
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    printf("Start RSA Batch Decryption Test\n");
+
+    utils_ts_gettime(t1);
+    res = pkcs1_fiat_keygen(FIAT_TEST_N_LEN, FIAT_TEST_KEYS, &fkey);
+    utils_ts_gettime(t2);
+    if ((NULL == t1) || (NULL == t2) || (NULL == t3) || (PKCS1_E_OK != res)) {
+        printf("Key Generation: NG. ret=%d\n", res);
+        utils_ts_free(t1);
+        utils_ts_free(t2);
+        utils_ts_free(t3);
+        return PKCS1_E_VERIFY;
+    }
+    printf("Key Generation (%d keys, %d bit): %" PRIu64 " usec\n",
+           FIAT_TEST_KEYS, FIAT_TEST_N_LEN * 8, fiat_test_usec(t1, t2, t3));
+
+    /* Encrypt a random message (< n) under every key. */
+    for (i = 0; (PKCS1_E_OK == ret) && (i < FIAT_TEST_KEYS); i++) {
+        pub.n     = fkey.key[i].n;
+        pub.n_len = fkey.key[i].n_len;
+        pub.e     = fkey.key[i].e;
+        pub.e_len = fkey.key[i].e_len;
+        utils_random(msg[i], FIAT_TEST_N_LEN);
+        msg[i][0] = 0x00;
+        len = FIAT_TEST_N_LEN;
+        res = rsaep(pub, msg[i], FIAT_TEST_N_LEN, buf, &len);
+        if ((PKCS1_E_OK != res) || (FIAT_TEST_N_LEN < len)) {
+            printf("RSAEP %02zu: NG. ret=%d\n", i, res);
+            ret = PKCS1_E_VERIFY;
+        }
+        else {
+            /* rsadp() takes a ciphertext of exactly n_len bytes. */
+            memset(emsg[i], 0, FIAT_TEST_N_LEN - len);
+            memcpy(&emsg[i][FIAT_TEST_N_LEN - len], buf, len);
+        }
+    }
+
+    /* Every batch size, keys in reverse order. */
+    for (cnt = 1; (PKCS1_E_OK == ret) && (cnt <= FIAT_TEST_KEYS); cnt++) {
+        printf("Batch of %zu: ", cnt);
+        for (i = 0; i < cnt; i++) {
+            items[i].key   = FIAT_TEST_KEYS - 1 - i;
+            items[i].emsg  = emsg[items[i].key];
+            items[i].emlen = FIAT_TEST_N_LEN;
+            items[i].msg   = dmsg[i];
+            items[i].mlen  = FIAT_TEST_N_LEN;
+        }
+        res = rsadp_fiat(&fkey, items, cnt);
+        for (i = 0; (PKCS1_E_OK == res) && (i < cnt); i++) {
+            if (!utils_blkcmp(msg[items[i].key], FIAT_TEST_N_LEN, items[i].msg, items[i].mlen, true)) {
+                res = PKCS1_E_VERIFY;
+            }
+        }
+        if (PKCS1_E_OK == res) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+
+    /* Error cases: same key twice, ciphertext out of range. */
+    if (PKCS1_E_OK == ret) {
+        printf("Error Cases: ");
+        items[0].mlen = FIAT_TEST_N_LEN;
+        items[1].mlen = FIAT_TEST_N_LEN;
+        items[1].key  = items[0].key;
+        items[1].emsg = items[0].emsg;
+        res = rsadp_fiat(&fkey, items, 2);
+        items[1].key  = 0;
+        items[1].emsg = fkey.key[0].n;
+        if ((PKCS1_E_PARAM == res) && (PKCS1_E_RANGE == rsadp_fiat(&fkey, items, 2))) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG.\n");
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+
+    /* Benchmark: FIAT_TEST_KEYS ciphertexts, rsadp() with CRT one by one vs rsadp_fiat(). */
+    if (PKCS1_E_OK == ret) {
+        for (i = 0; i < FIAT_TEST_KEYS; i++) {
+            items[i].key   = i;
+            items[i].emsg  = emsg[i];
+            items[i].emlen = FIAT_TEST_N_LEN;
+            items[i].msg   = dmsg[i];
+            items[i].mlen  = FIAT_TEST_N_LEN;
+        }
+        utils_ts_gettime(t1);
+        for (j = 0; j < FIAT_TEST_ROUNDS; j++) {
+            for (i = 0; i < FIAT_TEST_KEYS; i++) {
+                len = FIAT_TEST_N_LEN;
+                if (PKCS1_E_OK != rsadp(fkey.key[i], emsg[i], FIAT_TEST_N_LEN, dmsg[i], &len, true)) {
+                    ret = PKCS1_E_VERIFY;
+                }
+            }
+        }
+        utils_ts_gettime(t2);
+        usec_crt = fiat_test_usec(t1, t2, t3);
+
+        utils_ts_gettime(t1);
+        for (j = 0; j < FIAT_TEST_ROUNDS; j++) {
+            for (i = 0; i < FIAT_TEST_KEYS; i++) {
+                items[i].mlen = FIAT_TEST_N_LEN;
+            }
+            if (PKCS1_E_OK != rsadp_fiat(&fkey, items, FIAT_TEST_KEYS)) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        utils_ts_gettime(t2);
+        usec_fiat = fiat_test_usec(t1, t2, t3);
+
+        printf("Benchmark (%d x %d decryptions): rsadp(CRT) %" PRIu64 " usec, rsadp_fiat %" PRIu64 " usec\n",
+               FIAT_TEST_ROUNDS, FIAT_TEST_KEYS, usec_crt, usec_fiat);
+    }
+    printf("Finish RSA Batch Decryption Test\n");
+
+    pkcs1_fiat_key_free(&fkey);
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+#define MPRIME_TEST_ROUNDS  (8)
+
+/**
+ * @brief Verification Test for multi-prime keys.
+ *        RSADP with CRT over all the primes has to give the same output as
+ *        RSADP with (n, d), and the context functions have to agree with them.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_mprime_test()
+{
+    int                  ret;
+    int                  res;
+    uint8_t              msg[PKCS1_MAX_N_LEN];
+    uint8_t              emsg[PKCS1_MAX_N_LEN];
+    uint8_t              m_d[PKCS1_MAX_N_LEN];
+    uint8_t              m_crt[PKCS1_MAX_N_LEN];
+    uint8_t              m_ctx[PKCS1_MAX_N_LEN];
+    size_t               len;
+    size_t               len_d;
+    size_t               len_crt;
+    size_t               len_ctx;
+    int                  i;
+    int                  j;
+    int                  tv_cnt;
+    RSA_TV_MPRIME_t      *tv;
+    RSA_TOOLS_PRIV_KEY_t key;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+
+    ret = PKCS1_E_OK;
+    printf("Start Multi-prime RSA Test\n");
+    tv_cnt = (sizeof(rsa_mprime_tv_param) / sizeof(RSA_TV_MPRIME_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv = &(rsa_mprime_tv_param[i]);
+        printf("Test Key %02d (%d bit, %d primes): ", i, (int)(tv->pubkey.n_len * 8), (int)(tv->privkey.other_cnt + 2));
+        res = pkcs1_ctx_priv_alloc(tv->privkey, &ctx);
+        for (j = 0; (PKCS1_E_OK == res) && (j < MPRIME_TEST_ROUNDS); j++) {
+            /* Random c < n, and also c = 0, 1. */
+            utils_random(emsg, tv->pubkey.n_len);
+            emsg[0] = 0x00;
+            if (j < 2) {
+                memset(emsg, 0, tv->pubkey.n_len);
+                emsg[tv->pubkey.n_len - 1] = (uint8_t)j;
+            }
+            len_d   = tv->pubkey.n_len;
+            len_crt = tv->pubkey.n_len;
+            len_ctx = tv->pubkey.n_len;
+            res = rsadp(tv->privkey, emsg, tv->pubkey.n_len, m_d, &len_d, false);
+            if (PKCS1_E_OK == res) {
+                res = rsadp(tv->privkey, emsg, tv->pubkey.n_len, m_crt, &len_crt, true);
+            }
+            if (PKCS1_E_OK == res) {
+                res = rsadp_ctx(ctx, emsg, tv->pubkey.n_len, m_ctx, &len_ctx, true);
+            }
+            if ((PKCS1_E_OK == res) &&
+                ((len_d != len_crt) || (0 != memcmp(m_d, m_crt, len_d)) ||
+                 (len_d != len_ctx) || (0 != memcmp(m_d, m_ctx, len_d)))) {
+                res = PKCS1_E_VERIFY;
+            }
+            /* Back with RSAEP. */
+            if (PKCS1_E_OK == res) {
+                memset(msg, 0, tv->pubkey.n_len);
+                memcpy(&msg[tv->pubkey.n_len - len_d], m_d, len_d);
+                len = tv->pubkey.n_len;
+                res = rsaep(tv->pubkey, msg, tv->pubkey.n_len, m_crt, &len);
+            }
+            if ((PKCS1_E_OK == res) && !utils_blkcmp(emsg, tv->pubkey.n_len, m_crt, len, true)) {
+                res = PKCS1_E_VERIFY;
+            }
+        }
+        /* Sign with CRT and verify. */
+        if (PKCS1_E_OK == res) {
+            len = tv->pubkey.n_len;
+            res = pkcs1_rsa_sign(tv->privkey, emsg, tv->pubkey.n_len, m_crt, &len, true);
+        }
+        if (PKCS1_E_OK == res) {
+            memset(msg, 0, tv->pubkey.n_len);
+            memcpy(&msg[tv->pubkey.n_len - len], m_crt, len);
+            res = pksc1_rsa_verify(tv->pubkey, emsg, tv->pubkey.n_len, msg, tv->pubkey.n_len);
+        }
+        /* Malformed additional primes. */
+        if (PKCS1_E_OK == res) {
+            key       = tv->privkey;
+            key.other = NULL;
+            len       = tv->pubkey.n_len;
+            if (PKCS1_E_PARAM != rsadp(key, emsg, tv->pubkey.n_len, m_crt, &len, true)) {
+                res = PKCS1_E_VERIFY;
+            }
+        }
+        pkcs1_ctx_free(ctx);
+
+        if (PKCS1_E_OK == res) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    printf("Finish Multi-prime RSA Test\n");
+
+    return ret;
+}
+
+#define CRT_PAR_TEST_ROUNDS (200)
+
+/**
+ * @brief qsort() comparator of latencies.
+ */
+static int crt_par_test_cmp(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Latency of one signature, CRT in the calling thread or on a pool.
+ *        Prints the median and the 99th percentile in micro seconds.
+ */
+static int crt_par_test_bench(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *msg, void *tpool, const char *label)
+{
+    int      ret;
+    int      i;
+    uint8_t  sig[PKCS1_MAX_N_LEN];
+    size_t   len;
+    uint64_t usec[CRT_PAR_TEST_ROUNDS];
+    void     *t1;
+    void     *t2;
+    void     *t3;
+
+    ret = PKCS1_E_OK;
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    if ((NULL == t1) || (NULL == t2) || (NULL == t3)) {
+        ret = PKCS1_E_RESOURCE;
+    }
+    for (i = 0; (PKCS1_E_OK == ret) && (i < CRT_PAR_TEST_ROUNDS); i++) {
+        len = sizeof(sig);
+        utils_ts_gettime(t1);
+        if (NULL == tpool) {
+            ret = rsasp1_ctx(ctx, msg, pkcs1_ctx_n_len(ctx), sig, &len, true);
+        }
+        else {
+            ret = rsasp1_ctx_par(ctx, msg, pkcs1_ctx_n_len(ctx), sig, &len, tpool);
+        }
+        utils_ts_gettime(t2);
+        usec[i] = fiat_test_usec(t1, t2, t3);
+    }
+    if (PKCS1_E_OK == ret) {
+        qsort(usec, CRT_PAR_TEST_ROUNDS, sizeof(uint64_t), crt_par_test_cmp);
+        printf("    %-14s p50 %6" PRIu64 " usec, p99 %6" PRIu64 " usec\n", label,
+               usec[CRT_PAR_TEST_ROUNDS / 2], usec[(CRT_PAR_TEST_ROUNDS * 99) / 100]);
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for RSASP1 with the CRT halves on a
+ *        thread pool. rsasp1_ctx_par() has to give the NIST signatures and the
+ *        same output as rsasp1_ctx() for the multi-prime keys.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_crt_par_test()
+{
+    int                  ret;
+    int                  res;
+    uint8_t              buf[PKCS1_MAX_N_LEN];
+    uint8_t              ref[PKCS1_MAX_N_LEN];
+    uint8_t              msg[PKCS1_MAX_N_LEN];
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    size_t               len;
+    size_t               ref_len;
+    int                  i;
+    int                  tv_cnt;
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TV_MPRIME_t      *tv2;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+    RSA_TOOLS_KEY_CTX_t  *bench[1 + (sizeof(rsa_mprime_tv_param) / sizeof(RSA_TV_MPRIME_t))];
+    size_t               bench_cnt;
+    void                 *tpool;
+
+    ret = PKCS1_E_OK;
+    bench_cnt = 0;
+    tpool = utils_tpool_alloc(1);
+    if (NULL == tpool) {
+        printf("Error. Thread pool.\n");
+        return PKCS1_E_VERIFY;
+    }
+    printf("Start Parallel CRT Test\n");
+
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv = &(nist_rsasp1_tv_param[i]);
+        if (!tv->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        printf("Test Vector %02d: ", i);
+        priv = tv->privkey;
+        if (!tv_crt_derive(&priv, crt) || (PKCS1_E_OK != pkcs1_ctx_priv_alloc(priv, &ctx))) {
+            printf("Error. Key context.\n");
+            ret = PKCS1_E_VERIFY;
+            continue;
+        }
+        len = sizeof(buf);
+        res = rsasp1_ctx_par(ctx, tv->EM, tv->em_len, buf, &len, tpool);
+        if ((PKCS1_E_OK == res) && utils_blkcmp(tv->Sig, tv->sig_len, buf, len, true)) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+        if (0 == bench_cnt) {
+            bench[bench_cnt++] = ctx;
+        }
+        else {
+            pkcs1_ctx_free(ctx);
+        }
+    }
+
+    tv_cnt = (sizeof(rsa_mprime_tv_param) / sizeof(RSA_TV_MPRIME_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv2 = &(rsa_mprime_tv_param[i]);
+        printf("Test Key %02d (%d primes): ", i, (int)(tv2->privkey.other_cnt + 2));
+        if (PKCS1_E_OK != pkcs1_ctx_priv_alloc(tv2->privkey, &ctx)) {
+            printf("Error. Key context.\n");
+            ret = PKCS1_E_VERIFY;
+            continue;
+        }
+        utils_random(msg, tv2->pubkey.n_len);
+        msg[0] = 0x00;
+        ref_len = sizeof(ref);
+        len     = sizeof(buf);
+        res = rsasp1_ctx(ctx, msg, tv2->pubkey.n_len, ref, &ref_len, true);
+        if (PKCS1_E_OK == res) {
+            res = rsasp1_ctx_par(ctx, msg, tv2->pubkey.n_len, buf, &len, tpool);
+        }
+        if ((PKCS1_E_OK == res) && utils_blkcmp(ref, ref_len, buf, len, true)) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+        bench[bench_cnt++] = ctx;
+    }
+
+    /* Benchmark: single signature latency. */
+    for (i = 0; (PKCS1_E_OK == ret) && (i < (int)bench_cnt); i++) {
+        printf("Benchmark (%d bit, %d rounds):\n", (int)(pkcs1_ctx_n_len(bench[i]) * 8), CRT_PAR_TEST_ROUNDS);
+        utils_random(msg, pkcs1_ctx_n_len(bench[i]));
+        msg[0] = 0x00;
+        if ((PKCS1_E_OK != crt_par_test_bench(bench[i], msg, NULL, "rsasp1_ctx")) ||
+            (PKCS1_E_OK != crt_par_test_bench(bench[i], msg, tpool, "rsasp1_ctx_par"))) {
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    printf("Finish Parallel CRT Test\n");
+
+    for (i = 0; i < (int)bench_cnt; i++) {
+        pkcs1_ctx_free(bench[i]);
+    }
+    utils_tpool_free(tpool);
+
+    return ret;
+}
+
+#define BLIND_TEST_JOBS     (16)
+#define BLIND_TEST_ROUNDS   (10)
+
+typedef struct {
+    RSA_TOOLS_KEY_CTX_t *ctx;
+    NIST_TV_RSASP1_t    *tv;
+    int                 status[BLIND_TEST_JOBS];
+} BLIND_TEST_JOB_t;
+
+/**
+ * @brief Sign one test vector BLIND_TEST_ROUNDS times from a pool thread.
+ */
+static void blind_test_job(void *arg, size_t idx)
+{
+    BLIND_TEST_JOB_t *job;
+    uint8_t          buf[PKCS1_MAX_N_LEN];
+    size_t           len;
+    int              i;
+    int              res;
+
+    job = (BLIND_TEST_JOB_t *)arg;
+    res = PKCS1_E_OK;
+    for (i = 0; (PKCS1_E_OK == res) && (i < BLIND_TEST_ROUNDS); i++) {
+        len = sizeof(buf);
+        res = rsasp1_ctx(job->ctx, job->tv->EM, job->tv->em_len, buf, &len, (0 != (idx & 1)));
+        if ((PKCS1_E_OK == res) && !utils_blkcmp(job->tv->Sig, job->tv->sig_len, buf, len, true)) {
+            res = PKCS1_E_VERIFY;
+        }
+    }
+    job->status[idx] = res;
+}
+
+/**
+ * @brief Verification Test and benchmark for the blinding of key contexts.
+ *        Blinded signatures have to match the NIST signatures for several
+ *        refresh intervals, also when many threads share one context.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_blind_test()
+{
+    int                  ret;
+    int                  res;
+    uint8_t              buf[PKCS1_MAX_N_LEN];
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    size_t               len;
+    size_t               refresh[] = { 1, 3, PKCS1_BLIND_REFRESH };
+    size_t               k;
+    int                  i;
+    int                  j;
+    int                  tv_cnt;
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+    RSA_TOOLS_KEY_CTX_t  *pctx;
+    BLIND_TEST_JOB_t     job;
+    void                 *tpool;
+
+    ret = PKCS1_E_OK;
+    printf("Start Blinding Test\n");
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv = &(nist_rsasp1_tv_param[i]);
+        if (!tv->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        printf("Test Vector %02d: ", i);
+        priv = tv->privkey;
+        if (!tv_crt_derive(&priv, crt) || (PKCS1_E_OK != pkcs1_ctx_priv_alloc(priv, &ctx))) {
+            printf("Error. Key context.\n");
+            ret = PKCS1_E_VERIFY;
+            continue;
+        }
+        /* Across two draws of the blinding factor, with and without CRT. */
+        res = PKCS1_E_OK;
+        for (k = 0; (PKCS1_E_OK == res) && (k < (sizeof(refresh) / sizeof(size_t))); k++) {
+            res = pkcs1_ctx_set_blinding(ctx, refresh[k]);
+            for (j = 0; (PKCS1_E_OK == res) && (j < (int)(2 * refresh[k] + 1)); j++) {
+                len = sizeof(buf);
+                res = rsasp1_ctx(ctx, tv->EM, tv->em_len, buf, &len, (0 != (j & 1)));
+                if ((PKCS1_E_OK == res) && !utils_blkcmp(tv->Sig, tv->sig_len, buf, len, true)) {
+                    res = PKCS1_E_VERIFY;
+                }
+            }
+        }
+        if (PKCS1_E_OK == res) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+        pkcs1_ctx_free(ctx);
+    }
+
+    /* One context shared by the threads of a pool. */
+    tv = &(nist_rsasp1_tv_param[0]);
+    priv = tv->privkey;
+    tpool = utils_tpool_alloc(3);
+    printf("Shared Context: ");
+    if ((NULL == tpool) || !tv_crt_derive(&priv, crt) || (PKCS1_E_OK != pkcs1_ctx_priv_alloc(priv, &ctx))) {
+        printf("Error. Key context.\n");
+        ret = PKCS1_E_VERIFY;
+    }
+    else {
+        res = pkcs1_ctx_set_blinding(ctx, 4);
+        if (PKCS1_E_OK == res) {
+            job.ctx = ctx;
+            job.tv  = tv;
+            utils_tpool_run(tpool, blind_test_job, &job, BLIND_TEST_JOBS);
+            for (j = 0; j < BLIND_TEST_JOBS; j++) {
+                if (PKCS1_E_OK != job.status[j]) {
+                    res = job.status[j];
+                }
+            }
+        }
+        if (PKCS1_E_OK == res) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+
+        /* Error cases: blinding needs a private key. */
+        printf("Error Cases: ");
+        pctx = NULL;
+        if ((PKCS1_E_OK == pkcs1_ctx_pub_alloc(tv->pubkey, &pctx)) &&
+            (PKCS1_E_PARAM == pkcs1_ctx_set_blinding(pctx, 1)) &&
+            (PKCS1_E_OK == pkcs1_ctx_set_blinding(pctx, 0)) &&
+            (PKCS1_E_PARAM == pkcs1_ctx_set_blinding(NULL, 1))) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG.\n");
+            ret = PKCS1_E_VERIFY;
+        }
+        pkcs1_ctx_free(pctx);
+
+        /* Benchmark: single signature latency with and without blinding. */
+        if (PKCS1_E_OK == ret) {
+            printf("Benchmark (%d bit, %d rounds):\n", (int)(pkcs1_ctx_n_len(ctx) * 8), CRT_PAR_TEST_ROUNDS);
+            if ((PKCS1_E_OK != pkcs1_ctx_set_blinding(ctx, 0)) ||
+                (PKCS1_E_OK != crt_par_test_bench(ctx, tv->EM, NULL, "no blinding")) ||
+                (PKCS1_E_OK != pkcs1_ctx_set_blinding(ctx, PKCS1_BLIND_REFRESH)) ||
+                (PKCS1_E_OK != crt_par_test_bench(ctx, tv->EM, NULL, "blinding"))) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        pkcs1_ctx_free(ctx);
+    }
+    utils_tpool_free(tpool);
+    printf("Finish Blinding Test\n");
+
+    return ret;
+}
+
+#define KERNEL_TEST_RANDOM  (20)
+#define KERNEL_TEST_OPS     (2000)
+#define KERNEL_TEST_REPS    (10)    /* Runs of KERNEL_TEST_OPS operations, the fastest counts. */
+
+/**
+ * @brief NIST RSADP and RSASP1 test vectors with the primitives taking a key
+ *        (CRT and non-CRT) and with key contexts.
+ */
+static int kernel_test_nist(void)
+{
+    int                  ret;
+    int                  res;
+    uint8_t              buf[PKCS1_MAX_N_LEN];
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    size_t               len;
+    int                  i;
+    int                  tv_cnt;
+    bool                 use_crt;
+    NIST_TV_RSADP_t      *tv;
+    NIST_TV_RSASP1_t     *tv2;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+
+    ret = PKCS1_E_OK;
+    tv_cnt = (sizeof(nist_rsadp_tv_param) / sizeof(NIST_TV_RSADP_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv = &(nist_rsadp_tv_param[i]);
+        if (!tv->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        len = tv->pubkey.n_len;
+        res = rsaep(tv->pubkey, tv->k, tv->k_len, buf, &len);
+        if ((PKCS1_E_OK != res) || !utils_blkcmp(tv->c, tv->c_len, buf, len, false)) {
+            ret = PKCS1_E_VERIFY;
+        }
+        len = tv->privkey.n_len;
+        res = rsadp(tv->privkey, tv->c, tv->c_len, buf, &len, false);
+        if ((PKCS1_E_OK != res) || !utils_blkcmp(tv->k, tv->k_len, buf, len, false)) {
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv2 = &(nist_rsasp1_tv_param[i]);
+        if (!tv2->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        priv = tv2->privkey;
+        if (!tv_crt_derive(&priv, crt) || (PKCS1_E_OK != pkcs1_ctx_priv_alloc(priv, &ctx))) {
+            ret = PKCS1_E_VERIFY;
+            continue;
+        }
+        for (use_crt = false; ; use_crt = true) {
+            len = priv.n_len;
+            res = rsasp1(priv, tv2->EM, tv2->em_len, buf, &len, use_crt);
+            if ((PKCS1_E_OK != res) || !utils_blkcmp(tv2->Sig, tv2->sig_len, buf, len, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+            len = sizeof(buf);
+            res = rsasp1_ctx(ctx, tv2->EM, tv2->em_len, buf, &len, use_crt);
+            if ((PKCS1_E_OK != res) || !utils_blkcmp(tv2->Sig, tv2->sig_len, buf, len, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+            if (use_crt) {
+                break;
+            }
+        }
+        pkcs1_ctx_free(ctx);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief pkcs1_mont_exptmod() against mp_exptmod() for random odd moduli of
+ *        every length the kernels take (512 to 4096 bits), lengths that do
+ *        not fill the last limb included.
+ */
+static int kernel_test_random(void)
+{
+    int          ret;
+    int          i;
+    size_t       bits;
+    size_t       len;
+    uint8_t      buf[PKCS1_MAX_N_LEN];
+    uint8_t      ebuf[PKCS1_MAX_N_LEN];
+    PKCS1_MONT_t mt;
+    PKCS1_EXP_t  ex;
+    mp_int       b, e, y1, y2;
+
+    ret = pkcs1_mp_status(mp_init_multi(&b, &e, &y1, &y2, NULL));
+    for (i = 0; (PKCS1_E_OK == ret) && (i < KERNEL_TEST_RANDOM); i++) {
+        /* The unrolled lengths first. */
+        bits = (i < 4) ? (512 * ((size_t)i + 1)) : (512 + (((size_t)i * 3079) % (PKCS1_KERNEL_MAX_N_LEN * 8 - 512 + 1)));
+        len  = (bits + 7) / 8;
+        utils_random(buf, len);
+        buf[0] &= (uint8_t)(0xFF >> ((8 - (bits % 8)) % 8));
+        buf[0] |= (uint8_t)(0x80 >> ((8 - (bits % 8)) % 8));
+        buf[len - 1] |= 0x01;
+        memset(&ex, 0, sizeof(ex));
+        ret = pkcs1_mont_init(&mt, buf, len);
+        if (PKCS1_E_OK == ret) {
+            utils_random(buf, len);
+            ret = pkcs1_mp_status(mp_read_unsigned_bin(&b, buf, (int)len));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_mod(&b, &mt.m, &b));
+        }
+        if (PKCS1_E_OK == ret) {
+            utils_random(ebuf, len);
+            ret = pkcs1_mp_status(mp_read_unsigned_bin(&e, ebuf, (int)len));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_exp_recode(&ex, ebuf, len);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_mont_exptmod(&mt, &ex, &b, &y1));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_exptmod(&b, &e, &mt.m, &y2));
+        }
+        if ((PKCS1_E_OK == ret) && (MP_EQ != mp_cmp(&y1, &y2))) {
+            printf("(%zu bit) ", bits);
+            ret = PKCS1_E_VERIFY;
+        }
+        pkcs1_exp_clear(&ex);
+        pkcs1_mont_clear(&mt);
+    }
+    mp_clear_multi(&b, &e, &y1, &y2, NULL);
+
+    return ret;
+}
+
+/**
+ * @brief Microbenchmark of the kernel in use: nano seconds of one Montgomery
+ *        multiplication and one squaring for every operand length of the
+ *        keys (CRT halves and moduli) the kernel takes, the fastest of
+ *        KERNEL_TEST_REPS runs each.
+ */
+static int kernel_test_micro(void)
+{
+    int          ret;
+    size_t       i;
+    size_t       k;
+    size_t       rep;
+    size_t       len;
+    size_t       bits[] = { 512, 1024, 1536, 2048, 3072, 4096 };
+    uint8_t      buf[PKCS1_MAX_N_LEN];
+    uint64_t     x[PKCS1_KERNEL_MAX_LIMBS];
+    uint64_t     usec;
+    uint64_t     usec_mul;
+    uint64_t     usec_sqr;
+    PKCS1_MONT_t mt;
+    void         *t1;
+    void         *t2;
+    void         *t3;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    for (i = 0; (PKCS1_E_OK == ret) && (i < (sizeof(bits) / sizeof(bits[0]))); i++) {
+        len = bits[i] / 8;
+        utils_random(buf, len);
+        buf[0]       |= 0x80;
+        buf[len - 1] |= 0x01;
+        ret = pkcs1_mont_init(&mt, buf, len);
+        if ((PKCS1_E_OK == ret) && (NULL != mt.km)) {
+            memcpy(x, mt.km->rr, mt.km->limbs * sizeof(uint64_t));
+            usec_mul = UINT64_MAX;
+            usec_sqr = UINT64_MAX;
+            for (rep = 0; rep < KERNEL_TEST_REPS; rep++) {
+                utils_ts_gettime(t1);
+                for (k = 0; k < KERNEL_TEST_OPS; k++) {
+                    mt.km->kernel->mul(mt.km, x, x, mt.km->rr);
+                }
+                utils_ts_gettime(t2);
+                usec = fiat_test_usec(t1, t2, t3);
+                usec_mul = (usec < usec_mul) ? usec : usec_mul;
+                utils_ts_gettime(t1);
+                for (k = 0; k < KERNEL_TEST_OPS; k++) {
+                    mt.km->kernel->sqr(mt.km, x, x);
+                }
+                utils_ts_gettime(t2);
+                usec = fiat_test_usec(t1, t2, t3);
+                usec_sqr = (usec < usec_sqr) ? usec : usec_sqr;
+            }
+            printf("    %4zu bit: mul %6" PRIu64 " nsec, sqr %6" PRIu64 " nsec\n", bits[i],
+                   (usec_mul * 1000) / KERNEL_TEST_OPS, (usec_sqr * 1000) / KERNEL_TEST_OPS);
+        }
+        pkcs1_mont_clear(&mt);
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for the Montgomery multiplication
+ *        kernels. Every kernel the CPU supports has to pass the NIST test
+ *        vectors and agree with mp_exptmod().
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_kernel_test()
+{
+    int                  ret;
+    int                  res;
+    size_t               i;
+    const char           *names[] = { "portable", "avx2", "bmi2" };
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+
+    ret = PKCS1_E_OK;
+    printf("Start Kernel Test (default: %s)\n", pkcs1_kernel_name());
+    tv = &(nist_rsasp1_tv_param[0]);
+    priv = tv->privkey;
+    tv_crt_derive(&priv, crt);
+    for (i = 0; i < (sizeof(names) / sizeof(names[0])); i++) {
+        printf("Kernel %-8s: ", names[i]);
+        if (PKCS1_E_OK != pkcs1_kernel_select(names[i])) {
+            printf("Skipped.\n");
+            continue;
+        }
+        res = kernel_test_nist();
+        if (PKCS1_E_OK == res) {
+            res = kernel_test_random();
+        }
+        if (PKCS1_E_OK == res) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+
+        /* Benchmark: kernel operations and single signature latency, CRT. */
+        if ((PKCS1_E_OK == res) && (PKCS1_E_OK != kernel_test_micro())) {
+            ret = PKCS1_E_VERIFY;
+        }
+        if ((PKCS1_E_OK == res) && (PKCS1_E_OK == pkcs1_ctx_priv_alloc(priv, &ctx))) {
+            pkcs1_ctx_set_blinding(ctx, 0);
+            if (PKCS1_E_OK != crt_par_test_bench(ctx, tv->EM, NULL, "rsasp1_ctx")) {
+                ret = PKCS1_E_VERIFY;
+            }
+            pkcs1_ctx_free(ctx);
+        }
+    }
+    if (PKCS1_E_PARAM != pkcs1_kernel_select("unknown")) {
+        printf("Error Cases: NG.\n");
+        ret = PKCS1_E_VERIFY;
+    }
+    pkcs1_kernel_select(NULL);
+    printf("Finish Kernel Test\n");
+
+    return ret;
+}
+
+
+#define LANES_TEST_RANDOM   (6)
+#define LANES_TEST_ITEMS    ((PKCS1_LANES * 2) + 3)
+#define LANES_TEST_BENCH    (64)
+
+/**
+ * @brief pkcs1_lanes_exptmod() against mp_exptmod() with a different base
+ *        and exponent in every lane. Lanes 2k and 2k + 1 share a modulus,
+ *        and some runs leave lanes idle.
+ */
+static int lanes_test_random(void)
+{
+    int             ret;
+    int             i;
+    size_t          l;
+    size_t          cnt;
+    size_t          bits;
+    size_t          len;
+    size_t          elen;
+    uint8_t         buf[PKCS1_MAX_N_LEN];
+    PKCS1_MONT_t    mt[PKCS1_LANES / 2];
+    PKCS1_EXP_t     ex[PKCS1_LANES];
+    PKCS1_LANE_OP_t op[PKCS1_LANES];
+    mp_int          b[PKCS1_LANES];
+    mp_int          y[PKCS1_LANES];
+    mp_int          x[PKCS1_LANES];
+    mp_int          e;
+
+    ret = pkcs1_mp_status(mp_init(&e));
+    for (l = 0; (PKCS1_E_OK == ret) && (l < PKCS1_LANES); l++) {
+        ret = pkcs1_mp_status(mp_init_multi(&b[l], &y[l], &x[l], NULL));
+    }
+    for (i = 0; (PKCS1_E_OK == ret) && (i < LANES_TEST_RANDOM); i++) {
+        memset(mt, 0, sizeof(mt));
+        memset(ex, 0, sizeof(ex));
+        bits = 1024 + (((size_t)i * 613) % (PKCS1_KERNEL_MAX_N_LEN * 8 - 1024 + 1));
+        len  = (bits + 7) / 8;
+        cnt  = (0 == (i % 2)) ? PKCS1_LANES : (1 + (size_t)i);
+        for (l = 0; (PKCS1_E_OK == ret) && (l < cnt); l++) {
+            /* Moduli of exactly bits bits. */
+            if (0 == (l % 2)) {
+                utils_random(buf, len);
+                buf[0] &= (uint8_t)(0xFF >> ((8 - (bits % 8)) % 8));
+                buf[0] |= (uint8_t)(0x80 >> ((8 - (bits % 8)) % 8));
+                buf[len - 1] |= 0x01;
+                ret = pkcs1_mont_init(&mt[l / 2], buf, len);
+            }
+            /* Exponents of 0 to len bytes, e = 0 included. */
+            elen = (len * l) / (PKCS1_LANES - 1);
+            utils_random(buf, len);
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_exp_recode(&ex[l], buf, elen);
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_read_unsigned_bin(&e, buf, (int)elen));
+            }
+            utils_random(buf, len);
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_read_unsigned_bin(&b[l], buf, (int)len));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_mod(&b[l], &mt[l / 2].m, &b[l]));
+            }
+            if (PKCS1_E_OK == ret) {
+                ret = pkcs1_mp_status(mp_exptmod(&b[l], &e, &mt[l / 2].m, &x[l]));
+            }
+            op[l].mt = &mt[l / 2];
+            op[l].ex = &ex[l];
+            op[l].b  = &b[l];
+            op[l].y  = &y[l];
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(pkcs1_lanes_exptmod(op, cnt));
+        }
+        for (l = 0; (PKCS1_E_OK == ret) && (l < cnt); l++) {
+            if (MP_EQ != mp_cmp(&y[l], &x[l])) {
+                printf("(%zu bit, lane %zu) ", bits, l);
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        for (l = 0; l < PKCS1_LANES; l++) {
+            pkcs1_exp_clear(&ex[l]);
+        }
+        for (l = 0; l < (PKCS1_LANES / 2); l++) {
+            pkcs1_mont_clear(&mt[l]);
+        }
+    }
+    for (l = 0; l < PKCS1_LANES; l++) {
+        mp_clear_multi(&b[l], &y[l], &x[l], NULL);
+    }
+    mp_clear(&e);
+
+    return ret;
+}
+
+/**
+ * @brief Batch signing and verification of LANES_TEST_ITEMS message
+ *        representatives under one key, two full lane groups and a rest.
+ *        Every signature has to equal the one of rsasp1_ctx(), and the one
+ *        of the test vector for em (every fifth item). Then the signatures
+ *        are verified in a batch with one message altered.
+ */
+static int lanes_test_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *em, const uint8_t *sig, size_t sig_len)
+{
+    int                 ret;
+    int                 res;
+    size_t              n_len;
+    size_t              len;
+    size_t              i;
+    bool                use_crt;
+    uint8_t             *msg;
+    uint8_t             *sbuf;
+    uint8_t             buf[PKCS1_MAX_N_LEN];
+    int                 status[LANES_TEST_ITEMS];
+    PKCS1_SIGN_ITEM_t   sitem[LANES_TEST_ITEMS];
+    PKCS1_VERIFY_ITEM_t vitem[LANES_TEST_ITEMS];
+
+    n_len = pkcs1_ctx_n_len(ctx);
+    msg   = calloc(LANES_TEST_ITEMS, n_len);
+    sbuf  = calloc(LANES_TEST_ITEMS, n_len);
+    ret   = ((NULL != msg) && (NULL != sbuf)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    for (i = 0; (PKCS1_E_OK == ret) && (i < LANES_TEST_ITEMS); i++) {
+        if ((NULL != em) && (0 == (i % 5))) {
+            memcpy(&msg[i * n_len], em, n_len);
+        }
+        else {
+            utils_random(&msg[i * n_len], n_len);
+            msg[i * n_len] = 0x00;
+        }
+    }
+
+    for (use_crt = false; PKCS1_E_OK == ret; use_crt = true) {
+        for (i = 0; i < LANES_TEST_ITEMS; i++) {
+            sitem[i].msg  = &msg[i * n_len];
+            sitem[i].mlen = n_len;
+            sitem[i].sig  = &sbuf[i * n_len];
+            sitem[i].slen = n_len;
+        }
+        ret = pkcs1_rsa_sign_batch_ctx(ctx, sitem, LANES_TEST_ITEMS, use_crt, status, NULL);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < LANES_TEST_ITEMS); i++) {
+            len = sizeof(buf);
+            ret = rsasp1_ctx(ctx, sitem[i].msg, n_len, buf, &len, use_crt);
+            if ((PKCS1_E_OK == ret) &&
+                (!utils_blkcmp(buf, len, sitem[i].sig, sitem[i].slen, true) ||
+                 ((NULL != em) && (0 == (i % 5)) && !utils_blkcmp(sig, sig_len, sitem[i].sig, sitem[i].slen, true)))) {
+                printf("(item %zu) ", i);
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        if (use_crt) {
+            break;
+        }
+    }
+
+    /* Signatures of the length of n, message 3 altered. */
+    for (i = 0; (PKCS1_E_OK == ret) && (i < LANES_TEST_ITEMS); i++) {
+        memmove(&sbuf[(i * n_len) + n_len - sitem[i].slen], sitem[i].sig, sitem[i].slen);
+        memset(&sbuf[i * n_len], 0, n_len - sitem[i].slen);
+        vitem[i].msg  = &msg[i * n_len];
+        vitem[i].mlen = n_len;
+        vitem[i].sig  = &sbuf[i * n_len];
+        vitem[i].slen = n_len;
+    }
+    if (PKCS1_E_OK == ret) {
+        msg[(3 * n_len) + n_len - 1] ^= 0x01;
+        res = pkcs1_rsa_verify_batch_ctx(ctx, vitem, LANES_TEST_ITEMS, status, NULL);
+        if (PKCS1_E_VERIFY != res) {
+            ret = PKCS1_E_VERIFY;
+        }
+        for (i = 0; i < LANES_TEST_ITEMS; i++) {
+            if (status[i] != ((3 == i) ? PKCS1_E_VERIFY : PKCS1_E_OK)) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+    }
+    free(msg);
+    free(sbuf);
+
+    return ret;
+}
+
+/**
+ * @brief Batch sign and verify with the NIST RSASP1 test vectors and the
+ *        multi-prime keys.
+ */
+static int lanes_test_batch(void)
+{
+    int                  ret;
+    int                  i;
+    int                  tv_cnt;
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+
+    ret = PKCS1_E_OK;
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; (PKCS1_E_OK == ret) && (i < tv_cnt); i++) {
+        tv = &(nist_rsasp1_tv_param[i]);
+        if (!tv->e_result) {
+            /* Try next test vector. */
+            continue;
+        }
+        priv = tv->privkey;
+        if (!tv_crt_derive(&priv, crt) || (PKCS1_E_OK != pkcs1_ctx_priv_alloc(priv, &ctx))) {
+            ret = PKCS1_E_VERIFY;
+        }
+        else {
+            ret = lanes_test_ctx(ctx, tv->EM, tv->Sig, tv->sig_len);
+            pkcs1_ctx_free(ctx);
+        }
+    }
+
+    tv_cnt = (sizeof(rsa_mprime_tv_param) / sizeof(RSA_TV_MPRIME_t));
+    for (i = 0; (PKCS1_E_OK == ret) && (i < tv_cnt); i++) {
+        ret = pkcs1_ctx_priv_alloc(rsa_mprime_tv_param[i].privkey, &ctx);
+        if (PKCS1_E_OK == ret) {
+            ret = lanes_test_ctx(ctx, NULL, NULL, 0);
+            pkcs1_ctx_free(ctx);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Time LANES_TEST_BENCH signatures (CRT) as a batch and one by one.
+ */
+static int lanes_test_bench(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *em)
+{
+    int               ret;
+    size_t            i;
+    size_t            n_len;
+    uint8_t           *sbuf;
+    int               status[LANES_TEST_BENCH];
+    PKCS1_SIGN_ITEM_t item[LANES_TEST_BENCH];
+    uint64_t          usec_batch;
+    uint64_t          usec_one;
+    void              *t1;
+    void              *t2;
+    void              *t3;
+
+    n_len = pkcs1_ctx_n_len(ctx);
+    sbuf  = calloc(LANES_TEST_BENCH, n_len);
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != sbuf) && (NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    if (PKCS1_E_OK == ret) {
+        for (i = 0; i < LANES_TEST_BENCH; i++) {
+            item[i].msg  = em;
+            item[i].mlen = n_len;
+            item[i].sig  = &sbuf[i * n_len];
+            item[i].slen = n_len;
+        }
+        utils_ts_gettime(t1);
+        ret = pkcs1_rsa_sign_batch_ctx(ctx, item, LANES_TEST_BENCH, true, status, NULL);
+        utils_ts_gettime(t2);
+        usec_batch = fiat_test_usec(t1, t2, t3);
+    }
+    if (PKCS1_E_OK == ret) {
+        utils_ts_gettime(t1);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < LANES_TEST_BENCH); i++) {
+            item[i].slen = n_len;
+            ret = rsasp1_ctx(ctx, em, n_len, item[i].sig, &item[i].slen, true);
+        }
+        utils_ts_gettime(t2);
+        usec_one = fiat_test_usec(t1, t2, t3);
+    }
+    if (PKCS1_E_OK == ret) {
+        printf("    %d signatures: batch %8" PRIu64 " usec, one by one %8" PRIu64 " usec\n",
+               LANES_TEST_BENCH, usec_batch, usec_one);
+    }
+    free(sbuf);
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for the lane kernels. The scalar
+ *        emulation and every lane kernel the CPU supports have to agree with
+ *        mp_exptmod() and rsasp1_ctx(), and give the NIST signatures.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_lanes_test()
+{
+    int                  ret;
+    int                  res;
+    size_t               i;
+    const char           *names[] = { "none", "ifma-emu", "ifma" };
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+
+    ret = PKCS1_E_OK;
+    printf("Start Lanes Test (default: %s)\n", pkcs1_lane_kernel_name());
+    tv = &(nist_rsasp1_tv_param[0]);
+    priv = tv->privkey;
+    tv_crt_derive(&priv, crt);
+    for (i = 0; i < (sizeof(names) / sizeof(names[0])); i++) {
+        printf("Lanes %-8s: ", names[i]);
+        if (PKCS1_E_OK != pkcs1_lane_kernel_select(names[i])) {
+            printf("Skipped.\n");
+            continue;
+        }
+        res = (0 == i) ? PKCS1_E_OK : lanes_test_random();
+        if (PKCS1_E_OK == res) {
+            res = lanes_test_batch();
+        }
+        if (PKCS1_E_OK == res) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+
+        /* Benchmark: throughput of CRT signatures. */
+        if ((PKCS1_E_OK == res) && (PKCS1_E_OK == pkcs1_ctx_priv_alloc(priv, &ctx))) {
+            pkcs1_ctx_set_blinding(ctx, 0);
+            if (PKCS1_E_OK != lanes_test_bench(ctx, tv->EM)) {
+                ret = PKCS1_E_VERIFY;
+            }
+            pkcs1_ctx_free(ctx);
+        }
+    }
+    if (PKCS1_E_PARAM != pkcs1_lane_kernel_select("unknown")) {
+        printf("Error Cases: NG.\n");
+        ret = PKCS1_E_VERIFY;
+    }
+    pkcs1_lane_kernel_select(NULL);
+    printf("Finish Lanes Test\n");
+
+    return ret;
+}
+
+#define FBN_TEST_RANDOM     (200)
+#define FBN_TEST_BENCH      (200)
+#define FBN_TEST_E_LEN      (32)    /* Max exponent of the moduli the kernels do not take. */
+#define FBN_TEST_SQR_OPS    (400)   /* Squarings of a 2048 bit modulus timed, fewer for longer ones. */
+#define FBN_TEST_SQR_REPS   (20)    /* Runs of them, the fastest counts. */
+
+/**
+ * @brief Random octet string, in which bytes of 0x00 and 0xFF are frequent,
+ *        so that the rare corrections of the long division are reached.
+ */
+static void fbn_test_random(uint8_t *buf, size_t len)
+{
+    size_t  i;
+    uint8_t sel[PKCS1_MAX_N_LEN * 2];
+
+    utils_random(buf, len);
+    utils_random(sel, len);
+    for (i = 0; i < len; i++) {
+        if (0x40 > sel[i]) {
+            buf[i] = 0x00;
+        }
+        else if (0x80 > sel[i]) {
+            buf[i] = 0xFF;
+        }
+    }
+}
+
+/**
+ * @brief Check a fixed-width number against an mp_int.
+ */
+static bool fbn_test_eq(const PKCS1_FBN_t *x, const mp_int *y)
+{
+    uint8_t a[PKCS1_MAX_N_LEN * 2];
+    uint8_t b[PKCS1_MAX_N_LEN * 2];
+
+    return (PKCS1_E_OK == pkcs1_fbn_write(x, a, sizeof(a))) &&
+           (MP_OKAY == mp_to_unsigned_bin((mp_int *)y, b)) &&
+           utils_blkcmp(a, sizeof(a), b, (size_t)mp_unsigned_bin_size((mp_int *)y), true);
+}
+
+/**
+ * @brief pkcs1_fbn_*() against libtommath for random operands of up to a
+ *        product of two moduli and random odd moduli up to the largest one.
+ */
+static int fbn_test_ops(void)
+{
+    int         ret;
+    int         i;
+    size_t      alen;
+    size_t      blen;
+    size_t      mlen;
+    size_t      elen;
+    uint8_t     abuf[PKCS1_MAX_N_LEN * 2];
+    uint8_t     bbuf[PKCS1_MAX_N_LEN];
+    uint8_t     mbuf[PKCS1_MAX_N_LEN];
+    uint8_t     ebuf[PKCS1_MAX_N_LEN];
+    PKCS1_FBN_t a, b, m, x;
+    mp_int      ma, mb, mm, me, my;
+
+    ret = pkcs1_mp_status(mp_init_multi(&ma, &mb, &mm, &me, &my, NULL));
+    for (i = 0; (PKCS1_E_OK == ret) && (i < FBN_TEST_RANDOM); i++) {
+        mlen = 1 + ((size_t)i * 7919) % PKCS1_MAX_N_LEN;
+        blen = 1 + ((size_t)i * 104729) % mlen;
+        alen = 1 + ((size_t)i * 1299709) % ((2 * mlen) - blen + 1);
+        elen = (PKCS1_KERNEL_MAX_N_LEN < mlen) ? FBN_TEST_E_LEN : mlen;
+        elen = (0 == (i % 10)) ? 3 : (((size_t)i * 31) % (elen + 1));
+        fbn_test_random(abuf, alen);
+        fbn_test_random(bbuf, blen);
+        fbn_test_random(mbuf, mlen);
+        fbn_test_random(ebuf, elen);
+        mbuf[0] |= 0x01 << (i % 8);
+        mbuf[mlen - 1] |= 0x01;
+        if (0 == (i % 10)) {
+            /* e = 65537 */
+            ebuf[0] = 0x01;
+            ebuf[1] = 0x00;
+            ebuf[2] = 0x01;
+        }
+        ret = pkcs1_fbn_read(&a, abuf, alen);
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_fbn_read(&b, bbuf, blen);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_fbn_read(&m, mbuf, mlen);
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_read_unsigned_bin(&ma, abuf, (int)alen));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_read_unsigned_bin(&mb, bbuf, (int)blen));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_read_unsigned_bin(&mm, mbuf, (int)mlen));
+        }
+        if (PKCS1_E_OK == ret) {
+            ret = pkcs1_mp_status(mp_read_unsigned_bin(&me, ebuf, (int)elen));
+        }
+
+        /* a + b, (a + b) - b in place, a * b */
+        if ((PKCS1_E_OK == ret) && (PKCS1_E_OK == (ret = pkcs1_fbn_add(&a, &b, &x))) &&
+            (PKCS1_E_OK == (ret = pkcs1_mp_status(mp_add(&ma, &mb, &my)))) && !fbn_test_eq(&x, &my)) {
+            printf("(add %d) ", i);
+            ret = PKCS1_E_VERIFY;
+        }
+        if ((PKCS1_E_OK == ret) && (PKCS1_E_OK == (ret = pkcs1_fbn_sub(&x, &b, &x))) && !fbn_test_eq(&x, &ma)) {
+            printf("(sub %d) ", i);
+            ret = PKCS1_E_VERIFY;
+        }
+        if ((PKCS1_E_OK == ret) && (PKCS1_E_OK == (ret = pkcs1_fbn_mul(&a, &b, &x))) &&
+            (PKCS1_E_OK == (ret = pkcs1_mp_status(mp_mul(&ma, &mb, &my)))) && !fbn_test_eq(&x, &my)) {
+            printf("(mul %d) ", i);
+            ret = PKCS1_E_VERIFY;
+        }
+        /* a mod m, a * b mod m, b^e mod m */
+        if ((PKCS1_E_OK == ret) && (PKCS1_E_OK == (ret = pkcs1_fbn_mod(&a, &m, &x))) &&
+            (PKCS1_E_OK == (ret = pkcs1_mp_status(mp_mod(&ma, &mm, &my)))) && !fbn_test_eq(&x, &my)) {
+            printf("(mod %d) ", i);
+            ret = PKCS1_E_VERIFY;
+        }
+        if ((PKCS1_E_OK == ret) && (PKCS1_E_OK == (ret = pkcs1_fbn_mulmod(&x, &b, &m, &x))) &&
+            (PKCS1_E_OK == (ret = pkcs1_mp_status(mp_mulmod(&my, &mb, &mm, &my)))) && !fbn_test_eq(&x, &my)) {
+            printf("(mulmod %d) ", i);
+            ret = PKCS1_E_VERIFY;
+        }
+        if ((PKCS1_E_OK == ret) && (PKCS1_E_OK == (ret = pkcs1_fbn_exptmod(&b, ebuf, elen, &m, &x))) &&
+            (PKCS1_E_OK == (ret = pkcs1_mp_status(mp_exptmod(&mb, &me, &mm, &my)))) && !fbn_test_eq(&x, &my)) {
+            printf("(exptmod %d) ", i);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    mp_clear_multi(&ma, &mb, &mm, &me, &my, NULL);
+
+    /* Error cases: a negative difference, an even modulus, a product too long. */
+    if (PKCS1_E_OK == ret) {
+        mbuf[0] = 0x02;
+        memset(abuf, 0xFF, sizeof(abuf));
+        if ((PKCS1_E_OK != pkcs1_fbn_read(&m, mbuf, 1)) ||
+            (PKCS1_E_OK != pkcs1_fbn_read(&b, mbuf, 0)) ||
+            (PKCS1_E_PARAM != pkcs1_fbn_sub(&b, &m, &x)) ||
+            (PKCS1_E_PARAM != pkcs1_fbn_exptmod(&m, mbuf, 1, &m, &x)) ||
+            (PKCS1_E_OK != pkcs1_fbn_read(&a, abuf, sizeof(abuf))) ||
+            (PKCS1_E_PARAM != pkcs1_fbn_mul(&a, &a, &x)) ||
+            (PKCS1_E_PARAM != pkcs1_fbn_read(&a, abuf, sizeof(abuf) + 1))) {
+            printf("(error cases) ");
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    /* Fixed-length output: leading zeros, a partial top limb, too short. */
+    for (alen = 1; (PKCS1_E_OK == ret) && (alen < 20); alen++) {
+        fbn_test_random(abuf, alen);
+        abuf[0] = 0x00;
+        if ((PKCS1_E_OK != pkcs1_fbn_read(&a, abuf, alen)) ||
+            (PKCS1_E_OK != pkcs1_fbn_write(&a, bbuf, alen + 9)) ||
+            !utils_blkcmp(abuf, alen, bbuf, alen + 9, true) || (0x00 != bbuf[9]) ||
+            (PKCS1_E_OK != pkcs1_fbn_write(&a, bbuf, alen - 1)) ||
+            !utils_blkcmp(&abuf[1], alen - 1, bbuf, alen - 1, false)) {
+            printf("(write %zu) ", alen);
+            ret = PKCS1_E_VERIFY;
+        }
+        abuf[0] = 0x01;
+        if ((PKCS1_E_OK == ret) &&
+            ((PKCS1_E_OK != pkcs1_fbn_read(&a, abuf, alen)) ||
+             (PKCS1_E_PARAM != pkcs1_fbn_write(&a, bbuf, alen - 1)))) {
+            printf("(write short %zu) ", alen);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    pkcs1_fbn_clear(&a);
+    pkcs1_fbn_clear(&b);
+    pkcs1_fbn_clear(&x);
+
+    return ret;
+}
+
+/**
+ * @brief Time FBN_TEST_BENCH signatures (CRT) with rsasp1().
+ */
+static int fbn_test_bench(RSA_TOOLS_PRIV_KEY_t priv, uint8_t *em)
+{
+    int      ret;
+    size_t   i;
+    size_t   len;
+    uint8_t  buf[PKCS1_MAX_N_LEN];
+    uint64_t usec;
+    void     *t1;
+    void     *t2;
+    void     *t3;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    if (PKCS1_E_OK == ret) {
+        utils_ts_gettime(t1);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < FBN_TEST_BENCH); i++) {
+            len = priv.n_len;
+            ret = rsasp1(priv, em, priv.n_len, buf, &len, true);
+        }
+        utils_ts_gettime(t2);
+        usec = fiat_test_usec(t1, t2, t3);
+    }
+    if (PKCS1_E_OK == ret) {
+        printf("    rsasp1 (%zu bit, CRT): %6" PRIu64 " usec\n", priv.n_len * 8, usec / FBN_TEST_BENCH);
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Squarings against multiplications of a number by itself, for the
+ *        CRT halves and moduli from 1024 to 16384 bit. Both have to agree.
+ *        The operations of an exponentiation by an exponent of the modulus
+ *        length are counted from its sliding windows, and with the times of
+ *        one operation give the share of the squarings in it, with a * a
+ *        (before) and with the squaring (after), and the time of the
+ *        exponentiation after relative to before.
+ *        Every time is the fastest of FBN_TEST_SQR_REPS runs, taken by turns
+ *        from the same number, so that one preempted run does not decide.
+ */
+static int fbn_test_sqr(void)
+{
+    int         ret;
+    size_t      i;
+    size_t      k;
+    size_t      len;
+    size_t      ops;
+    size_t      rep;
+    size_t      nsqr;
+    size_t      nmul;
+    size_t      bits[] = { 1024, 2048, 4096, 8192, 16384 };
+    uint8_t     buf[PKCS1_MAX_N_LEN];
+    uint64_t    usec;
+    uint64_t    usec_mul;
+    uint64_t    usec_sqr;
+    uint64_t    before;
+    uint64_t    after;
+    PKCS1_FBN_t m;
+    PKCS1_FBN_t x;
+    PKCS1_FBN_t a;
+    PKCS1_FBN_t b;
+    PKCS1_EXP_t ex;
+    void        *t1;
+    void        *t2;
+    void        *t3;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    for (i = 0; (PKCS1_E_OK == ret) && (i < (sizeof(bits) / sizeof(bits[0]))) &&
+                ((PKCS1_MAX_N_LEN * 8) >= bits[i]); i++) {
+        len = bits[i] / 8;
+        ops = (FBN_TEST_SQR_OPS * 2048) / bits[i];
+        fbn_test_random(buf, len);
+        buf[0]       |= 0x80;
+        buf[len - 1] |= 0x01;
+        ret = pkcs1_fbn_read(&m, buf, len);
+        if (PKCS1_E_OK == ret) {
+            buf[0] &= 0x7F;
+            ret = pkcs1_fbn_read(&x, buf, len);
+        }
+        usec_mul = UINT64_MAX;
+        usec_sqr = UINT64_MAX;
+        for (rep = 0; (PKCS1_E_OK == ret) && (rep < FBN_TEST_SQR_REPS); rep++) {
+            a = x;
+            utils_ts_gettime(t1);
+            ret = pkcs1_fbn_mont_sqr_run(&m, &a, ops, true);
+            utils_ts_gettime(t2);
+            usec = fiat_test_usec(t1, t2, t3);
+            usec_mul = (usec < usec_mul) ? usec : usec_mul;
+            if (PKCS1_E_OK == ret) {
+                b = x;
+                utils_ts_gettime(t1);
+                ret = pkcs1_fbn_mont_sqr_run(&m, &b, ops, false);
+                utils_ts_gettime(t2);
+                usec = fiat_test_usec(t1, t2, t3);
+                usec_sqr = (usec < usec_sqr) ? usec : usec_sqr;
+            }
+        }
+        if ((PKCS1_E_OK == ret) && (0 != pkcs1_fbn_cmp(&a, &b))) {
+            printf("(sqr %zu bit) ", bits[i]);
+            ret = PKCS1_E_VERIFY;
+        }
+
+        /* Operations of an exponentiation: the table, the windows and the squarings. */
+        utils_random(buf, len);
+        buf[0] |= 0x80;
+        if ((PKCS1_E_OK == ret) && (PKCS1_E_OK == (ret = pkcs1_exp_recode(&ex, buf, len)))) {
+            nsqr = ex.tail + 1;
+            nmul = ((size_t)1 << (ex.wsize - 1)) + ex.cnt;
+            for (k = 1; k < ex.cnt; k++) {
+                nsqr += ex.win[k].sqr;
+            }
+            pkcs1_exp_clear(&ex);
+            before = nsqr * usec_mul;
+            after  = nsqr * usec_sqr;
+            printf("    %5zu bit: %5zu sqr, %4zu mul, a * a %6" PRIu64 " nsec, sqr %6" PRIu64 " nsec,"
+                   " squarings %2" PRIu64 "%% -> %2" PRIu64 "%%, exptmod %3" PRIu64 "%%\n",
+                   bits[i], nsqr, nmul, (usec_mul * 1000) / ops, (usec_sqr * 1000) / ops,
+                   (before * 100) / (before + (nmul * usec_mul)), (after * 100) / (after + (nmul * usec_mul)),
+                   ((after + (nmul * usec_mul)) * 100) / (before + (nmul * usec_mul)));
+        }
+    }
+    pkcs1_fbn_clear(&m);
+    pkcs1_fbn_clear(&x);
+    pkcs1_fbn_clear(&a);
+    pkcs1_fbn_clear(&b);
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for the fixed-width numbers of the
+ *        primitives taking a key, with the portable loop and with every
+ *        kernel of 64 bit limbs the CPU supports.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_fbn_test()
+{
+    int                  ret;
+    int                  res;
+    size_t               i;
+    const char           *names[] = { "portable", "bmi2" };
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv;
+
+    ret = PKCS1_E_OK;
+    printf("Start Fixed-width Number Test (capacity: %d bit)\n", PKCS1_MAX_N_LEN * 8);
+    tv = &(nist_rsasp1_tv_param[0]);
+    priv = tv->privkey;
+    tv_crt_derive(&priv, crt);
+    for (i = 0; i < (sizeof(names) / sizeof(names[0])); i++) {
+        printf("Kernel %-8s: ", names[i]);
+        if (PKCS1_E_OK != pkcs1_kernel_select(names[i])) {
+            printf("Skipped.\n");
+            continue;
+        }
+        res = fbn_test_ops();
+        if (PKCS1_E_OK == res) {
+            res = kernel_test_nist();
+        }
+        if (PKCS1_E_OK == res) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+
+        /* Benchmark: single signature latency without any key context. */
+        if ((PKCS1_E_OK == res) && (PKCS1_E_OK != fbn_test_bench(priv, tv->EM))) {
+            ret = PKCS1_E_VERIFY;
+        }
+        /* Benchmark: share of the squarings in an exponentiation. */
+        if ((PKCS1_E_OK == res) && (PKCS1_E_OK != fbn_test_sqr())) {
+            printf("    Squaring NG.\n");
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    pkcs1_kernel_select(NULL);
+    printf("Finish Fixed-width Number Test\n");
+
+    return ret;
+}
+
+#define ARENA_TEST_ROUNDS   (64)
+#define ARENA_TEST_OPS      (6)
+#define ARENA_TEST_ITEMS    (4)
+
+/**
+ * @brief Run one kind of primitive of a key context and check its output.
+ */
+static int arena_test_op(const RSA_TOOLS_KEY_CTX_t *ctx, const NIST_TV_RSASP1_t *tv, int op, void *tpool)
+{
+    int                 ret;
+    size_t              i;
+    uint8_t             buf[PKCS1_MAX_N_LEN];
+    size_t              len;
+    int                 status[ARENA_TEST_ITEMS];
+    PKCS1_VERIFY_ITEM_t items[ARENA_TEST_ITEMS];
+
+    len = sizeof(buf);
+    switch (op) {
+        case 0 :
+            ret = rsavp1_ctx(ctx, tv->Sig, tv->sig_len, buf, &len);
+            if ((PKCS1_E_OK == ret) && !utils_blkcmp(tv->EM, tv->em_len, buf, len, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+            break;
+        case 4 :
+            ret = rsasp1_ctx_par(ctx, tv->EM, tv->em_len, buf, &len, tpool);
+            if ((PKCS1_E_OK == ret) && !utils_blkcmp(tv->Sig, tv->sig_len, buf, len, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+            break;
+        case 5 :
+            for (i = 0; i < ARENA_TEST_ITEMS; i++) {
+                items[i].msg  = tv->EM;
+                items[i].mlen = tv->em_len;
+                items[i].sig  = tv->Sig;
+                items[i].slen = tv->sig_len;
+            }
+            ret = pkcs1_rsa_verify_batch_ctx(ctx, items, ARENA_TEST_ITEMS, status, NULL);
+            break;
+        default :
+            /* 1: without CRT, 2: with CRT, 3: with CRT and blinding. */
+            ret = rsasp1_ctx(ctx, tv->EM, tv->em_len, buf, &len, (1 < op));
+            if ((PKCS1_E_OK == ret) && !utils_blkcmp(tv->Sig, tv->sig_len, buf, len, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+            break;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Test of the arena scopes of the primitives.
+ *        Every primitive must give the same output in a scope of its own and
+ *        nested in a scope of the caller, allocate and free a non-zero and
+ *        equal number of blocks with no live bytes left in both, and, once
+ *        the arena is warm, make no call of malloc() for its working
+ *        integers.
+ *        The test fails if nothing was counted, which is the case unless
+ *        libtommath is built with the allocation hooks of utils_arena.c
+ *        (PKCS1_ARENA_TOMMATH).
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_arena_test()
+{
+    int                  ret;
+    int                  res;
+    int                  op;
+    int                  j;
+    bool                 hooked;
+    const char           *names[ARENA_TEST_OPS] = { "rsavp1", "rsasp1", "rsasp1 CRT", "blinded CRT", "CRT on pool", "batch verify" };
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+    void                 *tpool;
+    PKCS1_ARENA_STAT_t   first;
+    PKCS1_ARENA_STAT_t   last;
+    PKCS1_ARENA_STAT_t   stat;
+
+    ret = PKCS1_E_OK;
+    hooked = true;
+    printf("Start Arena Test\n");
+    tv = &(nist_rsasp1_tv_param[0]);
+    priv = tv->privkey;
+    tpool = utils_tpool_alloc(1);
+    if ((NULL == tpool) || !tv_crt_derive(&priv, crt) || (PKCS1_E_OK != pkcs1_ctx_priv_alloc(priv, &ctx))) {
+        printf("Error. Key context.\n");
+        utils_tpool_free(tpool);
+        return PKCS1_E_VERIFY;
+    }
+
+    for (op = 0; op < ARENA_TEST_OPS; op++) {
+        printf("%-12s: ", names[op]);
+        memset(&last, 0, sizeof(last));
+        res = (3 == op) ? pkcs1_ctx_set_blinding(ctx, 2) : PKCS1_E_OK;
+        for (j = 0; (PKCS1_E_OK == res) && (j < ARENA_TEST_ROUNDS); j++) {
+            res = arena_test_op(ctx, tv, op, tpool);
+            pkcs1_arena_stat((0 == j) ? &first : &last);
+            /* Nothing is kept from one call to the next. */
+            pkcs1_arena_stat(&stat);
+            if ((PKCS1_E_OK == res) && ((stat.allocs != stat.frees) || (0 != stat.live))) {
+                res = PKCS1_E_VERIFY;
+            }
+        }
+        /* Nested in a scope of the caller, counted and balanced as well. */
+        if ((PKCS1_E_OK == res) && (UTILS_E_OK == utils_arena_begin())) {
+            res = arena_test_op(ctx, tv, op, tpool);
+            utils_arena_end(NULL);
+            pkcs1_arena_stat(&stat);
+            if ((PKCS1_E_OK == res) && ((0 == stat.allocs) || (stat.allocs != stat.frees) || (0 != stat.live))) {
+                res = PKCS1_E_VERIFY;
+            }
+        }
+        /* Every primitive allocates its working integers through the hooks. */
+        if (0 == last.allocs) {
+            hooked = false;
+            res = PKCS1_E_VERIFY;
+        }
+        else if ((PKCS1_E_OK == res) && (0 != last.heap)) {
+            res = PKCS1_E_VERIFY;
+        }
+        if (PKCS1_E_OK == res) {
+            printf("OK. allocs %4zu, frees %4zu, live %lld, bytes %7zu, peak %7zu, heap %zu -> %zu\n",
+                   last.allocs, last.frees, (long long)last.live, last.bytes, last.peak, first.heap, last.heap);
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    if (!hooked) {
+        printf("Nothing was counted: libtommath does not allocate through utils_arena_malloc().\n");
+    }
+    pkcs1_ctx_free(ctx);
+    utils_tpool_free(tpool);
+    printf("Finish Arena Test\n");
+
+    return ret;
+}
+
+#define BIGMOD_TEST_ROUNDS  (2)
+#define BIGMOD_TEST_D_LEN   (256)   /* Significant octets of the private exponents. */
+
+/**
+ * @brief Check an octet string against an mp_int, leading zeros aside.
+ */
+static bool bigmod_test_eq(const uint8_t *a, size_t alen, mp_int *y)
+{
+    uint8_t b[PKCS1_MAX_N_LEN];
+
+    return (PKCS1_MAX_N_LEN >= mp_unsigned_bin_size(y)) && (MP_OKAY == mp_to_unsigned_bin(y, b)) &&
+           utils_blkcmp(a, alen, b, (size_t)mp_unsigned_bin_size(y), true);
+}
+
+/**
+ * @brief rsaep() and rsadp() without CRT against libtommath for a random odd
+ *        modulus of n_len octets, a random message and random exponents.
+ */
+static int bigmod_test_one(size_t n_len, int round)
+{
+    int                  ret;
+    uint8_t              n[PKCS1_MAX_N_LEN];
+    uint8_t              d[PKCS1_MAX_N_LEN];
+    uint8_t              msg[PKCS1_MAX_N_LEN];
+    uint8_t              out[PKCS1_MAX_N_LEN];
+    uint8_t              e[3] = { 0x01, 0x00, 0x01 };
+    size_t               len;
+    RSA_TOOLS_PUB_KEY_t  pub;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    mp_int               mn, mm, me, my;
+
+    utils_random(n, n_len);
+    utils_random(msg, n_len);
+    memset(d, 0, n_len);
+    len = (BIGMOD_TEST_D_LEN < n_len) ? BIGMOD_TEST_D_LEN : n_len;
+    utils_random(&d[n_len - len], len);
+    n[0]         |= 0x80;
+    n[n_len - 1] |= 0x01;
+    msg[0]        = 0x00;
+    if (0 != (round % 2)) {
+        /* e = 3 */
+        e[0] = 0x00;
+        e[1] = 0x00;
+        e[2] = 0x03;
+    }
+
+    memset(&priv, 0, sizeof(priv));
+    pub.n       = n;
+    pub.n_len   = n_len;
+    pub.e       = e;
+    pub.e_len   = sizeof(e);
+    priv.n      = n;
+    priv.n_len  = n_len;
+    priv.d      = d;
+    priv.d_len  = n_len;
+
+    ret = pkcs1_mp_status(mp_init_multi(&mn, &mm, &me, &my, NULL));
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&mn, n, (int)n_len));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&mm, msg, (int)n_len));
+    }
+
+    /* c = m^e mod n */
+    if (PKCS1_E_OK == ret) {
+        len = n_len;
+        ret = rsaep(pub, msg, n_len, out, &len);
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&me, e, (int)sizeof(e)));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_exptmod(&mm, &me, &mn, &my));
+    }
+    if ((PKCS1_E_OK == ret) && !bigmod_test_eq(out, len, &my)) {
+        printf("(rsaep %zu) ", n_len);
+        ret = PKCS1_E_VERIFY;
+    }
+
+    /* m = c^d mod n, c = msg */
+    if (PKCS1_E_OK == ret) {
+        len = n_len;
+        ret = rsadp(priv, msg, n_len, out, &len, false);
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_read_unsigned_bin(&me, d, (int)n_len));
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_mp_status(mp_exptmod(&mm, &me, &mn, &my));
+    }
+    if ((PKCS1_E_OK == ret) && !bigmod_test_eq(out, len, &my)) {
+        printf("(rsadp %zu) ", n_len);
+        ret = PKCS1_E_VERIFY;
+    }
+    mp_clear_multi(&mn, &mm, &me, &my, NULL);
+
+    return ret;
+}
+
+/**
+ * @brief Time one rsadp() without CRT of a random modulus of n_len octets,
+ *        with an exponent of BIGMOD_TEST_D_LEN octets at most.
+ */
+static int bigmod_test_bench(size_t n_len, uint64_t *usec)
+{
+    int                  ret;
+    uint8_t              n[PKCS1_MAX_N_LEN];
+    uint8_t              d[PKCS1_MAX_N_LEN];
+    uint8_t              buf[PKCS1_MAX_N_LEN];
+    size_t               len;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    void                 *t1;
+    void                 *t2;
+    void                 *t3;
+
+    utils_random(n, n_len);
+    utils_random(buf, n_len);
+    memset(d, 0, n_len);
+    len = (BIGMOD_TEST_D_LEN < n_len) ? BIGMOD_TEST_D_LEN : n_len;
+    utils_random(&d[n_len - len], len);
+    d[n_len - len] |= 0x80;
+    n[0]         |= 0x80;
+    n[n_len - 1] |= 0x01;
+    buf[0]        = 0x00;
+    memset(&priv, 0, sizeof(priv));
+    priv.n     = n;
+    priv.n_len = n_len;
+    priv.d     = d;
+    priv.d_len = n_len;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    if (PKCS1_E_OK == ret) {
+        utils_ts_gettime(t1);
+        len = n_len;
+        ret = rsadp(priv, buf, n_len, buf, &len, false);
+        utils_ts_gettime(t2);
+        *usec = fiat_test_usec(t1, t2, t3);
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for moduli of any length up to
+ *        PKCS1_MAX_N_LEN, without and with the products split over a thread
+ *        pool (pkcs1_mul_pool_set()).
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_bigmod_test()
+{
+    int                 ret;
+    int                 res;
+    int                 pass;
+    int                 round;
+    size_t              i;
+    size_t              len;
+    const size_t        lens[] = { PKCS1_MIN_N_LEN, 200, 333, 448, 1024, 1536, PKCS1_MAX_N_LEN };
+    const char          *names[] = { "no pool", "pool" };
+    uint8_t             n[PKCS1_MAX_N_LEN + 1];
+    uint8_t             buf[PKCS1_MAX_N_LEN + 1];
+    uint8_t             e[1] = { 0x03 };
+    uint64_t            usec;
+    void                *tpool;
+    RSA_TOOLS_PUB_KEY_t pub;
+
+    ret = PKCS1_E_OK;
+    /* The pool only pays with free CPUs, so the timings come with their count. */
+    printf("Start Big Modulus Test (%d - %d bit, %ld CPUs)\n", PKCS1_MIN_N_LEN * 8, PKCS1_MAX_N_LEN * 8,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    tpool = utils_tpool_alloc(3);
+    if (NULL == tpool) {
+        printf("Error. Thread pool.\n");
+        return PKCS1_E_VERIFY;
+    }
+
+    for (pass = 0; pass < 2; pass++) {
+        /* The pool splits products from 2048 bit on, so that it is also reached by small moduli. */
+        (void)pkcs1_mul_pool_set((0 == pass) ? NULL : tpool, 2048);
+        for (i = 0; i < (sizeof(lens) / sizeof(lens[0])); i++) {
+            /* Lengths of 8192 and 16384 bit builds only. */
+            if (((i + 1) < (sizeof(lens) / sizeof(lens[0]))) && (PKCS1_MAX_N_LEN <= lens[i])) {
+                continue;
+            }
+            printf("%-7s %5zu bit: ", names[pass], lens[i] * 8);
+            res = PKCS1_E_OK;
+            for (round = 0; (PKCS1_E_OK == res) && (round < BIGMOD_TEST_ROUNDS); round++) {
+                res = bigmod_test_one(lens[i], round);
+            }
+            if (PKCS1_E_OK == res) {
+                res = bigmod_test_bench(lens[i], &usec);
+            }
+            if (PKCS1_E_OK == res) {
+                printf("OK. rsadp %8" PRIu64 " usec\n", usec);
+            }
+            else {
+                printf("NG. ret=%d\n", res);
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+    }
+    (void)pkcs1_mul_pool_set(NULL, 0);
+    utils_tpool_free(tpool);
+
+    /* Error cases: too short, too long, a leading zero octet. */
+    printf("Length check: ");
+    utils_random(n, sizeof(n));
+    memset(buf, 0, sizeof(buf));
+    n[0]  |= 0x80;
+    pub.n  = n;
+    pub.e  = e;
+    pub.e_len = sizeof(e);
+    len = PKCS1_MIN_N_LEN - 1;
+    pub.n_len = len;
+    res = rsaep(pub, buf, pub.n_len, buf, &len);
+    len = PKCS1_MAX_N_LEN + 1;
+    pub.n_len = len;
+    res = (PKCS1_E_PARAM == res) ? rsaep(pub, buf, pub.n_len, buf, &len) : PKCS1_E_OK;
+    n[0] = 0x00;
+    len = PKCS1_MAX_N_LEN;
+    pub.n_len = len;
+    res = (PKCS1_E_PARAM == res) ? rsaep(pub, buf, pub.n_len, buf, &len) : PKCS1_E_OK;
+    if (PKCS1_E_PARAM == res) {
+        printf("OK.\n");
+    }
+    else {
+        printf("NG. ret=%d\n", res);
+        ret = PKCS1_E_VERIFY;
+    }
+    printf("Finish Big Modulus Test\n");
+
+    return ret;
+}
+
+#define CT_TEST_BENCH   (20)
+
+/**
+ * @brief Time CT_TEST_BENCH signatures (CRT) of rsasp1() and rsasp1_ctx()
+ *        with the current engine.
+ */
+static int ct_test_bench(RSA_TOOLS_PRIV_KEY_t priv, const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *em, uint64_t *usec)
+{
+    int     ret;
+    size_t  i;
+    size_t  len;
+    uint8_t buf[PKCS1_MAX_N_LEN];
+    void    *t1;
+    void    *t2;
+    void    *t3;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    if (PKCS1_E_OK == ret) {
+        utils_ts_gettime(t1);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < CT_TEST_BENCH); i++) {
+            len = priv.n_len;
+            ret = rsasp1(priv, (uint8_t *)em, priv.n_len, buf, &len, true);
+        }
+        utils_ts_gettime(t2);
+        usec[0] = fiat_test_usec(t1, t2, t3) / CT_TEST_BENCH;
+    }
+    if (PKCS1_E_OK == ret) {
+        utils_ts_gettime(t1);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < CT_TEST_BENCH); i++) {
+            len = sizeof(buf);
+            ret = rsasp1_ctx(ctx, em, priv.n_len, buf, &len, true);
+        }
+        utils_ts_gettime(t2);
+        usec[1] = fiat_test_usec(t1, t2, t3) / CT_TEST_BENCH;
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Sign em with and without CRT, by the primitive and by the key
+ *        context, and check every signature against ref.
+ *        ref is filled by the first one if it is not yet known.
+ */
+static int ct_test_sign(RSA_TOOLS_PRIV_KEY_t priv, const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *em, uint8_t *ref, size_t *ref_len)
+{
+    int     ret;
+    int     k;
+    size_t  len;
+    uint8_t buf[PKCS1_MAX_N_LEN];
+
+    ret = PKCS1_E_OK;
+    for (k = 0; (PKCS1_E_OK == ret) && (k < 4); k++) {
+        len = (2 > k) ? priv.n_len : sizeof(buf);
+        ret = (2 > k) ? rsasp1(priv, (uint8_t *)em, priv.n_len, buf, &len, (0 != (k % 2))) :
+                        rsasp1_ctx(ctx, em, priv.n_len, buf, &len, (0 != (k % 2)));
+        if (PKCS1_E_OK != ret) {
+            /* Error case */
+        }
+        else if (0 == *ref_len) {
+            memcpy(ref, buf, len);
+            *ref_len = len;
+        }
+        else if (!utils_blkcmp(ref, *ref_len, buf, len, true)) {
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief The batch entry points with the private key under the current
+ *        engine: PKCS1_LANES signatures of em by
+ *        pkcs1_rsa_sign_batch_ctx() with and without CRT against ref, and
+ *        rsadp_fiat() of em under both keys of fkey against rsadp().
+ */
+static int ct_test_batch(const RSA_TOOLS_FIAT_KEY_t *fkey, const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *em,
+                         const uint8_t *ref, size_t ref_len)
+{
+    int               ret;
+    int               status[PKCS1_LANES];
+    size_t            i;
+    size_t            len;
+    size_t            n_len;
+    bool              use_crt;
+    uint8_t           buf[PKCS1_MAX_N_LEN];
+    uint8_t           sig[PKCS1_LANES][PKCS1_MAX_N_LEN];
+    PKCS1_SIGN_ITEM_t sitem[PKCS1_LANES];
+    PKCS1_FIAT_ITEM_t fitem[2];
+
+    ret   = PKCS1_E_OK;
+    n_len = fkey->key[0].n_len;
+    for (use_crt = false; PKCS1_E_OK == ret; use_crt = true) {
+        for (i = 0; i < PKCS1_LANES; i++) {
+            sitem[i].msg  = em;
+            sitem[i].mlen = n_len;
+            sitem[i].sig  = sig[i];
+            sitem[i].slen = sizeof(sig[i]);
+        }
+        ret = pkcs1_rsa_sign_batch_ctx(ctx, sitem, PKCS1_LANES, use_crt, status, NULL);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < PKCS1_LANES); i++) {
+            if (!utils_blkcmp(ref, ref_len, sitem[i].sig, sitem[i].slen, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        if (use_crt) {
+            break;
+        }
+    }
+
+    for (i = 0; (PKCS1_E_OK == ret) && (i < 2); i++) {
+        fitem[i].key   = i;
+        fitem[i].emsg  = em;
+        fitem[i].emlen = n_len;
+        fitem[i].msg   = sig[i];
+        fitem[i].mlen  = sizeof(sig[i]);
+    }
+    if (PKCS1_E_OK == ret) {
+        ret = rsadp_fiat(fkey, fitem, 2);
+    }
+    for (i = 0; (PKCS1_E_OK == ret) && (i < 2); i++) {
+        len = n_len;
+        ret = rsadp(fkey->key[i], (uint8_t *)em, n_len, buf, &len, true);
+        if ((PKCS1_E_OK == ret) && !utils_blkcmp(buf, len, fitem[i].msg, fitem[i].mlen, true)) {
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for the constant-time engine of
+ *        pkcs1_const_time_set(). Keys of 1024 to 4096 bit are generated, and
+ *        every signature has to be the same as that of the default engine,
+ *        those of the batch entry points included.
+ *        The benchmark gives the cost of the constant-time engine relative
+ *        to the default one for each key size.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_ct_test()
+{
+    int                  ret;
+    int                  res;
+    int                  mode;
+    size_t               i;
+    size_t               ref_len;
+    const size_t         lens[] = { 128, 256, 384, 512 };
+    uint8_t              em[PKCS1_MAX_N_LEN];
+    uint8_t              ref[PKCS1_MAX_N_LEN];
+    uint64_t             usec[2][2];
+    RSA_TOOLS_FIAT_KEY_t fkey;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+
+    ret = PKCS1_E_OK;
+    printf("Start Constant-time Engine Test (kernel: %s)\n", pkcs1_kernel_name());
+    for (i = 0; i < (sizeof(lens) / sizeof(lens[0])); i++) {
+        printf("%4zu bit: ", lens[i] * 8);
+        ctx = NULL;
+        memset(&fkey, 0, sizeof(fkey));
+        res = pkcs1_fiat_keygen(lens[i], 2, &fkey);
+        if (PKCS1_E_OK == res) {
+            res = pkcs1_ctx_priv_alloc(fkey.key[0], &ctx);
+        }
+        if (PKCS1_E_OK == res) {
+            utils_random(em, lens[i]);
+            em[0]   = 0x00;
+            ref_len = 0;
+        }
+        /* Default engine first, so that it gives the reference. */
+        for (mode = 0; (PKCS1_E_OK == res) && (mode < 2); mode++) {
+            (void)pkcs1_const_time_set(1 == mode);
+            res = ct_test_sign(fkey.key[0], ctx, em, ref, &ref_len);
+            if (PKCS1_E_OK == res) {
+                res = ct_test_batch(&fkey, ctx, em, ref, ref_len);
+            }
+            if (PKCS1_E_OK == res) {
+                res = ct_test_bench(fkey.key[0], ctx, em, usec[mode]);
+            }
+        }
+        (void)pkcs1_const_time_set(false);
+        if (PKCS1_E_OK == res) {
+            printf("OK. rsasp1 CRT %6" PRIu64 " -> %6" PRIu64 " usec (%+4" PRId64 "%%), ctx CRT %6" PRIu64 " -> %6" PRIu64 " usec (%+4" PRId64 "%%)\n",
+                   usec[0][0], usec[1][0], (((int64_t)usec[1][0] - (int64_t)usec[0][0]) * 100) / (int64_t)(usec[0][0] + 1),
+                   usec[0][1], usec[1][1], (((int64_t)usec[1][1] - (int64_t)usec[0][1]) * 100) / (int64_t)(usec[0][1] + 1));
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+        pkcs1_ctx_free(ctx);
+        pkcs1_fiat_key_free(&fkey);
+    }
+    printf("Finish Constant-time Engine Test\n");
+
+    return ret;
+}
+
+#define FAULT_TEST_N_LEN    (256)
+#define FAULT_TEST_BENCH    (50)
+
+static uint8_t fault_test_e[] = { 0x01, 0x00, 0x01 };
+
+/**
+ * @brief Make a two-prime key with e = 65537 out of the primes of a key
+ *        family of pkcs1_fiat_keygen(). d, dP and dQ are written to buf
+ *        (2 * key->n_len bytes) at their full lengths.
+ */
+static bool fault_test_key(RSA_TOOLS_PRIV_KEY_t *key, uint8_t *buf)
+{
+    bool   ret;
+    size_t half;
+    mp_int e, p, q, t, u, d;
+
+    ret  = false;
+    half = key->n_len / 2;
+    if (MP_OKAY == mp_init_multi(&e, &p, &q, &t, &u, &d, NULL)) {
+        if ((MP_OKAY == mp_read_unsigned_bin(&e, fault_test_e, sizeof(fault_test_e))) &&
+            (MP_OKAY == mp_read_unsigned_bin(&p, key->p, key->p_len)) &&
+            (MP_OKAY == mp_read_unsigned_bin(&q, key->q, key->q_len)) &&
+            /* d = e^-1 mod (p - 1)(q - 1) */
+            (MP_OKAY == mp_sub_d(&p, 1, &t)) &&
+            (MP_OKAY == mp_sub_d(&q, 1, &u)) &&
+            (MP_OKAY == mp_mul(&t, &u, &u)) &&
+            (MP_OKAY == mp_invmod(&e, &u, &d)) &&
+            screen_test_write(&d, &buf[0], key->n_len) &&
+            /* dP = d mod (p - 1), dQ = d mod (q - 1) */
+            (MP_OKAY == mp_mod(&d, &t, &u)) &&
+            screen_test_write(&u, &buf[key->n_len], half) &&
+            (MP_OKAY == mp_sub_d(&q, 1, &t)) &&
+            (MP_OKAY == mp_mod(&d, &t, &u)) &&
+            screen_test_write(&u, &buf[key->n_len + half], half)) {
+            key->e      = fault_test_e;
+            key->e_len  = sizeof(fault_test_e);
+            key->d      = &buf[0];
+            key->d_len  = key->n_len;
+            key->dp     = &buf[key->n_len];
+            key->dp_len = half;
+            key->dq     = &buf[key->n_len + half];
+            key->dq_len = half;
+            ret = true;
+        }
+        mp_clear_multi(&e, &p, &q, &t, &u, &d, NULL);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Sign em with CRT by pkcs1_rsa_sign() and pkcs1_rsa_sign_ctx() with
+ *        the current check, and compare both signatures with ref.
+ *        If expect is PKCS1_E_OK, both have to be ref. Otherwise both calls
+ *        have to return expect with a wiped signature, or, if expect is
+ *        PKCS1_E_VERIFY and the check is off, a signature other than ref.
+ */
+static int fault_test_sign(RSA_TOOLS_PRIV_KEY_t priv, const uint8_t *em, const uint8_t *ref, int expect)
+{
+    int                 ret;
+    int                 res;
+    int                 k;
+    size_t              i;
+    size_t              len;
+    uint8_t             buf[PKCS1_MAX_N_LEN];
+    RSA_TOOLS_KEY_CTX_t *ctx;
+
+    ret = pkcs1_ctx_priv_alloc(priv, &ctx);
+    for (k = 0; (PKCS1_E_OK == ret) && (k < 4); k++) {
+        (void)pkcs1_sign_check_set(0 != (k % 2));
+        memset(buf, 0xA5, sizeof(buf));
+        len = priv.n_len;
+        res = (2 > k) ? pkcs1_rsa_sign(priv, (uint8_t *)em, priv.n_len, buf, &len, true) :
+                        pkcs1_rsa_sign_ctx(ctx, em, priv.n_len, buf, &len, true);
+        if (PKCS1_E_OK == expect) {
+            if ((PKCS1_E_OK != res) || !utils_blkcmp(ref, priv.n_len, buf, len, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        else if (0 == (k % 2)) {
+            /* Without the check the fault goes out. */
+            if ((PKCS1_E_OK != res) || utils_blkcmp(ref, priv.n_len, buf, len, true)) {
+                ret = PKCS1_E_VERIFY;
+            }
+        }
+        else if (expect != res) {
+            ret = PKCS1_E_VERIFY;
+        }
+        else {
+            /* The wrong signature never reaches sig. */
+            for (i = 0; i < priv.n_len; i++) {
+                if (0xA5 != buf[i]) {
+                    ret = PKCS1_E_VERIFY;
+                }
+            }
+        }
+    }
+    /* Signed in place, the check must not take the signature for the input. */
+    (void)pkcs1_sign_check_set(true);
+    for (k = 0; (PKCS1_E_OK == ret) && (k < 2); k++) {
+        memcpy(buf, em, priv.n_len);
+        len = priv.n_len;
+        res = (0 == k) ? pkcs1_rsa_sign(priv, buf, priv.n_len, buf, &len, true) :
+                         pkcs1_rsa_sign_ctx(ctx, buf, priv.n_len, buf, &len, true);
+        if (expect != res) {
+            ret = PKCS1_E_VERIFY;
+        }
+        else if (PKCS1_E_OK == expect) {
+            ret = utils_blkcmp(ref, priv.n_len, buf, len, true) ? PKCS1_E_OK : PKCS1_E_VERIFY;
+        }
+        else {
+            ret = utils_blkcmp(em, priv.n_len, buf, priv.n_len, true) ? PKCS1_E_OK : PKCS1_E_VERIFY;
+        }
+    }
+    (void)pkcs1_sign_check_set(false);
+    pkcs1_ctx_free(ctx);
+
+    return ret;
+}
+
+/**
+ * @brief Time FAULT_TEST_BENCH signatures (CRT) of pkcs1_rsa_sign() and
+ *        pkcs1_rsa_sign_ctx() without and with the check.
+ */
+static int fault_test_bench(RSA_TOOLS_PRIV_KEY_t priv, const uint8_t *em, uint64_t usec[2][2])
+{
+    int                 ret;
+    int                 k;
+    size_t              i;
+    size_t              len;
+    uint8_t             buf[PKCS1_MAX_N_LEN];
+    RSA_TOOLS_KEY_CTX_t *ctx;
+    void                *t1;
+    void                *t2;
+    void                *t3;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    if (PKCS1_E_OK == ret) {
+        ret = pkcs1_ctx_priv_alloc(priv, &ctx);
+    }
+    if (PKCS1_E_OK == ret) {
+        for (k = 0; (PKCS1_E_OK == ret) && (k < 4); k++) {
+            (void)pkcs1_sign_check_set(0 != (k % 2));
+            utils_ts_gettime(t1);
+            for (i = 0; (PKCS1_E_OK == ret) && (i < FAULT_TEST_BENCH); i++) {
+                len = priv.n_len;
+                ret = (2 > k) ? pkcs1_rsa_sign(priv, (uint8_t *)em, priv.n_len, buf, &len, true) :
+                                pkcs1_rsa_sign_ctx(ctx, em, priv.n_len, buf, &len, true);
+            }
+            utils_ts_gettime(t2);
+            usec[k / 2][k % 2] = fiat_test_usec(t1, t2, t3) / FAULT_TEST_BENCH;
+        }
+        (void)pkcs1_sign_check_set(false);
+        pkcs1_ctx_free(ctx);
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for the fault check of
+ *        pkcs1_sign_check_set().
+ *        The NIST test vectors are signed with the check, with and without
+ *        CRT. Then qInv and dP of keys with e = 65537 are corrupted: without
+ *        the check a wrong signature has to go out, with it PKCS1_E_VERIFY
+ *        has to be returned and the signature buffer left as it was, when
+ *        signing in place too. The benchmark gives the
+ *        cost of the check relative to the signature for each key.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_fault_test()
+{
+    int                  ret;
+    int                  res;
+    int                  i;
+    int                  k;
+    int                  idx;
+    int                  tv_cnt;
+    size_t               len;
+    uint8_t              buf[PKCS1_MAX_N_LEN];
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    uint8_t              em[PKCS1_MAX_N_LEN];
+    uint8_t              ref[PKCS1_MAX_N_LEN];
+    uint8_t              bad[PKCS1_MAX_N_LEN / 2];
+    uint64_t             usec[2][2];
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_PRIV_KEY_t fault;
+    RSA_TOOLS_FIAT_KEY_t fkey;
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+
+    ret = PKCS1_E_OK;
+    idx = -1;
+    printf("Start Fault Check Test\n");
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; i < tv_cnt; i++) {
+        tv = &(nist_rsasp1_tv_param[i]);
+        if (!tv->e_result) {
+            continue;
+        }
+        printf("Test Vector %02d: ", i);
+        if (0 > idx) {
+            idx = i;
+        }
+        ctx  = NULL;
+        priv = tv->privkey;
+        res  = tv_crt_derive(&priv, crt) ? PKCS1_E_OK : PKCS1_E_INTERNAL;
+        if (PKCS1_E_OK == res) {
+            res = pkcs1_ctx_priv_alloc(priv, &ctx);
+        }
+        /* The derived CRT components are not of full length, so CRT only by the context. */
+        (void)pkcs1_sign_check_set(true);
+        for (k = 0; (PKCS1_E_OK == res) && (k < 3); k++) {
+            memset(buf, 0, sizeof(buf));
+            len = priv.n_len;
+            res = (0 == k) ? pkcs1_rsa_sign(priv, tv->EM, tv->em_len, buf, &len, false) :
+                             pkcs1_rsa_sign_ctx(ctx, tv->EM, tv->em_len, buf, &len, (2 == k));
+            if ((PKCS1_E_OK == res) && !utils_blkcmp(tv->Sig, tv->sig_len, buf, len, true)) {
+                res = PKCS1_E_VERIFY;
+            }
+        }
+        (void)pkcs1_sign_check_set(false);
+        pkcs1_ctx_free(ctx);
+        if (PKCS1_E_OK == res) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+
+    /* A key without e cannot be checked. */
+    printf("Key without e: ");
+    res = PKCS1_E_OK;
+    if (0 <= idx) {
+        tv         = &(nist_rsasp1_tv_param[idx]);
+        priv       = tv->privkey;
+        priv.e     = NULL;
+        priv.e_len = 0;
+        len = priv.n_len;
+        (void)pkcs1_sign_check_set(true);
+        res = pkcs1_rsa_sign(priv, tv->EM, tv->em_len, buf, &len, false);
+        if ((PKCS1_E_PARAM == res) && (PKCS1_E_OK == pkcs1_ctx_priv_alloc(priv, &ctx))) {
+            len = priv.n_len;
+            res = pkcs1_rsa_sign_ctx(ctx, tv->EM, tv->em_len, buf, &len, false);
+            pkcs1_ctx_free(ctx);
+        }
+        (void)pkcs1_sign_check_set(false);
+    }
+    if (PKCS1_E_PARAM == res) {
+        printf("OK.\n");
+    }
+    else {
+        printf("NG. ret=%d\n", res);
+        ret = PKCS1_E_VERIFY;
+    }
+
+    memset(&fkey, 0, sizeof(fkey));
+    res = pkcs1_fiat_keygen(FAULT_TEST_N_LEN, 2, &fkey);
+    if (PKCS1_E_OK != res) {
+        printf("Key generation: NG. ret=%d\n", res);
+        ret = PKCS1_E_VERIFY;
+    }
+    for (i = 0; (PKCS1_E_OK == res) && (i < 3); i++) {
+        if (0 == i) {
+            priv = fkey.key[0];
+            res  = fault_test_key(&priv, crt) ? PKCS1_E_OK : PKCS1_E_INTERNAL;
+        }
+        else {
+            priv = rsa_mprime_tv_param[i - 1].privkey;
+        }
+        if (PKCS1_E_OK == res) {
+            utils_random(em, priv.n_len);
+            em[0] = 0x00;
+            len   = priv.n_len;
+            res   = pkcs1_rsa_sign(priv, em, priv.n_len, ref, &len, true);
+        }
+        printf("%4zu bit, %zu primes: ", priv.n_len * 8, priv.other_cnt + 2);
+        /* One bit flipped in qInv, then in dP. */
+        for (k = 0; (PKCS1_E_OK == res) && (k < 2); k++) {
+            fault = priv;
+            if (0 == k) {
+                memcpy(bad, priv.qinv, priv.qinv_len);
+                bad[priv.qinv_len / 2] ^= 0x10;
+                fault.qinv = bad;
+            }
+            else {
+                memcpy(bad, priv.dp, priv.dp_len);
+                bad[priv.dp_len - 1] ^= 0x02;
+                fault.dp = bad;
+            }
+            res = fault_test_sign(fault, em, ref, PKCS1_E_VERIFY);
+        }
+        if (PKCS1_E_OK == res) {
+            res = fault_test_bench(priv, em, usec);
+        }
+        if (PKCS1_E_OK == res) {
+            printf("OK. sign CRT %6" PRIu64 " -> %6" PRIu64 " usec (%+3" PRId64 "%%), ctx CRT %6" PRIu64 " -> %6" PRIu64 " usec (%+3" PRId64 "%%)\n",
+                   usec[0][0], usec[0][1], (((int64_t)usec[0][1] - (int64_t)usec[0][0]) * 100) / (int64_t)(usec[0][0] + 1),
+                   usec[1][0], usec[1][1], (((int64_t)usec[1][1] - (int64_t)usec[1][0]) * 100) / (int64_t)(usec[1][0] + 1));
+        }
+        else {
+            printf("NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    pkcs1_fiat_key_free(&fkey);
+    printf("Finish Fault Check Test\n");
+
+    return ret;
+}
+
+#define TUNE_TEST_BENCH     (20)
+
+/**
+ * @brief Sign em by the key context with and without CRT, compare both
+ *        signatures with ref, and time TUNE_TEST_BENCH signatures of each.
+ */
+static int tune_test_ctx(const RSA_TOOLS_KEY_CTX_t *ctx, const uint8_t *em, size_t len, const uint8_t *ref, uint64_t *usec)
+{
+    int     ret;
+    int     k;
+    size_t  i;
+    size_t  slen;
+    uint8_t buf[PKCS1_MAX_N_LEN];
+    void    *t1;
+    void    *t2;
+    void    *t3;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    for (k = 0; (PKCS1_E_OK == ret) && (k < 2); k++) {
+        slen = sizeof(buf);
+        ret = rsasp1_ctx(ctx, em, len, buf, &slen, (0 == k));
+        if ((PKCS1_E_OK == ret) && !utils_blkcmp(ref, len, buf, slen, true)) {
+            ret = PKCS1_E_VERIFY;
+        }
+        utils_ts_gettime(t1);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < TUNE_TEST_BENCH); i++) {
+            slen = sizeof(buf);
+            ret = rsasp1_ctx(ctx, em, len, buf, &slen, (0 == k));
+        }
+        utils_ts_gettime(t2);
+        usec[k] = fiat_test_usec(t1, t2, t3) / TUNE_TEST_BENCH;
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for the window autotuner of
+ *        pkcs1_exp_autotune().
+ *        Key contexts built before and after tuning have to give the same
+ *        signatures, and rsasp1() those of the NIST test vectors. The
+ *        benchmark compares the signatures with the static widths to those
+ *        with the tuned ones.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_tune_test()
+{
+    int                  ret;
+    int                  res;
+    int                  i;
+    int                  k;
+    int                  tv_cnt;
+    int                  wsize[2][4];
+    int                  fsize[2][4];
+    size_t               len;
+    uint8_t              buf[PKCS1_MAX_N_LEN];
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    uint8_t              em[3][PKCS1_MAX_N_LEN];
+    uint8_t              ref[3][PKCS1_MAX_N_LEN];
+    uint64_t             usec[2][3][2];
+    uint64_t             tune;
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv[3];
+    RSA_TOOLS_KEY_CTX_t  *ctx;
+    void                 *t1;
+    void                 *t2;
+    void                 *t3;
+
+    ret  = PKCS1_E_OK;
+    tune = 0;
+    printf("Start Window Autotuning Test (kernel: %s)\n", pkcs1_kernel_name());
+
+    /* The first NIST key of 2048 bit, and the multi-prime keys. */
+    tv = NULL;
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; (NULL == tv) && (i < tv_cnt); i++) {
+        if (nist_rsasp1_tv_param[i].e_result) {
+            tv = &(nist_rsasp1_tv_param[i]);
+        }
+    }
+    if (NULL != tv) {
+        priv[0] = tv->privkey;
+    }
+    res = ((NULL != tv) && tv_crt_derive(&priv[0], crt)) ? PKCS1_E_OK : PKCS1_E_INTERNAL;
+    for (i = 0; (PKCS1_E_OK == res) && (i < 3); i++) {
+        if (0 == i) {
+            memcpy(em[0], tv->EM, tv->em_len);
+            memcpy(ref[0], tv->Sig, tv->sig_len);
+        }
+        else {
+            priv[i] = rsa_mprime_tv_param[i - 1].privkey;
+            utils_random(em[i], priv[i].n_len);
+            em[i][0] = 0x00;
+            len = priv[i].n_len;
+            res = rsasp1(priv[i], em[i], priv[i].n_len, ref[i], &len, true);
+        }
+    }
+
+    for (k = 0; (PKCS1_E_OK == res) && (k < 2); k++) {
+        if (1 == k) {
+            t1 = utils_ts_alloc();
+            t2 = utils_ts_alloc();
+            t3 = utils_ts_alloc();
+            res = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+            if (PKCS1_E_OK == res) {
+                utils_ts_gettime(t1);
+                res = pkcs1_exp_autotune(0);
+                utils_ts_gettime(t2);
+                tune = fiat_test_usec(t1, t2, t3);
+            }
+            utils_ts_free(t1);
+            utils_ts_free(t2);
+            utils_ts_free(t3);
+        }
+        for (i = 0; i < 4; i++) {
+            wsize[k][i] = pkcs1_exp_wsize((size_t)512 << i);
+            fsize[k][i] = pkcs1_fbn_exp_wsize((size_t)512 << i);
+            /* The fixed-width numbers are only tuned within their widths. */
+            if ((1 == k) && (PKCS1_FBN_WSIZE_MAX < fsize[k][i]) && (PKCS1_E_OK == res)) {
+                res = PKCS1_E_VERIFY;
+            }
+            fsize[k][i] = (PKCS1_FBN_WSIZE_MAX < fsize[k][i]) ? PKCS1_FBN_WSIZE_MAX : fsize[k][i];
+        }
+        for (i = 0; (PKCS1_E_OK == res) && (i < 3); i++) {
+            res = pkcs1_ctx_priv_alloc(priv[i], &ctx);
+            if (PKCS1_E_OK == res) {
+                res = tune_test_ctx(ctx, em[i], priv[i].n_len, ref[i], usec[k][i]);
+                pkcs1_ctx_free(ctx);
+            }
+            /* The primitive without a context takes the tuned widths too. */
+            if (PKCS1_E_OK == res) {
+                len = priv[i].n_len;
+                res = rsasp1(priv[i], em[i], priv[i].n_len, buf, &len, (0 != i));
+                if ((PKCS1_E_OK == res) && !utils_blkcmp(ref[i], priv[i].n_len, buf, len, true)) {
+                    res = PKCS1_E_VERIFY;
+                }
+            }
+        }
+    }
+    if (PKCS1_E_OK == res) {
+        printf("Autotune: OK. %" PRIu64 " usec\n", tune);
+        for (i = 0; i < 4; i++) {
+            printf("  %4zu bit exponent: window %d -> %d, fixed-width %d -> %d\n", (size_t)512 << i,
+                   wsize[0][i], wsize[1][i], fsize[0][i], fsize[1][i]);
+        }
+        for (i = 0; i < 3; i++) {
+            printf("  %4zu bit, %zu primes: CRT %6" PRIu64 " -> %6" PRIu64 " usec, no CRT %6" PRIu64 " -> %6" PRIu64 " usec\n",
+                   priv[i].n_len * 8, priv[i].other_cnt + 2,
+                   usec[0][i][0], usec[1][i][0], usec[0][i][1], usec[1][i][1]);
+        }
+    }
+    else {
+        printf("NG. ret=%d\n", res);
+        ret = PKCS1_E_VERIFY;
+    }
+    printf("Finish Window Autotuning Test\n");
+
+    return ret;
+}
+
+#define MT_TEST_THREADS_MIN (4)
+#define MT_TEST_THREADS_MAX (64)
+#define MT_TEST_ROUNDS      (2)
+#define MT_TEST_SP_MAX      (64)
+
+typedef struct {
+    RSA_TOOLS_PRIV_KEY_t *crt;      /* CRT keys of the RSASP1 vectors, read only */
+    bool                 *crt_ok;
+    int                  status;
+    size_t               ops;
+} MT_TEST_ARG_t;
+
+/**
+ * @brief Result of one primitive against a NIST test vector. A primitive
+ *        which succeeds has to give the expected value, one which fails has
+ *        to fail on a vector expected to fail.
+ */
+static int mt_test_chk(int res, bool e_result, const uint8_t *ref, size_t ref_len, const uint8_t *buf, size_t len)
+{
+    int ret;
+
+    if (PKCS1_E_OK == res) {
+        ret = utils_blkcmp(ref, ref_len, buf, len, false) ? PKCS1_E_OK : PKCS1_E_VERIFY;
+    }
+    else {
+        ret = e_result ? res : PKCS1_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Run the NIST vectors of RSADP and RSASP1 MT_TEST_ROUNDS times with
+ *        a scratch of this thread. The keys and vectors are shared.
+ */
+static void *mt_test_thread(void *arg)
+{
+    MT_TEST_ARG_t    *mt;
+    PKCS1_SCRATCH_t  *ws;
+    NIST_TV_RSADP_t  *dtv;
+    NIST_TV_RSASP1_t *stv;
+    uint8_t          buf[PKCS1_MAX_N_LEN];
+    size_t           len;
+    int              res;
+    int              round;
+    int              i;
+    int              tv_cnt;
+
+    mt  = (MT_TEST_ARG_t *)arg;
+    res = pkcs1_scratch_alloc(&ws);
+    for (round = 0; (PKCS1_E_OK == res) && (round < MT_TEST_ROUNDS); round++) {
+        tv_cnt = (sizeof(nist_rsadp_tv_param) / sizeof(NIST_TV_RSADP_t));
+        for (i = 0; (PKCS1_E_OK == res) && (i < tv_cnt); i++) {
+            dtv = &(nist_rsadp_tv_param[i]);
+            if (dtv->e_result) {
+                len = dtv->pubkey.n_len;
+                res = mt_test_chk(rsaep_ws(ws, dtv->pubkey, dtv->k, dtv->k_len, buf, &len),
+                                  true, dtv->c, dtv->c_len, buf, len);
+                mt->ops++;
+            }
+            if (PKCS1_E_OK == res) {
+                len = dtv->privkey.n_len;
+                res = mt_test_chk(rsadp_ws(ws, dtv->privkey, dtv->c, dtv->c_len, buf, &len, false),
+                                  dtv->e_result, dtv->k, dtv->k_len, buf, len);
+                mt->ops++;
+            }
+        }
+        tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+        for (i = 0; (PKCS1_E_OK == res) && (i < tv_cnt); i++) {
+            stv = &(nist_rsasp1_tv_param[i]);
+            if (stv->e_result) {
+                len = stv->privkey.n_len;
+                res = mt_test_chk(rsasp1_ws(ws, stv->privkey, stv->EM, stv->em_len, buf, &len, false),
+                                  true, stv->Sig, stv->sig_len, buf, len);
+                mt->ops++;
+                if ((PKCS1_E_OK == res) && (i < MT_TEST_SP_MAX) && mt->crt_ok[i]) {
+                    len = stv->privkey.n_len;
+                    res = mt_test_chk(rsasp1_ws(ws, mt->crt[i], stv->EM, stv->em_len, buf, &len, true),
+                                      true, stv->Sig, stv->sig_len, buf, len);
+                    mt->ops++;
+                }
+            }
+            if (PKCS1_E_OK == res) {
+                len = stv->privkey.n_len;
+                res = mt_test_chk(rsavp1_ws(ws, stv->pubkey, stv->Sig, stv->sig_len, buf, &len),
+                                  stv->e_result, stv->EM, stv->em_len, buf, len);
+                mt->ops++;
+            }
+        }
+    }
+    pkcs1_scratch_free(ws);
+    mt->status = res;
+
+    return NULL;
+}
+
+/**
+ * @brief Run mt_test_thread() on threads at once.
+ *
+ * @param usec[out]     Elapsed time of all threads.
+ * @param ops[out]      Primitives run by all threads.
+ */
+static int mt_test_run(MT_TEST_ARG_t *mt, size_t threads, uint64_t *usec, size_t *ops)
+{
+    int       ret;
+    pthread_t th[MT_TEST_THREADS_MAX];
+    bool      started[MT_TEST_THREADS_MAX];
+    void      *t1;
+    void      *t2;
+    void      *t3;
+    size_t    i;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    if ((NULL == t1) || (NULL == t2) || (NULL == t3)) {
+        ret = PKCS1_E_RESOURCE;
+    }
+    else {
+        ret = PKCS1_E_OK;
+        utils_ts_gettime(t1);
+        for (i = 0; i < threads; i++) {
+            mt[i].status = PKCS1_E_INTERNAL;
+            mt[i].ops    = 0;
+            started[i]   = (0 == pthread_create(&th[i], NULL, mt_test_thread, &mt[i]));
+        }
+        *ops = 0;
+        for (i = 0; i < threads; i++) {
+            if (!started[i]) {
+                ret = PKCS1_E_RESOURCE;
+            }
+            else {
+                pthread_join(th[i], NULL);
+                if (PKCS1_E_OK != mt[i].status) {
+                    ret = mt[i].status;
+                }
+                *ops += mt[i].ops;
+            }
+        }
+        utils_ts_gettime(t2);
+        *usec = fiat_test_usec(t1, t2, t3);
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for the primitives with a scratch
+ *        of each thread.
+ *        The NIST vectors of RSADP and RSASP1 run on every core at once,
+ *        each thread with its own scratch and the keys shared. The
+ *        throughput is compared to that of one thread. The scaling is only
+ *        reported, it depends on the host.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_mt_test()
+{
+    int                  ret;
+    int                  res;
+    long                 cores;
+    size_t               threads;
+    size_t               ops[2];
+    uint64_t             usec[2];
+    uint8_t              buf[PKCS1_MAX_N_LEN];
+    uint8_t              crt_buf[MT_TEST_SP_MAX][PKCS1_MAX_N_LEN * 3];
+    RSA_TOOLS_PRIV_KEY_t crt[MT_TEST_SP_MAX];
+    bool                 crt_ok[MT_TEST_SP_MAX];
+    MT_TEST_ARG_t        mt[MT_TEST_THREADS_MAX];
+    size_t               len;
+    size_t               i;
+    int                  tv_cnt;
+    double               scale;
+
+    ret = PKCS1_E_OK;
+    printf("Start Multi-thread Test\n");
+
+    printf("Test Case 1 (parameters): ");
+    len = sizeof(buf);
+    if ((PKCS1_E_PARAM == pkcs1_scratch_alloc(NULL)) &&
+        (PKCS1_E_PARAM == rsaep_ws(NULL, nist_rsadp_tv_param[0].pubkey, nist_rsadp_tv_param[0].k,
+                                   nist_rsadp_tv_param[0].k_len, buf, &len)) &&
+        (PKCS1_E_PARAM == rsasp1_ws(NULL, nist_rsasp1_tv_param[0].privkey, nist_rsasp1_tv_param[0].EM,
+                                    nist_rsasp1_tv_param[0].em_len, buf, &len, false))) {
+        printf("OK.\n");
+    }
+    else {
+        printf("NG.\n");
+        ret = PKCS1_E_VERIFY;
+    }
+
+    /* The CRT components are derived once, the threads only read them. */
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    if (MT_TEST_SP_MAX < tv_cnt) {
+        tv_cnt = MT_TEST_SP_MAX;
+    }
+    for (i = 0; i < (size_t)tv_cnt; i++) {
+        crt[i]    = nist_rsasp1_tv_param[i].privkey;
+        crt_ok[i] = nist_rsasp1_tv_param[i].e_result && tv_crt_derive(&crt[i], crt_buf[i]);
+    }
+    for (i = 0; i < MT_TEST_THREADS_MAX; i++) {
+        mt[i].crt    = crt;
+        mt[i].crt_ok = crt_ok;
+    }
+
+    cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (1 > cores) {
+        cores = 1;
+    }
+    threads = (MT_TEST_THREADS_MIN > cores) ? MT_TEST_THREADS_MIN : (size_t)cores;
+    if (MT_TEST_THREADS_MAX < threads) {
+        threads = MT_TEST_THREADS_MAX;
+    }
+
+    printf("Test Case 2 (1 thread): ");
+    res = mt_test_run(mt, 1, &usec[0], &ops[0]);
+    printf("%s\n", (PKCS1_E_OK == res) ? "OK." : "NG.");
+    if (PKCS1_E_OK != res) {
+        ret = PKCS1_E_VERIFY;
+    }
+
+    printf("Test Case 3 (%zu threads): ", threads);
+    res = mt_test_run(mt, threads, &usec[1], &ops[1]);
+    printf("%s\n", (PKCS1_E_OK == res) ? "OK." : "NG.");
+    if (PKCS1_E_OK != res) {
+        ret = PKCS1_E_VERIFY;
+    }
+
+    if ((PKCS1_E_OK == ret) && (0 != usec[0]) && (0 != usec[1])) {
+        /* Throughput of all threads over that of one. */
+        scale = ((double)ops[1] / usec[1]) / ((double)ops[0] / usec[0]);
+        printf("  1 thread:  %zu ops %10" PRIu64 " usec\n", ops[0], usec[0]);
+        printf("  %zu threads: %zu ops %10" PRIu64 " usec\n", threads, ops[1], usec[1]);
+        printf("  scaling x%.2f on %ld cores (ideal x%.2f)\n", scale, cores,
+               (double)((threads < (size_t)cores) ? threads : (size_t)cores));
+    }
+    printf("Finish Multi-thread Test\n");
+
+    return ret;
+}
+
+#define SLOT_TEST_KEYS      (3)
+#define SLOT_TEST_READERS   (4)
+#define SLOT_TEST_ROTATIONS (20)
+
+typedef struct {
+    PKCS1_KEY_SLOT_t *slot;
+    atomic_bool      *stop;
+    atomic_size_t    *total;    /* Signatures of all readers. */
+    atomic_size_t    *running;  /* Readers not finished. */
+    int              status;
+    size_t           signs;
+    size_t           keys;      /* Changes of the key seen. */
+    uint64_t         max_usec;  /* Longest signature. */
+} SLOT_TEST_ARG_t;
+
+/**
+ * @brief Sign with the current key of the slot until stopped. A signature
+ *        has to verify with the same context, which is not released while
+ *        the reader is inside.
+ */
+static void *slot_test_thread(void *arg)
+{
+    SLOT_TEST_ARG_t           *st;
+    PKCS1_SLOT_READER_t       *rd;
+    const RSA_TOOLS_KEY_CTX_t *ctx;
+    const RSA_TOOLS_KEY_CTX_t *last;
+    uint8_t                   em[PKCS1_MAX_N_LEN];
+    uint8_t                   sig[PKCS1_MAX_N_LEN];
+    uint8_t                   buf[PKCS1_MAX_N_LEN];
+    size_t                    n_len;
+    size_t                    len;
+    uint64_t                  usec;
+    void                      *t1;
+    void                      *t2;
+    void                      *t3;
+    int                       res;
+
+    st   = (SLOT_TEST_ARG_t *)arg;
+    last = NULL;
+    t1   = utils_ts_alloc();
+    t2   = utils_ts_alloc();
+    t3   = utils_ts_alloc();
+    res  = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    if (PKCS1_E_OK == res) {
+        res = pkcs1_slot_reader_alloc(st->slot, &rd);
+    }
+    if (PKCS1_E_OK == res) {
+        memset(em, 0, sizeof(em));
+        utils_random(&em[PKCS1_MAX_N_LEN - 8], 8);
+        while ((PKCS1_E_OK == res) && !atomic_load(st->stop)) {
+            utils_ts_gettime(t1);
+            ctx   = pkcs1_slot_enter(rd);
+            n_len = pkcs1_ctx_n_len(ctx);
+            len   = sizeof(sig);
+            res   = rsasp1_ctx(ctx, &em[PKCS1_MAX_N_LEN - n_len], n_len, sig, &len, true);
+            if (PKCS1_E_OK == res) {
+                len = sizeof(buf);
+                res = rsavp1_ctx(ctx, sig, n_len, buf, &len);
+            }
+            if ((PKCS1_E_OK == res) && !utils_blkcmp(&em[PKCS1_MAX_N_LEN - n_len], n_len, buf, len, false)) {
+                res = PKCS1_E_VERIFY;
+            }
+            if (ctx != last) {
+                st->keys++;
+                last = ctx;
+            }
+            pkcs1_slot_leave(rd);
+            utils_ts_gettime(t2);
+            usec = fiat_test_usec(t1, t2, t3);
+            if (usec > st->max_usec) {
+                st->max_usec = usec;
+            }
+            st->signs++;
+            atomic_fetch_add(st->total, 1);
+        }
+        pkcs1_slot_reader_free(rd);
+    }
+    atomic_fetch_sub(st->running, 1);
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+    st->status = res;
+
+    return NULL;
+}
+
+/**
+ * @brief Verification Test for key slots.
+ *        A context published while a reader is inside has to outlive it,
+ *        and readers have to keep signing correctly while the keys of the
+ *        NIST test vectors are rotated under them.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_slot_test()
+{
+    int                       ret;
+    int                       res;
+    int                       i;
+    int                       k;
+    int                       tv_cnt;
+    size_t                    left;
+    size_t                    len;
+    uint8_t                   buf[PKCS1_MAX_N_LEN];
+    uint8_t                   crt[SLOT_TEST_KEYS][PKCS1_MAX_N_LEN * 3];
+    NIST_TV_RSASP1_t          *tv[SLOT_TEST_KEYS];
+    RSA_TOOLS_PRIV_KEY_t      priv[SLOT_TEST_KEYS];
+    RSA_TOOLS_KEY_CTX_t       *ctx;
+    const RSA_TOOLS_KEY_CTX_t *cur;
+    PKCS1_KEY_SLOT_t          *slot;
+    PKCS1_SLOT_READER_t       *rd;
+    PKCS1_SLOT_READER_t       *rds[PKCS1_SLOT_READERS + 1];
+    SLOT_TEST_ARG_t           st[SLOT_TEST_READERS];
+    pthread_t                 th[SLOT_TEST_READERS];
+    bool                      started[SLOT_TEST_READERS];
+    atomic_bool               stop;
+    atomic_size_t             total;
+    atomic_size_t             running;
+    size_t                    target;
+
+    ret  = PKCS1_E_OK;
+    slot = NULL;
+    printf("Start Key Slot Test\n");
+
+    /* Keys of the NIST test vectors with CRT. */
+    k = 0;
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; (k < SLOT_TEST_KEYS) && (i < tv_cnt); i++) {
+        tv[k]   = &(nist_rsasp1_tv_param[i]);
+        priv[k] = tv[k]->privkey;
+        if (tv[k]->e_result && tv_crt_derive(&priv[k], crt[k])) {
+            k++;
+        }
+    }
+    res = (SLOT_TEST_KEYS == k) ? PKCS1_E_OK : PKCS1_E_INTERNAL;
+
+    printf("Test Case 1 (parameters): ");
+    if ((PKCS1_E_OK == res) &&
+        (PKCS1_E_PARAM == pkcs1_slot_alloc(NULL, &slot)) &&
+        (PKCS1_E_PARAM == pkcs1_slot_publish(NULL, NULL)) &&
+        (PKCS1_E_PARAM == pkcs1_slot_reader_alloc(NULL, &rd)) &&
+        (NULL == pkcs1_slot_enter(NULL)) &&
+        (0 == pkcs1_slot_reclaim(NULL))) {
+        printf("OK.\n");
+    }
+    else {
+        printf("NG.\n");
+        ret = PKCS1_E_VERIFY;
+    }
+
+    printf("Test Case 2 (publish while inside): ");
+    if (PKCS1_E_OK == res) {
+        res = pkcs1_ctx_priv_alloc(priv[0], &ctx);
+        if (PKCS1_E_OK == res) {
+            res = pkcs1_slot_alloc(ctx, &slot);
+            if (PKCS1_E_OK != res) {
+                pkcs1_ctx_free(ctx);
+            }
+        }
+    }
+    if (PKCS1_E_OK == res) {
+        res = pkcs1_slot_reader_alloc(slot, &rd);
+    }
+    if (PKCS1_E_OK == res) {
+        cur = pkcs1_slot_enter(rd);
+        res = pkcs1_ctx_priv_alloc(priv[1], &ctx);
+        if (PKCS1_E_OK == res) {
+            res = pkcs1_slot_publish(slot, ctx);
+        }
+        /* The old key is still in use, and signs with the old key. */
+        left = pkcs1_slot_reclaim(slot);
+        len  = sizeof(buf);
+        if ((PKCS1_E_OK == res) && (1 == left) && (cur != ctx)) {
+            res = rsasp1_ctx(cur, tv[0]->EM, tv[0]->em_len, buf, &len, true);
+        }
+        else if (PKCS1_E_OK == res) {
+            res = PKCS1_E_VERIFY;
+        }
+        if ((PKCS1_E_OK == res) && !utils_blkcmp(tv[0]->Sig, tv[0]->sig_len, buf, len, false)) {
+            res = PKCS1_E_VERIFY;
+        }
+        pkcs1_slot_leave(rd);
+        if ((PKCS1_E_OK == res) && (0 != pkcs1_slot_reclaim(slot))) {
+            res = PKCS1_E_VERIFY;
+        }
+        /* The new key from now on. */
+        if (PKCS1_E_OK == res) {
+            cur = pkcs1_slot_enter(rd);
+            len = sizeof(buf);
+            res = (cur == ctx) ? rsasp1_ctx(cur, tv[1]->EM, tv[1]->em_len, buf, &len, true) : PKCS1_E_VERIFY;
+            pkcs1_slot_leave(rd);
+        }
+        if ((PKCS1_E_OK == res) && !utils_blkcmp(tv[1]->Sig, tv[1]->sig_len, buf, len, false)) {
+            res = PKCS1_E_VERIFY;
+        }
+        pkcs1_slot_reader_free(rd);
+    }
+    /* All the readers are taken, then one is free again. */
+    for (i = 0; (PKCS1_E_OK == res) && (i < PKCS1_SLOT_READERS); i++) {
+        res = pkcs1_slot_reader_alloc(slot, &rds[i]);
+    }
+    if ((PKCS1_E_OK == res) && (PKCS1_E_RESOURCE != pkcs1_slot_reader_alloc(slot, &rds[i]))) {
+        res = PKCS1_E_VERIFY;
+    }
+    if (PKCS1_E_OK == res) {
+        pkcs1_slot_reader_free(rds[7]);
+        res = pkcs1_slot_reader_alloc(slot, &rds[7]);
+    }
+    for (i = 0; (PKCS1_E_OK == res) && (i < PKCS1_SLOT_READERS); i++) {
+        pkcs1_slot_reader_free(rds[i]);
+    }
+    if (PKCS1_E_OK == res) {
+        printf("OK.\n");
+    }
+    else {
+        printf("NG. ret=%d\n", res);
+        ret = PKCS1_E_VERIFY;
+    }
+
+    printf("Test Case 3 (rotation under %d readers): ", SLOT_TEST_READERS);
+    if (PKCS1_E_OK == res) {
+        atomic_init(&stop, false);
+        atomic_init(&total, 0);
+        atomic_init(&running, SLOT_TEST_READERS);
+        for (i = 0; i < SLOT_TEST_READERS; i++) {
+            memset(&st[i], 0, sizeof(SLOT_TEST_ARG_t));
+            st[i].slot    = slot;
+            st[i].stop    = &stop;
+            st[i].total   = &total;
+            st[i].running = &running;
+            st[i].status  = PKCS1_E_INTERNAL;
+            started[i]    = (0 == pthread_create(&th[i], NULL, slot_test_thread, &st[i]));
+            if (!started[i]) {
+                atomic_fetch_sub(&running, 1);
+            }
+        }
+        for (k = 0; (PKCS1_E_OK == res) && (k < SLOT_TEST_ROTATIONS); k++) {
+            /* Let the readers sign a few times with each key. */
+            target = atomic_load(&total) + SLOT_TEST_READERS;
+            while ((atomic_load(&total) < target) && (0 < atomic_load(&running))) {
+                sched_yield();
+            }
+            res = pkcs1_ctx_priv_alloc(priv[k % SLOT_TEST_KEYS], &ctx);
+            if (PKCS1_E_OK == res) {
+                res = pkcs1_slot_publish(slot, ctx);
+                if (PKCS1_E_OK != res) {
+                    pkcs1_ctx_free(ctx);
+                }
+            }
+        }
+        atomic_store(&stop, true);
+        for (i = 0; i < SLOT_TEST_READERS; i++) {
+            if (!started[i]) {
+                res = PKCS1_E_RESOURCE;
+            }
+            else {
+                pthread_join(th[i], NULL);
+                if ((PKCS1_E_OK == res) && (PKCS1_E_OK != st[i].status)) {
+                    res = st[i].status;
+                }
+            }
+        }
+        left = pkcs1_slot_reclaim(slot);
+        if ((PKCS1_E_OK == res) && (0 != left)) {
+            res = PKCS1_E_VERIFY;
+        }
+    }
+    if (PKCS1_E_OK == res) {
+        printf("OK.\n");
+        for (i = 0; i < SLOT_TEST_READERS; i++) {
+            printf("  reader %d: %zu signatures, %zu keys, longest %" PRIu64 " usec\n",
+                   i, st[i].signs, st[i].keys, st[i].max_usec);
+        }
+    }
+    else {
+        printf("NG. ret=%d\n", res);
+        ret = PKCS1_E_VERIFY;
+    }
+    pkcs1_slot_free(slot);
+    printf("Finish Key Slot Test\n");
+
+    return ret;
+}
+
+#define VCACHE_TEST_TRIPLES (100)
+#define VCACHE_TEST_THREADS (4)
+#define VCACHE_TEST_ROUNDS  (3)
+
+typedef struct {
+    RSA_TOOLS_PUB_KEY_t key;
+    uint8_t             (*em)[PKCS1_MAX_N_LEN];
+    uint8_t             (*sig)[PKCS1_MAX_N_LEN];
+    int                 status;
+} VCACHE_TEST_ARG_t;
+
+/**
+ * @brief Verify all the triples VCACHE_TEST_ROUNDS times.
+ */
+static void *vcache_test_thread(void *arg)
+{
+    VCACHE_TEST_ARG_t *vt;
+    int               res;
+    int               round;
+    int               i;
+
+    vt  = (VCACHE_TEST_ARG_t *)arg;
+    res = PKCS1_E_OK;
+    for (round = 0; (PKCS1_E_OK == res) && (round < VCACHE_TEST_ROUNDS); round++) {
+        for (i = 0; (PKCS1_E_OK == res) && (i < VCACHE_TEST_TRIPLES); i++) {
+            res = pksc1_rsa_verify(vt->key, vt->em[i], vt->key.n_len, vt->sig[i], vt->key.n_len);
+        }
+    }
+    vt->status = res;
+
+    return NULL;
+}
+
+/**
+ * @brief Verify all the triples once.
+ *
+ * @param usec[out]     Elapsed time of one verification.
+ */
+static int vcache_test_all(RSA_TOOLS_PUB_KEY_t key, uint8_t (*em)[PKCS1_MAX_N_LEN], uint8_t (*sig)[PKCS1_MAX_N_LEN], uint64_t *usec)
+{
+    int  ret;
+    int  i;
+    void *t1;
+    void *t2;
+    void *t3;
+
+    t1 = utils_ts_alloc();
+    t2 = utils_ts_alloc();
+    t3 = utils_ts_alloc();
+    ret = ((NULL != t1) && (NULL != t2) && (NULL != t3)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    if (PKCS1_E_OK == ret) {
+        utils_ts_gettime(t1);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < VCACHE_TEST_TRIPLES); i++) {
+            ret = pksc1_rsa_verify(key, em[i], key.n_len, sig[i], key.n_len);
+        }
+        utils_ts_gettime(t2);
+        *usec = fiat_test_usec(t1, t2, t3) / VCACHE_TEST_TRIPLES;
+    }
+    utils_ts_free(t1);
+    utils_ts_free(t2);
+    utils_ts_free(t3);
+
+    return ret;
+}
+
+/**
+ * @brief Verification Test and benchmark for the verification cache of
+ *        pksc1_rsa_verify().
+ *        Only successful verifications may be found again, the cache has to
+ *        stay within its capacity, entries have to expire, and threads have
+ *        to share the cache. Then verifications found in the cache are timed
+ *        against full ones.
+ * 
+ * @return Status of this function.
+ * 
+ * @retval  PKCS1_E_OK      Success.
+ * @retval  PKCS1_E_VERIFY  Some test failed.
+ */
+int pkcs1_vcache_test()
+{
+    int                  ret;
+    int                  res;
+    int                  i;
+    int                  tv_cnt;
+    size_t               len;
+    uint8_t              crt[PKCS1_MAX_N_LEN * 3];
+    uint8_t              (*em)[PKCS1_MAX_N_LEN];
+    uint8_t              (*sig)[PKCS1_MAX_N_LEN];
+    uint8_t              digest[UTILS_SHA256_LEN];
+    uint64_t             usec[2];
+    NIST_TV_RSASP1_t     *tv;
+    RSA_TOOLS_PRIV_KEY_t priv;
+    RSA_TOOLS_PUB_KEY_t  pub;
+    PKCS1_VCACHE_STAT_t  stat;
+    PKCS1_VCACHE_STAT_t  stat2;
+    VCACHE_TEST_ARG_t    vt[VCACHE_TEST_THREADS];
+    pthread_t            th[VCACHE_TEST_THREADS];
+    bool                 started[VCACHE_TEST_THREADS];
+
+    ret = PKCS1_E_OK;
+    printf("Start Verification Cache Test\n");
+
+    /* Signatures of random messages under the first NIST key. */
+    tv = NULL;
+    tv_cnt = (sizeof(nist_rsasp1_tv_param) / sizeof(NIST_TV_RSASP1_t));
+    for (i = 0; (NULL == tv) && (i < tv_cnt); i++) {
+        if (nist_rsasp1_tv_param[i].e_result) {
+            tv = &(nist_rsasp1_tv_param[i]);
+        }
+    }
+    em  = calloc(VCACHE_TEST_TRIPLES, PKCS1_MAX_N_LEN);
+    sig = calloc(VCACHE_TEST_TRIPLES, PKCS1_MAX_N_LEN);
+    res = ((NULL != tv) && (NULL != em) && (NULL != sig)) ? PKCS1_E_OK : PKCS1_E_RESOURCE;
+    if (PKCS1_E_OK == res) {
+        priv = tv->privkey;
+        pub  = tv->pubkey;
+        res  = tv_crt_derive(&priv, crt) ? PKCS1_E_OK : PKCS1_E_INTERNAL;
+    }
+    for (i = 0; (PKCS1_E_OK == res) && (i < VCACHE_TEST_TRIPLES); i++) {
+        (void)utils_random(&em[i][1], pub.n_len - 1);
+        len = pub.n_len;
+        res = rsasp1(priv, em[i], pub.n_len, sig[i], &len, true);
+    }
+    if (PKCS1_E_OK != res) {
+        printf("Error. ret=%d\n", res);
+        ret = PKCS1_E_VERIFY;
+    }
+
+    if (PKCS1_E_OK == ret) {
+        printf("Test Case 1 (parameters): ");
+        pkcs1_vcache_stat(&stat);
+        if ((PKCS1_E_PARAM == pkcs1_vcache_set((size_t)PKCS1_VCACHE_MAX + 1, 0)) && (0 == stat.capacity)) {
+            printf("OK.\n");
+        }
+        else {
+            printf("NG.\n");
+            ret = PKCS1_E_VERIFY;
+        }
+
+        /* A failed verification is never found, and a hit needs the very same triple. */
+        printf("Test Case 2 (hits): ");
+        res = pkcs1_vcache_set(64, 0);
+        if ((PKCS1_E_OK == res) &&
+            (PKCS1_E_OK == pksc1_rsa_verify(pub, tv->EM, tv->em_len, tv->Sig, tv->sig_len)) &&
+            (PKCS1_E_OK == pksc1_rsa_verify(pub, tv->EM, tv->em_len, tv->Sig, tv->sig_len)) &&
+            (PKCS1_E_OK != pksc1_rsa_verify(pub, em[0], pub.n_len, sig[1], pub.n_len)) &&
+            (PKCS1_E_OK != pksc1_rsa_verify(pub, em[0], pub.n_len, sig[1], pub.n_len)) &&
+            (PKCS1_E_OK == pksc1_rsa_verify(pub, em[0], pub.n_len, sig[0], pub.n_len)) &&
+            (PKCS1_E_OK != pksc1_rsa_verify(pub, em[1], pub.n_len, sig[0], pub.n_len))) {
+            pkcs1_vcache_stat(&stat);
+            res = ((64 == stat.capacity) && (1 == stat.hits) && (5 == stat.misses) && (2 == stat.inserts)) ?
+                  PKCS1_E_OK : PKCS1_E_VERIFY;
+        }
+        else {
+            res = PKCS1_E_VERIFY;
+        }
+        /* A digest put in twice, as by two threads at once, takes one entry. */
+        if (PKCS1_E_OK == res) {
+            (void)pkcs1_vcache_key(&pub, em[2], pub.n_len, sig[2], pub.n_len, digest);
+            pkcs1_vcache_insert(digest);
+            pkcs1_vcache_insert(digest);
+            pkcs1_vcache_stat(&stat);
+            res = ((3 == stat.inserts) && (0 == stat.evictions)) ? PKCS1_E_OK : PKCS1_E_VERIFY;
+        }
+        printf("%s\n", (PKCS1_E_OK == res) ? "OK." : "NG.");
+        if (PKCS1_E_OK != res) {
+            ret = PKCS1_E_VERIFY;
+        }
+
+        printf("Test Case 3 (capacity): ");
+        res = pkcs1_vcache_set(64, 0);
+        if (PKCS1_E_OK == res) {
+            res = vcache_test_all(pub, em, sig, &usec[0]);
+        }
+        if (PKCS1_E_OK == res) {
+            res = vcache_test_all(pub, em, sig, &usec[0]);
+        }
+        pkcs1_vcache_stat(&stat);
+        if ((PKCS1_E_OK == res) &&
+            (((VCACHE_TEST_TRIPLES - 64) > stat.evictions) || (64 < stat.hits) ||
+             ((2 * VCACHE_TEST_TRIPLES) != (stat.hits + stat.misses)))) {
+            res = PKCS1_E_VERIFY;
+        }
+        printf("%s\n", (PKCS1_E_OK == res) ? "OK." : "NG.");
+        if (PKCS1_E_OK != res) {
+            ret = PKCS1_E_VERIFY;
+        }
+        printf("  hits %zu, misses %zu, inserts %zu, evictions %zu\n", stat.hits, stat.misses, stat.inserts, stat.evictions);
+
+        printf("Test Case 4 (expiry): ");
+        res = pkcs1_vcache_set(64, 20);
+        for (i = 0; (PKCS1_E_OK == res) && (i < 2); i++) {
+            res = pksc1_rsa_verify(pub, em[0], pub.n_len, sig[0], pub.n_len);
+        }
+        usleep(50000);
+        for (i = 0; (PKCS1_E_OK == res) && (i < 2); i++) {
+            res = pksc1_rsa_verify(pub, em[0], pub.n_len, sig[0], pub.n_len);
+        }
+        pkcs1_vcache_stat(&stat);
+        if ((PKCS1_E_OK == res) &&
+            ((2 != stat.hits) || (2 != stat.misses) || (1 != stat.expired) || (2 != stat.inserts))) {
+            res = PKCS1_E_VERIFY;
+        }
+        printf("%s\n", (PKCS1_E_OK == res) ? "OK." : "NG.");
+        if (PKCS1_E_OK != res) {
+            ret = PKCS1_E_VERIFY;
+        }
+
+        printf("Test Case 5 (%d threads): ", VCACHE_TEST_THREADS);
+        res = pkcs1_vcache_set(1024, 0);
+        for (i = 0; (PKCS1_E_OK == res) && (i < VCACHE_TEST_THREADS); i++) {
+            vt[i].key    = pub;
+            vt[i].em     = em;
+            vt[i].sig    = sig;
+            vt[i].status = PKCS1_E_INTERNAL;
+            started[i]   = (0 == pthread_create(&th[i], NULL, vcache_test_thread, &vt[i]));
+        }
+        for (i = 0; (PKCS1_E_OK == res) && (i < VCACHE_TEST_THREADS); i++) {
+            if (!started[i]) {
+                res = PKCS1_E_RESOURCE;
+            }
+            else {
+                pthread_join(th[i], NULL);
+            }
+            if ((PKCS1_E_OK == res) && (PKCS1_E_OK != vt[i].status)) {
+                res = vt[i].status;
+            }
+        }
+        pkcs1_vcache_stat(&stat);
+        /* No triple takes two entries. */
+        if ((PKCS1_E_OK == res) &&
+            (((VCACHE_TEST_THREADS * VCACHE_TEST_ROUNDS * VCACHE_TEST_TRIPLES) != (stat.hits + stat.misses)) ||
+             ((VCACHE_TEST_TRIPLES + stat.evictions) < stat.inserts))) {
+            res = PKCS1_E_VERIFY;
+        }
+        printf("%s\n", (PKCS1_E_OK == res) ? "OK." : "NG.");
+        if (PKCS1_E_OK != res) {
+            ret = PKCS1_E_VERIFY;
+        }
+        printf("  hits %zu, misses %zu, inserts %zu\n", stat.hits, stat.misses, stat.inserts);
+
+        /* Full verifications, then the same ones from the cache. */
+        res = pkcs1_vcache_set(1024, 0);
+        if (PKCS1_E_OK == res) {
+            res = vcache_test_all(pub, em, sig, &usec[0]);
+        }
+        if (PKCS1_E_OK == res) {
+            res = vcache_test_all(pub, em, sig, &usec[1]);
+        }
+        pkcs1_vcache_stat(&stat2);
+        if ((PKCS1_E_OK == res) && (VCACHE_TEST_TRIPLES == stat2.hits)) {
+            printf("Benchmark: %zu bit, miss %6" PRIu64 " usec, hit %6" PRIu64 " usec\n",
+                   pub.n_len * 8, usec[0], usec[1]);
+        }
+        else {
+            printf("Benchmark: NG. ret=%d\n", res);
+            ret = PKCS1_E_VERIFY;
+        }
+    }
+    (void)pkcs1_vcache_set(0, 0);
+    free(em);
+    free(sig);
+    printf("Finish Verification Cache Test\n");
+
+    return ret;
+}
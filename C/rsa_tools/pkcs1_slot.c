@@ -0,0 +1,314 @@
+/**
+ * @file pkcs1_slot.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Key slot, a key context which may be replaced while it is in use.
+ *        Readers take the current context by pkcs1_slot_enter() and give it
+ *        back by pkcs1_slot_leave(). Neither takes a lock nor waits, a
+ *        reader only announces the epoch it entered at.
+ *        pkcs1_slot_publish() swaps in a new context and retires the old one
+ *        with the epoch it was current in. A retired context is released,
+ *        which clears its key material, once no reader is inside from that
+ *        epoch or an earlier one. Publishing does not wait for readers
+ *        either, the contexts still in use are released by a later
+ *        pkcs1_slot_publish() or pkcs1_slot_reclaim().
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+#include "utils.h"
+
+/* Readers are kept on cache lines of their own, they are written on every operation. */
+#define SLOT_LINE_SIZE  (64)
+
+struct pkcs1_slot_reader {
+    _Alignas(SLOT_LINE_SIZE) _Atomic uint64_t epoch;    /* Epoch entered at, 0 outside. */
+    atomic_bool      used;
+    PKCS1_KEY_SLOT_t *slot;
+};
+
+typedef struct slot_retired {
+    RSA_TOOLS_KEY_CTX_t *ctx;
+    uint64_t            epoch;      /* Last epoch ctx was current in. */
+    struct slot_retired *next;
+} SLOT_RETIRED_t;
+
+struct pkcs1_key_slot {
+    PKCS1_SLOT_READER_t                 readers[PKCS1_SLOT_READERS];
+    _Alignas(SLOT_LINE_SIZE) _Atomic(RSA_TOOLS_KEY_CTX_t *) cur;
+    _Atomic uint64_t                    epoch;      /* Current epoch, from 1. */
+    pthread_mutex_t                     lock;       /* Serializes publishers, protects retired. Readers never take it. */
+    SLOT_RETIRED_t                      *retired;
+};
+
+/**
+ * @brief Release the retired contexts no reader may still use.
+ *        The lock of the slot is held.
+ *
+ * @return  Number of retired contexts left.
+ */
+static size_t slot_reclaim(PKCS1_KEY_SLOT_t *slot)
+{
+    SLOT_RETIRED_t **pp;
+    SLOT_RETIRED_t *r;
+    uint64_t       min;
+    uint64_t       e;
+    size_t         left;
+    size_t         i;
+
+    /* The oldest epoch a reader is inside from. */
+    min = UINT64_MAX;
+    for (i = 0; i < PKCS1_SLOT_READERS; i++) {
+        e = atomic_load(&slot->readers[i].epoch);
+        if ((0 != e) && (e < min)) {
+            min = e;
+        }
+    }
+
+    left = 0;
+    pp   = &slot->retired;
+    while (NULL != *pp) {
+        r = *pp;
+        if (r->epoch < min) {
+            *pp = r->next;
+            pkcs1_ctx_free(r->ctx);
+            free(r);
+        }
+        else {
+            pp = &r->next;
+            left++;
+        }
+    }
+
+    return left;
+}
+
+/**
+ * @brief Allocate a key slot. The slot takes over ctx.
+ *
+ * @param ctx[in]   First key context.
+ * @param slot[out] Key slot.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ */
+int pkcs1_slot_alloc(RSA_TOOLS_KEY_CTX_t *ctx, PKCS1_KEY_SLOT_t **slot)
+{
+    int              ret;
+    PKCS1_KEY_SLOT_t *s;
+    size_t           i;
+
+    if ((NULL == ctx) || (NULL == slot)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        s = aligned_alloc(SLOT_LINE_SIZE, sizeof(PKCS1_KEY_SLOT_t));
+        if (NULL == s) {
+            ret = PKCS1_E_RESOURCE;
+        }
+        else if (0 != pthread_mutex_init(&s->lock, NULL)) {
+            free(s);
+            ret = PKCS1_E_RESOURCE;
+        }
+        else {
+            for (i = 0; i < PKCS1_SLOT_READERS; i++) {
+                atomic_init(&s->readers[i].epoch, 0);
+                atomic_init(&s->readers[i].used, false);
+                s->readers[i].slot = s;
+            }
+            atomic_init(&s->cur, ctx);
+            atomic_init(&s->epoch, 1);
+            s->retired = NULL;
+            *slot = s;
+            ret = PKCS1_E_OK;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Release a key slot, its current context and all retired ones.
+ *        No reader may be inside.
+ *
+ * @param slot[in]  Key slot (NULL is allowed).
+ */
+void pkcs1_slot_free(PKCS1_KEY_SLOT_t *slot)
+{
+    SLOT_RETIRED_t *r;
+
+    if (NULL != slot) {
+        while (NULL != slot->retired) {
+            r = slot->retired;
+            slot->retired = r->next;
+            pkcs1_ctx_free(r->ctx);
+            free(r);
+        }
+        pkcs1_ctx_free(atomic_load(&slot->cur));
+        pthread_mutex_destroy(&slot->lock);
+        free(slot);
+    }
+}
+
+/**
+ * @brief Register a reader of a key slot, one per thread.
+ *
+ * @param slot[in]      Key slot.
+ * @param reader[out]   Reader.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE PKCS1_SLOT_READERS readers are registered.
+ */
+int pkcs1_slot_reader_alloc(PKCS1_KEY_SLOT_t *slot, PKCS1_SLOT_READER_t **reader)
+{
+    int    ret;
+    bool   expect;
+    size_t i;
+
+    if ((NULL == slot) || (NULL == reader)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        ret = PKCS1_E_RESOURCE;
+        for (i = 0; (PKCS1_E_OK != ret) && (i < PKCS1_SLOT_READERS); i++) {
+            expect = false;
+            if (atomic_compare_exchange_strong(&slot->readers[i].used, &expect, true)) {
+                *reader = &slot->readers[i];
+                ret = PKCS1_E_OK;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Unregister a reader. It may not be inside.
+ *
+ * @param reader[in]    Reader (NULL is allowed).
+ */
+void pkcs1_slot_reader_free(PKCS1_SLOT_READER_t *reader)
+{
+    if (NULL != reader) {
+        atomic_store(&reader->epoch, 0);
+        atomic_store(&reader->used, false);
+    }
+}
+
+/**
+ * @brief Take the current key context of a slot.
+ *        The context stays valid until pkcs1_slot_leave(), whatever is
+ *        published in the meantime. A reader does not enter twice.
+ *
+ * @param reader[in]    Reader.
+ * @return              Key context, NULL if reader is NULL.
+ */
+const RSA_TOOLS_KEY_CTX_t *pkcs1_slot_enter(PKCS1_SLOT_READER_t *reader)
+{
+    const RSA_TOOLS_KEY_CTX_t *ctx;
+
+    ctx = NULL;
+    if (NULL != reader) {
+        /* The epoch is announced before the context is read, see pkcs1_slot_publish(). */
+        atomic_store(&reader->epoch, atomic_load(&reader->slot->epoch));
+        ctx = atomic_load(&reader->slot->cur);
+    }
+
+    return ctx;
+}
+
+/**
+ * @brief Give back the key context of pkcs1_slot_enter().
+ *
+ * @param reader[in]    Reader.
+ */
+void pkcs1_slot_leave(PKCS1_SLOT_READER_t *reader)
+{
+    if (NULL != reader) {
+        atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+    }
+}
+
+/**
+ * @brief Publish a new key context in a slot and retire the current one.
+ *        The slot takes over ctx. Readers entering from now on take ctx,
+ *        those inside keep the old one. The retired contexts no reader uses
+ *        any more are released.
+ *        ctx is built by pkcs1_ctx_priv_alloc() or pkcs1_ctx_pub_alloc()
+ *        beforehand, so the readers never wait for the precomputation.
+ *
+ * @param slot[in]  Key slot.
+ * @param ctx[in]   New key context.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE Memory allocation error, ctx is not published.
+ */
+int pkcs1_slot_publish(PKCS1_KEY_SLOT_t *slot, RSA_TOOLS_KEY_CTX_t *ctx)
+{
+    int            ret;
+    SLOT_RETIRED_t *r;
+
+    if ((NULL == slot) || (NULL == ctx)) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        r = malloc(sizeof(SLOT_RETIRED_t));
+        if (NULL == r) {
+            ret = PKCS1_E_RESOURCE;
+        }
+        else {
+            pthread_mutex_lock(&slot->lock);
+            /*
+             * A reader which reads the old context announced its epoch before,
+             * and the epoch is advanced only after the swap. So it is inside
+             * from r->epoch or earlier until it leaves. One which announces
+             * a later epoch reads ctx.
+             */
+            r->ctx     = atomic_exchange(&slot->cur, ctx);
+            r->epoch   = atomic_fetch_add(&slot->epoch, 1);
+            r->next    = slot->retired;
+            slot->retired = r;
+            (void)slot_reclaim(slot);
+            pthread_mutex_unlock(&slot->lock);
+            ret = PKCS1_E_OK;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Release the retired contexts of a slot no reader uses any more.
+ *
+ * @param slot[in]  Key slot.
+ * @return          Number of retired contexts still in use, 0 if slot is NULL.
+ */
+size_t pkcs1_slot_reclaim(PKCS1_KEY_SLOT_t *slot)
+{
+    size_t left;
+
+    left = 0;
+    if (NULL != slot) {
+        pthread_mutex_lock(&slot->lock);
+        left = slot_reclaim(slot);
+        pthread_mutex_unlock(&slot->lock);
+    }
+
+    return left;
+}
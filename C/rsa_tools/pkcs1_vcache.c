@@ -0,0 +1,316 @@
+/**
+ * @file pkcs1_vcache.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Cache of successful verifications of pksc1_rsa_verify().
+ *        An entry is the SHA-256 digest of (n, e, message, signature), with a
+ *        random salt of the cache in front, so a triple which verified once
+ *        is found again without the exponentiation. Failed verifications are
+ *        never cached.
+ *        The cache is split in PKCS1_VCACHE_SHARDS shards by the digest, each
+ *        with its own lock. A shard is a set associative table of
+ *        PKCS1_VCACHE_WAYS ways, the oldest entry of a set is replaced, so
+ *        the cache never grows beyond its capacity.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "pkcs1.h"
+#include "pkcs1_local.h"
+#include "utils.h"
+
+#define PKCS1_VCACHE_SHARDS (16)
+#define PKCS1_VCACHE_WAYS   (4)
+
+typedef struct {
+    uint8_t  digest[UTILS_SHA256_LEN];
+    uint64_t stamp;     /* Time of insertion in msec, 0 for a free entry. */
+} VCACHE_ENTRY_t;
+
+typedef struct {
+    pthread_mutex_t lock;       /* Protects the fields below. */
+    VCACHE_ENTRY_t  *ent;       /* sets * PKCS1_VCACHE_WAYS entries */
+    size_t          hits;
+    size_t          misses;
+    size_t          inserts;
+    size_t          evictions;
+    size_t          expired;
+} VCACHE_SHARD_t;
+
+static VCACHE_SHARD_t *vcache;      /* PKCS1_VCACHE_SHARDS shards, NULL if off */
+static size_t         vcache_sets;  /* Sets of a shard. */
+static uint64_t       vcache_ttl;   /* Lifetime of an entry in msec, 0 for no limit. */
+static uint8_t        vcache_salt[UTILS_SHA256_LEN];
+
+/**
+ * @brief Monotonic time in msec, never 0.
+ */
+static uint64_t vcache_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000) + 1;
+}
+
+/**
+ * @brief Shard and first entry of the set of a digest.
+ */
+static VCACHE_SHARD_t *vcache_set(const uint8_t *digest, VCACHE_ENTRY_t **set)
+{
+    VCACHE_SHARD_t *shard;
+    uint64_t       h;
+    int            i;
+
+    h = 0;
+    for (i = 0; i < 8; i++) {
+        h = (h << 8) | digest[i + 1];
+    }
+    shard = &vcache[digest[0] % PKCS1_VCACHE_SHARDS];
+    *set  = &shard->ent[(h % vcache_sets) * PKCS1_VCACHE_WAYS];
+
+    return shard;
+}
+
+/**
+ * @brief Release the first cnt shards of the cache and the cache.
+ */
+static void vcache_free(size_t cnt)
+{
+    size_t i;
+
+    if (NULL != vcache) {
+        for (i = 0; i < cnt; i++) {
+            free(vcache[i].ent);
+            pthread_mutex_destroy(&vcache[i].lock);
+        }
+        free(vcache);
+        vcache = NULL;
+    }
+}
+
+/**
+ * @brief Set up the verification cache of pksc1_rsa_verify().
+ *        Any cache before is dropped with its counters. The capacity is
+ *        rounded up to a multiple of PKCS1_VCACHE_SHARDS * PKCS1_VCACHE_WAYS.
+ *        An entry older than ttl_msec is not used any more. Call it before
+ *        other threads use this module.
+ *
+ * @param capacity[in]  Max number of entries, 0 to turn the cache off.
+ * @param ttl_msec[in]  Lifetime of an entry in msec, 0 for no limit.
+ * @return              Status of this function.
+ *
+ * @retval PKCS1_E_OK       Success.
+ * @retval PKCS1_E_PARAM    Invalid parameter.
+ * @retval PKCS1_E_RESOURCE Memory allocation error, the cache is off.
+ * @retval PKCS1_E_INTERNAL Internal Error, the cache is off.
+ */
+int pkcs1_vcache_set(size_t capacity, uint64_t ttl_msec)
+{
+    int    ret;
+    size_t sets;
+    size_t ready;
+
+    if (PKCS1_VCACHE_MAX < capacity) {
+        ret = PKCS1_E_PARAM;
+    }
+    else {
+        vcache_free(PKCS1_VCACHE_SHARDS);
+        ret = PKCS1_E_OK;
+        if (0 < capacity) {
+            sets  = (capacity + (PKCS1_VCACHE_SHARDS * PKCS1_VCACHE_WAYS) - 1) / (PKCS1_VCACHE_SHARDS * PKCS1_VCACHE_WAYS);
+            ready = 0;
+            vcache = calloc(PKCS1_VCACHE_SHARDS, sizeof(VCACHE_SHARD_t));
+            if (NULL == vcache) {
+                ret = PKCS1_E_RESOURCE;
+            }
+            while ((PKCS1_E_OK == ret) && (ready < PKCS1_VCACHE_SHARDS)) {
+                vcache[ready].ent = calloc(sets * PKCS1_VCACHE_WAYS, sizeof(VCACHE_ENTRY_t));
+                if (NULL == vcache[ready].ent) {
+                    ret = PKCS1_E_RESOURCE;
+                }
+                else if (0 != pthread_mutex_init(&vcache[ready].lock, NULL)) {
+                    free(vcache[ready].ent);
+                    ret = PKCS1_E_RESOURCE;
+                }
+                else {
+                    ready++;
+                }
+            }
+            if ((PKCS1_E_OK == ret) && (UTILS_E_OK != utils_random(vcache_salt, sizeof(vcache_salt)))) {
+                ret = PKCS1_E_INTERNAL;
+            }
+            if (PKCS1_E_OK == ret) {
+                vcache_sets = sets;
+                vcache_ttl  = ttl_msec;
+            }
+            else {
+                vcache_free(ready);
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Get the counters of the verification cache.
+ *
+ * @param stat[out] Counters, all 0 if the cache is off.
+ */
+void pkcs1_vcache_stat(PKCS1_VCACHE_STAT_t *stat)
+{
+    size_t i;
+
+    if (NULL != stat) {
+        memset(stat, 0, sizeof(PKCS1_VCACHE_STAT_t));
+        if (NULL != vcache) {
+            stat->capacity = PKCS1_VCACHE_SHARDS * vcache_sets * PKCS1_VCACHE_WAYS;
+            for (i = 0; i < PKCS1_VCACHE_SHARDS; i++) {
+                pthread_mutex_lock(&vcache[i].lock);
+                stat->hits      += vcache[i].hits;
+                stat->misses    += vcache[i].misses;
+                stat->inserts   += vcache[i].inserts;
+                stat->evictions += vcache[i].evictions;
+                stat->expired   += vcache[i].expired;
+                pthread_mutex_unlock(&vcache[i].lock);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Digest of a verification for the cache.
+ *        The lengths are hashed too, so no two triples share an input.
+ *
+ * @param key[in]       Public Key.
+ * @param digest[out]   Digest of UTILS_SHA256_LEN bytes.
+ * @return              false if the cache is off, digest is not set then.
+ */
+bool pkcs1_vcache_key(const RSA_TOOLS_PUB_KEY_t *key, const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, uint8_t *digest)
+{
+    UTILS_SHA256_t ctx;
+    uint8_t        len[8];
+    const uint8_t  *part[4];
+    size_t         plen[4];
+    int            i;
+    int            j;
+
+    if (NULL != vcache) {
+        part[0] = key->n;
+        plen[0] = key->n_len;
+        part[1] = key->e;
+        plen[1] = key->e_len;
+        part[2] = msg;
+        plen[2] = mlen;
+        part[3] = sig;
+        plen[3] = slen;
+        utils_sha256_init(&ctx);
+        utils_sha256_update(&ctx, vcache_salt, sizeof(vcache_salt));
+        for (i = 0; i < 4; i++) {
+            for (j = 0; j < 8; j++) {
+                len[j] = (uint8_t)((uint64_t)plen[i] >> (56 - (8 * j)));
+            }
+            utils_sha256_update(&ctx, len, sizeof(len));
+            utils_sha256_update(&ctx, part[i], plen[i]);
+        }
+        utils_sha256_final(&ctx, digest);
+    }
+
+    return (NULL != vcache);
+}
+
+/**
+ * @brief Look a digest of pkcs1_vcache_key() up.
+ *
+ * @return  true if the triple verified before.
+ */
+bool pkcs1_vcache_lookup(const uint8_t *digest)
+{
+    bool           ret;
+    VCACHE_SHARD_t *shard;
+    VCACHE_ENTRY_t *set;
+    uint64_t       now;
+    size_t         i;
+
+    ret   = false;
+    now   = vcache_now();
+    shard = vcache_set(digest, &set);
+    pthread_mutex_lock(&shard->lock);
+    for (i = 0; (!ret) && (i < PKCS1_VCACHE_WAYS); i++) {
+        if ((0 != set[i].stamp) && (0 == memcmp(set[i].digest, digest, UTILS_SHA256_LEN))) {
+            if ((0 != vcache_ttl) && (vcache_ttl <= (now - set[i].stamp))) {
+                set[i].stamp = 0;
+                shard->expired++;
+                break;
+            }
+            ret = true;
+        }
+    }
+    if (ret) {
+        shard->hits++;
+    }
+    else {
+        shard->misses++;
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    return ret;
+}
+
+/**
+ * @brief Add the digest of a successful verification.
+ *        If another thread put it in first, that entry is renewed. Else a
+ *        free or expired way of the set is taken, or the oldest entry is
+ *        replaced.
+ */
+void pkcs1_vcache_insert(const uint8_t *digest)
+{
+    VCACHE_SHARD_t *shard;
+    VCACHE_ENTRY_t *set;
+    VCACHE_ENTRY_t *victim;
+    uint64_t       now;
+    size_t         i;
+
+    now   = vcache_now();
+    shard = vcache_set(digest, &set);
+    pthread_mutex_lock(&shard->lock);
+    victim = NULL;
+    for (i = 0; (NULL == victim) && (i < PKCS1_VCACHE_WAYS); i++) {
+        if ((0 != set[i].stamp) && (0 == memcmp(set[i].digest, digest, UTILS_SHA256_LEN))) {
+            victim = &set[i];
+        }
+    }
+    if (NULL == victim) {
+        for (i = 0; i < PKCS1_VCACHE_WAYS; i++) {
+            if (0 == set[i].stamp) {
+                victim = &set[i];
+                break;
+            }
+            if ((0 != vcache_ttl) && (vcache_ttl <= (now - set[i].stamp))) {
+                victim = &set[i];
+                shard->expired++;
+                break;
+            }
+            if ((NULL == victim) || (set[i].stamp < victim->stamp)) {
+                victim = &set[i];
+            }
+        }
+        if (PKCS1_VCACHE_WAYS == i) {
+            shard->evictions++;
+        }
+        memcpy(victim->digest, digest, UTILS_SHA256_LEN);
+        shard->inserts++;
+    }
+    victim->stamp = now;
+    pthread_mutex_unlock(&shard->lock);
+}
@@ -8,22 +8,62 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
-#include <assert.h>
 #include <tommath.h>
 
 #include "pkcs1.h"
+#include "pkcs1_local.h"
 #include "utils.h"
+#include "rsa_tv_mprime.h"
 
 //#define TEST_PKCS1_RSADP        (1)
 //#define TEST_PKCS1_RSASP1       (1)
 //#define TEST_PKCS1_RSA_SIGN     (1)
 //#define TEST_PKCS1_RSA_VERIFY   (1)
+//#define TEST_PKCS1_CTX          (1)
+//#define TEST_PKCS1_FERMAT       (1)
+//#define TEST_PKCS1_BATCH        (1)
+//#define TEST_PKCS1_SCREEN       (1)
+//#define TEST_PKCS1_FIAT         (1)
+//#define TEST_PKCS1_MPRIME       (1)
+//#define TEST_PKCS1_CRT_PAR      (1)
+//#define TEST_PKCS1_BLIND        (1)
+//#define TEST_PKCS1_KERNEL       (1)
+//#define TEST_PKCS1_LANES        (1)
+//#define TEST_PKCS1_FBN          (1)
+//#define TEST_PKCS1_ARENA        (1)
+//#define TEST_PKCS1_BIGMOD       (1)
+//#define TEST_PKCS1_CT           (1)
+//#define TEST_PKCS1_FAULT        (1)
+//#define TEST_PKCS1_TUNE         (1)
+//#define TEST_PKCS1_MT           (1)
+//#define TEST_PKCS1_SLOT         (1)
+//#define TEST_PKCS1_VCACHE       (1)
 
 extern int pkcs1_rsadp_test();
 extern int pkcs1_rsasp1_test();
 extern int pkcs1_rsa_sign_test();
 extern int pkcs1_rsa_verify_test();
+extern int pkcs1_ctx_test();
+extern int pkcs1_fermat_test();
+extern int pkcs1_batch_test();
+extern int pkcs1_screen_test();
+extern int pkcs1_fiat_test();
+extern int pkcs1_mprime_test();
+extern int pkcs1_crt_par_test();
+extern int pkcs1_blind_test();
+extern int pkcs1_kernel_test();
+extern int pkcs1_lanes_test();
+extern int pkcs1_fbn_test();
+extern int pkcs1_arena_test();
+extern int pkcs1_bigmod_test();
+extern int pkcs1_ct_test();
+extern int pkcs1_fault_test();
+extern int pkcs1_tune_test();
+extern int pkcs1_mt_test();
+extern int pkcs1_slot_test();
+extern int pkcs1_vcache_test();
 
 /*
 Theis RSA private key was generated by OpenSSL as the following command.
@@ -148,6 +188,318 @@ uint8_t rsa2048_01_qinv[] = {	/* coefficient */
 };
 
 
+/**
+ * @brief Print an integer in hex with its length.
+ */
+static void rsa_param_dump(const char *label, mp_int *x)
+{
+    static char buf[10000];
+
+    memset(buf, 0, sizeof(buf));
+    mp_tohex(x, buf);
+    printf("%s[%3d]: %s\n", label, mp_unsigned_bin_size(x), buf);
+}
+
+/**
+ * @brief Check a prime and print the result.
+ *
+ * @return  PKCS1_E_OK, PKCS1_E_VERIFY if x is not prime, or the status of
+ *          libtommath.
+ */
+static int rsa_prime_chk(const char *name, const char *sym, mp_int *x)
+{
+    int ret;
+    int result;
+
+    printf("Checking RSA Private %s (%s)... ", name, sym);
+    ret = pkcs1_mp_status(mp_prime_is_prime(x, PRIME_SIZE, &result));
+    if (PKCS1_E_OK != ret) {
+        printf("Error. ret=%d\n", ret);
+    }
+    else if (1 != result) {
+        printf("%s is not prime number.\n", sym);
+        rsa_param_dump("   ", x);
+        ret = PKCS1_E_VERIFY;
+    }
+    else {
+        printf("OK.\n");
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Compare a key component with its calculated value and print the result.
+ *
+ * @param status[in]    Status of libtommath calculating the value.
+ * @return              PKCS1_E_OK, PKCS1_E_VERIFY if the values differ, or
+ *                      the status of libtommath.
+ */
+static int rsa_param_cmp(const char *sym, mp_int *expected, mp_int *calculated, int status)
+{
+    int  ret;
+    char label[32];
+
+    ret = pkcs1_mp_status(status);
+    if (PKCS1_E_OK != ret) {
+        printf("Error. ret=%d\n", ret);
+    }
+    else if (0 != mp_cmp(calculated, expected)) {
+        printf("%s is bad.\n", sym);
+        snprintf(label, sizeof(label), "Expected   %s", sym);
+        rsa_param_dump(label, expected);
+        snprintf(label, sizeof(label), "Calculated %s", sym);
+        rsa_param_dump(label, calculated);
+        ret = PKCS1_E_VERIFY;
+    }
+    else {
+        printf("OK.\n");
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Read all the components of a key.
+ */
+static int rsa_param_read(RSA_TOOLS_PRIV_KEY_t priv, RSA_TOOLS_PUB_KEY_t pub,
+                          mp_int *n, mp_int *e, mp_int *d, mp_int *p, mp_int *q, mp_int *dp, mp_int *dq, mp_int *qinv)
+{
+    int status;
+
+    status = mp_read_unsigned_bin(n, pub.n, (int)pub.n_len);
+    if (MP_OKAY == status) {
+        status = mp_read_unsigned_bin(e, pub.e, (int)pub.e_len);
+    }
+    if (MP_OKAY == status) {
+        status = mp_read_unsigned_bin(d, priv.d, (int)priv.d_len);
+    }
+    if (MP_OKAY == status) {
+        status = mp_read_unsigned_bin(p, priv.p, (int)priv.p_len);
+    }
+    if (MP_OKAY == status) {
+        status = mp_read_unsigned_bin(q, priv.q, (int)priv.q_len);
+    }
+    if (MP_OKAY == status) {
+        status = mp_read_unsigned_bin(dp, priv.dp, (int)priv.dp_len);
+    }
+    if (MP_OKAY == status) {
+        status = mp_read_unsigned_bin(dq, priv.dq, (int)priv.dq_len);
+    }
+    if (MP_OKAY == status) {
+        status = mp_read_unsigned_bin(qinv, priv.qinv, (int)priv.qinv_len);
+    }
+
+    return pkcs1_mp_status(status);
+}
+
+/**
+ * @brief Check the consistency of an RSA key and print the result.
+ *        For a multi-prime key (RFC 8017 3.2), r_i, d_i and t_i of the
+ *        additional primes are checked too, and n and lambda(n) cover all
+ *        the primes.
+ *        Every libtommath call is checked, so the result holds in a build
+ *        with NDEBUG as well.
+ * 
+ * @param priv[in]  RSA Private Key.
+ * @param pub[in]   RSA Public Key.
+ * @return          Status of this function.
+ *
+ * @retval PKCS1_E_OK       The key is consistent.
+ * @retval PKCS1_E_VERIFY   Some component is wrong.
+ * @retval PKCS1_E_RESOURCE Memory allocation error.
+ * @retval PKCS1_E_INTERNAL Internal Error.
+ */
+static int rsa_param_chk(RSA_TOOLS_PRIV_KEY_t priv, RSA_TOOLS_PUB_KEY_t pub)
+{
+    int    ret;
+    int    res;
+    int    status;
+    size_t i;
+    int    result;
+    char   name[32];
+    char   sym[32];
+    mp_int n, e, d, p, q, dp, dq, qinv;
+    mp_int r, d_i, t_i, R;
+    mp_int work, r_minus_1, lambda_n;
+
+    ret = pkcs1_mp_status(mp_init_multi(&n, &e, &d, &p, &q, &dp, &dq, &qinv, NULL));
+    if (PKCS1_E_OK != ret) {
+        return ret;
+    }
+    ret = pkcs1_mp_status(mp_init_multi(&r, &d_i, &t_i, &R, &work, &r_minus_1, &lambda_n, NULL));
+    if (PKCS1_E_OK != ret) {
+        mp_clear_multi(&n, &e, &d, &p, &q, &dp, &dq, &qinv, NULL);
+        return ret;
+    }
+
+    printf("<<< Check RSA Parameters (%d bit, %d primes) >>>\n",
+           (int)(pub.n_len * 8), (int)(priv.other_cnt + 2));
+    ret = rsa_param_read(priv, pub, &n, &e, &d, &p, &q, &dp, &dq, &qinv);
+    if (PKCS1_E_OK == ret) {
+        /* work = p * q * r_3 * ... * r_u */
+        /* lambda(n) = lcm((p - 1), (q - 1), (r_3 - 1), ..., (r_u - 1)) */
+        status = mp_mul(&p, &q, &work);
+        if (MP_OKAY == status) {
+            status = mp_sub_d(&p, 1, &r_minus_1);
+        }
+        if (MP_OKAY == status) {
+            status = mp_sub_d(&q, 1, &lambda_n);
+        }
+        if (MP_OKAY == status) {
+            status = mp_lcm(&r_minus_1, &lambda_n, &lambda_n);
+        }
+        for (i = 0; (MP_OKAY == status) && (i < priv.other_cnt); i++) {
+            status = mp_read_unsigned_bin(&r, priv.other[i].r, (int)priv.other[i].r_len);
+            if (MP_OKAY == status) {
+                status = mp_mul(&work, &r, &work);
+            }
+            if (MP_OKAY == status) {
+                status = mp_sub_d(&r, 1, &r_minus_1);
+            }
+            if (MP_OKAY == status) {
+                status = mp_lcm(&r_minus_1, &lambda_n, &lambda_n);
+            }
+        }
+        ret = pkcs1_mp_status(status);
+    }
+
+    if (PKCS1_E_OK != ret) {
+        printf("Error. ret=%d\n", ret);
+    }
+    else {
+        /* Check p, q, r_i */
+        ret = rsa_prime_chk("prime1", "p", &p);
+        res = rsa_prime_chk("prime2", "q", &q);
+        ret = (PKCS1_E_OK != ret) ? ret : res;
+        for (i = 0; i < priv.other_cnt; i++) {
+            status = mp_read_unsigned_bin(&r, priv.other[i].r, (int)priv.other[i].r_len);
+            snprintf(name, sizeof(name), "prime%d", (int)(i + 3));
+            snprintf(sym, sizeof(sym), "r_%d", (int)(i + 3));
+            res = (MP_OKAY == status) ? rsa_prime_chk(name, sym, &r) : pkcs1_mp_status(status);
+            ret = (PKCS1_E_OK != ret) ? ret : res;
+        }
+
+        /* Check n */
+        printf("Checking RSA Private/Public modulus (n)... ");
+        res = rsa_param_cmp("n", &n, &work, MP_OKAY);
+        ret = (PKCS1_E_OK != ret) ? ret : res;
+
+        /* Check e */
+        printf("Checking RSA Public Exponent (e)... ");
+        res = pkcs1_mp_status(mp_prime_is_prime(&e, PRIME_SIZE, &result));
+        if (PKCS1_E_OK != res) {
+            printf("Error. ret=%d\n", res);
+        }
+        else if (1 != result) {
+            printf("e is not prime number.\n");
+            rsa_param_dump("   e", &e);
+            res = PKCS1_E_VERIFY;
+        }
+        else {
+            printf("OK.\n");
+        }
+        ret = (PKCS1_E_OK != ret) ? ret : res;
+
+        /* Check d */
+        printf("Checking RSA Private Exponent (d)... ");
+        status = mp_gcd(&lambda_n, &e, &work);
+        if ((MP_OKAY == status) && (MP_EQ != mp_cmp_d(&work, 1))) {
+            printf("GCD(lambda_n, e) is not ONE.\n");
+            rsa_param_dump("gcd(lambda_n, e)", &work);
+            ret = (PKCS1_E_OK != ret) ? ret : PKCS1_E_VERIFY;
+        }
+
+        /* d * e = 1 mod lambda(n). d may also be given modulo phi(n). */
+        if (MP_OKAY == status) {
+            status = mp_invmod(&e, &lambda_n, &work);
+        }
+        if (MP_OKAY == status) {
+            status = mp_mulmod(&d, &e, &lambda_n, &R);
+        }
+        if ((MP_OKAY != status) || ((0 != mp_cmp(&work, &d)) && (MP_EQ != mp_cmp_d(&R, 1)))) {
+            res = rsa_param_cmp("d", &d, &work, status);
+            ret = (PKCS1_E_OK != ret) ? ret : res;
+        }
+        else {
+            printf("OK.\n");
+
+            /* Check dp */
+            printf("Checking RSA Private exponent1 (dp)... ");
+            /* dp = d mod (p - 1) */
+            status = mp_sub_d(&p, 1, &r_minus_1);
+            if (MP_OKAY == status) {
+                status = mp_mod(&d, &r_minus_1, &work);
+            }
+            res = rsa_param_cmp("dp", &dp, &work, status);
+            ret = (PKCS1_E_OK != ret) ? ret : res;
+
+            /* Check dq */
+            printf("Checking RSA Private exponent2 (dq)... ");
+            /* dq = d mod (q - 1) */
+            status = mp_sub_d(&q, 1, &r_minus_1);
+            if (MP_OKAY == status) {
+                status = mp_mod(&d, &r_minus_1, &work);
+            }
+            res = rsa_param_cmp("dq", &dq, &work, status);
+            ret = (PKCS1_E_OK != ret) ? ret : res;
+
+            /* Check d_i */
+            for (i = 0; i < priv.other_cnt; i++) {
+                printf("Checking RSA Private exponent%d (d_%d)... ", (int)(i + 3), (int)(i + 3));
+                /* d_i = d mod (r_i - 1) */
+                status = mp_read_unsigned_bin(&r, priv.other[i].r, (int)priv.other[i].r_len);
+                if (MP_OKAY == status) {
+                    status = mp_read_unsigned_bin(&d_i, priv.other[i].d, (int)priv.other[i].d_len);
+                }
+                if (MP_OKAY == status) {
+                    status = mp_sub_d(&r, 1, &r_minus_1);
+                }
+                if (MP_OKAY == status) {
+                    status = mp_mod(&d, &r_minus_1, &work);
+                }
+                snprintf(sym, sizeof(sym), "d_%d", (int)(i + 3));
+                res = rsa_param_cmp(sym, &d_i, &work, status);
+                ret = (PKCS1_E_OK != ret) ? ret : res;
+            }
+        }
+
+        /* Check qinv */
+        printf("Checking RSA Private coefficient (qinv)... ");
+        /* qinv = q^-1 mod p */
+        res = rsa_param_cmp("qinv", &qinv, &work, mp_invmod(&q, &p, &work));
+        ret = (PKCS1_E_OK != ret) ? ret : res;
+
+        /* Check t_i */
+        status = mp_mul(&p, &q, &R);
+        for (i = 0; (MP_OKAY == status) && (i < priv.other_cnt); i++) {
+            printf("Checking RSA Private coefficient%d (t_%d)... ", (int)(i + 3), (int)(i + 3));
+            /* t_i = (r_1 * r_2 * ... * r_(i-1))^-1 mod r_i */
+            status = mp_read_unsigned_bin(&r, priv.other[i].r, (int)priv.other[i].r_len);
+            if (MP_OKAY == status) {
+                status = mp_read_unsigned_bin(&t_i, priv.other[i].t, (int)priv.other[i].t_len);
+            }
+            if (MP_OKAY == status) {
+                status = mp_invmod(&R, &r, &work);
+            }
+            snprintf(sym, sizeof(sym), "t_%d", (int)(i + 3));
+            res = rsa_param_cmp(sym, &t_i, &work, status);
+            ret = (PKCS1_E_OK != ret) ? ret : res;
+            if (MP_OKAY == status) {
+                status = mp_mul(&R, &r, &R);
+            }
+        }
+        res = pkcs1_mp_status(status);
+        ret = (PKCS1_E_OK != ret) ? ret : res;
+    }
+    printf("<<< DONE >>>\n");
+
+    mp_clear_multi(&n, &e, &d, &p, &q, &dp, &dq, &qinv, NULL);
+    mp_clear_multi(&r, &d_i, &t_i, &R, &work, &r_minus_1, &lambda_n, NULL);
+
+    return ret;
+}
+
 int main(int argc, char *argv[])
 {
     int ret;
@@ -160,20 +512,7 @@ int main(int argc, char *argv[])
     size_t               elen;
     size_t               dlen;
 
-    mp_int n;
-	mp_int e;
-	mp_int p;
-	mp_int q;
-	mp_int dp;
-	mp_int dq;
-	mp_int qinv;
-	mp_int d;
-	mp_int work;
-	mp_int p_minus_1;
-	mp_int q_minus_1;
-	mp_int lambda_n;
-	int    result;
-	char buf[10000];
+    int                  i;
 
     ret = PKCS1_E_OK;
 #ifdef TEST_PKCS1_RSADP
@@ -228,191 +567,282 @@ int main(int argc, char *argv[])
     }
 #endif  /* TEST_PKCS1_RSA_VERIFY */
 
+#ifdef TEST_PKCS1_CTX
     if (PKCS1_E_OK != ret) {
         /* Error Exit */
     }
     else {
-        priv.n        = rsa2048_01_n;
-        priv.n_len    = sizeof(rsa2048_01_n);
-        priv.d        = rsa2048_01_d;
-        priv.d_len    = sizeof(rsa2048_01_d);
-        priv.p        = rsa2048_01_p;
-        priv.p_len    = sizeof(rsa2048_01_p);
-        priv.q        = rsa2048_01_q;
-        priv.q_len    = sizeof(rsa2048_01_q);
-        priv.dp       = rsa2048_01_dp;
-        priv.dp_len   = sizeof(rsa2048_01_dp);
-        priv.dq       = rsa2048_01_dq;
-        priv.dq_len   = sizeof(rsa2048_01_dq);
-        priv.qinv     = rsa2048_01_qinv;
-        priv.qinv_len = sizeof(rsa2048_01_qinv);
+        ret = pkcs1_ctx_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
+        }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_CTX */
 
-        pub.n = rsa2048_01_n;
-        pub.n_len = sizeof(rsa2048_01_n);
-        pub.e = rsa2048_01_e;
-        pub.e_len = sizeof(rsa2048_01_e);
+#ifdef TEST_PKCS1_FERMAT
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_fermat_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
+        }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_FERMAT */
 
-        mp_init_multi(&n, &e, &p, &q, &dp, &dq, &qinv, &d, NULL);
-	    mp_init_multi(&work, &p_minus_1, &q_minus_1, &lambda_n, NULL);
-
-	    mp_read_unsigned_bin(&n,    rsa2048_01_n,    sizeof(rsa2048_01_n));
-	    mp_read_unsigned_bin(&e,    rsa2048_01_e,    sizeof(rsa2048_01_e));
-	    mp_read_unsigned_bin(&d,    rsa2048_01_d,    sizeof(rsa2048_01_d));
-	    mp_read_unsigned_bin(&p,    rsa2048_01_p,    sizeof(rsa2048_01_p));
-	    mp_read_unsigned_bin(&q,    rsa2048_01_q,    sizeof(rsa2048_01_q));
-	    mp_read_unsigned_bin(&dp,   rsa2048_01_dp,   sizeof(rsa2048_01_dp));
-	    mp_read_unsigned_bin(&dq,   rsa2048_01_dq,   sizeof(rsa2048_01_dq));
-	    mp_read_unsigned_bin(&qinv, rsa2048_01_qinv, sizeof(rsa2048_01_qinv));
-
-	    mp_clear(&work);
-	    mp_clear(&p_minus_1);
-	    mp_clear(&q_minus_1);
-	    mp_clear(&lambda_n);
-
-        printf("<<< Check RSA Parameters >>>\n");
-        /* Check p */
-        printf("Checking RSA Private prime1 (p)... ");
-        assert(MP_OKAY == mp_prime_is_prime(&p, PRIME_SIZE, &result));
-        if (1 != result) {
-            printf("p is not prime number.\n");
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&p, buf);
-            printf("   p[%3d]: %s\n", mp_unsigned_bin_size(&p), buf);
+#ifdef TEST_PKCS1_BATCH
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_batch_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
-        else {
-            printf("OK.\n");
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_BATCH */
+
+#ifdef TEST_PKCS1_SCREEN
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_screen_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_SCREEN */
 
-        /* Check q */
-        printf("Checking RSA Private prime2 (q)... ");
-        assert(MP_OKAY == mp_prime_is_prime(&q, PRIME_SIZE, &result));
-        if (1 != result) {
-            printf("q is not prime number.\n");
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&q, buf);
-            printf("   q[%3d]: %s\n", mp_unsigned_bin_size(&q), buf);
+#ifdef TEST_PKCS1_FIAT
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_fiat_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
-        else {
-            printf("OK.\n");
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_FIAT */
+
+#ifdef TEST_PKCS1_MPRIME
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_mprime_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_MPRIME */
 
-        /* Check n */
-        printf("Checking RSA Private/Public modulus (n)... ");
-        /* n = p * q */
-        assert(MP_OKAY == mp_mul(&p, &q, &work));
-        if (0 != mp_cmp(&work, &n)) {
-            printf("n is bad.n\n");
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&n, buf);
-            printf("Expected   n[%3d]: %s\n", mp_unsigned_bin_size(&n), buf);
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&work, buf);
-            printf("Calculated n[%3d]: %s\n", mp_unsigned_bin_size(&work), buf);
+#ifdef TEST_PKCS1_CRT_PAR
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_crt_par_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
-        else {
-            printf("OK.\n");
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_CRT_PAR */
+
+#ifdef TEST_PKCS1_BLIND
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_blind_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_BLIND */
 
-        /* lambda(n) = lcm((p - 1), (q - 1)) */
-        assert(MP_OKAY == mp_sub_d(&p, 1, &p_minus_1));
-        assert(MP_OKAY == mp_sub_d(&q, 1, &q_minus_1));
-        assert(MP_OKAY == mp_lcm(&p_minus_1, &q_minus_1, &lambda_n));
+#ifdef TEST_PKCS1_KERNEL
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_kernel_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
+        }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_KERNEL */
 
-        /* Check e */
-        printf("Checking RSA Public Exponent (e)... ");
-        assert(MP_OKAY == mp_prime_is_prime(&e, PRIME_SIZE, &result));
-        if (1 != result) {
-            printf("e is not prime number.\n");
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&e, buf);
-            printf("   e[%3d]: %s\n", mp_unsigned_bin_size(&e), buf);
+#ifdef TEST_PKCS1_LANES
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_lanes_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
-        else {
-            printf("OK.\n");
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_LANES */
+
+#ifdef TEST_PKCS1_FBN
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_fbn_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_FBN */
 
-        /* Check e */
-        printf("Checking RSA Private Exponent (d)... ");
-        mp_clear(&work);
-        assert(MP_OKAY == mp_gcd(&lambda_n, &e, &work));
-        if (MP_EQ != mp_cmp_d(&work, 1)) {
-            printf("GCD(lambda_n, e) is not ONE.\n");
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&work, buf);
-            printf("gcd(lambda_n, e):    %s\n", buf);
-        }
-
-        /* d * e = 1 mod lambda(n) */
-        mp_clear(&work);
-        assert(MP_OKAY == mp_invmod(&e, &lambda_n, &work));
-        if (0 != mp_cmp(&work, &d)) {
-            printf("d is bad.n\n");
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&d, buf);
-            printf("Expected   d[%3d]: %s\n", mp_unsigned_bin_size(&d), buf);
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&work, buf);
-            printf("Calculated d[%3d]: %s\n", mp_unsigned_bin_size(&work), buf);
+#ifdef TEST_PKCS1_ARENA
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_arena_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
-        else {
-            printf("OK.\n");
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_ARENA */
 
-            /* Check dp */
-            printf("Checking RSA Private exponent1 (dp)... ");
-            /* dp = d mod (p - 1) */
-            mp_clear(&work);
-            assert(MP_OKAY == mp_mod(&d, &p_minus_1, &work));
-            if (0 != mp_cmp(&work, &dp)) {
-                printf("dp is bad.n\n");
-                memset(buf, 0, sizeof(buf));
-                mp_tohex(&dp, buf);
-                printf("Expected   dp[%3d]: %s\n", mp_unsigned_bin_size(&dp), buf);
-                memset(buf, 0, sizeof(buf));
-                mp_tohex(&work, buf);
-                printf("Calculated dp[%3d]: %s\n", mp_unsigned_bin_size(&work), buf);
-            }
-            else {
-                printf("OK.\n");
-            }
+#ifdef TEST_PKCS1_BIGMOD
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_bigmod_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
+        }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_BIGMOD */
 
-            /* Check dp */
-            printf("Checking RSA Private exponent2 (dq)... ");
-            /* dq = d mod (q - 1) */
-            mp_clear(&work);
-            assert(MP_OKAY == mp_mod(&d, &q_minus_1, &work));   
-            if (0 != mp_cmp(&work, &dq)) {
-                printf("dq is bad.n\n");
-                memset(buf, 0, sizeof(buf));
-                mp_tohex(&dp, buf);
-                printf("Expected   dq[%3d]: %s\n", mp_unsigned_bin_size(&dq), buf);
-                memset(buf, 0, sizeof(buf));
-                mp_tohex(&work, buf);
-                printf("Calculated dq[%3d]: %s\n", mp_unsigned_bin_size(&work), buf);
-            }
-            else {
-                printf("OK.\n");
-            }
+#ifdef TEST_PKCS1_CT
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_ct_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_CT */
 
-        /* Check qinv */
-        printf("Checking RSA Private coefficient (qinv)... ");
-        /* qinv = q^-1 mod p */
-        mp_clear(&work);
-        assert(MP_OKAY == mp_invmod(&q, &p, &work));
-        if (0 != mp_cmp(&work, &qinv)) {
-            printf("dinv is bad.n\n");
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&qinv, buf);
-            printf("  Expected qinv[%3d]: %s\n", mp_unsigned_bin_size(&qinv), buf);
-            memset(buf, 0, sizeof(buf));
-            mp_tohex(&work, buf);
-            printf("Calculated qinv[%3d]: %s\n", mp_unsigned_bin_size(&work), buf);
+#ifdef TEST_PKCS1_FAULT
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_fault_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
         }
-        else {
-            printf("OK.\n");
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_FAULT */
+
+#ifdef TEST_PKCS1_TUNE
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_tune_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
+        }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_TUNE */
+
+#ifdef TEST_PKCS1_MT
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_mt_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
+        }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_MT */
+
+#ifdef TEST_PKCS1_SLOT
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_slot_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
+        }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_SLOT */
+
+#ifdef TEST_PKCS1_VCACHE
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        ret = pkcs1_vcache_test();
+        if (PKCS1_E_OK != ret) {
+            printf("Error.  ret=%d\n", ret);
+        }
+        printf("\n");
+    }
+#endif  /* TEST_PKCS1_VCACHE */
+
+    if (PKCS1_E_OK != ret) {
+        /* Error Exit */
+    }
+    else {
+        priv.n        = rsa2048_01_n;
+        priv.n_len    = sizeof(rsa2048_01_n);
+        priv.d        = rsa2048_01_d;
+        priv.d_len    = sizeof(rsa2048_01_d);
+        priv.p        = rsa2048_01_p;
+        priv.p_len    = sizeof(rsa2048_01_p);
+        priv.q        = rsa2048_01_q;
+        priv.q_len    = sizeof(rsa2048_01_q);
+        priv.dp       = rsa2048_01_dp;
+        priv.dp_len   = sizeof(rsa2048_01_dp);
+        priv.dq       = rsa2048_01_dq;
+        priv.dq_len   = sizeof(rsa2048_01_dq);
+        priv.qinv     = rsa2048_01_qinv;
+        priv.qinv_len = sizeof(rsa2048_01_qinv);
+
+        pub.n = rsa2048_01_n;
+        pub.n_len = sizeof(rsa2048_01_n);
+        pub.e = rsa2048_01_e;
+        pub.e_len = sizeof(rsa2048_01_e);
+
+        ret = rsa_param_chk(priv, pub);
+        for (i = 0; (PKCS1_E_OK == ret) && (i < (int)(sizeof(rsa_mprime_tv_param) / sizeof(RSA_TV_MPRIME_t))); i++) {
+            ret = rsa_param_chk(rsa_mprime_tv_param[i].privkey, rsa_mprime_tv_param[i].pubkey);
         }
-        printf("<<< DONE >>>\n");
    }
 
-    return 0;
+    return (PKCS1_E_OK == ret) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
\ No newline at end of file
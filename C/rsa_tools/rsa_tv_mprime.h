@@ -0,0 +1,435 @@
+/**
+ * @file rsa_tv_mprime.h
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Multi-prime RSA keys (RFC 8017 3.2, u > 2) for test.
+ *        These keys were generated by OpenSSL as the following commands.
+ *        $ openssl genpkey -algorithm RSA -pkeyopt rsa_keygen_bits:3072 -pkeyopt rsa_keygen_primes:3
+ *        $ openssl genpkey -algorithm RSA -pkeyopt rsa_keygen_bits:4096 -pkeyopt rsa_keygen_primes:4
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+#ifndef __RSA_TV_MPRIME_H__
+#define __RSA_TV_MPRIME_H__
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pkcs1.h"
+
+typedef struct {
+    RSA_TOOLS_PRIV_KEY_t    privkey;
+    RSA_TOOLS_PUB_KEY_t     pubkey;
+} RSA_TV_MPRIME_t;
+
+/*
+ * RSA 3072 bit, 3 primes
+ */
+static uint8_t rsa3072_3p_n[] = {	/* modulus */
+    0xa3, 0x87, 0xf2, 0xf9, 0x43, 0x27, 0x68, 0x25, 0x33, 0x88, 0x69, 0xd2, 0x8a, 0x36, 0x01, 0xfc, 
+    0x9f, 0xbe, 0x0a, 0xa7, 0xd6, 0xcd, 0x42, 0x41, 0xa7, 0x50, 0x95, 0xe9, 0x5e, 0xb9, 0xa8, 0x0e, 
+    0x06, 0x69, 0xd5, 0x15, 0x67, 0x55, 0x65, 0x2f, 0x59, 0x41, 0x9a, 0x6b, 0xc9, 0x64, 0x00, 0xaa, 
+    0x64, 0x9f, 0x1d, 0xd1, 0x94, 0x54, 0x09, 0x9b, 0x96, 0x69, 0x4b, 0x27, 0x67, 0x51, 0x37, 0xd6, 
+    0x04, 0x3d, 0x41, 0x77, 0x22, 0x5c, 0x5e, 0x79, 0x6d, 0x99, 0xff, 0xea, 0x39, 0x1b, 0x91, 0xf9, 
+    0xaa, 0x35, 0x79, 0xef, 0x39, 0xc1, 0x9a, 0x74, 0x99, 0x31, 0x39, 0x16, 0x47, 0x04, 0x3b, 0xfd, 
+    0x9e, 0x7e, 0x5a, 0xb2, 0x03, 0x55, 0x1e, 0x82, 0xd0, 0xe1, 0x4d, 0xcc, 0xa3, 0x64, 0x96, 0x92, 
+    0xc9, 0x1e, 0x17, 0xa0, 0xbd, 0x98, 0x91, 0x88, 0xdb, 0xa4, 0xd4, 0x99, 0xbd, 0xbc, 0x9c, 0x64, 
+    0x9a, 0xd7, 0x2c, 0x60, 0x0f, 0x0f, 0x42, 0x52, 0x4c, 0xeb, 0xe5, 0xf1, 0x9d, 0xfc, 0x42, 0xd8, 
+    0xd3, 0xc1, 0x4c, 0x27, 0x7a, 0x94, 0xda, 0x79, 0xec, 0xde, 0xeb, 0x6f, 0x19, 0x7e, 0xf6, 0x4b, 
+    0x01, 0x2d, 0x6f, 0xa1, 0x0b, 0x96, 0xf9, 0x41, 0xb2, 0xa8, 0x82, 0x05, 0x8c, 0xa0, 0x04, 0x0c, 
+    0x87, 0xe6, 0x7f, 0xa7, 0x71, 0x0a, 0xf7, 0xfa, 0xa4, 0x38, 0x11, 0x26, 0x4e, 0xcc, 0x6a, 0x73, 
+    0xa5, 0xab, 0xe3, 0xf7, 0xe6, 0x05, 0x2c, 0x46, 0x30, 0xe6, 0x9e, 0x9a, 0x8f, 0xb9, 0x21, 0x21, 
+    0xf5, 0xee, 0x87, 0x8c, 0xdf, 0xf1, 0x5c, 0xe1, 0x5d, 0x36, 0x4e, 0xde, 0x03, 0xf7, 0x90, 0x89, 
+    0x3e, 0x37, 0xc2, 0x32, 0x79, 0xcf, 0xed, 0x53, 0xc9, 0xaa, 0xdd, 0x41, 0xa4, 0x0f, 0x3e, 0x48, 
+    0xf8, 0xab, 0xc5, 0x4a, 0x20, 0x54, 0x4c, 0xda, 0x2e, 0x10, 0x0d, 0x3b, 0x3b, 0x1e, 0x42, 0x16, 
+    0xda, 0xbf, 0xda, 0xc7, 0xd9, 0xa5, 0x5f, 0x1a, 0xaf, 0x64, 0x2f, 0xce, 0x62, 0x4c, 0x84, 0x7a, 
+    0x8d, 0x64, 0xe0, 0x43, 0x3c, 0x58, 0x22, 0x5b, 0xb1, 0xaa, 0x9a, 0x9f, 0xd5, 0xe5, 0xb4, 0x3f, 
+    0xf9, 0x60, 0x10, 0xa2, 0x2a, 0x47, 0xc6, 0xb7, 0x76, 0xc7, 0x6b, 0xa5, 0xd7, 0xd3, 0xc4, 0x3b, 
+    0x11, 0x6c, 0xb2, 0x5e, 0x04, 0x9e, 0x9e, 0x84, 0xc8, 0xa8, 0x58, 0xdd, 0xcd, 0x64, 0xa9, 0x5e, 
+    0x00, 0xfc, 0x14, 0x46, 0x40, 0x0d, 0x1e, 0xe1, 0x3a, 0x03, 0x48, 0x89, 0xe3, 0xa4, 0x92, 0x04, 
+    0xa9, 0xc9, 0xa5, 0xf4, 0xb4, 0x86, 0x87, 0x26, 0x24, 0x38, 0xd9, 0x19, 0x25, 0x37, 0x30, 0xfb, 
+    0x3c, 0xfa, 0xc3, 0x50, 0xa9, 0xed, 0x4f, 0xca, 0xea, 0x23, 0x02, 0x60, 0x8d, 0x4a, 0xb9, 0x03, 
+    0x6e, 0xa2, 0x42, 0xe7, 0x03, 0x0e, 0x8c, 0x13, 0x66, 0x83, 0x5e, 0xab, 0x32, 0x63, 0x55, 0x93, 
+};
+static uint8_t rsa3072_3p_e[] = {	/* publicExponent */
+    0x01, 0x00, 0x01, 
+};
+static uint8_t rsa3072_3p_d[] = {	/* privateExponent */
+    0x6d, 0x98, 0x01, 0xb5, 0x1d, 0x55, 0x3e, 0x8d, 0x97, 0xf0, 0xb7, 0x02, 0xdb, 0x8f, 0x80, 0x5b, 
+    0x5e, 0x6f, 0x0d, 0x53, 0x18, 0x38, 0xad, 0x4b, 0xb4, 0xa6, 0xe4, 0x20, 0xe7, 0x53, 0xc3, 0x15, 
+    0xcb, 0x24, 0x88, 0x22, 0x75, 0x03, 0x1c, 0xf1, 0xd3, 0x7e, 0x8c, 0xcf, 0xe9, 0xc2, 0xf4, 0x53, 
+    0x3d, 0x66, 0x09, 0xa4, 0xd8, 0x24, 0x4d, 0xe0, 0x10, 0xb8, 0x76, 0x1e, 0x6d, 0x36, 0x58, 0x16, 
+    0x3c, 0xf7, 0x14, 0x75, 0x93, 0xf8, 0x95, 0x74, 0x09, 0x88, 0xe8, 0xa2, 0x7f, 0x2d, 0x43, 0xf2, 
+    0x2f, 0x28, 0xf1, 0x93, 0xea, 0x80, 0x1e, 0x54, 0x40, 0x0a, 0x65, 0xf8, 0xd1, 0x15, 0x3c, 0x63, 
+    0x27, 0x22, 0x05, 0x04, 0x42, 0x09, 0x7c, 0x8e, 0x2d, 0x10, 0xa1, 0x84, 0x20, 0x88, 0x9c, 0x04, 
+    0xb9, 0x76, 0x4a, 0x5d, 0x76, 0x52, 0xd6, 0x4e, 0x02, 0xed, 0x7f, 0x71, 0x9d, 0x5f, 0xd6, 0xea, 
+    0x71, 0x95, 0x59, 0x0e, 0xe8, 0x78, 0x1a, 0xbf, 0x3a, 0x22, 0xf6, 0x20, 0x1e, 0x17, 0xbf, 0xcc, 
+    0x5c, 0x60, 0x04, 0x2f, 0xe1, 0x4a, 0xe4, 0xdb, 0x84, 0x80, 0xbc, 0xeb, 0xc5, 0x1c, 0x88, 0x65, 
+    0x83, 0x79, 0x21, 0x22, 0xd5, 0x8a, 0x33, 0x14, 0x0f, 0xda, 0x50, 0x79, 0xe4, 0xc8, 0xc8, 0x31, 
+    0x8a, 0xa1, 0x15, 0x62, 0x48, 0x12, 0xc3, 0x64, 0x1b, 0xd4, 0x1b, 0x56, 0x36, 0xd3, 0x09, 0xa4, 
+    0x47, 0xab, 0xa2, 0xcf, 0xb9, 0x02, 0xe4, 0x9d, 0xa6, 0x6f, 0x22, 0xf2, 0xca, 0x42, 0xf3, 0x6b, 
+    0x9d, 0x96, 0x6e, 0xba, 0x1d, 0x1c, 0x5a, 0xdc, 0x45, 0x19, 0xbf, 0xa5, 0xdd, 0xae, 0xb6, 0xc9, 
+    0x08, 0x15, 0xa7, 0xb5, 0x6b, 0xfa, 0x89, 0x5a, 0x35, 0xa2, 0xfa, 0x5e, 0x21, 0x38, 0xf9, 0xa2, 
+    0xf3, 0xcd, 0xb5, 0x66, 0x7a, 0xbf, 0xd7, 0x08, 0x53, 0xda, 0x50, 0xa7, 0x67, 0x45, 0x7a, 0xc4, 
+    0xe6, 0xd8, 0x7a, 0x28, 0xd6, 0x5d, 0x31, 0x7d, 0xea, 0x76, 0xbb, 0xc8, 0x49, 0x31, 0x33, 0x94, 
+    0xa5, 0x1c, 0x6a, 0x80, 0xae, 0x11, 0x0b, 0x76, 0x33, 0x09, 0xa4, 0xe7, 0xc8, 0x73, 0xc6, 0xa1, 
+    0x85, 0x95, 0x2d, 0x3a, 0x2d, 0xad, 0xa2, 0x8d, 0x04, 0x7f, 0x0a, 0xb2, 0x56, 0x71, 0x03, 0xe1, 
+    0xd6, 0xfe, 0x39, 0x6a, 0xe9, 0x3d, 0xa4, 0x15, 0xe6, 0xb0, 0x01, 0xb2, 0x7d, 0xd4, 0x97, 0xe6, 
+    0x1e, 0x2b, 0x22, 0x82, 0x79, 0x65, 0x94, 0xcd, 0x57, 0x6f, 0x8f, 0x70, 0x9f, 0xd4, 0xa4, 0x0f, 
+    0xe7, 0x13, 0xca, 0x2f, 0x60, 0xae, 0x84, 0x43, 0xe0, 0x75, 0x78, 0xaf, 0x3d, 0x61, 0xb1, 0xcb, 
+    0x1d, 0x1a, 0xb4, 0xbe, 0x9e, 0xee, 0x0b, 0x71, 0x10, 0xab, 0xbc, 0xcf, 0x03, 0x97, 0x1a, 0x89, 
+    0xc4, 0x9f, 0x6c, 0xf7, 0x5f, 0x1a, 0xf8, 0x39, 0xa0, 0x4f, 0x9f, 0x67, 0x68, 0xc1, 0x07, 0x61, 
+};
+static uint8_t rsa3072_3p_p[] = {	/* prime1 */
+    0xd6, 0xc2, 0x44, 0xd2, 0x2d, 0x44, 0x73, 0x29, 0xbb, 0x23, 0x08, 0x46, 0x35, 0x67, 0xee, 0xd1, 
+    0x15, 0x34, 0xeb, 0xda, 0x8c, 0x65, 0x01, 0xe3, 0x57, 0xbe, 0x91, 0x15, 0x87, 0xc2, 0x06, 0x96, 
+    0x89, 0x64, 0x88, 0xf8, 0x0e, 0xa6, 0x98, 0xfb, 0x5c, 0x4a, 0x9b, 0x37, 0x5b, 0xe6, 0xfb, 0xfc, 
+    0xc6, 0xae, 0xd8, 0x9e, 0xa9, 0x83, 0xea, 0xcd, 0xb0, 0x34, 0xc2, 0x57, 0x34, 0x27, 0x05, 0x54, 
+    0x28, 0x66, 0x80, 0x4a, 0xbb, 0xa6, 0x44, 0x53, 0x85, 0xf2, 0xb9, 0x86, 0x36, 0xc3, 0x99, 0x7c, 
+    0x72, 0xf2, 0xdb, 0xdc, 0xc7, 0x25, 0xfb, 0xae, 0x8c, 0x92, 0x04, 0x00, 0xa0, 0x64, 0x0c, 0x12, 
+    0x23, 0xa8, 0xa1, 0x50, 0x7c, 0x82, 0x20, 0x7a, 0x0f, 0xae, 0x9e, 0x4f, 0xc4, 0x9c, 0xd0, 0xa1, 
+    0xa7, 0xb4, 0x72, 0x75, 0x89, 0xc1, 0xaf, 0xa1, 0xf7, 0xc8, 0x0f, 0x24, 0xd1, 0x12, 0x2f, 0x15, 
+};
+static uint8_t rsa3072_3p_q[] = {	/* prime2 */
+    0xc4, 0x69, 0x14, 0x22, 0x08, 0x0a, 0xa9, 0x3c, 0x8c, 0x99, 0xbb, 0x5a, 0x98, 0x5a, 0x43, 0x5f, 
+    0x87, 0x8e, 0x0e, 0x1d, 0x24, 0x27, 0xcd, 0x1d, 0xb4, 0xed, 0x6f, 0x4a, 0xa7, 0xde, 0xed, 0xc6, 
+    0x61, 0x3d, 0xb8, 0x9b, 0xd9, 0x9c, 0x03, 0xc0, 0x2d, 0xfc, 0xeb, 0x7b, 0x20, 0x2b, 0xda, 0x5f, 
+    0x7f, 0xe6, 0x8c, 0x33, 0x85, 0x68, 0xa5, 0xbc, 0x90, 0xac, 0x57, 0x4f, 0x42, 0x4b, 0x7e, 0xd4, 
+    0x11, 0xf5, 0xca, 0x1e, 0xab, 0x6c, 0x97, 0x10, 0xb4, 0xe6, 0xf7, 0x59, 0xa2, 0x4d, 0x33, 0x59, 
+    0xb6, 0x70, 0x53, 0x3f, 0xf0, 0x9a, 0x61, 0xd9, 0x94, 0xda, 0xa0, 0xfb, 0x84, 0x81, 0x95, 0x90, 
+    0x01, 0x1b, 0xae, 0x5e, 0x03, 0x79, 0x4e, 0x4e, 0xa4, 0x33, 0x25, 0xee, 0x78, 0x0f, 0x57, 0x09, 
+    0x20, 0xf4, 0xee, 0x25, 0x41, 0xf4, 0xdf, 0x4b, 0x64, 0x75, 0x65, 0x38, 0x8c, 0xac, 0x16, 0x1d, 
+};
+static uint8_t rsa3072_3p_dp[] = {	/* exponent1 */
+    0xcd, 0xc6, 0x09, 0x01, 0x45, 0xe4, 0x7f, 0x60, 0x2d, 0xf2, 0x2c, 0x3c, 0x71, 0x71, 0xab, 0x8f, 
+    0x64, 0xfd, 0x77, 0x3b, 0xca, 0x28, 0x02, 0x3e, 0x1e, 0x55, 0xf7, 0x58, 0x24, 0xe3, 0x51, 0x42, 
+    0xae, 0x54, 0xc9, 0x34, 0xbd, 0x7c, 0xfd, 0xba, 0x63, 0x3d, 0x0d, 0x2a, 0x67, 0x01, 0x94, 0xd3, 
+    0x28, 0x60, 0x62, 0x28, 0xec, 0x8d, 0xfc, 0xce, 0xa7, 0x16, 0x76, 0x5b, 0xee, 0x19, 0xb1, 0x6e, 
+    0x68, 0xe3, 0x85, 0xeb, 0x95, 0x8f, 0x83, 0x8a, 0x70, 0x1f, 0x19, 0x8a, 0xb3, 0x30, 0x8a, 0x01, 
+    0x87, 0x76, 0x92, 0x1a, 0x22, 0x2b, 0x8f, 0xd3, 0x38, 0xd7, 0xb3, 0xc4, 0x11, 0xea, 0xaa, 0xf2, 
+    0x3a, 0x7e, 0x9a, 0x4a, 0xaf, 0x72, 0x53, 0xc2, 0x01, 0x02, 0xb4, 0xa8, 0x03, 0xe0, 0xa9, 0xbb, 
+    0x2b, 0x20, 0xa8, 0x47, 0x5c, 0xfe, 0x5b, 0xd6, 0x1a, 0xbf, 0xf3, 0x5a, 0xb8, 0x84, 0xee, 0xdd, 
+};
+static uint8_t rsa3072_3p_dq[] = {	/* exponent2 */
+    0xae, 0x5b, 0x21, 0x96, 0x3c, 0x51, 0x4a, 0x7f, 0x07, 0xc9, 0x88, 0xfa, 0x19, 0x79, 0x37, 0x89, 
+    0xdc, 0x4a, 0x0c, 0xd9, 0x6d, 0xb9, 0x2f, 0x6b, 0x09, 0xac, 0x25, 0x39, 0xbe, 0xe0, 0x35, 0x6f, 
+    0xff, 0xee, 0xcc, 0xac, 0xfd, 0x76, 0x74, 0x15, 0xec, 0x3d, 0x33, 0xc5, 0xaf, 0x7f, 0x7e, 0x71, 
+    0x7c, 0x96, 0xeb, 0x2a, 0xe9, 0x69, 0x46, 0x87, 0xa8, 0x5e, 0x75, 0x7b, 0x54, 0xbc, 0xb4, 0x30, 
+    0x0a, 0x69, 0x89, 0x2d, 0xc4, 0xbb, 0xb7, 0x37, 0x0b, 0x80, 0x65, 0x5f, 0xda, 0xa6, 0x71, 0xc9, 
+    0x58, 0x1d, 0x4a, 0xa9, 0xde, 0x2b, 0x0e, 0x66, 0x1a, 0xb0, 0x22, 0x6c, 0x64, 0xea, 0xac, 0x1c, 
+    0x93, 0xff, 0x40, 0xc1, 0x10, 0x90, 0x65, 0x25, 0x86, 0xba, 0x29, 0x18, 0x12, 0xd8, 0x7b, 0x49, 
+    0x0d, 0x4a, 0xa1, 0x05, 0xce, 0x11, 0x55, 0x10, 0x16, 0x73, 0xe8, 0x91, 0x54, 0xbf, 0x87, 0x39, 
+};
+static uint8_t rsa3072_3p_qinv[] = {	/* coefficient */
+    0x08, 0xc8, 0x3a, 0xef, 0x1b, 0xeb, 0x0f, 0x4f, 0x26, 0x40, 0x34, 0xa8, 0xa0, 0xe1, 0xdb, 0x32, 
+    0x07, 0x98, 0xdc, 0xdb, 0xc9, 0xdd, 0x4c, 0xe3, 0xba, 0x51, 0x05, 0xdb, 0xb3, 0x2a, 0xdf, 0x83, 
+    0x57, 0xda, 0x34, 0x99, 0x0e, 0x42, 0x3d, 0xec, 0x22, 0xe8, 0x96, 0x31, 0x00, 0xc0, 0x0c, 0xec, 
+    0x1c, 0xc4, 0x0e, 0xce, 0xd4, 0xd6, 0x81, 0xc3, 0x5f, 0xef, 0xf0, 0x53, 0x46, 0x78, 0xdc, 0xd3, 
+    0x88, 0x11, 0xe1, 0x3b, 0xc2, 0xc7, 0x1a, 0x5f, 0x6e, 0xab, 0x1e, 0xab, 0x05, 0x5b, 0xe2, 0x81, 
+    0xba, 0x07, 0xb7, 0x3f, 0x56, 0xbd, 0xb9, 0xcd, 0x17, 0x20, 0x5b, 0x78, 0x1a, 0xa9, 0xad, 0x5f, 
+    0xfe, 0x01, 0xe8, 0x09, 0xcf, 0xbf, 0xb4, 0x0e, 0x4c, 0x2c, 0xc5, 0x68, 0x80, 0xc5, 0x0e, 0x5b, 
+    0x4b, 0x77, 0xad, 0x6f, 0x37, 0x7e, 0xd3, 0xe5, 0x3f, 0x99, 0xad, 0x3e, 0x66, 0x77, 0xef, 0x6d, 
+};
+static uint8_t rsa3072_3p_r3[] = {	/* prime3 */
+    0xfe, 0x13, 0x93, 0x68, 0x15, 0x39, 0x86, 0x14, 0xc5, 0xf4, 0xed, 0xd8, 0x9b, 0xc6, 0x3e, 0x17, 
+    0x38, 0xb6, 0x10, 0xc9, 0x70, 0x08, 0xd8, 0xfa, 0x1f, 0x48, 0xd7, 0x7d, 0x8e, 0x2c, 0x38, 0x3d, 
+    0x93, 0x13, 0xd9, 0x47, 0x49, 0xed, 0xff, 0xd0, 0x46, 0x73, 0x2c, 0x59, 0x4c, 0x13, 0x67, 0x23, 
+    0xae, 0xec, 0x33, 0x89, 0x56, 0x70, 0x6e, 0x7e, 0xad, 0x44, 0x7f, 0x92, 0x46, 0x13, 0x3f, 0x0f, 
+    0x93, 0x80, 0xb1, 0xe6, 0xdf, 0x7d, 0x3a, 0xeb, 0x16, 0x41, 0xd6, 0x71, 0xf5, 0xed, 0x11, 0x6f, 
+    0xf3, 0xac, 0xa0, 0x8b, 0x69, 0x0b, 0x25, 0xc7, 0xd1, 0x4e, 0x3e, 0x98, 0xc7, 0xb2, 0x9f, 0x59, 
+    0xb6, 0xba, 0x1a, 0xc1, 0x9a, 0x6f, 0xba, 0x32, 0xf2, 0xe1, 0x6f, 0x12, 0x65, 0xe8, 0x65, 0x24, 
+    0xa3, 0x6a, 0xce, 0xa0, 0x74, 0xa6, 0xa9, 0x3f, 0x8e, 0xfc, 0xde, 0xaa, 0x34, 0x65, 0x11, 0x73, 
+};
+static uint8_t rsa3072_3p_d3[] = {	/* exponent3 */
+    0xdc, 0x46, 0x38, 0x7b, 0xfa, 0x3a, 0xbe, 0xe5, 0xef, 0xa1, 0xa3, 0x3b, 0x32, 0x02, 0x32, 0xfe, 
+    0x8a, 0xea, 0x3d, 0xaf, 0x86, 0x74, 0x05, 0x39, 0x04, 0x3a, 0x70, 0xa8, 0xa7, 0xc3, 0xea, 0x96, 
+    0x67, 0x96, 0xc3, 0xbf, 0x2c, 0x77, 0x2c, 0x5b, 0x73, 0x58, 0x92, 0xd0, 0x70, 0x46, 0x3a, 0x1b, 
+    0x13, 0xa2, 0x30, 0x24, 0x17, 0x4e, 0xae, 0x5d, 0x20, 0xf6, 0xcb, 0xeb, 0x12, 0xd9, 0xc8, 0xc8, 
+    0x46, 0x47, 0x42, 0xf5, 0x38, 0x39, 0x28, 0x05, 0x7c, 0x6c, 0x63, 0xf0, 0xb5, 0x17, 0x6d, 0x10, 
+    0xb4, 0x1f, 0xab, 0xa8, 0x71, 0xcf, 0x7a, 0x57, 0xbc, 0x3c, 0xab, 0xc4, 0x65, 0x0d, 0x95, 0x5d, 
+    0x80, 0x2f, 0xe4, 0xd6, 0x88, 0x7f, 0xe8, 0xdc, 0x16, 0xfa, 0x1f, 0x03, 0xc2, 0x5a, 0x32, 0xa6, 
+    0x0b, 0x0f, 0xa4, 0x48, 0x34, 0x19, 0xf1, 0x8d, 0xea, 0xf7, 0x8c, 0x4b, 0xdf, 0xd4, 0xe7, 0xc5, 
+};
+static uint8_t rsa3072_3p_t3[] = {	/* coefficient3 */
+    0x67, 0x11, 0xc9, 0x0d, 0xcd, 0x7b, 0x4f, 0x93, 0x32, 0xbb, 0xe7, 0xb9, 0xb3, 0xba, 0x34, 0xf2, 
+    0x6d, 0x35, 0xc9, 0x15, 0x9f, 0xf0, 0x80, 0x7c, 0xfe, 0xa9, 0xec, 0x8b, 0xe2, 0x8a, 0x59, 0x0e, 
+    0x9c, 0x51, 0xce, 0x3e, 0x75, 0x6d, 0xf0, 0x59, 0x0d, 0x9b, 0xd9, 0x0b, 0x20, 0x5c, 0x9a, 0xc4, 
+    0x4a, 0x0a, 0x85, 0x82, 0x51, 0x89, 0x00, 0x41, 0xc6, 0x2b, 0xe9, 0x4f, 0x4a, 0x68, 0x70, 0xf0, 
+    0x4a, 0x51, 0x2d, 0x66, 0x9b, 0x6d, 0x01, 0x5a, 0xe1, 0x76, 0xe8, 0x80, 0x3b, 0x0c, 0x5d, 0x11, 
+    0x65, 0xae, 0xed, 0xba, 0x1e, 0x99, 0xc2, 0x3f, 0xde, 0x09, 0x6d, 0x7f, 0x78, 0x0d, 0x01, 0x06, 
+    0x34, 0x03, 0x5d, 0xd2, 0x2f, 0xd4, 0x7d, 0x38, 0x64, 0xc6, 0xac, 0x81, 0x85, 0x8d, 0x42, 0x49, 
+    0x3b, 0x8e, 0xd7, 0x7f, 0xe9, 0xe4, 0x65, 0xdb, 0x42, 0x80, 0x24, 0x66, 0xce, 0xed, 0x1e, 0xa0, 
+};
+static RSA_TOOLS_PRIME_INFO_t rsa3072_3p_other[] = {
+    {   /* r_3, d_3, t_3 */
+        rsa3072_3p_r3,
+        rsa3072_3p_d3,
+        rsa3072_3p_t3,
+        sizeof(rsa3072_3p_r3),
+        sizeof(rsa3072_3p_d3),
+        sizeof(rsa3072_3p_t3),
+    },
+};
+
+/*
+ * RSA 4096 bit, 4 primes
+ */
+static uint8_t rsa4096_4p_n[] = {	/* modulus */
+    0x97, 0xbc, 0xc0, 0xcd, 0x56, 0xdc, 0x46, 0xab, 0xa1, 0x7b, 0x95, 0x9c, 0xe9, 0x04, 0x37, 0x27, 
+    0xbf, 0x74, 0xdc, 0xb2, 0xa6, 0x5c, 0x8d, 0xc2, 0x92, 0x4d, 0xbd, 0xa7, 0x2f, 0xb7, 0x43, 0x77, 
+    0xcf, 0x9c, 0x01, 0xba, 0x09, 0xc2, 0xa5, 0x45, 0x52, 0xa3, 0xe8, 0xf0, 0x5c, 0x0d, 0x1b, 0x39, 
+    0xc6, 0x2d, 0x22, 0x7c, 0x9f, 0xa5, 0xb7, 0x1f, 0x2e, 0x4f, 0xe5, 0xbb, 0xe8, 0xb0, 0x29, 0xfe, 
+    0xa5, 0xd2, 0x02, 0xd1, 0x58, 0x33, 0x55, 0xb1, 0xf5, 0x8f, 0xb3, 0x0b, 0xa0, 0x35, 0xc5, 0x88, 
+    0x1b, 0xa0, 0xe8, 0x2c, 0xbb, 0xa4, 0x18, 0x85, 0x75, 0x9f, 0xf4, 0x54, 0xf5, 0x13, 0x45, 0xa8, 
+    0xf6, 0x4c, 0x00, 0x16, 0x21, 0x9a, 0x6c, 0x60, 0xc4, 0x33, 0x6f, 0x37, 0x20, 0x03, 0x2c, 0xa3, 
+    0x6d, 0x7c, 0x6d, 0x32, 0xf9, 0x96, 0x27, 0x3d, 0x10, 0x24, 0xd8, 0xd2, 0x72, 0x52, 0xc7, 0x9f, 
+    0xe9, 0x1c, 0x88, 0xf1, 0xd6, 0xa4, 0xa2, 0xa7, 0x86, 0xd4, 0xbd, 0x08, 0xfa, 0x2d, 0xb6, 0xc2, 
+    0x2f, 0xec, 0x9f, 0x68, 0x08, 0x78, 0xd8, 0x43, 0x84, 0x7f, 0x97, 0xd2, 0x33, 0xf6, 0xa9, 0x27, 
+    0xab, 0xc9, 0x6d, 0x81, 0x13, 0x69, 0x76, 0x4b, 0x99, 0x3e, 0x03, 0xe9, 0x0e, 0x56, 0xfd, 0xd9, 
+    0xc9, 0x1f, 0xbe, 0x23, 0x64, 0xd3, 0x72, 0x74, 0x09, 0xbf, 0xce, 0x4a, 0xe1, 0x81, 0x08, 0x3d, 
+    0x0c, 0x40, 0x2e, 0x5e, 0x02, 0x99, 0x65, 0x9d, 0x56, 0xfe, 0x3a, 0x8a, 0x23, 0x31, 0x23, 0xae, 
+    0xb8, 0xba, 0xa0, 0x37, 0x30, 0x05, 0xfd, 0xeb, 0x94, 0x30, 0x66, 0x64, 0x7c, 0xa3, 0x6a, 0x64, 
+    0x79, 0x79, 0x9a, 0x39, 0xc9, 0x94, 0xf0, 0x93, 0x3e, 0xf2, 0xad, 0x31, 0x1f, 0x7c, 0x30, 0x15, 
+    0x83, 0x9e, 0x70, 0x20, 0x51, 0x2e, 0xd7, 0x37, 0xe5, 0x39, 0x7f, 0xa7, 0x36, 0xa1, 0xd3, 0xbb, 
+    0x19, 0x74, 0x46, 0x6c, 0x8a, 0xbe, 0xbe, 0xe3, 0xe5, 0x28, 0xf4, 0x77, 0x2c, 0x5c, 0x86, 0x08, 
+    0x45, 0x9b, 0x79, 0x67, 0xe6, 0xb8, 0x46, 0x01, 0x00, 0x5d, 0xb3, 0xab, 0x11, 0x0d, 0x0b, 0xef, 
+    0x27, 0x03, 0x22, 0xa2, 0xcd, 0x2d, 0xfb, 0xfe, 0x22, 0x53, 0x56, 0xe3, 0x4e, 0x3c, 0x3b, 0x83, 
+    0x4e, 0xd9, 0x51, 0xb4, 0x4a, 0xc6, 0x7c, 0x54, 0x8a, 0x2e, 0xb9, 0xa4, 0x15, 0xad, 0x80, 0xa7, 
+    0x92, 0x00, 0xab, 0x0e, 0x36, 0x92, 0xac, 0x12, 0xad, 0x07, 0x63, 0x6d, 0x8d, 0x27, 0xe5, 0x31, 
+    0xb5, 0xb8, 0x5d, 0x63, 0xc4, 0x07, 0x3b, 0x6b, 0xa9, 0xf2, 0xd7, 0x93, 0xc3, 0xa6, 0x96, 0x42, 
+    0xf6, 0xed, 0xc3, 0xbb, 0xd0, 0x4c, 0x4b, 0x64, 0x71, 0x30, 0x25, 0xea, 0x5a, 0xe1, 0xbf, 0x85, 
+    0xcb, 0x52, 0x88, 0xce, 0x12, 0xff, 0xf3, 0xea, 0xb8, 0x2b, 0x41, 0x45, 0xd4, 0x52, 0x84, 0xce, 
+    0xfc, 0x2a, 0x57, 0xef, 0xb9, 0xf7, 0x77, 0xda, 0x3c, 0x7a, 0x49, 0xd9, 0x16, 0xcd, 0x2f, 0xc1, 
+    0x8b, 0x2e, 0x39, 0xdd, 0x9f, 0x39, 0x6a, 0xc3, 0x65, 0x2e, 0xf7, 0xcb, 0x17, 0xc2, 0xb4, 0xd6, 
+    0x2f, 0xef, 0xc9, 0x01, 0x78, 0x66, 0x1f, 0x4e, 0x38, 0x18, 0x68, 0xfc, 0xd9, 0xac, 0xfc, 0x29, 
+    0xf8, 0xb5, 0x86, 0xcf, 0x45, 0x86, 0x74, 0xfd, 0x7f, 0xca, 0xb0, 0x3c, 0x89, 0xfb, 0x03, 0x0c, 
+    0x43, 0xc5, 0x10, 0x24, 0xaa, 0xae, 0xc6, 0x0b, 0x61, 0x29, 0x11, 0xbf, 0xf9, 0x3b, 0x26, 0x78, 
+    0x44, 0xaf, 0x79, 0x3d, 0xce, 0xac, 0x55, 0x23, 0x48, 0x78, 0x56, 0xb8, 0xbc, 0x79, 0x6f, 0x1b, 
+    0xdb, 0xbe, 0xd1, 0xa8, 0x3c, 0x72, 0x35, 0xdd, 0xf8, 0xe0, 0xf0, 0x69, 0xe1, 0xce, 0x73, 0x5e, 
+    0x08, 0x92, 0xdc, 0x39, 0x6e, 0x58, 0x7e, 0x3a, 0xbf, 0xfd, 0xd4, 0x53, 0x53, 0x7c, 0x7d, 0x01, 
+};
+static uint8_t rsa4096_4p_e[] = {	/* publicExponent */
+    0x01, 0x00, 0x01, 
+};
+static uint8_t rsa4096_4p_d[] = {	/* privateExponent */
+    0x47, 0x5e, 0x6f, 0x6c, 0xe5, 0x82, 0xfb, 0xf6, 0x74, 0x20, 0xb5, 0xb1, 0x34, 0xe4, 0x57, 0xb0, 
+    0xe9, 0x5b, 0x65, 0x06, 0xde, 0x3a, 0xc0, 0x2e, 0x99, 0x33, 0xd9, 0x95, 0x4e, 0x5b, 0x2b, 0x6f, 
+    0xaa, 0x05, 0x9d, 0xc6, 0x4c, 0x1a, 0xf2, 0x33, 0x55, 0xf8, 0x64, 0x72, 0xd1, 0x49, 0x14, 0xda, 
+    0x2a, 0xbd, 0x45, 0xf0, 0x4a, 0x02, 0xde, 0xcb, 0xda, 0xb3, 0x97, 0xc1, 0xb7, 0x63, 0x4c, 0x8d, 
+    0x4a, 0x9f, 0x29, 0xd6, 0x1f, 0x5f, 0x1d, 0xda, 0x73, 0x3e, 0xa0, 0x9f, 0x42, 0x3e, 0xa8, 0x67, 
+    0x29, 0x5f, 0x98, 0x74, 0x99, 0xd9, 0x47, 0xf3, 0x55, 0xec, 0xe3, 0x36, 0x26, 0x83, 0x67, 0x0b, 
+    0x5e, 0xb5, 0x46, 0x81, 0x22, 0x53, 0x08, 0xd0, 0xc6, 0xd7, 0xce, 0x62, 0xa6, 0x3a, 0xf7, 0xfe, 
+    0xf2, 0x5b, 0x48, 0xdd, 0x66, 0x09, 0x5a, 0xf1, 0x5c, 0xab, 0x88, 0x14, 0x0b, 0xd3, 0xa5, 0xb1, 
+    0xe9, 0x69, 0xf7, 0xdf, 0x93, 0x29, 0x40, 0x55, 0xa3, 0xcb, 0xe4, 0x22, 0xfc, 0x30, 0x40, 0xb5, 
+    0x93, 0xe6, 0x18, 0x6c, 0xcc, 0x83, 0xd4, 0x62, 0x6d, 0xea, 0x97, 0xa0, 0xc6, 0x87, 0x00, 0xa1, 
+    0x3a, 0xe1, 0x48, 0x06, 0xaf, 0x74, 0xf6, 0x46, 0x06, 0x11, 0xdc, 0x71, 0xdd, 0x09, 0xbd, 0x39, 
+    0xf9, 0x95, 0xca, 0x04, 0x6e, 0x7e, 0xe2, 0x17, 0x5c, 0x0f, 0x28, 0x18, 0x10, 0x04, 0x0b, 0x80, 
+    0x9f, 0x3e, 0x5c, 0x96, 0xf3, 0xbe, 0x74, 0x03, 0x58, 0x09, 0x4d, 0x54, 0x8a, 0x88, 0x71, 0x7b, 
+    0x04, 0x6d, 0x0f, 0x89, 0xa2, 0x5c, 0x15, 0x6b, 0xb3, 0xb6, 0x3e, 0xed, 0xf8, 0xe2, 0x0e, 0x1f, 
+    0x21, 0x86, 0x4b, 0x18, 0x17, 0x4b, 0x8f, 0x99, 0xc1, 0xee, 0xf6, 0xe7, 0x8d, 0x04, 0xf1, 0x47, 
+    0xb0, 0x05, 0xf2, 0xcb, 0xe5, 0xd0, 0xf8, 0x53, 0x57, 0x8f, 0x4e, 0x85, 0xe7, 0x5f, 0xd5, 0xe3, 
+    0x4d, 0x77, 0x68, 0x68, 0x7d, 0x19, 0xac, 0xa2, 0xf6, 0x5b, 0xb2, 0x6e, 0x62, 0x2a, 0xb0, 0xcd, 
+    0xf1, 0x3b, 0x88, 0x9a, 0xab, 0xe7, 0xf3, 0x0f, 0xdd, 0xf6, 0xb6, 0x41, 0xbe, 0x1b, 0x49, 0x1b, 
+    0x5d, 0x0f, 0x12, 0x92, 0x1d, 0x1f, 0x17, 0x3c, 0x4d, 0x01, 0x55, 0xf4, 0xde, 0x5d, 0x12, 0xe8, 
+    0xd4, 0x28, 0x5b, 0x93, 0xbc, 0xaf, 0x7c, 0x6e, 0xc5, 0x0d, 0x06, 0x40, 0xaa, 0x12, 0x73, 0x1c, 
+    0xb2, 0x9b, 0xb9, 0x59, 0x27, 0x77, 0xeb, 0x7f, 0xd5, 0x65, 0xb1, 0xf6, 0x4b, 0x40, 0x93, 0x95, 
+    0xda, 0xd9, 0xc1, 0x5a, 0x3b, 0xf1, 0x57, 0xee, 0xe0, 0x56, 0x7e, 0xd8, 0x84, 0xa7, 0x3a, 0xb4, 
+    0x16, 0x44, 0x7f, 0xb3, 0x08, 0xaa, 0xdd, 0x4d, 0x3b, 0xfa, 0x12, 0x57, 0x12, 0xac, 0xb6, 0x48, 
+    0x73, 0xaa, 0x99, 0xd8, 0xf1, 0x64, 0xb5, 0x18, 0x94, 0x48, 0x7b, 0xd4, 0x4c, 0x8f, 0x95, 0x92, 
+    0xdf, 0x20, 0x06, 0x0b, 0x1f, 0x98, 0x76, 0xf5, 0x84, 0xf3, 0x1b, 0x8d, 0xcb, 0xb7, 0x3d, 0x78, 
+    0x5e, 0x81, 0xe6, 0xf4, 0xc4, 0xf9, 0x46, 0x80, 0x9d, 0x55, 0x56, 0xd1, 0xe3, 0xf5, 0x87, 0xfb, 
+    0xc5, 0xa7, 0x1f, 0x01, 0x95, 0x73, 0x73, 0x74, 0x95, 0x1d, 0x36, 0x10, 0xd0, 0x0a, 0x96, 0xdd, 
+    0xbf, 0x1c, 0x48, 0xca, 0x07, 0x0d, 0xd0, 0x73, 0xf8, 0x88, 0x70, 0xee, 0x91, 0x4f, 0xd7, 0xc1, 
+    0x94, 0xef, 0xee, 0xaa, 0x23, 0x9a, 0x4d, 0x01, 0xe4, 0xc3, 0x73, 0x59, 0xd8, 0x6b, 0x2a, 0x16, 
+    0x16, 0xc0, 0x87, 0x16, 0x31, 0x98, 0x5a, 0x11, 0xca, 0x00, 0x33, 0xa5, 0x3c, 0x85, 0x4e, 0x55, 
+    0xe9, 0xc1, 0x17, 0x4a, 0x7f, 0x80, 0x4d, 0xde, 0xa5, 0xe4, 0x78, 0x38, 0x27, 0x77, 0x15, 0x79, 
+    0xec, 0xa9, 0xa0, 0x72, 0xc9, 0x3a, 0x24, 0xf0, 0x47, 0xcd, 0x8d, 0x5b, 0xe9, 0x9e, 0x97, 0x81, 
+};
+static uint8_t rsa4096_4p_p[] = {	/* prime1 */
+    0xf0, 0x71, 0xc1, 0xb2, 0x9a, 0x6d, 0xdf, 0x49, 0x06, 0x65, 0xe0, 0x41, 0x66, 0x35, 0xd6, 0x94, 
+    0xdd, 0x51, 0x88, 0xa8, 0xda, 0xb4, 0x0a, 0x6b, 0xf0, 0xfc, 0xf5, 0x21, 0xe3, 0x6e, 0x03, 0x9e, 
+    0xdd, 0xdc, 0x8e, 0xb4, 0xe8, 0x5a, 0x29, 0x15, 0x9a, 0x4a, 0xfa, 0xea, 0x1a, 0xec, 0xa3, 0x29, 
+    0x3b, 0x36, 0x27, 0x52, 0x06, 0xa7, 0x89, 0x35, 0x72, 0x50, 0xd2, 0xe7, 0xcf, 0xe2, 0x51, 0x2c, 
+    0xd5, 0x24, 0x53, 0x40, 0xde, 0xd0, 0xee, 0xd2, 0xe0, 0x8b, 0xeb, 0xaa, 0x4c, 0xf7, 0x48, 0x97, 
+    0xcc, 0x0c, 0x6c, 0xb3, 0xd5, 0x40, 0x4c, 0xdb, 0x73, 0xbc, 0x17, 0x50, 0xcf, 0x85, 0xc5, 0xa5, 
+    0x07, 0xed, 0xc7, 0x0e, 0x8c, 0x18, 0xba, 0x8d, 0x5c, 0x9b, 0xb3, 0x5e, 0xfe, 0xae, 0x42, 0xbb, 
+    0xa3, 0xf1, 0x6e, 0xe3, 0x00, 0xf7, 0x2b, 0x49, 0x82, 0xb6, 0xa5, 0x3e, 0xe0, 0x66, 0xbc, 0xc3, 
+};
+static uint8_t rsa4096_4p_q[] = {	/* prime2 */
+    0xc9, 0xf9, 0xe2, 0x1a, 0x45, 0x6f, 0x61, 0x19, 0x1d, 0xe6, 0xc9, 0xff, 0x4f, 0xb8, 0xe2, 0x99, 
+    0x5c, 0x0d, 0x9a, 0x10, 0xec, 0xb4, 0x6b, 0xb0, 0x70, 0x35, 0x8e, 0x75, 0xd8, 0x33, 0x7a, 0x0c, 
+    0x69, 0x46, 0xa2, 0x5b, 0x27, 0x08, 0xc6, 0x55, 0x74, 0xca, 0xc3, 0x7c, 0x1d, 0x10, 0x37, 0x85, 
+    0x5c, 0xcc, 0x6a, 0xd1, 0xfc, 0xca, 0x2d, 0x7f, 0x99, 0x1c, 0x77, 0x00, 0x46, 0x1c, 0xdd, 0x07, 
+    0x3f, 0x51, 0x3d, 0x53, 0xe1, 0xa1, 0xa2, 0x7e, 0x61, 0xbf, 0xed, 0x5d, 0x4e, 0xfb, 0x68, 0xa9, 
+    0xf2, 0xd3, 0x9b, 0x32, 0x45, 0x5d, 0x78, 0x05, 0xf9, 0xcf, 0xf6, 0x96, 0x54, 0xa0, 0x00, 0x1f, 
+    0xc1, 0x22, 0xd5, 0xcc, 0xed, 0x61, 0xe6, 0x74, 0xe0, 0xe6, 0x74, 0xab, 0xc0, 0x88, 0x8c, 0xdd, 
+    0x19, 0xe5, 0xc0, 0x10, 0xc6, 0x7c, 0xab, 0xfb, 0x02, 0x01, 0x35, 0x39, 0x4c, 0x1e, 0xc6, 0xa9, 
+};
+static uint8_t rsa4096_4p_dp[] = {	/* exponent1 */
+    0xe7, 0x50, 0xf9, 0x40, 0xe3, 0x12, 0xba, 0xd2, 0x1d, 0x26, 0x9b, 0x65, 0x2f, 0x78, 0xb2, 0x14, 
+    0x8b, 0x0a, 0xea, 0x87, 0x4f, 0xc8, 0x0f, 0x92, 0xa2, 0xc8, 0x28, 0xe8, 0x4e, 0x4d, 0x43, 0x8c, 
+    0x6d, 0xf2, 0xc7, 0x13, 0xc1, 0xc9, 0x23, 0x67, 0x56, 0x05, 0xb6, 0x78, 0xcc, 0x28, 0x46, 0x1b, 
+    0xdf, 0x8c, 0x0c, 0xad, 0xfc, 0x1a, 0xe7, 0x84, 0x94, 0x92, 0xaf, 0x24, 0x36, 0xb9, 0x8a, 0xd0, 
+    0xaf, 0xc8, 0xff, 0x93, 0x14, 0x09, 0x3b, 0x09, 0x82, 0xde, 0xf9, 0x7c, 0xe0, 0x08, 0xb2, 0x3c, 
+    0xdf, 0x20, 0x40, 0xdf, 0x8d, 0x54, 0x0b, 0xdc, 0xbf, 0xed, 0xff, 0x1c, 0x4e, 0x59, 0x6a, 0xb8, 
+    0x86, 0xf5, 0x39, 0x20, 0x84, 0xa5, 0x31, 0xab, 0xd7, 0xa1, 0x2f, 0x22, 0x3f, 0xaf, 0xd4, 0x21, 
+    0x82, 0xea, 0x3d, 0x7c, 0x84, 0x2c, 0x45, 0xe7, 0xb5, 0xaa, 0x13, 0x35, 0x77, 0x5b, 0x3f, 0x53, 
+};
+static uint8_t rsa4096_4p_dq[] = {	/* exponent2 */
+    0x8e, 0x9b, 0x69, 0xc2, 0x84, 0xde, 0x24, 0x5f, 0xb8, 0x96, 0x18, 0x6f, 0xb5, 0x19, 0x64, 0x9d, 
+    0x45, 0xba, 0xb0, 0xda, 0x5c, 0x56, 0xf3, 0x66, 0x4b, 0x83, 0xf5, 0x07, 0x4d, 0xd4, 0xe2, 0xca, 
+    0xda, 0x96, 0x2d, 0xd2, 0x50, 0x58, 0x48, 0xb9, 0x53, 0xd2, 0x4a, 0x7e, 0x5a, 0x82, 0xf5, 0xc0, 
+    0xab, 0x0a, 0x06, 0x2e, 0x27, 0xdf, 0x94, 0x8a, 0x70, 0x50, 0x01, 0xd1, 0xe6, 0xaf, 0x40, 0x7c, 
+    0x7a, 0x7f, 0x60, 0xde, 0xd6, 0x03, 0xeb, 0x18, 0x72, 0xea, 0x31, 0xad, 0x5d, 0x33, 0xf3, 0xed, 
+    0x72, 0xef, 0x67, 0xb7, 0xf1, 0xf4, 0x11, 0xe7, 0x9e, 0x3f, 0xf0, 0xea, 0xa9, 0xeb, 0xa2, 0xca, 
+    0xc8, 0xf2, 0x50, 0xa4, 0xf5, 0xc2, 0xd7, 0x16, 0x15, 0x29, 0x82, 0x9d, 0x36, 0x3e, 0xf3, 0xbe, 
+    0xb5, 0x27, 0x5c, 0x1a, 0x3c, 0x1b, 0x10, 0xcf, 0x14, 0xd6, 0x47, 0x7f, 0x22, 0x38, 0xe4, 0xa9, 
+};
+static uint8_t rsa4096_4p_qinv[] = {	/* coefficient */
+    0xbc, 0x1d, 0xa8, 0x5a, 0x15, 0xe4, 0xce, 0x5d, 0x15, 0x24, 0x7b, 0xb4, 0x11, 0x8f, 0xf5, 0x0e, 
+    0xb3, 0x25, 0x77, 0xfe, 0xe6, 0xba, 0x8c, 0x8f, 0x43, 0x18, 0xa7, 0xff, 0xcd, 0xd5, 0x3b, 0x4a, 
+    0x33, 0x68, 0x29, 0xd4, 0xd1, 0x03, 0x37, 0x1f, 0xe0, 0xef, 0x02, 0xd6, 0x3b, 0xc3, 0x20, 0x22, 
+    0x20, 0xf3, 0xe3, 0xaa, 0x0d, 0x4b, 0xed, 0xf2, 0x64, 0x99, 0x10, 0xa2, 0x5f, 0xd3, 0xbc, 0x7b, 
+    0xc1, 0xb9, 0x2c, 0xa1, 0xce, 0x9a, 0xf3, 0x4c, 0x58, 0x5d, 0x30, 0x02, 0x3b, 0x0d, 0x3a, 0xa1, 
+    0x96, 0xf2, 0xde, 0xca, 0x4f, 0xda, 0xf7, 0x7f, 0xf9, 0xfe, 0xf3, 0xed, 0x30, 0x8d, 0x7a, 0xe5, 
+    0xc6, 0xee, 0x20, 0x82, 0x48, 0xcc, 0x4e, 0x18, 0x72, 0x29, 0x7c, 0x7d, 0x5e, 0xb5, 0x0c, 0x95, 
+    0x5f, 0xa0, 0x08, 0x75, 0x9c, 0x45, 0xd8, 0xf6, 0x25, 0xf3, 0xa7, 0x81, 0x16, 0x9e, 0x62, 0xee, 
+};
+static uint8_t rsa4096_4p_r3[] = {	/* prime3 */
+    0xd0, 0x76, 0xd1, 0xe5, 0xd1, 0xf9, 0x71, 0x30, 0x19, 0xca, 0xac, 0x39, 0xaf, 0x15, 0xcb, 0x40, 
+    0x56, 0x6f, 0x1a, 0x16, 0x39, 0x4e, 0x20, 0x30, 0xd6, 0xc3, 0x48, 0x1a, 0xd7, 0xd3, 0x57, 0x41, 
+    0x41, 0xb9, 0x34, 0x27, 0xd4, 0xe0, 0x78, 0xf5, 0xca, 0x02, 0x59, 0x47, 0xcf, 0x8a, 0x83, 0x7d, 
+    0x81, 0xfb, 0x07, 0xab, 0xc5, 0x71, 0x67, 0xa4, 0xec, 0x5d, 0x70, 0x00, 0x65, 0xed, 0x38, 0x60, 
+    0x26, 0x2e, 0xbf, 0x66, 0x0c, 0x83, 0x55, 0xc6, 0x3a, 0x32, 0x31, 0x97, 0x83, 0x97, 0xea, 0xab, 
+    0xc8, 0x52, 0x77, 0xb7, 0x53, 0x09, 0xd0, 0x0e, 0x02, 0x93, 0x67, 0x28, 0x9c, 0x0d, 0x90, 0xee, 
+    0xb1, 0x6e, 0xc9, 0x2c, 0x3b, 0x81, 0x36, 0x6e, 0xc4, 0x76, 0x76, 0x07, 0xfb, 0xc0, 0x35, 0x91, 
+    0xd1, 0xa1, 0x49, 0x66, 0xad, 0xa4, 0x84, 0x48, 0x3d, 0xe2, 0x31, 0x05, 0xad, 0x78, 0xb8, 0x45, 
+};
+static uint8_t rsa4096_4p_d3[] = {	/* exponent3 */
+    0x58, 0xba, 0xea, 0x76, 0x8e, 0xdc, 0x44, 0x90, 0x3b, 0xba, 0x27, 0x7a, 0x5a, 0x0a, 0xc5, 0xbb, 
+    0x79, 0xce, 0xca, 0x64, 0xc1, 0x39, 0x7e, 0xbc, 0x2a, 0xfd, 0x6d, 0xd8, 0x77, 0x1a, 0xee, 0x9d, 
+    0xc9, 0x12, 0xc2, 0x9f, 0x5d, 0x9d, 0xb9, 0xfe, 0xac, 0x60, 0x39, 0x8e, 0x36, 0x49, 0x77, 0xd4, 
+    0x59, 0x19, 0xf7, 0x56, 0xe6, 0xb0, 0x71, 0x74, 0x22, 0x63, 0x57, 0x03, 0xe4, 0x5e, 0x87, 0x4b, 
+    0x6d, 0x95, 0x22, 0x44, 0x96, 0x78, 0xe4, 0x6e, 0x7e, 0x60, 0xd4, 0xf8, 0xef, 0xbb, 0x1e, 0xd8, 
+    0xc5, 0x68, 0x4c, 0xaa, 0x8c, 0x3e, 0xb5, 0xfe, 0xf0, 0x9b, 0xbb, 0x21, 0xee, 0xe2, 0x5b, 0x59, 
+    0x2d, 0xce, 0xc0, 0xf4, 0x01, 0xd3, 0xea, 0xce, 0x54, 0xf3, 0x33, 0x24, 0x0c, 0xc4, 0xf0, 0x48, 
+    0x43, 0xd9, 0x09, 0xbc, 0x19, 0x96, 0xd7, 0xf3, 0x43, 0xdb, 0xde, 0x0f, 0xd3, 0x99, 0x79, 0x9d, 
+};
+static uint8_t rsa4096_4p_t3[] = {	/* coefficient3 */
+    0x74, 0x98, 0x03, 0x02, 0x00, 0x83, 0x7c, 0x01, 0x13, 0x45, 0xa7, 0xaa, 0x0f, 0x7a, 0x06, 0x76, 
+    0x28, 0xe9, 0x0d, 0x6a, 0x59, 0x6d, 0x55, 0xae, 0xea, 0x33, 0x33, 0xcc, 0x82, 0x4e, 0x3f, 0xae, 
+    0xae, 0x9d, 0x45, 0xc7, 0x90, 0xe7, 0x33, 0xc1, 0x06, 0x38, 0x1f, 0x08, 0xab, 0x67, 0x6a, 0x5e, 
+    0xb1, 0xf9, 0x97, 0x64, 0xf3, 0x5c, 0x33, 0x7c, 0x24, 0xc0, 0x56, 0x18, 0xcf, 0xc9, 0x40, 0x39, 
+    0x28, 0x41, 0xbf, 0x27, 0x36, 0xa8, 0x64, 0x1e, 0x65, 0x55, 0xad, 0xe2, 0xe1, 0xa9, 0x3b, 0x22, 
+    0xd4, 0x03, 0x63, 0xd5, 0x3a, 0x7e, 0xc5, 0x9d, 0x55, 0x0d, 0x1c, 0x2b, 0xea, 0x85, 0x12, 0x6f, 
+    0xaf, 0x9b, 0xfa, 0xe3, 0x6b, 0x8e, 0x6b, 0x8e, 0xf6, 0x90, 0xe2, 0xa7, 0xb3, 0xec, 0x57, 0x91, 
+    0x74, 0x22, 0xc4, 0x55, 0x1f, 0xaa, 0xca, 0x82, 0xcb, 0xc5, 0xba, 0x06, 0x1f, 0x0d, 0x3d, 0x45, 
+};
+static uint8_t rsa4096_4p_r4[] = {	/* prime4 */
+    0xfb, 0x75, 0x61, 0x24, 0xe9, 0x29, 0x48, 0x22, 0x5a, 0xe9, 0xf3, 0x5a, 0x6c, 0x12, 0x0f, 0x41, 
+    0x4b, 0x3b, 0x08, 0x32, 0xdf, 0x05, 0x8e, 0x27, 0x16, 0xdc, 0x8f, 0x5b, 0x50, 0x21, 0x8f, 0x4b, 
+    0x01, 0x3c, 0xbd, 0x41, 0xcc, 0xda, 0xcf, 0xc7, 0x7a, 0x1b, 0x3a, 0xe3, 0x2c, 0x79, 0x61, 0xe9, 
+    0xa9, 0x3d, 0x25, 0x50, 0x10, 0xc6, 0x98, 0x59, 0x70, 0x51, 0xa2, 0xc6, 0x9b, 0x11, 0xfe, 0xa5, 
+    0x25, 0xfc, 0x7e, 0x33, 0xf5, 0x7d, 0x1b, 0x00, 0x68, 0x1c, 0xfd, 0xbc, 0x7b, 0x5b, 0x55, 0x08, 
+    0x18, 0x9a, 0xb9, 0x19, 0x39, 0x66, 0x4c, 0x17, 0x80, 0x9e, 0x10, 0x12, 0x9c, 0x7d, 0x2e, 0x15, 
+    0xa7, 0x16, 0xa5, 0x65, 0xe6, 0x5e, 0x91, 0xe3, 0xac, 0xa8, 0x1a, 0x6b, 0x7d, 0x2c, 0xb8, 0x54, 
+    0x72, 0xde, 0x48, 0xf7, 0x32, 0xd3, 0xf1, 0x6d, 0x36, 0x8f, 0xad, 0xce, 0x24, 0x79, 0x56, 0x57, 
+};
+static uint8_t rsa4096_4p_d4[] = {	/* exponent4 */
+    0xee, 0xeb, 0x67, 0x42, 0xc7, 0xda, 0xf6, 0x73, 0xd6, 0x07, 0xe5, 0xb5, 0xeb, 0x6a, 0xf9, 0x5d, 
+    0xa3, 0x9a, 0x52, 0x3e, 0xeb, 0x92, 0x7e, 0xaf, 0x7b, 0x54, 0x53, 0x4d, 0x82, 0x84, 0x70, 0x7e, 
+    0xe6, 0x8d, 0x0c, 0x91, 0x81, 0x90, 0x01, 0xcd, 0xd9, 0xa2, 0x17, 0xc0, 0x93, 0x98, 0x3d, 0x44, 
+    0xe3, 0x0d, 0x7a, 0xef, 0x69, 0x11, 0x18, 0xde, 0x1a, 0x0f, 0x26, 0xe7, 0x27, 0x9d, 0xe0, 0x62, 
+    0x90, 0x06, 0x28, 0xef, 0x3b, 0x78, 0x03, 0xf8, 0xcd, 0xf3, 0x85, 0xce, 0xd9, 0x32, 0x3d, 0x47, 
+    0xb5, 0x01, 0x05, 0x90, 0x06, 0xee, 0xc0, 0xab, 0xb0, 0x03, 0xfe, 0xe7, 0x80, 0x12, 0x9c, 0x7f, 
+    0xec, 0x43, 0x63, 0x21, 0xbf, 0xd1, 0xe9, 0x31, 0xf6, 0xf1, 0xbe, 0x30, 0x95, 0x3d, 0xb1, 0x62, 
+    0x63, 0xc5, 0xfa, 0x74, 0x0d, 0xb2, 0x3c, 0xf8, 0xf4, 0xd7, 0x6d, 0x5f, 0xa9, 0x5e, 0x34, 0x7f, 
+};
+static uint8_t rsa4096_4p_t4[] = {	/* coefficient4 */
+    0xdb, 0x14, 0xa8, 0xad, 0x13, 0x4c, 0x7f, 0x70, 0x49, 0x0a, 0x59, 0x69, 0x43, 0x33, 0xe3, 0xd5, 
+    0x13, 0xfc, 0x04, 0x85, 0x94, 0x74, 0x44, 0x9b, 0x36, 0xe5, 0x46, 0xde, 0x7a, 0x42, 0x59, 0x2e, 
+    0x64, 0x40, 0xa0, 0x5b, 0x08, 0x97, 0xf8, 0xa7, 0xb3, 0x4d, 0x18, 0xb6, 0xbf, 0xe3, 0xa3, 0x2f, 
+    0x8e, 0x20, 0x23, 0x9f, 0x29, 0x60, 0xe6, 0xb4, 0xae, 0x00, 0xe6, 0x1d, 0x9f, 0x97, 0x22, 0xda, 
+    0x55, 0x72, 0xc3, 0x1b, 0xf6, 0xf9, 0xfa, 0x48, 0x4a, 0xfb, 0x97, 0x84, 0x6d, 0xcb, 0xf6, 0x6b, 
+    0x04, 0xc2, 0x8c, 0xc6, 0xdf, 0xab, 0x57, 0x6f, 0x69, 0x55, 0xe9, 0xf3, 0x7c, 0x5a, 0xee, 0xb1, 
+    0xe2, 0xd3, 0x1e, 0x0d, 0xe1, 0x0d, 0x13, 0x1a, 0x5c, 0x78, 0x8d, 0x3f, 0x10, 0x14, 0xb3, 0x23, 
+    0x4f, 0x20, 0xd8, 0x24, 0x30, 0xa4, 0x32, 0xc6, 0x0e, 0x7c, 0x1d, 0xa8, 0x2c, 0x18, 0xb2, 0x46, 
+};
+static RSA_TOOLS_PRIME_INFO_t rsa4096_4p_other[] = {
+    {   /* r_3, d_3, t_3 */
+        rsa4096_4p_r3,
+        rsa4096_4p_d3,
+        rsa4096_4p_t3,
+        sizeof(rsa4096_4p_r3),
+        sizeof(rsa4096_4p_d3),
+        sizeof(rsa4096_4p_t3),
+    },
+    {   /* r_4, d_4, t_4 */
+        rsa4096_4p_r4,
+        rsa4096_4p_d4,
+        rsa4096_4p_t4,
+        sizeof(rsa4096_4p_r4),
+        sizeof(rsa4096_4p_d4),
+        sizeof(rsa4096_4p_t4),
+    },
+};
+
+static RSA_TV_MPRIME_t rsa_mprime_tv_param[] = {
+    {   /* 3072 bit, 3 primes */
+        {   /* Private Key */
+            rsa3072_3p_n,
+            rsa3072_3p_e,
+            rsa3072_3p_d,
+            rsa3072_3p_p,
+            rsa3072_3p_q,
+            rsa3072_3p_dp,
+            rsa3072_3p_dq,
+            rsa3072_3p_qinv,
+            sizeof(rsa3072_3p_n),
+            sizeof(rsa3072_3p_e),
+            sizeof(rsa3072_3p_d),
+            sizeof(rsa3072_3p_p),
+            sizeof(rsa3072_3p_q),
+            sizeof(rsa3072_3p_dp),
+            sizeof(rsa3072_3p_dq),
+            sizeof(rsa3072_3p_qinv),
+            rsa3072_3p_other,
+            sizeof(rsa3072_3p_other) / sizeof(RSA_TOOLS_PRIME_INFO_t),
+        },
+        {   /* Public Key */
+            rsa3072_3p_n,
+            rsa3072_3p_e,
+            sizeof(rsa3072_3p_n),
+            sizeof(rsa3072_3p_e),
+        },
+    },
+    {   /* 4096 bit, 4 primes */
+        {   /* Private Key */
+            rsa4096_4p_n,
+            rsa4096_4p_e,
+            rsa4096_4p_d,
+            rsa4096_4p_p,
+            rsa4096_4p_q,
+            rsa4096_4p_dp,
+            rsa4096_4p_dq,
+            rsa4096_4p_qinv,
+            sizeof(rsa4096_4p_n),
+            sizeof(rsa4096_4p_e),
+            sizeof(rsa4096_4p_d),
+            sizeof(rsa4096_4p_p),
+            sizeof(rsa4096_4p_q),
+            sizeof(rsa4096_4p_dp),
+            sizeof(rsa4096_4p_dq),
+            sizeof(rsa4096_4p_qinv),
+            rsa4096_4p_other,
+            sizeof(rsa4096_4p_other) / sizeof(RSA_TOOLS_PRIME_INFO_t),
+        },
+        {   /* Public Key */
+            rsa4096_4p_n,
+            rsa4096_4p_e,
+            sizeof(rsa4096_4p_n),
+            sizeof(rsa4096_4p_e),
+        },
+    },
+};
+
+#endif  /* __RSA_TV_MPRIME_H__ */
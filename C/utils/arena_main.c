@@ -0,0 +1,266 @@
+/**
+ * @file arena_main.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Test function for per-thread arena
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "utils.h"
+
+#define ARENA_TEST_CNT    (1000)
+#define ARENA_TEST_ROUNDS (20)
+
+/**
+ * @brief Allocate, grow and free blocks of various sizes in one scope and
+ *        check that none of them overlap.
+ */
+static bool arena_test_scope(UTILS_ARENA_STAT_t *stat)
+{
+    bool    ret;
+    uint8_t *p[ARENA_TEST_CNT];
+    size_t  len[ARENA_TEST_CNT];
+    uint8_t *q;
+    size_t  i;
+    size_t  j;
+
+    ret = (UTILS_E_OK == utils_arena_begin());
+    for (i = 0; ret && (i < ARENA_TEST_CNT); i++) {
+        len[i] = 1 + (i * 7919) % ((0 == (i % 100)) ? 100000 : 300);
+        p[i] = (0 == (i % 3)) ? utils_arena_calloc(1, len[i]) : utils_arena_malloc(len[i]);
+        if ((NULL == p[i]) || (0 != ((uintptr_t)p[i] & 15))) {
+            ret = false;
+            break;
+        }
+        if (0 == (i % 3)) {
+            for (j = 0; j < len[i]; j++) {
+                if (0 != p[i][j]) {
+                    ret = false;
+                }
+            }
+        }
+        memset(p[i], (int)(i & 0xFF), len[i]);
+        if (0 == (i % 5)) {
+            /* Grow the last block, in place or not. */
+            q = utils_arena_realloc(p[i], len[i], len[i] * 2);
+            if (NULL == q) {
+                ret = false;
+                break;
+            }
+            memset(q + len[i], (int)(i & 0xFF), len[i]);
+            p[i]    = q;
+            len[i] *= 2;
+        }
+        if (0 == (i % 11)) {
+            /* Free and allocate again at the top. */
+            utils_arena_free(p[i], len[i]);
+            p[i] = utils_arena_malloc(len[i]);
+            if (NULL == p[i]) {
+                ret = false;
+                break;
+            }
+            memset(p[i], (int)(i & 0xFF), len[i]);
+        }
+    }
+    for (i = 0; ret && (i < ARENA_TEST_CNT); i++) {
+        for (j = 0; j < len[i]; j++) {
+            if ((uint8_t)(i & 0xFF) != p[i][j]) {
+                ret = false;
+                break;
+            }
+        }
+    }
+    utils_arena_end(stat);
+
+    return ret;
+}
+
+static void *arena_test_thread(void *arg)
+{
+    bool               *res;
+    int                round;
+    UTILS_ARENA_STAT_t stat;
+
+    res = (bool *)arg;
+    *res = true;
+    for (round = 0; round < ARENA_TEST_ROUNDS; round++) {
+        if (!arena_test_scope(&stat)) {
+            *res = false;
+        }
+    }
+    /* The chunks of the first round are reused. */
+    if (0 != stat.heap) {
+        *res = false;
+    }
+
+    return NULL;
+}
+
+bool arena_test()
+{
+    bool               ret;
+    bool               res[4];
+    pthread_t          th[4];
+    UTILS_ARENA_STAT_t stat;
+    UTILS_ARENA_STAT_t stat2;
+    uint8_t            *p;
+    uint8_t            *q;
+    uint8_t            *h;
+    size_t             i;
+    int                depth;
+
+    ret = true;
+
+    printf("Test Case 1: ");
+    if (!arena_test_scope(&stat) || (0 == stat.heap) ||
+        !arena_test_scope(&stat2) || (0 != stat2.heap) ||
+        (stat.allocs != stat2.allocs) || (stat.bytes != stat2.bytes) || (stat.peak != stat2.peak)) {
+        printf("NG.\n");
+        ret = false;
+    }
+    else {
+        printf("OK.\n");
+    }
+    printf("  allocs %zu, frees %zu, bytes %zu, live %lld, peak %zu, heap %zu -> %zu\n",
+           stat.allocs, stat.frees, stat.bytes, (long long)stat.live, stat.peak, stat.heap, stat2.heap);
+
+    printf("Test Case 2 (heap outside a scope or paused): ");
+    h = utils_arena_malloc(100);
+    (void)utils_arena_begin();
+    (void)utils_arena_pause(true);
+    p = utils_arena_malloc(100);
+    (void)utils_arena_pause(false);
+    q = utils_arena_malloc(100);
+    if ((NULL == h) || (NULL == p) || (NULL == q)) {
+        ret = false;
+    }
+    else {
+        memset(h, 1, 100);
+        memset(p, 2, 100);
+        memset(q, 3, 100);
+        /* Heap blocks grow on the heap, in a scope or not. */
+        h = utils_arena_realloc(h, 100, 100000);
+        p = utils_arena_realloc(p, 100, 100000);
+        utils_arena_free(q, 100);
+    }
+    utils_arena_end(&stat);
+    /* Only q is counted. */
+    if ((NULL == h) || (NULL == p) || (1 != h[99]) || (2 != p[99]) || (1 != stat.allocs) ||
+        (1 != stat.frees) || (0 != stat.live)) {
+        ret = false;
+    }
+    p = utils_arena_realloc(p, 100000, 200000);
+    if ((NULL == p) || (2 != p[0])) {
+        ret = false;
+    }
+    utils_arena_free(h, 100000);
+    utils_arena_free(p, 200000);
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    printf("Test Case 3 (nested scopes): ");
+    (void)utils_arena_begin();
+    p = utils_arena_malloc(64);
+    (void)utils_arena_begin();
+    q = utils_arena_malloc(64);
+    utils_arena_free(p, 64);    /* Not at the top, kept. */
+    utils_arena_end(&stat2);
+    /* The inner scope is gone, the outer block is not. */
+    q = utils_arena_malloc(64);
+    utils_arena_end(&stat);
+    if ((NULL == p) || (NULL == q) || (1 != stat2.allocs) || (3 != stat.allocs) ||
+        ((p + 64 + 16) != q)) {
+        ret = false;
+    }
+    for (depth = 0; depth < UTILS_ARENA_DEPTH_MAX; depth++) {
+        if (UTILS_E_OK != utils_arena_begin()) {
+            ret = false;
+        }
+    }
+    if (UTILS_E_RESOURCE != utils_arena_begin()) {
+        ret = false;
+    }
+    for (depth = 0; depth < UTILS_ARENA_DEPTH_MAX; depth++) {
+        utils_arena_end(NULL);
+    }
+    utils_arena_end(&stat);
+    if (0 != stat.allocs) {
+        ret = false;
+    }
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    printf("Test Case 4 (accounting): ");
+    (void)utils_arena_begin();
+    p = utils_arena_malloc(100);
+    h = utils_arena_malloc(100);
+    if ((NULL == p) || (NULL == h)) {
+        ret = false;
+    }
+    else {
+        memset(p, 4, 100);
+        /* Grown in an inner scope, p moves to the heap and outlives it. */
+        (void)utils_arena_begin();
+        q = utils_arena_malloc(10);
+        p = utils_arena_realloc(p, 100, 1000);
+        utils_arena_free(q, 10);
+        utils_arena_end(&stat2);
+        q = utils_arena_malloc(100000);
+        if ((NULL == p) || (NULL == q) || (4 != p[99]) || (2 != stat2.allocs) || (2 != stat2.frees) ||
+            (900 != stat2.live)) {
+            ret = false;
+        }
+        memset(q, 5, 100000);
+        if ((NULL != p) && (4 != p[0])) {
+            ret = false;
+        }
+        utils_arena_free(p, 1000);
+        utils_arena_free(q, 100000);
+    }
+    utils_arena_free(h, 100);
+    utils_arena_end(&stat);
+    if ((stat.allocs != stat.frees) || (0 != stat.live)) {
+        ret = false;
+    }
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    printf("Test Case 5 (hooks of libtommath 1.1): ");
+    (void)utils_arena_begin();
+    p = utils_arena_malloc(100);
+    p = utils_arena_xrealloc(p, 200);
+    q = utils_arena_xrealloc(NULL, 100);
+    utils_arena_xfree(q);
+    utils_arena_xfree(p);
+    utils_arena_end(&stat);
+    if ((NULL == p) || (NULL == q) || (2 != stat.allocs) || (2 != stat.frees) || (0 != stat.live) ||
+        (300 != stat.bytes)) {
+        ret = false;
+    }
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    printf("Test Case 6 (threads): ");
+    for (i = 0; i < 4; i++) {
+        res[i] = false;
+        if (0 != pthread_create(&th[i], NULL, arena_test_thread, &res[i])) {
+            th[i] = pthread_self();
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        if (!pthread_equal(th[i], pthread_self())) {
+            pthread_join(th[i], NULL);
+        }
+        if (!res[i]) {
+            ret = false;
+        }
+    }
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    utils_arena_release();
+
+    return ret;
+}
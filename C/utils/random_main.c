@@ -0,0 +1,54 @@
+/**
+ * @file random_main.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Test function for random bytes
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ * 
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "utils.h"
+
+bool random_test()
+{
+    bool    ret;
+    uint8_t buf[64];
+    uint8_t buf2[64];
+    uint8_t zero[64];
+
+    ret = true;
+    memset(zero, 0, sizeof(zero));
+
+    printf("Test Case 1: ");
+    memset(buf, 0, sizeof(buf));
+    memset(buf2, 0, sizeof(buf2));
+    if ((UTILS_E_OK != utils_random(buf, sizeof(buf))) ||
+        (UTILS_E_OK != utils_random(buf2, sizeof(buf2))) ||
+        (0 == memcmp(buf, zero, sizeof(buf))) ||
+        (0 == memcmp(buf, buf2, sizeof(buf)))) {
+        printf("NG.\n");
+        ret = false;
+    }
+    else {
+        printf("OK.\n");
+    }
+    utils_hexdump(buf,  sizeof(buf),  "random 1");
+    utils_hexdump(buf2, sizeof(buf2), "random 2");
+
+    printf("Test Case 2: ");
+    if ((UTILS_E_OK != utils_random(NULL, 0)) ||
+        (UTILS_E_PARAM != utils_random(NULL, 1))) {
+        printf("NG.\n");
+        ret = false;
+    }
+    else {
+        printf("OK.\n");
+    }
+
+    return ret;
+}
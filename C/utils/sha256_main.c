@@ -0,0 +1,103 @@
+/**
+ * @file sha256_main.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Test function for SHA-256
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "utils.h"
+
+/* FIPS 180-2, Appendix B */
+static const char *sha256_tv_msg[] = {
+    "",
+    "abc",
+    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+};
+static const uint8_t sha256_tv_md[][UTILS_SHA256_LEN] = {
+    {
+        0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+        0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55,
+    },
+    {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+    },
+    {
+        0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+        0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1,
+    },
+};
+/* One million of 'a' */
+static const uint8_t sha256_tv_md_a[UTILS_SHA256_LEN] = {
+    0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+    0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0,
+};
+
+bool sha256_test()
+{
+    bool           ret;
+    UTILS_SHA256_t ctx;
+    uint8_t        md[UTILS_SHA256_LEN];
+    uint8_t        md2[UTILS_SHA256_LEN];
+    uint8_t        buf[1000];
+    size_t         i;
+    size_t         j;
+
+    ret = true;
+
+    printf("Test Case 1 (FIPS 180-2): ");
+    for (i = 0; i < (sizeof(sha256_tv_msg) / sizeof(sha256_tv_msg[0])); i++) {
+        if ((UTILS_E_OK != utils_sha256(sha256_tv_msg[i], strlen(sha256_tv_msg[i]), md)) ||
+            (0 != memcmp(md, sha256_tv_md[i], UTILS_SHA256_LEN))) {
+            ret = false;
+        }
+    }
+    memset(buf, 'a', sizeof(buf));
+    utils_sha256_init(&ctx);
+    for (i = 0; i < 1000; i++) {
+        utils_sha256_update(&ctx, buf, sizeof(buf));
+    }
+    utils_sha256_final(&ctx, md);
+    if (0 != memcmp(md, sha256_tv_md_a, UTILS_SHA256_LEN)) {
+        ret = false;
+    }
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    printf("Test Case 2 (split updates): ");
+    (void)utils_random(buf, sizeof(buf));
+    for (i = 0; i < 200; i++) {
+        (void)utils_sha256(buf, i, md);
+        /* Every split point, across the block boundaries too. */
+        for (j = 0; j <= i; j++) {
+            utils_sha256_init(&ctx);
+            utils_sha256_update(&ctx, buf, j);
+            utils_sha256_update(&ctx, &buf[j], i - j);
+            utils_sha256_final(&ctx, md2);
+            if (0 != memcmp(md, md2, UTILS_SHA256_LEN)) {
+                ret = false;
+            }
+        }
+    }
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    printf("Test Case 3: ");
+    if ((UTILS_E_OK != utils_sha256(NULL, 0, md)) ||
+        (0 != memcmp(md, sha256_tv_md[0], UTILS_SHA256_LEN)) ||
+        (UTILS_E_PARAM != utils_sha256(NULL, 1, md)) ||
+        (UTILS_E_PARAM != utils_sha256(buf, 1, NULL))) {
+        printf("NG.\n");
+        ret = false;
+    }
+    else {
+        printf("OK.\n");
+    }
+
+    return ret;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file tpool_main.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Test function for thread pool
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ * 
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "utils.h"
+
+#define TPOOL_TEST_CNT (1000)
+
+static void tpool_test_func(void *arg, size_t idx)
+{
+    uint32_t *hits;
+
+    hits = (uint32_t *)arg;
+    hits[idx]++;
+}
+
+typedef struct {
+    void     *pool;
+    uint32_t hits[4][TPOOL_TEST_CNT];
+    int      res[4];
+} TPOOL_TEST_NEST_t;
+
+/* A job posting a job of its own to the same pool. */
+static void tpool_test_nest(void *arg, size_t idx)
+{
+    TPOOL_TEST_NEST_t *nest;
+
+    nest = (TPOOL_TEST_NEST_t *)arg;
+    nest->res[idx] = utils_tpool_try_run(nest->pool, tpool_test_func, nest->hits[idx], TPOOL_TEST_CNT);
+}
+
+bool tpool_test()
+{
+    bool              ret;
+    void              *pool;
+    uint32_t          hits[TPOOL_TEST_CNT];
+    TPOOL_TEST_NEST_t nest;
+    size_t            nthreads;
+    size_t            cnt;
+    size_t            i;
+    int               round;
+
+    ret = true;
+    for (nthreads = 0; nthreads <= 4; nthreads++) {
+        printf("Test Case %zu (%zu helper threads): ", nthreads + 1, nthreads);
+        pool = utils_tpool_alloc(nthreads);
+        if (NULL == pool) {
+            printf("NG. alloc\n");
+            ret = false;
+            continue;
+        }
+        if ((nthreads + 1) != utils_tpool_size(pool)) {
+            ret = false;
+        }
+        /* Every index must run exactly once, job after job. */
+        for (round = 0; round < 50; round++) {
+            cnt = (round * 37) % TPOOL_TEST_CNT;
+            memset(hits, 0, sizeof(hits));
+            if (UTILS_E_OK != utils_tpool_run(pool, tpool_test_func, hits, cnt)) {
+                ret = false;
+            }
+            for (i = 0; i < TPOOL_TEST_CNT; i++) {
+                if (hits[i] != ((i < cnt) ? 1 : 0)) {
+                    ret = false;
+                }
+            }
+        }
+        printf("%s\n", ret ? "OK." : "NG.");
+        utils_tpool_free(pool);
+    }
+
+    printf("Test Case 6 (no pool): ");
+    memset(hits, 0, sizeof(hits));
+    if ((UTILS_E_OK != utils_tpool_run(NULL, tpool_test_func, hits, TPOOL_TEST_CNT)) ||
+        (UTILS_E_PARAM != utils_tpool_run(NULL, NULL, hits, TPOOL_TEST_CNT)) ||
+        (1 != utils_tpool_size(NULL))) {
+        ret = false;
+    }
+    for (i = 0; i < TPOOL_TEST_CNT; i++) {
+        if (1 != hits[i]) {
+            ret = false;
+        }
+    }
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    printf("Test Case 7 (try run, nested): ");
+    memset(&nest, 0, sizeof(nest));
+    nest.pool = utils_tpool_alloc(2);
+    if ((NULL == nest.pool) ||
+        (UTILS_E_OK != utils_tpool_try_run(nest.pool, tpool_test_nest, &nest, 4)) ||
+        (UTILS_E_PARAM != utils_tpool_try_run(nest.pool, NULL, hits, TPOOL_TEST_CNT))) {
+        ret = false;
+    }
+    for (cnt = 0; cnt < 4; cnt++) {
+        if (UTILS_E_OK != nest.res[cnt]) {
+            ret = false;
+        }
+        for (i = 0; i < TPOOL_TEST_CNT; i++) {
+            if (1 != nest.hits[cnt][i]) {
+                ret = false;
+            }
+        }
+    }
+    utils_tpool_free(nest.pool);
+    printf("%s\n", ret ? "OK." : "NG.");
+
+    return ret;
+}
@@ -20,6 +20,30 @@
 #define UTILS_E_RESOURCE (-254)
 #define UTILS_E_INTERNAL (-255)
 
+#define UTILS_ARENA_DEPTH_MAX   (8)
+#define UTILS_SHA256_LEN        (32)    /* Length of a SHA-256 digest */
+#define UTILS_SHA256_BLOCK      (64)
+
+typedef void (*UTILS_TPOOL_FUNC_t)(void *arg, size_t idx);
+
+/* Allocations of an arena scope. */
+typedef struct {
+    size_t  allocs; /* Blocks allocated. */
+    size_t  frees;  /* Blocks freed. */
+    size_t  bytes;  /* Bytes requested, by allocations and growths. */
+    int64_t live;   /* Bytes allocated less bytes freed, 0 if nothing is kept. */
+    size_t  peak;   /* Peak bytes in use in the arena, with headers. */
+    size_t  heap;   /* Calls of malloc() made for the arena or on its behalf. */
+} UTILS_ARENA_STAT_t;
+
+/* SHA-256 hash state. */
+typedef struct {
+    uint32_t h[8];
+    uint64_t len;                       /* Bytes hashed. */
+    uint8_t  buf[UTILS_SHA256_BLOCK];   /* Partial block. */
+    size_t   fill;
+} UTILS_SHA256_t;
+
 void *utils_ts_alloc();
 void utils_ts_free(void *ctx);
 uint32_t utils_ts_gettime(void *ctx);
@@ -28,5 +52,26 @@ uint64_t utils_ts_sec(void *ctx);
 uint64_t utils_ts_nsec(void *ctx);
 void utils_hexdump(void *base, size_t len, const char *title);
 bool utils_blkcmp(const void *left, size_t llen, const void *right, size_t rlen, bool fill);
+void *utils_tpool_alloc(size_t nthreads);
+void utils_tpool_free(void *ctx);
+size_t utils_tpool_size(void *ctx);
+int utils_tpool_run(void *ctx, UTILS_TPOOL_FUNC_t func, void *arg, size_t cnt);
+int utils_tpool_try_run(void *ctx, UTILS_TPOOL_FUNC_t func, void *arg, size_t cnt);
+int utils_random(void *buf, size_t len);
+int utils_arena_begin(void);
+void utils_arena_end(UTILS_ARENA_STAT_t *stat);
+bool utils_arena_pause(bool pause);
+void utils_arena_release(void);
+void utils_arena_stat(UTILS_ARENA_STAT_t *stat);
+void *utils_arena_malloc(size_t size);
+void *utils_arena_calloc(size_t nmemb, size_t size);
+void *utils_arena_realloc(void *p, size_t oldsize, size_t newsize);
+void utils_arena_free(void *p, size_t size);
+void *utils_arena_xrealloc(void *p, size_t size);
+void utils_arena_xfree(void *p);
+void utils_sha256_init(UTILS_SHA256_t *ctx);
+void utils_sha256_update(UTILS_SHA256_t *ctx, const void *data, size_t len);
+void utils_sha256_final(UTILS_SHA256_t *ctx, uint8_t *digest);
+int utils_sha256(const void *data, size_t len, uint8_t *digest);
 
 #endif  /* __UTILS_H__ */
@@ -0,0 +1,542 @@
+/**
+ * @file utils_arena.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Per-thread bump arena.
+ *        Between utils_arena_begin() and utils_arena_end() the allocation
+ *        functions of this file hand out blocks of the arena of the calling
+ *        thread, which are all released at once by utils_arena_end(). No lock
+ *        is taken and, once the chunks of the arena have grown to the working
+ *        set, no call of malloc() either. Outside a scope, or while paused,
+ *        they fall back to the heap.
+ *        The functions have the signatures of the allocation hooks of
+ *        libtommath, so that it can be built from source to use them:
+ *            -DMP_MALLOC=utils_arena_malloc -DMP_CALLOC=utils_arena_calloc
+ *            -DMP_REALLOC=utils_arena_realloc -DMP_FREE=utils_arena_free
+ *        or, for libtommath 1.1, whose hooks take no old size and are
+ *        declared as functions of these names,
+ *            -DXMALLOC=utils_arena_malloc -DXCALLOC=utils_arena_calloc
+ *            -DXREALLOC=utils_arena_xrealloc -DXFREE=utils_arena_xfree
+ *        The CMake option TOMMATH_SOURCE_DIR of rsa_tools does so.
+ *        Every block carries a header with its size and the arena and scope
+ *        it was allocated in, so a block can be freed or grown by any thread,
+ *        in or out of a scope, and the old sizes passed by the caller are not
+ *        relied on. A block that has to move while it is not in the innermost
+ *        scope of the calling thread moves to the heap, where it outlives
+ *        that scope.
+ *        Allocations and frees in a scope are counted, so that a scope can
+ *        be checked to give back everything it took (UTILS_ARENA_STAT_t).
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "utils.h"
+
+#define ARENA_CHUNK_SIZE    (64 * 1024)
+#define ARENA_ALIGN         (16)
+
+#if (UTILS_ARENA_DEPTH_MAX >= ARENA_ALIGN)
+#error "The scope depth must fit in the low bits of an arena address."
+#endif
+
+/* Tags of the blocks on the heap. Arenas are aligned, so their tags are larger. */
+#define ARENA_TAG_HEAP      (0)     /* Not counted: out of a scope or paused. */
+#define ARENA_TAG_COUNTED   (1)     /* Allocated in a scope, counted. */
+
+/* Header of a block, ARENA_ALIGN bytes. */
+typedef struct {
+    size_t    size;     /* Bytes requested. */
+    uintptr_t tag;      /* Arena | depth of its scope, or ARENA_TAG_xxx. */
+} ARENA_HDR_t;
+
+typedef struct arena_chunk ARENA_CHUNK_t;
+struct arena_chunk {
+    ARENA_CHUNK_t *next;
+    size_t        cap;      /* Bytes of data. */
+    size_t        off;      /* Bytes of data in use. */
+    size_t        pad;
+    /* Data follows. */
+};
+
+/* Position of the arena at the beginning of a scope. */
+typedef struct {
+    ARENA_CHUNK_t      *chunk;
+    size_t             off;
+    size_t             used;
+    size_t             peak;    /* Peak of the enclosing scope. */
+    UTILS_ARENA_STAT_t stat;    /* Counters at the beginning. */
+} ARENA_MARK_t;
+
+typedef struct {
+    ARENA_CHUNK_t      *head;   /* Chunks, kept for the next scopes. */
+    ARENA_CHUNK_t      *cur;    /* Chunk allocated from. */
+    size_t             used;    /* Bytes in use in all chunks. */
+    size_t             peak;    /* Peak of used in the current scope. */
+    size_t             depth;
+    bool               paused;
+    UTILS_ARENA_STAT_t stat;    /* Counters since the arena was made. */
+    ARENA_MARK_t       mark[UTILS_ARENA_DEPTH_MAX];
+} ARENA_t;
+
+static pthread_once_t  arena_once = PTHREAD_ONCE_INIT;
+static pthread_key_t   arena_key;
+static __thread ARENA_t *arena_cur;
+
+/**
+ * @brief Release an arena, called at the exit of its thread.
+ */
+static void arena_destroy(void *arg)
+{
+    ARENA_t       *a;
+    ARENA_CHUNK_t *c;
+
+    a = (ARENA_t *)arg;
+    if (NULL != a) {
+        while (NULL != a->head) {
+            c       = a->head;
+            a->head = c->next;
+            free(c);
+        }
+        free(a);
+    }
+}
+
+static void arena_key_init(void)
+{
+    pthread_key_create(&arena_key, arena_destroy);
+}
+
+/**
+ * @brief Data of a chunk.
+ */
+static uint8_t *arena_data(ARENA_CHUNK_t *c)
+{
+    return (uint8_t *)(c + 1);
+}
+
+/**
+ * @brief Size of a block with its header, rounded up to ARENA_ALIGN.
+ */
+static size_t arena_round(size_t size)
+{
+    return sizeof(ARENA_HDR_t) + ((size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1));
+}
+
+/**
+ * @brief Tag of the blocks of the innermost scope of an arena.
+ */
+static uintptr_t arena_tag(const ARENA_t *a)
+{
+    return (uintptr_t)a | (uintptr_t)a->depth;
+}
+
+/**
+ * @brief Whether a block is on the heap.
+ */
+static bool arena_on_heap(const ARENA_HDR_t *h)
+{
+    return (ARENA_TAG_COUNTED >= h->tag);
+}
+
+/**
+ * @brief The arena of the calling thread if a scope is open and not paused.
+ */
+static ARENA_t *arena_active(void)
+{
+    ARENA_t *a;
+
+    a = arena_cur;
+    if ((NULL != a) && ((0 == a->depth) || a->paused)) {
+        a = NULL;
+    }
+
+    return a;
+}
+
+/**
+ * @brief Bump a block of size bytes out of an arena, adding a chunk if no
+ *        chunk has room for it.
+ */
+static ARENA_HDR_t *arena_bump(ARENA_t *a, size_t size)
+{
+    ARENA_HDR_t   *h;
+    ARENA_CHUNK_t *c;
+    size_t        len;
+    size_t        cap;
+
+    h   = NULL;
+    len = arena_round(size);
+    c   = a->cur;
+    while ((NULL != c) && (len > (c->cap - c->off))) {
+        c = c->next;
+        if (NULL != c) {
+            /* Chunks after the current one are free. */
+            c->off = 0;
+        }
+    }
+    if (NULL == c) {
+        cap = (ARENA_CHUNK_SIZE > len) ? ARENA_CHUNK_SIZE : len;
+        c = malloc(sizeof(ARENA_CHUNK_t) + cap);
+        if (NULL != c) {
+            a->stat.heap++;
+            c->cap  = cap;
+            c->off  = 0;
+            c->next = NULL;
+            if (NULL == a->cur) {
+                a->head = c;
+            }
+            else {
+                /* Append after the last chunk. */
+                while (NULL != a->cur->next) {
+                    a->cur = a->cur->next;
+                }
+                a->cur->next = c;
+            }
+        }
+    }
+    if (NULL != c) {
+        a->cur = c;
+        h = (ARENA_HDR_t *)(arena_data(c) + c->off);
+        h->size = size;
+        h->tag  = arena_tag(a);
+        c->off  += len;
+        a->used += len;
+        if (a->peak < a->used) {
+            a->peak = a->used;
+        }
+    }
+
+    return h;
+}
+
+/**
+ * @brief Allocate a block, from the arena a if bump, otherwise from the heap.
+ *        The block is counted in a, if not NULL.
+ */
+static void *arena_alloc(ARENA_t *a, size_t size, bool bump)
+{
+    ARENA_HDR_t *h;
+
+    h = ((NULL != a) && bump) ? arena_bump(a, size) : NULL;
+    if (NULL == h) {
+        h = malloc(sizeof(ARENA_HDR_t) + size);
+        if (NULL != h) {
+            h->size = size;
+            h->tag  = (NULL != a) ? ARENA_TAG_COUNTED : ARENA_TAG_HEAP;
+            if (NULL != a) {
+                a->stat.heap++;
+            }
+        }
+    }
+    if ((NULL != h) && (NULL != a)) {
+        a->stat.allocs++;
+        a->stat.bytes += size;
+        a->stat.live  += (int64_t)size;
+    }
+
+    return (NULL != h) ? (void *)(h + 1) : NULL;
+}
+
+/**
+ * @brief Whether a block is the last one of the innermost scope of an arena.
+ */
+static bool arena_is_top(const ARENA_t *a, const ARENA_HDR_t *h)
+{
+    ARENA_CHUNK_t *c;
+
+    c = a->cur;
+    return (0 < a->depth) && (arena_tag(a) == h->tag) && (NULL != c) &&
+           ((const uint8_t *)h + arena_round(h->size) == arena_data(c) + c->off);
+}
+
+/**
+ * @brief Open a scope on the arena of the calling thread. Blocks allocated
+ *        in it are released by the matching utils_arena_end(). Scopes nest
+ *        up to UTILS_ARENA_DEPTH_MAX deep.
+ *        Objects that outlive the scope must not be allocated in it, see
+ *        utils_arena_pause(). Objects of outer scopes may be grown in it.
+ *
+ * @return  Status of this function.
+ *
+ * @retval UTILS_E_OK       Success.
+ * @retval UTILS_E_RESOURCE Memory allocation error, or nested too deep.
+ */
+int utils_arena_begin(void)
+{
+    int          ret;
+    ARENA_t      *a;
+    ARENA_MARK_t *m;
+
+    pthread_once(&arena_once, arena_key_init);
+    a = arena_cur;
+    if (NULL == a) {
+        a = calloc(1, sizeof(ARENA_t));
+        if (NULL != a) {
+            arena_cur = a;
+            pthread_setspecific(arena_key, a);
+        }
+    }
+    if ((NULL == a) || (UTILS_ARENA_DEPTH_MAX <= a->depth)) {
+        ret = UTILS_E_RESOURCE;
+    }
+    else {
+        m = &a->mark[a->depth++];
+        m->chunk = a->cur;
+        m->off   = (NULL != a->cur) ? a->cur->off : 0;
+        m->used  = a->used;
+        m->peak  = a->peak;
+        m->stat  = a->stat;
+        a->peak  = a->used;
+        ret = UTILS_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Close the innermost scope of the calling thread and release all
+ *        blocks of the arena allocated in it.
+ *
+ * @param stat[out] Allocations of the scope, or NULL.
+ */
+void utils_arena_end(UTILS_ARENA_STAT_t *stat)
+{
+    ARENA_t      *a;
+    ARENA_MARK_t *m;
+
+    a = arena_cur;
+    if ((NULL != a) && (0 < a->depth)) {
+        m = &a->mark[--a->depth];
+        if (NULL != stat) {
+            stat->allocs = a->stat.allocs - m->stat.allocs;
+            stat->frees  = a->stat.frees - m->stat.frees;
+            stat->bytes  = a->stat.bytes - m->stat.bytes;
+            stat->live   = a->stat.live - m->stat.live;
+            stat->heap   = a->stat.heap - m->stat.heap;
+            stat->peak   = a->peak - m->used;
+        }
+        a->cur  = (NULL != m->chunk) ? m->chunk : a->head;
+        if (NULL != a->cur) {
+            a->cur->off = (NULL != m->chunk) ? m->off : 0;
+        }
+        a->used = m->used;
+        a->peak = (m->peak > a->peak) ? m->peak : a->peak;
+    }
+    else if (NULL != stat) {
+        memset(stat, 0, sizeof(UTILS_ARENA_STAT_t));
+    }
+}
+
+/**
+ * @brief Pause or resume the scope of the calling thread. While paused, new
+ *        blocks come from the heap and are not counted, so objects that
+ *        outlive the scope can be worked on. Blocks of the arena may still
+ *        be freed or grown.
+ *
+ * @param pause[in] true to pause, false to resume.
+ * @return          The previous state, to be given back to this function.
+ */
+bool utils_arena_pause(bool pause)
+{
+    bool ret;
+
+    ret = false;
+    if (NULL != arena_cur) {
+        ret = arena_cur->paused;
+        arena_cur->paused = pause;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Release the chunks of the arena of the calling thread. No scope
+ *        may be open. The arena is released at the exit of the thread anyway.
+ */
+void utils_arena_release(void)
+{
+    ARENA_t *a;
+
+    a = arena_cur;
+    if ((NULL != a) && (0 == a->depth)) {
+        pthread_setspecific(arena_key, NULL);
+        arena_cur = NULL;
+        arena_destroy(a);
+    }
+}
+
+/**
+ * @brief Allocate a block, from the arena in a scope, otherwise from the heap.
+ *
+ * @param size[in]  Bytes.
+ * @return          Block aligned to 16 bytes, or NULL.
+ */
+void *utils_arena_malloc(size_t size)
+{
+    return arena_alloc(arena_active(), size, true);
+}
+
+/**
+ * @brief Allocate a zeroed block of nmemb * size bytes.
+ */
+void *utils_arena_calloc(size_t nmemb, size_t size)
+{
+    void *p;
+
+    p = NULL;
+    if ((0 == size) || ((SIZE_MAX / size) >= nmemb)) {
+        p = utils_arena_malloc(nmemb * size);
+        if (NULL != p) {
+            memset(p, 0, nmemb * size);
+        }
+    }
+
+    return p;
+}
+
+/**
+ * @brief Resize a block. A block of the innermost scope is grown in place if
+ *        it is the last one and its chunk has room, otherwise moved within
+ *        the scope. Any other block is grown on the heap.
+ *
+ * @param p[in]         Block, or NULL.
+ * @param oldsize[in]   Ignored, the size is taken from the block.
+ * @param newsize[in]   Bytes.
+ * @return              Block, or NULL with p left as it is.
+ */
+void *utils_arena_realloc(void *p, size_t oldsize, size_t newsize)
+{
+    void          *q;
+    ARENA_t       *a;
+    ARENA_HDR_t   *h;
+    ARENA_HDR_t   *n;
+    ARENA_CHUNK_t *c;
+    size_t        size;
+    size_t        grow;
+
+    (void)oldsize;
+    a = arena_active();
+    if (NULL == p) {
+        q = arena_alloc(a, newsize, true);
+    }
+    else {
+        h    = (ARENA_HDR_t *)p - 1;
+        size = h->size;
+        q    = NULL;
+        if (arena_on_heap(h)) {
+            n = realloc(h, sizeof(ARENA_HDR_t) + newsize);
+            if (NULL != n) {
+                h = n;
+                h->size = newsize;
+                q = h + 1;
+            }
+        }
+        else if (newsize <= size) {
+            q = p;
+            newsize = size;
+        }
+        else if ((NULL != a) && arena_is_top(a, h)) {
+            c    = a->cur;
+            grow = arena_round(newsize) - arena_round(size);
+            if (grow <= (c->cap - c->off)) {
+                c->off  += grow;
+                a->used += grow;
+                if (a->peak < a->used) {
+                    a->peak = a->used;
+                }
+                h->size = newsize;
+                q = p;
+            }
+        }
+        if (NULL != q) {
+            /* A counted block stays counted, in a scope or not. */
+            if ((ARENA_TAG_HEAP != h->tag) && (NULL != arena_cur) && (newsize != size)) {
+                arena_cur->stat.bytes += (newsize > size) ? (newsize - size) : 0;
+                arena_cur->stat.live  += (int64_t)newsize - (int64_t)size;
+            }
+        }
+        else if (!arena_on_heap(h)) {
+            q = arena_alloc(a, newsize, (NULL != a) && (arena_tag(a) == h->tag));
+            if (NULL != q) {
+                memcpy(q, p, size);
+                utils_arena_free(p, size);
+            }
+        }
+    }
+
+    return q;
+}
+
+/**
+ * @brief Free a block. A block of the arena is given back only if it is the
+ *        last one of the innermost scope, the others go with their scope.
+ *        A block is counted as freed only if it was counted as allocated,
+ *        whether the scope is paused or not.
+ *
+ * @param p[in]     Block, or NULL.
+ * @param size[in]  Ignored, the size is taken from the block.
+ */
+void utils_arena_free(void *p, size_t size)
+{
+    ARENA_t     *a;
+    ARENA_HDR_t *h;
+    size_t      len;
+
+    (void)size;
+    if (NULL != p) {
+        h = (ARENA_HDR_t *)p - 1;
+        a = arena_cur;
+        if ((NULL != a) && (ARENA_TAG_HEAP != h->tag)) {
+            a->stat.frees++;
+            a->stat.live -= (int64_t)h->size;
+        }
+        if (arena_on_heap(h)) {
+            free(h);
+        }
+        else if ((NULL != a) && arena_is_top(a, h)) {
+            len = arena_round(h->size);
+            a->cur->off -= len;
+            a->used     -= len;
+        }
+    }
+}
+
+/**
+ * @brief utils_arena_realloc() without the old size, the XREALLOC hook of
+ *        libtommath 1.1.
+ */
+void *utils_arena_xrealloc(void *p, size_t size)
+{
+    return utils_arena_realloc(p, 0, size);
+}
+
+/**
+ * @brief utils_arena_free() without the size, the XFREE hook of
+ *        libtommath 1.1.
+ */
+void utils_arena_xfree(void *p)
+{
+    utils_arena_free(p, 0);
+}
+
+/**
+ * @brief Counters of the arena of the calling thread since it was made.
+ *
+ * @param stat[out] Counters.
+ */
+void utils_arena_stat(UTILS_ARENA_STAT_t *stat)
+{
+    if (NULL != arena_cur) {
+        *stat = arena_cur->stat;
+        stat->peak = arena_cur->peak;
+    }
+    else {
+        memset(stat, 0, sizeof(UTILS_ARENA_STAT_t));
+    }
+}
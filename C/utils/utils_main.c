@@ -14,10 +14,18 @@
 //#define TEST_UTILS_HEXDUMP  (1)
 #define TEST_UTILS_BLKCMP   (1)
 //#define TEST_UTILS_TIMESPEC (1)
+//#define TEST_UTILS_TPOOL    (1)
+//#define TEST_UTILS_RANDOM   (1)
+//#define TEST_UTILS_ARENA    (1)
+//#define TEST_UTILS_SHA256   (1)
 
 extern bool hexdump_test();
 extern bool blkcmp_test();
 extern bool ts_test();
+extern bool tpool_test();
+extern bool random_test();
+extern bool arena_test();
+extern bool sha256_test();
 
 int main(int argc, char *argv[])
 {
@@ -33,6 +41,18 @@ int main(int argc, char *argv[])
 #ifdef TEST_UTILS_TIMESPEC
     ret = ts_test() ? EXIT_SUCCESS : EXIT_FAILURE;
 #endif  /* TEST_UTILS_TIMESPEC */
+#ifdef TEST_UTILS_TPOOL
+    ret = tpool_test() ? EXIT_SUCCESS : EXIT_FAILURE;
+#endif  /* TEST_UTILS_TPOOL */
+#ifdef TEST_UTILS_RANDOM
+    ret = random_test() ? EXIT_SUCCESS : EXIT_FAILURE;
+#endif  /* TEST_UTILS_RANDOM */
+#ifdef TEST_UTILS_ARENA
+    ret = arena_test() ? EXIT_SUCCESS : EXIT_FAILURE;
+#endif  /* TEST_UTILS_ARENA */
+#ifdef TEST_UTILS_SHA256
+    ret = sha256_test() ? EXIT_SUCCESS : EXIT_FAILURE;
+#endif  /* TEST_UTILS_SHA256 */
 
     return ret;
 }
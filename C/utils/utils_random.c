@@ -0,0 +1,56 @@
+/**
+ * @file utils_random.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * 
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ * 
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/random.h>
+
+#include "utils.h"
+
+/**
+ * @brief Fill a buffer with cryptographically secure random bytes
+ *        (getrandom(2), blocking until the kernel pool is initialized).
+ * 
+ * @param buf [out] Buffer
+ * @param len [in]  Length of buffer
+ * 
+ * @return          Status of this function
+ * @retval  UTILS_E_OK          Success
+ * @retval  UTILS_E_PARAM       Invalid Parameter
+ * @retval  UTILS_E_INTERNAL    Internal Error
+ */
+int utils_random(void *buf, size_t len)
+{
+    int     ret;
+    ssize_t res;
+    uint8_t *p;
+
+    if ((NULL == buf) && (0 < len)) {
+        ret = UTILS_E_PARAM;
+    }
+    else {
+        ret = UTILS_E_OK;
+        p   = (uint8_t *)buf;
+        while ((UTILS_E_OK == ret) && (0 < len)) {
+            res = getrandom(p, len, 0);
+            if (0 < res) {
+                p   += res;
+                len -= (size_t)res;
+            }
+            else if ((0 > res) && (EINTR == errno)) {
+                /* Interrupted, try again. */
+            }
+            else {
+                ret = UTILS_E_INTERNAL;
+            }
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file utils_sha256.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief SHA-256 (FIPS 180-4).
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+#define ROTR(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/**
+ * @brief Process one block of 64 bytes.
+ */
+static void sha256_block(uint32_t *h, const uint8_t *p)
+{
+    uint32_t w[64];
+    uint32_t a, b, c, d, e, f, g, k;
+    uint32_t t1;
+    uint32_t t2;
+    int      i;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[(4 * i) + 1] << 16) |
+               ((uint32_t)p[(4 * i) + 2] << 8) | (uint32_t)p[(4 * i) + 3];
+    }
+    for (i = 16; i < 64; i++) {
+        w[i] = (ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10)) + w[i - 7] +
+               (ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3)) + w[i - 16];
+    }
+
+    a = h[0];
+    b = h[1];
+    c = h[2];
+    d = h[3];
+    e = h[4];
+    f = h[5];
+    g = h[6];
+    k = h[7];
+    for (i = 0; i < 64; i++) {
+        t1 = k + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += k;
+    memset(w, 0, sizeof(w));
+}
+
+/**
+ * @brief Start a SHA-256 hash.
+ *
+ * @param ctx [out] Hash state
+ */
+void utils_sha256_init(UTILS_SHA256_t *ctx)
+{
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    memcpy(ctx->h, iv, sizeof(iv));
+    ctx->len  = 0;
+    ctx->fill = 0;
+}
+
+/**
+ * @brief Hash more data.
+ *
+ * @param ctx [in,out]  Hash state
+ * @param data [in]     Data (NULL is allowed if len is 0)
+ * @param len [in]      Length of data
+ */
+void utils_sha256_update(UTILS_SHA256_t *ctx, const void *data, size_t len)
+{
+    const uint8_t *p;
+    size_t        n;
+
+    p = (const uint8_t *)data;
+    ctx->len += len;
+    if (0 < ctx->fill) {
+        n = UTILS_SHA256_BLOCK - ctx->fill;
+        n = (n < len) ? n : len;
+        memcpy(&ctx->buf[ctx->fill], p, n);
+        ctx->fill += n;
+        p   += n;
+        len -= n;
+        if (UTILS_SHA256_BLOCK == ctx->fill) {
+            sha256_block(ctx->h, ctx->buf);
+            ctx->fill = 0;
+        }
+    }
+    while (UTILS_SHA256_BLOCK <= len) {
+        sha256_block(ctx->h, p);
+        p   += UTILS_SHA256_BLOCK;
+        len -= UTILS_SHA256_BLOCK;
+    }
+    if (0 < len) {
+        memcpy(ctx->buf, p, len);
+        ctx->fill = len;
+    }
+}
+
+/**
+ * @brief Finish a SHA-256 hash. The hash state is cleared.
+ *
+ * @param ctx [in,out]  Hash state
+ * @param digest [out]  Digest of UTILS_SHA256_LEN bytes
+ */
+void utils_sha256_final(UTILS_SHA256_t *ctx, uint8_t *digest)
+{
+    uint64_t bits;
+    int      i;
+
+    bits = ctx->len * 8;
+    ctx->buf[ctx->fill++] = 0x80;
+    if ((UTILS_SHA256_BLOCK - 8) < ctx->fill) {
+        memset(&ctx->buf[ctx->fill], 0, UTILS_SHA256_BLOCK - ctx->fill);
+        sha256_block(ctx->h, ctx->buf);
+        ctx->fill = 0;
+    }
+    memset(&ctx->buf[ctx->fill], 0, (UTILS_SHA256_BLOCK - 8) - ctx->fill);
+    for (i = 0; i < 8; i++) {
+        ctx->buf[UTILS_SHA256_BLOCK - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+    sha256_block(ctx->h, ctx->buf);
+
+    for (i = 0; i < 8; i++) {
+        digest[4 * i]       = (uint8_t)(ctx->h[i] >> 24);
+        digest[(4 * i) + 1] = (uint8_t)(ctx->h[i] >> 16);
+        digest[(4 * i) + 2] = (uint8_t)(ctx->h[i] >> 8);
+        digest[(4 * i) + 3] = (uint8_t)ctx->h[i];
+    }
+    memset(ctx, 0, sizeof(UTILS_SHA256_t));
+}
+
+/**
+ * @brief SHA-256 hash of one buffer.
+ *
+ * @param data [in]     Data (NULL is allowed if len is 0)
+ * @param len [in]      Length of data
+ * @param digest [out]  Digest of UTILS_SHA256_LEN bytes
+ *
+ * @return          Status of this function
+ * @retval  UTILS_E_OK          Success
+ * @retval  UTILS_E_PARAM       Invalid Parameter
+ */
+int utils_sha256(const void *data, size_t len, uint8_t *digest)
+{
+    int            ret;
+    UTILS_SHA256_t ctx;
+
+    if (((NULL == data) && (0 < len)) || (NULL == digest)) {
+        ret = UTILS_E_PARAM;
+    }
+    else {
+        utils_sha256_init(&ctx);
+        utils_sha256_update(&ctx, data, len);
+        utils_sha256_final(&ctx, digest);
+        ret = UTILS_E_OK;
+    }
+
+    return ret;
+}
@@ -66,4 +66,6 @@ bool utils_blkcmp(const void *left, size_t llen, const void *right, size_t rlen,
     else {
         ret = (0 != memcmp(left, right, llen)) ? false : true;
     }
+
+    return ret;
 }
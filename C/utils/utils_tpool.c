@@ -0,0 +1,265 @@
+/**
+ * @file utils_tpool.c
+ * @author Hidenori BABA (BabaH@dotpro.jp)
+ * @brief Persistent worker thread pool.
+ *        utils_tpool_run() spreads the indices 0 .. cnt-1 of one job over the
+ *        helper threads and the calling thread, and returns when all of them
+ *        are done. Jobs of concurrent callers are run one after another,
+ *        unless they are posted by utils_tpool_try_run(), which does not wait.
+ *
+ * @copyright Copyright (c) 2020 Hidenori BABA
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "utils.h"
+
+typedef struct {
+    pthread_mutex_t    run_lock;    /* Serializes callers of utils_tpool_run(). */
+    pthread_mutex_t    lock;        /* Protects the fields below. */
+    pthread_cond_t     wake;        /* Signaled when a job is posted or on stop. */
+    pthread_cond_t     done;        /* Signaled when the last index is done. */
+    pthread_t          *th;
+    size_t             nthreads;
+    bool               stop;
+    UTILS_TPOOL_FUNC_t func;
+    void               *arg;
+    size_t             cnt;
+    size_t             next;        /* Next index to be claimed. */
+    size_t             pending;     /* Indices not finished yet. */
+} UTILS_TPOOL_t;
+
+/**
+ * @brief Claim and run indices of the current job until none is left.
+ *        Called with pool->lock held, returns with pool->lock held.
+ */
+static void tpool_drain(UTILS_TPOOL_t *pool)
+{
+    size_t             idx;
+    UTILS_TPOOL_FUNC_t func;
+    void               *arg;
+
+    while (pool->next < pool->cnt) {
+        idx  = pool->next++;
+        func = pool->func;
+        arg  = pool->arg;
+        pthread_mutex_unlock(&pool->lock);
+        func(arg, idx);
+        pthread_mutex_lock(&pool->lock);
+        pool->pending--;
+        if (0 == pool->pending) {
+            pthread_cond_broadcast(&pool->done);
+        }
+    }
+}
+
+/**
+ * @brief Helper thread main loop.
+ */
+static void *tpool_worker(void *ctx)
+{
+    UTILS_TPOOL_t *pool;
+
+    pool = (UTILS_TPOOL_t *)ctx;
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop) {
+        if (pool->next < pool->cnt) {
+            tpool_drain(pool);
+        }
+        else {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Allocate a thread pool.
+ *
+ * @param nthreads [in] Number of helper threads. The calling thread of
+ *                      utils_tpool_run() works as one more thread.
+ *
+ * @return  Thread pool context, NULL on error.
+ */
+void *utils_tpool_alloc(size_t nthreads)
+{
+    UTILS_TPOOL_t *pool;
+    bool          ok;
+
+    pool = calloc(1, sizeof(UTILS_TPOOL_t));
+    if (NULL != pool) {
+        ok = (0 == pthread_mutex_init(&pool->run_lock, NULL)) &&
+             (0 == pthread_mutex_init(&pool->lock, NULL)) &&
+             (0 == pthread_cond_init(&pool->wake, NULL)) &&
+             (0 == pthread_cond_init(&pool->done, NULL));
+        if (ok && (0 < nthreads)) {
+            pool->th = calloc(nthreads, sizeof(pthread_t));
+            ok = (NULL != pool->th);
+        }
+        while (ok && (pool->nthreads < nthreads)) {
+            if (0 == pthread_create(&pool->th[pool->nthreads], NULL, tpool_worker, pool)) {
+                pool->nthreads++;
+            }
+            else {
+                ok = false;
+            }
+        }
+        if (!ok) {
+            utils_tpool_free(pool);
+            pool = NULL;
+        }
+    }
+
+    return pool;
+}
+
+/**
+ * @brief Stop the helper threads and release a thread pool.
+ *
+ * @param ctx [in]  Thread pool context
+ */
+void utils_tpool_free(void *ctx)
+{
+    UTILS_TPOOL_t *pool;
+    size_t        i;
+
+    if (NULL != ctx) {
+        pool = (UTILS_TPOOL_t *)ctx;
+        pthread_mutex_lock(&pool->lock);
+        pool->stop = true;
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+        for (i = 0; i < pool->nthreads; i++) {
+            pthread_join(pool->th[i], NULL);
+        }
+        free(pool->th);
+        pthread_cond_destroy(&pool->done);
+        pthread_cond_destroy(&pool->wake);
+        pthread_mutex_destroy(&pool->lock);
+        pthread_mutex_destroy(&pool->run_lock);
+        memset(pool, 0, sizeof(UTILS_TPOOL_t));
+        free(pool);
+    }
+}
+
+/**
+ * @brief Get the number of threads working on a job.
+ *
+ * @param ctx [in]  Thread pool context (NULL is allowed).
+ *
+ * @return          Number of helper threads plus the calling thread.
+ */
+size_t utils_tpool_size(void *ctx)
+{
+    return (NULL != ctx) ? (((UTILS_TPOOL_t *)ctx)->nthreads + 1) : 1;
+}
+
+/**
+ * @brief Post a job and take part in it until all of its indices are done.
+ *        Called with pool->run_lock held.
+ */
+static void tpool_post(UTILS_TPOOL_t *pool, UTILS_TPOOL_FUNC_t func, void *arg, size_t cnt)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->func    = func;
+    pool->arg     = arg;
+    pool->cnt     = cnt;
+    pool->next    = 0;
+    pool->pending = cnt;
+    pthread_cond_broadcast(&pool->wake);
+    tpool_drain(pool);
+    while (0 < pool->pending) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pool->func = NULL;
+    pool->arg  = NULL;
+    pool->cnt  = 0;
+    pool->next = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * @brief Run func(arg, idx) for idx = 0 .. cnt-1 and wait for all of them.
+ *        Without a pool, the calls are made in order by the calling thread.
+ *
+ * @param ctx [in]  Thread pool context (NULL is allowed).
+ * @param func [in] Job function.
+ * @param arg [in]  Argument of the job function.
+ * @param cnt [in]  Number of indices.
+ *
+ * @return          Status of this function
+ * @retval  UTILS_E_OK          Success
+ * @retval  UTILS_E_PARAM       Invalid Parameter
+ */
+int utils_tpool_run(void *ctx, UTILS_TPOOL_FUNC_t func, void *arg, size_t cnt)
+{
+    int           ret;
+    size_t        i;
+    UTILS_TPOOL_t *pool;
+
+    if (NULL == func) {
+        ret = UTILS_E_PARAM;
+    }
+    else if ((NULL == ctx) || (1 >= cnt)) {
+        for (i = 0; i < cnt; i++) {
+            func(arg, i);
+        }
+        ret = UTILS_E_OK;
+    }
+    else {
+        pool = (UTILS_TPOOL_t *)ctx;
+        pthread_mutex_lock(&pool->run_lock);
+        tpool_post(pool, func, arg, cnt);
+        pthread_mutex_unlock(&pool->run_lock);
+        ret = UTILS_E_OK;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Run func(arg, idx) for idx = 0 .. cnt-1 like utils_tpool_run(), but
+ *        never wait for the pool. If it is running a job, of another caller
+ *        or of the calling thread itself, the calls are made in order by the
+ *        calling thread. So it may be called from a job of the same pool.
+ *
+ * @param ctx [in]  Thread pool context (NULL is allowed).
+ * @param func [in] Job function.
+ * @param arg [in]  Argument of the job function.
+ * @param cnt [in]  Number of indices.
+ *
+ * @return          Status of this function
+ * @retval  UTILS_E_OK          Success
+ * @retval  UTILS_E_PARAM       Invalid Parameter
+ */
+int utils_tpool_try_run(void *ctx, UTILS_TPOOL_FUNC_t func, void *arg, size_t cnt)
+{
+    int           ret;
+    size_t        i;
+    UTILS_TPOOL_t *pool;
+
+    pool = (UTILS_TPOOL_t *)ctx;
+    if (NULL == func) {
+        ret = UTILS_E_PARAM;
+    }
+    else if ((NULL == pool) || (1 >= cnt) || (0 != pthread_mutex_trylock(&pool->run_lock))) {
+        for (i = 0; i < cnt; i++) {
+            func(arg, i);
+        }
+        ret = UTILS_E_OK;
+    }
+    else {
+        tpool_post(pool, func, arg, cnt);
+        pthread_mutex_unlock(&pool->run_lock);
+        ret = UTILS_E_OK;
+    }
+
+    return ret;
+}